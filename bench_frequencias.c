@@ -0,0 +1,84 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "frequencias.h"
+
+#define TAMANHO_AMOSTRA (64u << 20)
+#define REPETICOES 5
+
+/**
+ * @brief Microbenchmark do histograma de bytes: compara a contagem ingênua (um contador por byte)
+ *        com o núcleo de histogramas intercalados de frequencias.c em dados de perfis diferentes.
+ * @details Uso: ./bench_frequencias [MB]. Imprime a melhor vazão (MB/s) de REPETICOES execuções.
+ */
+
+static double agora(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+static void contaIngenuo(const unsigned char* dados, size_t n, unsigned long long int* frequencias) {
+    for (size_t i = 0; i < n; i++) {
+        frequencias[dados[i]]++;
+    }
+}
+
+static void geraAmostra(const char* tipo, unsigned char* dados, size_t n) {
+    unsigned int estado = 12345;
+    const char* texto = "Lorem ipsum dolor sit amet, consectetur adipiscing elit. 2026-10-16 INFO ok\n";
+    size_t tamTexto = strlen(texto);
+    for (size_t i = 0; i < n; i++) {
+        estado = estado * 1103515245u + 12345u;
+        if (strcmp(tipo, "aleatorio") == 0) {
+            dados[i] = (unsigned char) (estado >> 16);
+        } else if (strcmp(tipo, "zeros") == 0) {
+            dados[i] = 0;
+        } else {
+            dados[i] = (unsigned char) texto[i % tamTexto];
+        }
+    }
+}
+
+static double mede(void (*conta)(const unsigned char*, size_t, unsigned long long int*),
+                   const unsigned char* dados, size_t n, unsigned long long int* frequencias) {
+    double melhor = 1e30;
+    for (int r = 0; r < REPETICOES; r++) {
+        memset(frequencias, 0, 256 * sizeof(unsigned long long int));
+        double inicio = agora();
+        conta(dados, n, frequencias);
+        double t = agora() - inicio;
+        if (t < melhor) {
+            melhor = t;
+        }
+    }
+    return n / melhor / 1e6;
+}
+
+int main(int argc, char* argv[]) {
+    size_t n = argc > 1 ? (size_t) atol(argv[1]) << 20 : TAMANHO_AMOSTRA;
+    unsigned char* dados = (unsigned char*) malloc(n);
+    if (dados == NULL) {
+        printf("Erro de alocacao de memoria.\n");
+        return 1;
+    }
+
+    const char* tipos[] = {"texto", "aleatorio", "zeros"};
+    unsigned long long int ingenuo[256], intercalado[256];
+
+    printf("%-10s %14s %14s\n", "dados", "ingenuo MB/s", "8x MB/s");
+    for (int t = 0; t < 3; t++) {
+        geraAmostra(tipos[t], dados, n);
+        double v1 = mede(contaIngenuo, dados, n, ingenuo);
+        double v2 = mede(contaFrequencias, dados, n, intercalado);
+        if (memcmp(ingenuo, intercalado, sizeof(ingenuo)) != 0) {
+            printf("Erro: contagens divergentes em %s\n", tipos[t]);
+            return 1;
+        }
+        printf("%-10s %14.1f %14.1f\n", tipos[t], v1, v2);
+    }
+
+    free(dados);
+    return 0;
+}
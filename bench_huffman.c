@@ -0,0 +1,430 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/resource.h>
+#include "bitmap.h"
+#include "codificador.h"
+#include "decodificador.h"
+#include "frequencias.h"
+#include "huffman.h"
+#include "libhuffman.h"
+
+#define TAMANHO_AMOSTRA (16u << 20)
+#define REPETICOES 5
+#define REPETICOES_ARVORE 2000   ///< as fases sobre a árvore custam microssegundos; mede-se a média
+
+/**
+ * @brief Benchmark de cada fase da compactação sobre um corpus: histograma, construção da árvore,
+ *        dicionário, codificação, serialização e desserialização da árvore, decodificação, e o
+ *        caminho completo da biblioteca (compactaMemoria/descompactaMemoria com as opções padrão).
+ * @details Uso: ./bench_huffman [-m MB] [-r repeticoes] [-o resultado.json] [arquivo...]. Sem arquivos,
+ *          usa amostras sintéticas de -m MB: texto, log, binario, aleatorio, unico (um só byte) e
+ *          enviesado (distribuição geométrica). Cada fase informa a melhor de -r execuções em MB/s e
+ *          ns/byte; as fases sobre a árvore, de custo fixo, informam só a média em ns por chamada. O
+ *          pico de memória residente é o do processo até o fim da amostra. Com -o, grava os mesmos
+ *          números em JSON ("-" para a saída padrão).
+ */
+
+/**
+ * @brief Tempo e vazão de uma fase sobre uma amostra.
+ */
+typedef struct {
+    const char* nome;
+    double segundos;    ///< melhor tempo de uma execução (média por chamada nas fases da árvore)
+    int custoFixo;      ///< 1 nas fases sobre a árvore, que não dependem do tamanho da amostra
+} Fase;
+
+#define NUM_FASES 9
+
+/**
+ * @brief Resultado de uma amostra do corpus.
+ */
+typedef struct {
+    const char* nome;
+    size_t tamanho;
+    size_t tamanhoCompactado;   ///< saída de compactaMemoria
+    long picoRssKB;
+    Fase fases[NUM_FASES];
+} Medicao;
+
+static double agora(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+static long picoRssKB(void) {
+    struct rusage uso;
+    if (getrusage(RUSAGE_SELF, &uso) != 0) {
+        return -1;
+    }
+#ifdef __APPLE__
+    return uso.ru_maxrss / 1024;  // bytes no macOS
+#else
+    return uso.ru_maxrss;
+#endif
+}
+
+/**
+ * @brief Preenche @p dados com a amostra sintética @p tipo (sempre a mesma para o mesmo tamanho).
+ * @return 0 em sucesso; -1 se o tipo não existir.
+ */
+static int geraAmostra(const char* tipo, unsigned char* dados, size_t n) {
+    unsigned int estado = 12345;
+    const char* texto = "Lorem ipsum dolor sit amet, consectetur adipiscing elit. 2026-10-16 INFO ok\n";
+    const char* caminhos[] = {"/api/v1/itens", "/api/v1/pedidos", "/login", "/estatico/app.js"};
+    const char* niveis[] = {"INFO", "INFO", "INFO", "WARN", "DEBUG", "ERROR"};
+    size_t tamTexto = strlen(texto);
+
+    if (strcmp(tipo, "log") == 0) {
+        size_t i = 0;
+        unsigned int segundo = 0;
+        while (i < n) {
+            char linha[160];
+            estado = estado * 1103515245u + 12345u;
+            segundo += (estado >> 28) & 3;
+            int tam = snprintf(linha, sizeof(linha), "2026-10-16 %02u:%02u:%02u %s req=%u ms=%u path=%s\n",
+                               segundo / 3600 % 24, segundo / 60 % 60, segundo % 60, niveis[(estado >> 8) % 6],
+                               estado >> 12, (estado >> 4) % 500, caminhos[(estado >> 20) % 4]);
+            size_t copia = (size_t) tam < n - i ? (size_t) tam : n - i;
+            memcpy(dados + i, linha, copia);
+            i += copia;
+        }
+        return 0;
+    }
+    for (size_t i = 0; i < n; i++) {
+        estado = estado * 1103515245u + 12345u;
+        if (strcmp(tipo, "texto") == 0) {
+            dados[i] = (unsigned char) texto[(i + (estado >> 28)) % tamTexto];
+        } else if (strcmp(tipo, "aleatorio") == 0) {
+            dados[i] = (unsigned char) (estado >> 16);
+        } else if (strcmp(tipo, "binario") == 0) {
+            // Registros de 16 bytes: inteiros pequenos little-endian, um campo de flags e preenchimento
+            size_t campo = i % 16;
+            dados[i] = campo < 2 ? (unsigned char) (estado >> 20) : campo == 4 ? (unsigned char) (estado >> 28) :
+                       campo == 8 ? (unsigned char) (i >> 4) : 0;
+        } else if (strcmp(tipo, "unico") == 0) {
+            dados[i] = 'a';
+        } else if (strcmp(tipo, "enviesado") == 0) {
+            // Geométrica: cada byte tem metade da probabilidade do anterior
+            unsigned int bits = (estado >> 8) | (1u << 23);
+            int zeros = 0;
+            while (!(bits & 1u)) {
+                bits >>= 1;
+                zeros++;
+            }
+            dados[i] = (unsigned char) ('a' + zeros);
+        } else {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Lê um arquivo inteiro do corpus.
+ * @return Bytes lidos (liberar com free) ou NULL em erro.
+ */
+static unsigned char* leArquivo(const char* nome, size_t* tamanho) {
+    FILE* f = fopen(nome, "rb");
+    if (f == NULL) {
+        return NULL;
+    }
+    unsigned char* dados = NULL;
+    if (fseek(f, 0, SEEK_END) == 0) {
+        long fim = ftell(f);
+        rewind(f);
+        if (fim >= 0 && (dados = (unsigned char*) malloc(fim > 0 ? (size_t) fim : 1)) != NULL) {
+            *tamanho = (size_t) fim;
+            if (fread(dados, 1, *tamanho, f) != *tamanho) {
+                free(dados);
+                dados = NULL;
+            }
+        }
+    }
+    fclose(f);
+    return dados;
+}
+
+static void registraMelhor(Fase* fase, const char* nome, double inicio, double* melhor) {
+    double t = agora() - inicio;
+    if (t < *melhor) {
+        *melhor = t;
+    }
+    fase->nome = nome;
+    fase->segundos = *melhor;
+    fase->custoFixo = 0;
+}
+
+/**
+ * @brief Mede todas as fases sobre uma amostra, conferindo que a decodificação reproduz os dados.
+ * @return 0 em sucesso; -1 em falta de memória ou divergência.
+ */
+static int medeAmostra(const unsigned char* dados, size_t n, int repeticoes, Medicao* m) {
+    EscritorBits* e = criaEscritorBits(NULL);
+    bitmap* serializada = bitmapInit(TAMANHO_MAX_ARVORE_BITS);
+    unsigned char* saida = (unsigned char*) malloc(n + 1);
+    ContextoCompactacao* cc = criaContextoCompactacao(1);
+    ContextoDescompactacao* cd = criaContextoDescompactacao(1);
+    size_t limite = cc ? limiteCompactacao(cc, n) : 0;
+    unsigned char* compactado = (unsigned char*) malloc(limite);
+    int resultado = -1;
+    if (e == NULL || serializada == NULL || saida == NULL || cc == NULL || cd == NULL || compactado == NULL ||
+        reservaEscritorBits(e, n + 8) < 0) {
+        goto fim;
+    }
+
+    unsigned long long int frequencias[256];
+    double melhor = 1e30;
+    for (int r = 0; r < repeticoes; r++) {
+        memset(frequencias, 0, sizeof(frequencias));
+        double inicio = agora();
+        contaFrequencias(dados, n, frequencias);
+        registraMelhor(&m->fases[0], "histograma", inicio, &melhor);
+    }
+
+    ArvoreHuffman arvore;
+    double inicio = agora();
+    for (int r = 0; r < REPETICOES_ARVORE; r++) {
+        construirArvoreHuffman(frequencias, &arvore);
+    }
+    m->fases[1] = (Fase) {"arvore", (agora() - inicio) / REPETICOES_ARVORE, 1};
+
+    Codigo codigos[256];
+    inicio = agora();
+    for (int r = 0; r < REPETICOES_ARVORE; r++) {
+        memset(codigos, 0, sizeof(codigos));
+        if (gerarDicionario(codigos, &arvore) < 0) {
+            goto fim;
+        }
+    }
+    m->fases[2] = (Fase) {"dicionario", (agora() - inicio) / REPETICOES_ARVORE, 1};
+
+    melhor = 1e30;
+    for (int r = 0; r < repeticoes; r++) {
+        reiniciaEscritorBits(e);
+        inicio = agora();
+        codificaBuffer(e, codigos, dados, n);
+        finalizaEscritorBits(e);
+        registraMelhor(&m->fases[3], "codificacao", inicio, &melhor);
+    }
+    unsigned long long int numBits = bitsEscritorBits(e);
+    size_t tamanhoCodificado;
+    const unsigned char* codificado = conteudoEscritorBits(e, &tamanhoCodificado);
+
+    inicio = agora();
+    for (int r = 0; r < REPETICOES_ARVORE; r++) {
+        bitmapLimpa(serializada);
+        serializarArvore(&arvore, serializada);
+    }
+    m->fases[4] = (Fase) {"serializacao", (agora() - inicio) / REPETICOES_ARVORE, 1};
+
+    unsigned int bitsArvore = (unsigned int) bitmapGetLength(serializada);
+    ArvoreHuffman lida;
+    inicio = agora();
+    for (int r = 0; r < REPETICOES_ARVORE; r++) {
+        if (leArvoreHuffman(bitmapGetContents(serializada), bitsArvore, &lida) < 0) {
+            goto fim;
+        }
+    }
+    m->fases[5] = (Fase) {"desserializacao", (agora() - inicio) / REPETICOES_ARVORE, 1};
+
+    Decodificador* d = criaDecodificador(&lida);
+    if (d == NULL) {
+        goto fim;
+    }
+    melhor = 1e30;
+    for (int r = 0; r < repeticoes; r++) {
+        inicio = agora();
+        long long int produzidos = decodificaParaMemoria(d, codificado, numBits, saida, n);
+        registraMelhor(&m->fases[6], "decodificacao", inicio, &melhor);
+        if (produzidos != (long long int) n || memcmp(saida, dados, n) != 0) {
+            liberaDecodificador(d);
+            goto fim;
+        }
+    }
+    liberaDecodificador(d);
+
+    melhor = 1e30;
+    for (int r = 0; r < repeticoes; r++) {
+        inicio = agora();
+        if (compactaMemoria(cc, dados, n, compactado, limite, &m->tamanhoCompactado) != HUFFMAN_OK) {
+            goto fim;
+        }
+        registraMelhor(&m->fases[7], "compacta", inicio, &melhor);
+    }
+    melhor = 1e30;
+    for (int r = 0; r < repeticoes; r++) {
+        size_t produzidos;
+        inicio = agora();
+        if (descompactaMemoria(cd, compactado, m->tamanhoCompactado, saida, n, &produzidos) != HUFFMAN_OK) {
+            goto fim;
+        }
+        registraMelhor(&m->fases[8], "descompacta", inicio, &melhor);
+        if (produzidos != n || memcmp(saida, dados, n) != 0) {
+            goto fim;
+        }
+    }
+    m->tamanho = n;
+    m->picoRssKB = picoRssKB();
+    resultado = 0;
+
+fim:
+    liberaContextoDescompactacao(cd);
+    liberaContextoCompactacao(cc);
+    free(compactado);
+    free(saida);
+    if (serializada) {
+        bitmapLibera(serializada);
+    }
+    liberaEscritorBits(e);
+    return resultado;
+}
+
+static double mbPorSegundo(const Medicao* m, const Fase* f) {
+    return f->segundos > 0 ? m->tamanho / f->segundos / 1e6 : 0;
+}
+
+static double nsPorByte(const Medicao* m, const Fase* f) {
+    return m->tamanho > 0 ? f->segundos * 1e9 / m->tamanho : 0;
+}
+
+static double razao(const Medicao* m) {
+    return m->tamanho > 0 ? (double) m->tamanhoCompactado / m->tamanho : 0;
+}
+
+static void imprimeTabela(FILE* saida, const Medicao* m) {
+    fprintf(saida, "%s: %zu bytes, razão %.4f, pico RSS %ld KB\n", m->nome, m->tamanho, razao(m), m->picoRssKB);
+    for (int k = 0; k < NUM_FASES; k++) {
+        const Fase* f = &m->fases[k];
+        if (f->custoFixo) {
+            fprintf(saida, "  %-16s %17s %18s %14.0f ns\n", f->nome, "-", "-", f->segundos * 1e9);
+        } else {
+            fprintf(saida, "  %-16s %12.1f MB/s %10.3f ns/byte %14.0f ns\n", f->nome, mbPorSegundo(m, f),
+                    nsPorByte(m, f), f->segundos * 1e9);
+        }
+    }
+}
+
+/**
+ * @brief Grava um texto como string JSON, escapando aspas, barras e controles.
+ */
+static void gravaTextoJson(FILE* saida, const char* texto) {
+    fputc('"', saida);
+    for (const unsigned char* p = (const unsigned char*) texto; *p; p++) {
+        if (*p == '"' || *p == '\\') {
+            fprintf(saida, "\\%c", *p);
+        } else if (*p < 0x20) {
+            fprintf(saida, "\\u%04x", *p);
+        } else {
+            fputc(*p, saida);
+        }
+    }
+    fputc('"', saida);
+}
+
+static void gravaJson(FILE* saida, const Medicao* medicoes, int numMedicoes, int repeticoes) {
+    fprintf(saida, "{\n  \"repeticoes\": %d,\n  \"amostras\": [\n", repeticoes);
+    for (int i = 0; i < numMedicoes; i++) {
+        const Medicao* m = &medicoes[i];
+        fprintf(saida, "    {\"nome\": ");
+        gravaTextoJson(saida, m->nome);
+        fprintf(saida, ", \"bytes\": %zu, \"bytes_compactados\": %zu, \"razao\": %.6f, \"pico_rss_kb\": %ld,\n",
+                m->tamanho, m->tamanhoCompactado, razao(m), m->picoRssKB);
+        fprintf(saida, "     \"fases\": {");
+        for (int k = 0; k < NUM_FASES; k++) {
+            const Fase* f = &m->fases[k];
+            fprintf(saida, "%s\n       \"%s\": {\"ns\": %.1f", k ? "," : "", f->nome, f->segundos * 1e9);
+            if (!f->custoFixo) {
+                fprintf(saida, ", \"mb_s\": %.3f, \"ns_byte\": %.4f", mbPorSegundo(m, f), nsPorByte(m, f));
+            }
+            fputc('}', saida);
+        }
+        fprintf(saida, "}}%s\n", i + 1 < numMedicoes ? "," : "");
+    }
+    fprintf(saida, "  ]\n}\n");
+}
+
+int main(int argc, char* argv[]) {
+    size_t tamanho = TAMANHO_AMOSTRA;
+    int repeticoes = REPETICOES;
+    const char* nomeJson = NULL;
+    int primeiroArquivo = argc;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-m") == 0 && i + 1 < argc) {
+            tamanho = (size_t) atol(argv[++i]) << 20;
+        } else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc) {
+            repeticoes = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            nomeJson = argv[++i];
+        } else if (argv[i][0] != '-') {
+            primeiroArquivo = i;
+            break;
+        } else {
+            repeticoes = 0;
+            break;
+        }
+    }
+    if (tamanho == 0 || repeticoes < 1) {
+        printf("Uso: ./bench_huffman [-m <MB por amostra sintética>] [-r <repeticoes>] [-o <resultado.json | ->] "
+               "[arquivo...]\n");
+        return 1;
+    }
+
+    const char* sinteticas[] = {"texto", "log", "binario", "aleatorio", "unico", "enviesado"};
+    int numSinteticas = (int) (sizeof(sinteticas) / sizeof(sinteticas[0]));
+    int numAmostras = primeiroArquivo < argc ? argc - primeiroArquivo : numSinteticas;
+    Medicao* medicoes = (Medicao*) calloc(numAmostras, sizeof(Medicao));
+    if (medicoes == NULL) {
+        printf("Erro de alocacao de memoria.\n");
+        return 1;
+    }
+
+    // Com JSON na saída padrão, a tabela vai para a saída de erro
+    int jsonNaSaida = nomeJson != NULL && strcmp(nomeJson, "-") == 0;
+    FILE* mensagens = jsonNaSaida ? stderr : stdout;
+    for (int i = 0; i < numAmostras; i++) {
+        Medicao* m = &medicoes[i];
+        unsigned char* dados;
+        size_t n = tamanho;
+        if (primeiroArquivo < argc) {
+            m->nome = argv[primeiroArquivo + i];
+            dados = leArquivo(m->nome, &n);
+            if (dados == NULL) {
+                fprintf(mensagens, "Erro: não foi possível ler %s\n", m->nome);
+                return 1;
+            }
+        } else {
+            m->nome = sinteticas[i];
+            dados = (unsigned char*) malloc(n);
+            if (dados == NULL) {
+                fprintf(mensagens, "Erro de alocacao de memoria.\n");
+                return 1;
+            }
+            geraAmostra(m->nome, dados, n);
+        }
+        if (medeAmostra(dados, n, repeticoes, m) < 0) {
+            fprintf(mensagens, "Erro: falha ao medir %s (memória ou decodificação divergente)\n", m->nome);
+            return 1;
+        }
+        free(dados);
+        imprimeTabela(mensagens, m);
+    }
+
+    if (nomeJson) {
+        FILE* saida = jsonNaSaida ? stdout : fopen(nomeJson, "w");
+        if (saida == NULL) {
+            fprintf(mensagens, "Erro: não foi possível criar %s\n", nomeJson);
+            return 1;
+        }
+        gravaJson(saida, medicoes, numAmostras, repeticoes);
+        if (!jsonNaSaida && fclose(saida) != 0) {
+            fprintf(mensagens, "Erro: falha ao gravar %s\n", nomeJson);
+            return 1;
+        }
+    }
+    free(medicoes);
+    return 0;
+}
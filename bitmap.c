@@ -10,8 +10,8 @@
 #include "bitmap.h"
 
 struct map {
-    unsigned int max_size;        ///< tamanho maximo em bits
-    unsigned int length;         ///< tamanho atual em bits
+    unsigned long long int max_size;    ///< tamanho maximo em bits
+    unsigned long long int length;      ///< tamanho atual em bits
     unsigned char* contents;     ///< conteudo do mapa de bits
 };
 
@@ -41,7 +41,7 @@ unsigned char* bitmapGetContents(bitmap* bm) {
  * @param bm O mapa de bits.
  * @return O tamanho maximo do mapa de bits.
  */
-unsigned int bitmapGetMaxSize(bitmap* bm) {
+unsigned long long int bitmapGetMaxSize(bitmap* bm) {
 	return bm->max_size;
 }
 
@@ -50,7 +50,7 @@ unsigned int bitmapGetMaxSize(bitmap* bm) {
  * @param bm O mapa de bits.
  * @return O tamanho atual do mapa de bits.
  */
-unsigned int bitmapGetLength(bitmap* bm) {
+unsigned long long int bitmapGetLength(bitmap* bm) {
 	return bm->length;
 }
 
@@ -59,11 +59,11 @@ unsigned int bitmapGetLength(bitmap* bm) {
  * @param max_size O tamanho maximo para o mapa de bits.
  * @return O mapa de bits inicializado.
  */
-bitmap* bitmapInit(unsigned int max_size) {
+bitmap* bitmapInit(unsigned long long int max_size) {
 	bitmap* bm;
     bm = (bitmap*)malloc(sizeof(bitmap));
 	// definir tamanho maximo em bytes, com arredondamento para cima
-	unsigned int max_sizeInBytes=(max_size+7)/8;
+	unsigned long long int max_sizeInBytes=(max_size+7)/8;
 	// alocar espaco de memoria para o tamanho maximo em bytes
 	bm->contents=calloc(max_sizeInBytes, sizeof(char));
 	// verificar alocacao de memoria
@@ -81,7 +81,7 @@ bitmap* bitmapInit(unsigned int max_size) {
  * @pre index<bitmapGetLength(bm)
  * @return O valor do bit.
  */
-unsigned char bitmapGetBit(bitmap* bm, unsigned int index) // index in bits
+unsigned char bitmapGetBit(bitmap* bm, unsigned long long int index) // index in bits
 {
 	// verificar se index<bm.length, pois caso contrario, index e' invalido
 	assert(index<bm->length, "Acesso a posicao inexistente no mapa de bits.");
@@ -97,7 +97,7 @@ unsigned char bitmapGetBit(bitmap* bm, unsigned int index) // index in bits
  * @param bit O novo valor do bit.
  * @post bitmapGetBit(bm,index)==bit
  */
-static void bitmapSetBit(bitmap* bm, unsigned int index, unsigned char bit) {
+static void bitmapSetBit(bitmap* bm, unsigned long long int index, unsigned char bit) {
     // verificar se index<bm->length, pois caso contrario, index e' invalido
     assert(index<bm->length, "Acesso a posicao inexistente no mapa de bits.");
     // index/8 e' o indice do byte que contem o bit em questao
@@ -124,6 +124,17 @@ void bitmapAppendLeastSignificantBit(bitmap* bm, unsigned char bit) {
 	bitmapSetBit(bm, bm->length-1, bit);
 }
 
+/**
+ * Esvazia o mapa de bits para reutilizacao, mantendo o tamanho maximo.
+ * @param bm O mapa de bits.
+ * @post bitmapGetLength(bm) == 0
+ */
+void bitmapLimpa(bitmap* bm) {
+	// apenas os bytes em uso podem conter bits ligados
+	memset(bm->contents, 0, (bm->length+7)/8);
+	bm->length=0;
+}
+
 /**
  * Libera a memória dinâmica alocada para o mapa de bits.
  * @param bm O mapa de bits.
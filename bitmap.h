@@ -12,11 +12,12 @@
 typedef struct map bitmap;
 
 unsigned char* bitmapGetContents(bitmap* bm);
-unsigned int bitmapGetMaxSize(bitmap* bm);
-unsigned int bitmapGetLength(bitmap* bm);
-bitmap* bitmapInit(unsigned int max_size);
-unsigned char bitmapGetBit(bitmap* bm, unsigned int index);
+unsigned long long int bitmapGetMaxSize(bitmap* bm);
+unsigned long long int bitmapGetLength(bitmap* bm);
+bitmap* bitmapInit(unsigned long long int max_size);
+unsigned char bitmapGetBit(bitmap* bm, unsigned long long int index);
 void bitmapAppendLeastSignificantBit(bitmap* bm, unsigned char bit);
+void bitmapLimpa(bitmap* bm);
 void bitmapLibera (bitmap* bm);
 
 #endif /*BITMAP_H_*/
@@ -0,0 +1,915 @@
+#include "bloco.h"
+#include <stdlib.h>
+#include <string.h>
+#include "bitmap.h"
+#include "codificador.h"
+#include "contexto.h"
+#include "crc.h"
+#include "frequencias.h"
+#include "huffman.h"
+
+#if FLUXOS_INTERCALADOS != FLUXOS_INDEPENDENTES
+#error "o formato em quatro fluxos precisa de um decodificador com a mesma quantidade de fluxos"
+#endif
+
+#define CORRIDA_MINIMA 256      ///< menor corrida que vale uma entrada na tabela de um BLOCO_CORRIDAS
+// As descrições trocam de lugar com b->arvore, então todas comportam a maior delas
+#define TAMANHO_MAX_DESCRICAO_BITS TAMANHO_MAX_DESCRICAO_CONTEXTO_BITS
+
+struct blocoCompactado {
+    CabecalhoBloco cabecalho;
+    bitmap* arvore;             ///< árvore serializada ou comprimentos dos códigos
+    bitmap* descricaoCorridas;  ///< comprimentos dos códigos dos literais, se o bloco tiver corridas
+    bitmap* descricaoContexto;  ///< modelo de ordem 1, se medido
+    unsigned int (*frequenciasContexto)[256];   ///< pares (byte anterior, byte), alocados no primeiro uso
+    unsigned char* tabela;      ///< tabela de corridas de um BLOCO_CORRIDAS
+    size_t tamanhoTabela;
+    size_t capacidadeTabela;
+    EscritorBits* dados;        ///< dados codificados (em memória)
+    unsigned long long int* pontos;     ///< pontos de acesso do bloco
+    unsigned int numPontos;             ///< pontos gravados no último bloco (0 se o tipo não os usa)
+    unsigned int capacidadePontos;
+    const unsigned char* armazenado;    ///< bytes originais de um BLOCO_ARMAZENADO (não copiados)
+    unsigned int crc;           ///< CRC32C dos bytes originais, gravado com cabecalho.crc
+    Medicao medicao;            ///< da última compactação com ParametrosBloco.medir
+};
+
+/**
+ * @brief Cria a área de trabalho de um bloco; os buffers são mantidos entre compactações.
+ * @return Bloco vazio ou NULL em falta de memória.
+ */
+BlocoCompactado* criaBlocoCompactado(void) {
+    BlocoCompactado* b = (BlocoCompactado*) calloc(1, sizeof(BlocoCompactado));
+    if (b == NULL) {
+        return NULL;
+    }
+    b->arvore = bitmapInit(TAMANHO_MAX_DESCRICAO_BITS);
+    b->descricaoCorridas = bitmapInit(TAMANHO_MAX_DESCRICAO_BITS);
+    b->descricaoContexto = bitmapInit(TAMANHO_MAX_DESCRICAO_BITS);
+    b->dados = criaEscritorBits(NULL);
+    if (b->dados == NULL) {
+        liberaBlocoCompactado(b);
+        return NULL;
+    }
+    return b;
+}
+
+/**
+ * @brief Acrescenta um byte ao bitmap, do bit mais significativo ao menos significativo.
+ */
+static void acrescentaByte(bitmap* bm, unsigned char byte) {
+    for (int i = 7; i >= 0; i--) {
+        bitmapAppendLeastSignificantBit(bm, (byte >> i) & 1);
+    }
+}
+
+/**
+ * @brief Garante espaço para os pontos de acesso de um bloco de @p n bytes.
+ * @return Quantidade de pontos; -1 em falta de memória.
+ */
+static long long int preparaPontos(BlocoCompactado* b, size_t n, unsigned int intervaloPontos) {
+    unsigned int numPontos = numPontosBloco((unsigned int) n, intervaloPontos);
+    if (numPontos > b->capacidadePontos) {
+        unsigned long long int* p = (unsigned long long int*) realloc(b->pontos,
+                                                                      numPontos * sizeof(unsigned long long int));
+        if (p == NULL) {
+            return -1;
+        }
+        b->pontos = p;
+        b->capacidadePontos = numPontos;
+    }
+    return numPontos;
+}
+
+/**
+ * @brief Garante ao menos @p capacidade bytes em b->tabela.
+ * @return 0 em sucesso; -1 em falta de memória.
+ */
+static int reservaTabela(BlocoCompactado* b, size_t capacidade) {
+    if (capacidade > b->capacidadeTabela) {
+        unsigned char* t = (unsigned char*) realloc(b->tabela, capacidade);
+        if (t == NULL) {
+            return -1;
+        }
+        b->tabela = t;
+        b->capacidadeTabela = capacidade;
+    }
+    return 0;
+}
+
+/**
+ * @brief Monta em b->tabela as corridas de ao menos CORRIDA_MINIMA bytes iguais (ver container.h).
+ * @return Total de bytes nas corridas; -1 em falta de memória.
+ */
+static long long int encontraCorridas(BlocoCompactado* b, const unsigned char* dados, size_t n) {
+    if (reservaTabela(b, 4 + TAMANHO_CORRIDA * (n / CORRIDA_MINIMA)) < 0) {
+        return -1;
+    }
+
+    unsigned long long int repetidos = 0;
+    unsigned int numCorridas = 0;
+    size_t fimAnterior = 0;
+    b->tamanhoTabela = 4;
+    // Toda corrida de CORRIDA_MINIMA bytes contém um múltiplo k de CORRIDA_MINIMA e também k - meio
+    // ou k + meio; só esses múltiplos são examinados
+    const size_t meio = CORRIDA_MINIMA / 2;
+    for (size_t k = 0; k < n; k += CORRIDA_MINIMA) {
+        unsigned char valor = dados[k];
+        if (!(k >= fimAnterior + meio && dados[k - meio] == valor) && !(k + meio < n && dados[k + meio] == valor)) {
+            continue;
+        }
+        size_t i = k, j = k + 1;
+        while (i > fimAnterior && dados[i - 1] == valor) {
+            i--;
+        }
+        while (j < n && dados[j] == valor) {
+            j++;
+        }
+        if (j - i >= CORRIDA_MINIMA) {
+            unsigned char* p = b->tabela + b->tamanhoTabela;
+            escreveU32(p, (unsigned int) (i - fimAnterior));
+            escreveU32(p + 4, (unsigned int) (j - i));
+            p[8] = valor;
+            b->tamanhoTabela += TAMANHO_CORRIDA;
+            repetidos += j - i;
+            numCorridas++;
+            fimAnterior = j;
+            // Continua no primeiro múltiplo a partir do fim da corrida
+            k = (j + CORRIDA_MINIMA - 1) / CORRIDA_MINIMA * CORRIDA_MINIMA - CORRIDA_MINIMA;
+        }
+    }
+    escreveU32(b->tabela, numCorridas);
+    return (long long int) repetidos;
+}
+
+/**
+ * @brief Codifica um BLOCO_CORRIDAS: a tabela de corridas seguida só dos literais, com códigos canônicos
+ *        próprios (já serializados em b->descricaoCorridas).
+ * @return 0 em sucesso; -1 em falta de memória.
+ */
+static int codificaCorridas(BlocoCompactado* b, const unsigned char* dados, size_t n, const Codigo* codigos,
+                            unsigned long long int bitsLiterais) {
+    bitmap* trocado = b->arvore;
+    b->arvore = b->descricaoCorridas;
+    b->descricaoCorridas = trocado;
+
+    if (reservaEscritorBits(b->dados, (bitsLiterais + 7) / 8 + 8) < 0) {
+        return -1;
+    }
+    size_t pos = 0;
+    unsigned int numCorridas = leU32(b->tabela);
+    for (unsigned int k = 0; k < numCorridas; k++) {
+        const unsigned char* p = b->tabela + 4 + (size_t) k * TAMANHO_CORRIDA;
+        size_t literais = leU32(p);
+        codificaBuffer(b->dados, codigos, dados + pos, literais);
+        pos += literais + leU32(p + 4);
+    }
+    codificaBuffer(b->dados, codigos, dados + pos, n - pos);
+    finalizaEscritorBits(b->dados);
+    if (erroEscritorBits(b->dados)) {
+        return -1;
+    }
+
+    b->cabecalho.tipo = BLOCO_CORRIDAS;
+    b->cabecalho.tamanhoArvore = (unsigned int) bitmapGetLength(b->arvore);
+    b->cabecalho.bitsDados = 8ULL * b->tamanhoTabela + bitsLiterais;
+    return 0;
+}
+
+/**
+ * @brief Codifica cada quarto do bloco em um fluxo próprio, iniciado em byte, com a tabela de saltos
+ *        (bits dos três primeiros fluxos) em b->tabela.
+ * @return 0 em sucesso; -1 em falta de memória.
+ */
+static int codificaFluxosIntercalados(BlocoCompactado* b, const unsigned char* dados, size_t n, const Codigo* codigos,
+                                      unsigned long long int bitsDados) {
+    if (reservaTabela(b, TAMANHO_TABELA_FLUXOS) < 0 ||
+        reservaEscritorBits(b->dados, (bitsDados + 7) / 8 + FLUXOS_INTERCALADOS + 8) < 0) {
+        return -1;
+    }
+    size_t quarto = (n + FLUXOS_INTERCALADOS - 1) / FLUXOS_INTERCALADOS;
+    unsigned long long int bitsAnteriores = 0, bytesFluxos = 0;
+    for (int k = 0; k < FLUXOS_INTERCALADOS; k++) {
+        size_t inicio = k * quarto < n ? k * quarto : n;
+        size_t fim = inicio + quarto < n ? inicio + quarto : n;
+        codificaBuffer(b->dados, codigos, dados + inicio, fim - inicio);
+        finalizaEscritorBits(b->dados);
+        unsigned long long int bitsFluxo = bitsEscritorBits(b->dados) - bitsAnteriores;
+        bitsAnteriores += bitsFluxo;
+        if (k < FLUXOS_INTERCALADOS - 1) {
+            escreveU64(b->tabela + 8 * k, bitsFluxo);
+            bytesFluxos += (bitsFluxo + 7) / 8;
+        } else {
+            b->cabecalho.bitsDados = 8 * (TAMANHO_TABELA_FLUXOS + bytesFluxos) + bitsFluxo;
+        }
+    }
+    if (erroEscritorBits(b->dados)) {
+        return -1;
+    }
+
+    b->tamanhoTabela = TAMANHO_TABELA_FLUXOS;
+    b->cabecalho.fluxos = FLUXOS_INTERCALADOS;
+    b->cabecalho.tamanhoArvore = (unsigned int) bitmapGetLength(b->arvore);
+    return 0;
+}
+
+/**
+ * @brief Codifica um BLOCO_CONTEXTO: cada byte com o código da tabela do byte anterior (modelo já
+ *        serializado em b->descricaoContexto).
+ * @return 0 em sucesso; -1 em falta de memória.
+ */
+static int codificaContexto(BlocoCompactado* b, const unsigned char* dados, size_t n, const ModeloContexto* modelo,
+                            unsigned long long int bitsDados) {
+    bitmap* trocado = b->arvore;
+    b->arvore = b->descricaoContexto;
+    b->descricaoContexto = trocado;
+
+    Codigo codigos[MAX_TABELAS_CONTEXTO][256];
+    const Codigo* porContexto[256];
+    for (int k = 0; k < modelo->numTabelas; k++) {
+        gerarDicionarioCanonico(codigos[k], modelo->comprimentos[k]);
+    }
+    for (int c = 0; c < 256; c++) {
+        porContexto[c] = codigos[modelo->tabelaDoContexto[c]];
+    }
+    if (reservaEscritorBits(b->dados, (bitsDados + 7) / 8 + 8) < 0) {
+        return -1;
+    }
+    codificaBufferContexto(b->dados, porContexto, dados, n);
+    finalizaEscritorBits(b->dados);
+    if (erroEscritorBits(b->dados)) {
+        return -1;
+    }
+
+    b->cabecalho.tipo = BLOCO_CONTEXTO;
+    b->cabecalho.tamanhoArvore = (unsigned int) bitmapGetLength(b->arvore);
+    b->cabecalho.bitsDados = bitsDados;
+    return 0;
+}
+
+/**
+ * @brief Soma a @p medicao os bytes de cada comprimento de código (NULL = sem medição).
+ */
+static void registraComprimentos(Medicao* medicao, const unsigned long long int* frequencias, const Codigo* codigos) {
+    if (medicao == NULL) {
+        return;
+    }
+    for (int i = 0; i < 256; i++) {
+        medicao->bytesPorComprimento[codigos[i].tamanho] += frequencias[i];
+    }
+}
+
+/**
+ * @brief Corpo de compactaBloco; com @p medicao, cada fase é encerrada em @p marca ao terminar.
+ */
+static int compactaBlocoMedido(BlocoCompactado* b, const unsigned char* dados, size_t n,
+                               const ParametrosBloco* parametros, Medicao* medicao, MarcaTempo* marca) {
+    TemposFases* tempos = medicao ? &medicao->tempos : NULL;
+    unsigned long long int frequencias[256] = {0};
+    contaFrequencias(dados, n, frequencias);
+    encerraFase(tempos, FASE_FREQUENCIAS, marca);
+    if (medicao) {
+        memcpy(medicao->frequencias, frequencias, sizeof(frequencias));
+    }
+
+    bitmapLimpa(b->arvore);
+    reiniciaEscritorBits(b->dados);
+    b->armazenado = NULL;
+    b->tamanhoTabela = 0;
+    b->numPontos = 0;
+    b->cabecalho.fluxos = 1;
+    b->cabecalho.crc = parametros->crc != 0;
+    b->cabecalho.tamanhoOriginal = (unsigned int) n;
+
+    // Um único byte repetido: só o byte, sem dados codificados
+    if (n > 0 && frequencias[dados[0]] == n) {
+        acrescentaByte(b->arvore, dados[0]);
+        if (medicao) {
+            medicao->bytesPorComprimento[0] += n;
+        }
+        b->cabecalho.tipo = BLOCO_REPETIDO;
+        b->cabecalho.tamanhoArvore = 8;
+        b->cabecalho.bitsDados = 0;
+        return 0;
+    }
+
+    Codigo dicionario[256] = {{0, 0}};
+    const Codigo* codigos = dicionario;
+    if (parametros->comprimentoMax > 0) {
+        unsigned char comprimentos[256];
+        calcularComprimentosLimitados(frequencias, parametros->comprimentoMax, comprimentos);
+        encerraFase(tempos, FASE_ARVORE, marca);
+        gerarDicionarioCanonico(dicionario, comprimentos);
+        encerraFase(tempos, FASE_DICIONARIO, marca);
+        serializarComprimentos(comprimentos, b->arvore);
+        encerraFase(tempos, FASE_ARVORE, marca);
+        b->cabecalho.tipo = BLOCO_CANONICO;
+    } else {
+        ArvoreHuffman arvore;
+        construirArvoreHuffman(frequencias, &arvore);
+        encerraFase(tempos, FASE_ARVORE, marca);
+        if (gerarDicionario(dicionario, &arvore) < 0) {
+            return -1;
+        }
+        encerraFase(tempos, FASE_DICIONARIO, marca);
+        serializarArvore(&arvore, b->arvore);
+        encerraFase(tempos, FASE_ARVORE, marca);
+        b->cabecalho.tipo = BLOCO_HUFFMAN;
+    }
+
+    unsigned long long int bitsDados = 0;
+    for (int i = 0; i < 256; i++) {
+        bitsDados += frequencias[i] * dicionario[i].tamanho;
+    }
+
+    // O dicionário só é usado se o id e os seus códigos não passarem do código próprio do bloco
+    const Dicionario* usado = NULL;
+    if (parametros->dicionario) {
+        const Codigo* codigosPreTreinados = codigosDicionario(parametros->dicionario);
+        unsigned long long int bitsPreTreinados = 0;
+        for (int i = 0; i < 256; i++) {
+            bitsPreTreinados += frequencias[i] * codigosPreTreinados[i].tamanho;
+        }
+        if (TAMANHO_ID_DICIONARIO_BITS / 8 + (bitsPreTreinados + 7) / 8 <=
+            (bitmapGetLength(b->arvore) + 7) / 8 + (bitsDados + 7) / 8) {
+            unsigned char id[4];
+            escreveU32(id, idDicionario(parametros->dicionario));
+            bitmapLimpa(b->arvore);
+            for (int i = 0; i < 4; i++) {
+                acrescentaByte(b->arvore, id[i]);
+            }
+            usado = parametros->dicionario;
+            codigos = codigosPreTreinados;
+            bitsDados = bitsPreTreinados;
+            b->cabecalho.tipo = BLOCO_DICIONARIO;
+        }
+        encerraFase(tempos, FASE_DICIONARIO, marca);
+    }
+
+    unsigned long long int bytesCodificado = (bitmapGetLength(b->arvore) + 7) / 8 + (bitsDados + 7) / 8;
+    if (parametros->fluxos == FLUXOS_INTERCALADOS) {
+        // Tabela de saltos e o enchimento do fim de cada fluxo
+        bytesCodificado += TAMANHO_TABELA_FLUXOS + FLUXOS_INTERCALADOS - 1;
+    }
+
+    // Modelo de ordem 1: vale se a descrição das várias tabelas se pagar nos dados
+    ModeloContexto modelo;
+    unsigned long long int bitsContexto = 0, bytesContexto = ~0ULL;
+    if (parametros->contexto && usado == NULL) {
+        if (b->frequenciasContexto == NULL) {
+            b->frequenciasContexto = (unsigned int (*)[256]) malloc(256 * sizeof(*b->frequenciasContexto));
+            if (b->frequenciasContexto == NULL) {
+                return -1;
+            }
+        }
+        contaFrequenciasContexto(dados, n, b->frequenciasContexto);
+        encerraFase(tempos, FASE_FREQUENCIAS, marca);
+        int limite = parametros->comprimentoMax > 0 ? parametros->comprimentoMax : COMPRIMENTO_MAX_CANONICO;
+        construirModeloContexto(b->frequenciasContexto, limite, &modelo);
+        bitsContexto = bitsDadosContexto(b->frequenciasContexto, &modelo);
+        bitmapLimpa(b->descricaoContexto);
+        serializarModeloContexto(&modelo, b->descricaoContexto);
+        bytesContexto = (bitmapGetLength(b->descricaoContexto) + 7) / 8 + (bitsContexto + 7) / 8;
+        encerraFase(tempos, FASE_ARVORE, marca);
+    }
+
+    // Corridas longas: cada uma vira uma entrada da tabela e sai do fluxo codificado
+    if (usado == NULL) {
+        long long int repetidos = encontraCorridas(b, dados, n);
+        if (repetidos < 0) {
+            return -1;
+        }
+        if (repetidos > 0) {
+            unsigned long long int literais[256];
+            memcpy(literais, frequencias, sizeof(literais));
+            unsigned int numCorridas = leU32(b->tabela);
+            for (unsigned int k = 0; k < numCorridas; k++) {
+                const unsigned char* p = b->tabela + 4 + (size_t) k * TAMANHO_CORRIDA;
+                literais[p[8]] -= leU32(p + 4);
+            }
+            Codigo codigosLiterais[256] = {{0, 0}};
+            unsigned long long int bitsLiterais = 0;
+            bitmapLimpa(b->descricaoCorridas);
+            if ((size_t) repetidos < n) {
+                unsigned char comprimentos[256];
+                int limite = parametros->comprimentoMax > 0 ? parametros->comprimentoMax : COMPRIMENTO_MAX_CANONICO;
+                calcularComprimentosLimitados(literais, limite, comprimentos);
+                gerarDicionarioCanonico(codigosLiterais, comprimentos);
+                serializarComprimentos(comprimentos, b->descricaoCorridas);
+                for (int i = 0; i < 256; i++) {
+                    bitsLiterais += literais[i] * codigosLiterais[i].tamanho;
+                }
+            }
+            unsigned long long int bytesCorridas = (bitmapGetLength(b->descricaoCorridas) + 7) / 8 +
+                                                   b->tamanhoTabela + (bitsLiterais + 7) / 8;
+            if (bytesCorridas < bytesCodificado && bytesCorridas < bytesContexto && bytesCorridas < n) {
+                registraComprimentos(medicao, literais, codigosLiterais);
+                if (medicao) {
+                    medicao->bytesPorComprimento[0] += (unsigned long long int) repetidos;
+                }
+                return codificaCorridas(b, dados, n, codigosLiterais, bitsLiterais);
+            }
+        }
+        b->tamanhoTabela = 0;
+    }
+    if (bytesContexto < bytesCodificado && bytesContexto < n) {
+        if (medicao) {
+            for (int c = 0; c < 256; c++) {
+                const unsigned char* comprimentos = modelo.comprimentos[modelo.tabelaDoContexto[c]];
+                for (int s = 0; s < 256; s++) {
+                    medicao->bytesPorComprimento[comprimentos[s]] += b->frequenciasContexto[c][s];
+                }
+            }
+        }
+        return codificaContexto(b, dados, n, &modelo, bitsContexto);
+    }
+
+    // Dados incompressíveis: os bytes originais são mais curtos que descrição + códigos
+    if (n <= bytesCodificado) {
+        bitmapLimpa(b->arvore);
+        if (medicao) {
+            medicao->bytesPorComprimento[0] += n;
+        }
+        b->armazenado = dados;
+        b->cabecalho.tipo = BLOCO_ARMAZENADO;
+        b->cabecalho.tamanhoArvore = 0;
+        b->cabecalho.bitsDados = 8ULL * n;
+        return 0;
+    }
+    registraComprimentos(medicao, frequencias, codigos);
+    if (parametros->fluxos == FLUXOS_INTERCALADOS) {
+        return codificaFluxosIntercalados(b, dados, n, codigos, bitsDados);
+    }
+
+    // Só o código de um único fluxo pode ser retomado a partir de um ponto de acesso
+    unsigned int intervaloPontos = parametros->intervaloPontos;
+    long long int numPontos = preparaPontos(b, n, intervaloPontos);
+    if (numPontos < 0 || reservaEscritorBits(b->dados, (bitsDados + 7) / 8 + 8) < 0) {
+        return -1;
+    }
+    // Codifica em trechos de intervaloPontos bytes, anotando o bit em que cada trecho começa
+    size_t passo = numPontos > 0 ? intervaloPontos : n;
+    for (size_t i = 0; i < n; i += passo) {
+        if (i > 0) {
+            b->pontos[i / passo - 1] = bitsEscritorBits(b->dados);
+        }
+        codificaBuffer(b->dados, codigos, dados + i, n - i < passo ? n - i : passo);
+    }
+    finalizaEscritorBits(b->dados);
+    if (erroEscritorBits(b->dados)) {
+        return -1;
+    }
+
+    b->numPontos = (unsigned int) numPontos;
+    b->cabecalho.tamanhoArvore = (unsigned int) bitmapGetLength(b->arvore);
+    b->cabecalho.bitsDados = bitsDados;
+    return 0;
+}
+
+/**
+ * @brief Compacta @p n bytes de forma independente: frequências, código, dicionário e codificação.
+ * @details Com @c comprimentoMax, gera um BLOCO_CANONICO com códigos limitados e só os comprimentos no
+ *          cabeçalho; caso contrário, um BLOCO_HUFFMAN com a árvore serializada. Com @c dicionario, gera
+ *          um BLOCO_DICIONARIO com os códigos dele e só o seu id no cabeçalho, a menos que o código
+ *          próprio do bloco, com a descrição, fique menor.
+ *          O tamanho codificado é conhecido pelo histograma antes da codificação: se não for menor que
+ *          os próprios bytes, o bloco é guardado como BLOCO_ARMAZENADO, sem codificar; um bloco de um
+ *          único byte repetido vira BLOCO_REPETIDO, que ocupa um byte. Sem dicionário, as corridas
+ *          longas de um mesmo byte também são medidas: se tirá-las do fluxo codificado (BLOCO_CORRIDAS,
+ *          cada corrida em tamanho fixo) resultar no menor bloco, essa forma é usada. Com @c contexto
+ *          (e sem dicionário), também é medido um modelo de ordem 1 (BLOCO_CONTEXTO, contexto.h), usado
+ *          se der o menor bloco.
+ * @param b Área de trabalho (o resultado anterior é descartado).
+ * @param dados Bytes do bloco; um BLOCO_ARMAZENADO os referencia até ser gravado ou copiado.
+ * @param n Quantidade de bytes (cabe em 32 bits).
+ * @param parametros Opções de compactação.
+ * @return 0 em sucesso; -1 em falta de memória ou código longo demais.
+ */
+int compactaBloco(BlocoCompactado* b, const unsigned char* dados, size_t n, const ParametrosBloco* parametros) {
+    if (!parametros->medir) {
+        int resultado = compactaBlocoMedido(b, dados, n, parametros, NULL, NULL);
+        b->crc = parametros->crc ? crc32c(0, dados, n) : 0;
+        return resultado;
+    }
+    MarcaTempo marca;
+    memset(&b->medicao, 0, sizeof(Medicao));
+    b->medicao.blocos = 1;
+    iniciaMedicao(&b->medicao.tempos, &marca);
+    int resultado = compactaBlocoMedido(b, dados, n, parametros, &b->medicao, &marca);
+    b->crc = parametros->crc ? crc32c(0, dados, n) : 0;
+    encerraFase(&b->medicao.tempos, FASE_CODIFICACAO, &marca);
+    return resultado;
+}
+
+/**
+ * @brief Dados do bloco como gravados no arquivo: os bytes originais de um BLOCO_ARMAZENADO ou os
+ *        códigos do escritor.
+ */
+static const unsigned char* dadosBloco(BlocoCompactado* b, size_t* bytesDados) {
+    if (b->armazenado) {
+        *bytesDados = b->cabecalho.tamanhoOriginal;
+        return b->armazenado;
+    }
+    return conteudoEscritorBits(b->dados, bytesDados);
+}
+
+/**
+ * @brief Tamanho do bloco no arquivo (cabeçalho + árvore + dados + CRC).
+ */
+unsigned long long int tamanhoBlocoCompactado(BlocoCompactado* b) {
+    return TAMANHO_CABECALHO_BLOCO + tamanhoCorpoBloco(&b->cabecalho);
+}
+
+/**
+ * @brief Grava o bloco compactado em @p saida.
+ * @return 0 em sucesso; -1 em erro de escrita.
+ */
+int gravaBlocoCompactado(BlocoCompactado* b, FILE* saida) {
+    unsigned char cabecalho[TAMANHO_CABECALHO_BLOCO];
+    int n = codificaCabecalhoBloco(cabecalho, &b->cabecalho);
+    size_t bytesArvore = (b->cabecalho.tamanhoArvore + 7) / 8;
+    size_t bytesDados;
+    const unsigned char* dados = dadosBloco(b, &bytesDados);
+    unsigned char crc[TAMANHO_CRC_BLOCO];
+    escreveU32(crc, b->crc);
+
+    if (fwrite(cabecalho, 1, n, saida) != (size_t) n ||
+        fwrite(bitmapGetContents(b->arvore), 1, bytesArvore, saida) != bytesArvore ||
+        (b->tamanhoTabela > 0 && fwrite(b->tabela, 1, b->tamanhoTabela, saida) != b->tamanhoTabela) ||
+        fwrite(dados, 1, bytesDados, saida) != bytesDados ||
+        (b->cabecalho.crc && fwrite(crc, 1, TAMANHO_CRC_BLOCO, saida) != TAMANHO_CRC_BLOCO)) {
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Copia o bloco compactado (cabeçalho, árvore, dados e CRC) para a memória.
+ * @param b Bloco compactado.
+ * @param destino Buffer com ao menos tamanhoBlocoCompactado(b) bytes.
+ */
+void copiaBlocoCompactado(BlocoCompactado* b, unsigned char* destino) {
+    int n = codificaCabecalhoBloco(destino, &b->cabecalho);
+    copiaCorpoBlocoCompactado(b, destino + n);
+}
+
+/**
+ * @brief Copia só o corpo do bloco compactado (árvore, dados e CRC), sem o cabeçalho.
+ * @param b Bloco compactado.
+ * @param destino Buffer com ao menos tamanhoCorpoBloco(cabecalhoBlocoCompactado(b)) bytes.
+ */
+void copiaCorpoBlocoCompactado(BlocoCompactado* b, unsigned char* destino) {
+    size_t bytesArvore = (b->cabecalho.tamanhoArvore + 7) / 8;
+    size_t bytesDados;
+    const unsigned char* dados = dadosBloco(b, &bytesDados);
+
+    memcpy(destino, bitmapGetContents(b->arvore), bytesArvore);
+    destino += bytesArvore;
+    if (b->tamanhoTabela > 0) {
+        memcpy(destino, b->tabela, b->tamanhoTabela);
+        destino += b->tamanhoTabela;
+    }
+    if (bytesDados > 0) {
+        memcpy(destino, dados, bytesDados);
+        destino += bytesDados;
+    }
+    if (b->cabecalho.crc) {
+        escreveU32(destino, b->crc);
+    }
+}
+
+/**
+ * @brief Libera a área de trabalho.
+ * @param b Bloco (pode ser NULL).
+ */
+void liberaBlocoCompactado(BlocoCompactado* b) {
+    if (b) {
+        if (b->arvore) {
+            bitmapLibera(b->arvore);
+        }
+        if (b->descricaoCorridas) {
+            bitmapLibera(b->descricaoCorridas);
+        }
+        if (b->descricaoContexto) {
+            bitmapLibera(b->descricaoContexto);
+        }
+        free(b->frequenciasContexto);
+        free(b->tabela);
+        liberaEscritorBits(b->dados);
+        free(b->pontos);
+        free(b);
+    }
+}
+
+/**
+ * @brief Acesso ao cabeçalho do último bloco compactado.
+ */
+const CabecalhoBloco* cabecalhoBlocoCompactado(BlocoCompactado* b) {
+    return &b->cabecalho;
+}
+
+/**
+ * @brief Tempos por fase, histograma e bytes por comprimento de código do último bloco compactado
+ *        com @c medir; o conteúdo é indefinido sem ele.
+ */
+const Medicao* medicaoBlocoCompactado(BlocoCompactado* b) {
+    return &b->medicao;
+}
+
+/**
+ * @brief Pontos de acesso do último bloco compactado: o bit dos dados em que começa cada byte
+ *        múltiplo do intervalo, numPontosBlocoCompactado(b) ao todo (ver container.h).
+ */
+const unsigned long long int* pontosBlocoCompactado(BlocoCompactado* b) {
+    return b->pontos;
+}
+
+/**
+ * @brief Quantidade de pontos de acesso do último bloco compactado: numPontosBloco(tamanhoOriginal,
+ *        intervaloPontos) se ele tiver um único fluxo de código, 0 nos tipos que não os usam
+ *        (armazenado, repetido, corridas, contexto e quatro fluxos).
+ */
+unsigned int numPontosBlocoCompactado(BlocoCompactado* b) {
+    return b->numPontos;
+}
+
+/**
+ * @brief Carrega em @p d as tabelas de um bloco a partir da descrição do código no início do corpo.
+ * @param d Decodificador reaproveitado (ver criaDecodificadorVazio).
+ * @param c Cabeçalho do bloco (BLOCO_HUFFMAN, BLOCO_CANONICO ou BLOCO_CORRIDAS com literais).
+ * @param corpo Árvore serializada ou comprimentos, conforme o tipo (c->tamanhoArvore bits).
+ * @return 0 em sucesso; -1 se o bloco for inválido ou faltar memória.
+ */
+int carregaDecodificadorBloco(Decodificador* d, const CabecalhoBloco* c, const unsigned char* corpo) {
+    if (c->tipo == BLOCO_CANONICO || c->tipo == BLOCO_CORRIDAS) {
+        unsigned char comprimentos[256];
+        if (c->tamanhoArvore > TAMANHO_MAX_COMPRIMENTOS_BITS ||
+            leComprimentos(corpo, c->tamanhoArvore, comprimentos) < 0) {
+            return -1;
+        }
+        return carregaDecodificadorCanonico(d, comprimentos);
+    }
+    if (c->tipo != BLOCO_HUFFMAN || c->tamanhoArvore == 0 || c->tamanhoArvore > TAMANHO_MAX_ARVORE_BITS) {
+        return -1;
+    }
+    ArvoreHuffman arvore;
+    if (leArvoreHuffman(corpo, c->tamanhoArvore, &arvore) < 0) {
+        return -1;
+    }
+    return carregaDecodificador(d, &arvore);
+}
+
+/**
+ * @brief Indica se o bloco é guardado sem código de Huffman, com campos coerentes: BLOCO_ARMAZENADO
+ *        (os bytes originais) ou BLOCO_REPETIDO (um único byte, repetido tamanhoOriginal vezes).
+ * @param c Cabeçalho do bloco.
+ * @return 1 se for um desses tipos; 0 caso contrário.
+ */
+int blocoSemCodigo(const CabecalhoBloco* c) {
+    if (c->tipo == BLOCO_ARMAZENADO) {
+        return c->tamanhoArvore == 0 && c->bitsDados == 8ULL * c->tamanhoOriginal;
+    }
+    return c->tipo == BLOCO_REPETIDO && c->tamanhoArvore == 8 && c->bitsDados == 0;
+}
+
+/**
+ * @brief Verifica se @p dicionario é o usado por um BLOCO_DICIONARIO.
+ * @param dicionario Dicionário disponível (pode ser NULL).
+ * @param c Cabeçalho do bloco.
+ * @param corpo Início do corpo do bloco.
+ * @return 1 se o bloco não usar dicionário ou se @p dicionario tiver o id gravado; 0 caso contrário.
+ */
+int dicionarioConfere(const Dicionario* dicionario, const CabecalhoBloco* c, const unsigned char* corpo) {
+    if (c->tipo != BLOCO_DICIONARIO) {
+        return 1;
+    }
+    return dicionario != NULL && c->tamanhoArvore == TAMANHO_ID_DICIONARIO_BITS &&
+           leU32(corpo) == idDicionario(dicionario);
+}
+
+/**
+ * @brief Obtém as tabelas para decodificar um bloco de qualquer tipo.
+ * @details As de um BLOCO_DICIONARIO já estão prontas no dicionário; as dos demais são carregadas em @p d.
+ * @param d Decodificador reaproveitado (ver criaDecodificadorVazio).
+ * @param dicionario Dicionário disponível (pode ser NULL).
+ * @param c Cabeçalho do bloco.
+ * @param corpo Descrição do código no início do corpo (c->tamanhoArvore bits).
+ * @return Decodificador a usar (@p d ou o do dicionário); NULL se o bloco for inválido, se faltar
+ *         memória ou se o dicionário não conferir.
+ */
+Decodificador* decodificadorBloco(Decodificador* d, const Dicionario* dicionario, const CabecalhoBloco* c,
+                                  const unsigned char* corpo) {
+    if (c->tipo == BLOCO_DICIONARIO) {
+        return dicionarioConfere(dicionario, c, corpo) ? decodificadorDicionario(dicionario) : NULL;
+    }
+    return carregaDecodificadorBloco(d, c, corpo) == 0 ? d : NULL;
+}
+
+/**
+ * @brief Cria o decodificador de um bloco a partir da descrição do código no início do corpo.
+ * @param c Cabeçalho do bloco (BLOCO_HUFFMAN ou BLOCO_CANONICO).
+ * @param corpo Árvore serializada ou comprimentos, conforme o tipo (c->tamanhoArvore bits).
+ * @return Decodificador (liberar com liberaDecodificador) ou NULL se o bloco for inválido.
+ */
+Decodificador* criaDecodificadorBloco(const CabecalhoBloco* c, const unsigned char* corpo) {
+    Decodificador* d = criaDecodificadorVazio();
+    if (d == NULL || carregaDecodificadorBloco(d, c, corpo) < 0) {
+        liberaDecodificador(d);
+        return NULL;
+    }
+    return d;
+}
+
+/**
+ * @brief Lê e valida a tabela no início dos dados de um BLOCO_CORRIDAS.
+ * @param c Cabeçalho do bloco.
+ * @param dados Início dos dados (após a descrição do código), com (c->bitsDados + 7) / 8 bytes.
+ * @param bytesTabela Recebe o tamanho da tabela.
+ * @return Quantidade de bytes literais do bloco; -1 se a tabela for inválida.
+ */
+long long int leTabelaCorridas(const CabecalhoBloco* c, const unsigned char* dados, size_t* bytesTabela) {
+    if (c->bitsDados < 32) {
+        return -1;
+    }
+    unsigned long long int numCorridas = leU32(dados);
+    if (4 + TAMANHO_CORRIDA * numCorridas > c->bitsDados / 8) {
+        return -1;
+    }
+    unsigned long long int total = 0, repetidos = 0;
+    for (unsigned long long int k = 0; k < numCorridas; k++) {
+        const unsigned char* p = dados + 4 + k * TAMANHO_CORRIDA;
+        total += (unsigned long long int) leU32(p) + leU32(p + 4);
+        repetidos += leU32(p + 4);
+        if (total > c->tamanhoOriginal) {
+            return -1;
+        }
+    }
+    *bytesTabela = 4 + TAMANHO_CORRIDA * numCorridas;
+    long long int literais = (long long int) (c->tamanhoOriginal - repetidos);
+    // Sem literais não há código nem bits de dados
+    if (literais == 0 && (c->tamanhoArvore != 0 || c->bitsDados != 8ULL * *bytesTabela)) {
+        return -1;
+    }
+    return literais;
+}
+
+/**
+ * @brief Descompacta um BLOCO_CORRIDAS: os literais são decodificados no fim do destino e depois
+ *        espalhados para a frente, entre as corridas preenchidas com memset (cada literal só anda
+ *        para trás, e cada corrida termina antes do próximo literal ainda não movido).
+ * @return 0 em sucesso; -1 se o bloco estiver corrompido.
+ */
+static int descompactaCorridas(Decodificador* d, const CabecalhoBloco* c, const unsigned char* corpo,
+                               unsigned char* destino) {
+    const unsigned char* dados = corpo + (c->tamanhoArvore + 7) / 8;
+    size_t bytesTabela;
+    long long int literais = leTabelaCorridas(c, dados, &bytesTabela);
+    if (literais < 0) {
+        return -1;
+    }
+    size_t n = c->tamanhoOriginal;
+    size_t origem = n - (size_t) literais;
+    if (literais > 0 &&
+        (carregaDecodificadorBloco(d, c, corpo) < 0 ||
+         decodificaParaMemoria(d, dados + bytesTabela, c->bitsDados - 8ULL * bytesTabela,
+                               destino + origem, (size_t) literais) != literais)) {
+        return -1;
+    }
+
+    size_t pos = 0;
+    unsigned int numCorridas = leU32(dados);
+    for (unsigned int k = 0; k < numCorridas; k++) {
+        const unsigned char* p = dados + 4 + (size_t) k * TAMANHO_CORRIDA;
+        size_t antes = leU32(p), repeticoes = leU32(p + 4);
+        memmove(destino + pos, destino + origem, antes);
+        pos += antes;
+        origem += antes;
+        memset(destino + pos, p[8], repeticoes);
+        pos += repeticoes;
+    }
+    memmove(destino + pos, destino + origem, n - pos);
+    return 0;
+}
+
+/**
+ * @brief Indica se o bloco só pode ser decodificado inteiro, sem pontos de acesso nem decodificação
+ *        incremental: um BLOCO_CORRIDAS, um BLOCO_CONTEXTO ou um bloco em quatro fluxos.
+ * @param c Cabeçalho do bloco.
+ * @return 1 se for um desses; 0 caso contrário.
+ */
+int blocoLidoInteiro(const CabecalhoBloco* c) {
+    return c->tipo == BLOCO_CORRIDAS || c->tipo == BLOCO_CONTEXTO || c->fluxos == FLUXOS_INTERCALADOS;
+}
+
+/**
+ * @brief Descompacta os dados de um bloco em quatro fluxos, localizados pela tabela de saltos; os
+ *        quatro quartos do bloco são decodificados juntos.
+ * @return 0 em sucesso; -1 se o bloco estiver corrompido.
+ */
+static int descompactaFluxosIntercalados(Decodificador* tabelas, const CabecalhoBloco* c, const unsigned char* dados,
+                                         unsigned char* destino) {
+    if (c->bitsDados < 8ULL * TAMANHO_TABELA_FLUXOS) {
+        return -1;
+    }
+    const unsigned char* inicios[FLUXOS_INDEPENDENTES];
+    unsigned long long int bits[FLUXOS_INDEPENDENTES];
+    unsigned char* destinos[FLUXOS_INDEPENDENTES];
+    size_t quantidades[FLUXOS_INDEPENDENTES];
+    unsigned long long int restantes = c->bitsDados - 8ULL * TAMANHO_TABELA_FLUXOS;
+    const unsigned char* p = dados + TAMANHO_TABELA_FLUXOS;
+    size_t n = c->tamanhoOriginal;
+    size_t quarto = (n + FLUXOS_INDEPENDENTES - 1) / FLUXOS_INDEPENDENTES;
+    for (int k = 0; k < FLUXOS_INDEPENDENTES; k++) {
+        bits[k] = restantes;
+        if (k < FLUXOS_INDEPENDENTES - 1) {
+            bits[k] = leU64(dados + 8 * k);
+            if (bits[k] > restantes || (bits[k] + 7) / 8 * 8 > restantes) {
+                return -1;
+            }
+            restantes -= (bits[k] + 7) / 8 * 8;
+        }
+        inicios[k] = p;
+        p += (bits[k] + 7) / 8;
+        size_t inicio = k * quarto < n ? k * quarto : n;
+        destinos[k] = destino + inicio;
+        quantidades[k] = (inicio + quarto < n ? inicio + quarto : n) - inicio;
+    }
+    return decodificaFluxosIndependentes(tabelas, inicios, bits, destinos, quantidades);
+}
+
+/**
+ * @brief Descompacta um BLOCO_CONTEXTO: monta uma tabela por código do modelo e decodifica trocando de
+ *        tabela pelo byte anterior.
+ * @return 0 em sucesso; -1 se o bloco estiver corrompido ou faltar memória.
+ */
+static int descompactaContexto(Decodificador* d, const CabecalhoBloco* c, const unsigned char* corpo,
+                               unsigned char* destino, TemposFases* tempos, MarcaTempo* marca) {
+    ModeloContexto modelo;
+    if (leModeloContexto(corpo, c->tamanhoArvore, &modelo) < 0 ||
+        carregaDecodificadorContexto(d, modelo.numTabelas, modelo.comprimentos, modelo.tabelaDoContexto) < 0) {
+        return -1;
+    }
+    encerraFase(tempos, FASE_ARVORE, marca);
+    return decodificaContexto(d, corpo + (c->tamanhoArvore + 7) / 8, c->bitsDados, destino, c->tamanhoOriginal);
+}
+
+/**
+ * @brief Corpo de descompactaBloco; com @p tempos, a montagem das tabelas é encerrada em @p marca.
+ */
+static int descompactaBlocoMedido(Decodificador* d, const Dicionario* dicionario, const CabecalhoBloco* c,
+                                  const unsigned char* corpo, unsigned char* destino, TemposFases* tempos,
+                                  MarcaTempo* marca) {
+    if (c->fluxos != 1 && (blocoSemCodigo(c) || c->tipo == BLOCO_CORRIDAS || c->tipo == BLOCO_CONTEXTO)) {
+        return -1;
+    }
+    if (blocoSemCodigo(c)) {
+        if (c->tipo == BLOCO_ARMAZENADO) {
+            memcpy(destino, corpo, c->tamanhoOriginal);
+        } else {
+            memset(destino, corpo[0], c->tamanhoOriginal);
+        }
+        return 0;
+    }
+    if (c->tipo == BLOCO_CORRIDAS) {
+        return descompactaCorridas(d, c, corpo, destino);
+    }
+    if (c->tipo == BLOCO_CONTEXTO) {
+        return descompactaContexto(d, c, corpo, destino, tempos, marca);
+    }
+    Decodificador* tabelas = decodificadorBloco(d, dicionario, c, corpo);
+    if (tabelas == NULL) {
+        return -1;
+    }
+    encerraFase(tempos, FASE_ARVORE, marca);
+    if (c->fluxos == FLUXOS_INTERCALADOS) {
+        return descompactaFluxosIntercalados(tabelas, c, corpo + (c->tamanhoArvore + 7) / 8, destino);
+    }
+    long long int produzidos = decodificaParaMemoria(tabelas, corpo + (c->tamanhoArvore + 7) / 8, c->bitsDados,
+                                                     destino, c->tamanhoOriginal);
+    return produzidos == (long long int) c->tamanhoOriginal ? 0 : -1;
+}
+
+/**
+ * @brief Descompacta um bloco para a memória (blocos sem código são copiados ou preenchidos direto).
+ * @param d Decodificador usado como área de trabalho; suas tabelas são substituídas pelas do bloco.
+ * @param dicionario Dicionário para blocos BLOCO_DICIONARIO (pode ser NULL).
+ * @param c Cabeçalho do bloco.
+ * @param corpo Descrição do código seguida dos dados codificados (tamanhoCorpoBloco bytes).
+ * @param destino Buffer com ao menos c->tamanhoOriginal bytes.
+ * @param tempos Recebe o tempo das tabelas (FASE_ARVORE) e da decodificação (FASE_DECODIFICACAO);
+ *        NULL = sem medição.
+ * @return 0 em sucesso; -1 se o bloco estiver corrompido (inclusive se não produzir exatamente
+ *         c->tamanhoOriginal bytes); -2 se for decodificado mas o CRC32C gravado não conferir.
+ */
+int descompactaBloco(Decodificador* d, const Dicionario* dicionario, const CabecalhoBloco* c,
+                     const unsigned char* corpo, unsigned char* destino, TemposFases* tempos) {
+    MarcaTempo marca;
+    iniciaMedicao(tempos, &marca);
+    int resultado = descompactaBlocoMedido(d, dicionario, c, corpo, destino, tempos, &marca);
+    if (resultado == 0 && c->crc &&
+        crc32c(0, destino, c->tamanhoOriginal) != leU32(corpo + tamanhoCorpoBloco(c) - TAMANHO_CRC_BLOCO)) {
+        resultado = -2;
+    }
+    encerraFase(tempos, FASE_DECODIFICACAO, &marca);
+    return resultado;
+}
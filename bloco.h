@@ -0,0 +1,188 @@
+#ifndef BLOCO_H
+#define BLOCO_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include "container.h"
+#include "decodificador.h"
+#include "dicionario.h"
+#include "medicao.h"
+
+typedef struct blocoCompactado BlocoCompactado;
+
+/**
+ * @brief Opções de compactação, as mesmas para todos os blocos de um arquivo.
+ */
+typedef struct {
+    unsigned int intervaloPontos;   ///< bytes entre pontos de acesso (0 = nenhum)
+    int comprimentoMax;             ///< limite dos códigos canônicos (0 = árvore sem limite)
+    const Dicionario* dicionario;   ///< códigos pré-treinados (NULL = código próprio de cada bloco)
+    int fluxos;                     ///< 1 ou FLUXOS_INTERCALADOS (cada quarto do bloco em um fluxo)
+    int contexto;                   ///< 1 = mede também o modelo de ordem 1 (BLOCO_CONTEXTO)
+    int crc;                        ///< 1 = grava o CRC32C dos bytes originais (BLOCO_COM_CRC)
+    int medir;                      ///< 1 = registra tempos e comprimentos (medicaoBlocoCompactado)
+} ParametrosBloco;
+
+/**
+ * @brief Cria a área de trabalho de um bloco; os buffers são mantidos entre compactações.
+ * @return Bloco vazio ou NULL em falta de memória.
+ */
+BlocoCompactado* criaBlocoCompactado(void);
+
+/**
+ * @brief Compacta @p n bytes de forma independente: frequências, código, dicionário e codificação.
+ * @details Com @c comprimentoMax, gera um BLOCO_CANONICO com códigos limitados e só os comprimentos no
+ *          cabeçalho; caso contrário, um BLOCO_HUFFMAN com a árvore serializada. Com @c dicionario, gera
+ *          um BLOCO_DICIONARIO com os códigos dele e só o seu id no cabeçalho, a menos que o código
+ *          próprio do bloco, com a descrição, fique menor.
+ *          O tamanho codificado é conhecido pelo histograma antes da codificação: se não for menor que
+ *          os próprios bytes, o bloco é guardado como BLOCO_ARMAZENADO, sem codificar; um bloco de um
+ *          único byte repetido vira BLOCO_REPETIDO, que ocupa um byte. Sem dicionário, as corridas
+ *          longas de um mesmo byte também são medidas: se tirá-las do fluxo codificado (BLOCO_CORRIDAS,
+ *          cada corrida em tamanho fixo) resultar no menor bloco, essa forma é usada. Com @c fluxos
+ *          igual a FLUXOS_INTERCALADOS, um bloco codificado é dividido em quatro fluxos, decodificados
+ *          juntos na leitura, e o bloco fica sem pontos de acesso. Com @c contexto (e sem dicionário),
+ *          também é medido um modelo de ordem 1 (BLOCO_CONTEXTO, contexto.h), usado se der o menor bloco.
+ * @param b Área de trabalho (o resultado anterior é descartado).
+ * @param dados Bytes do bloco; um BLOCO_ARMAZENADO os referencia até ser gravado ou copiado.
+ * @param n Quantidade de bytes (cabe em 32 bits).
+ * @param parametros Opções de compactação.
+ * @return 0 em sucesso; -1 em falta de memória ou código longo demais.
+ */
+int compactaBloco(BlocoCompactado* b, const unsigned char* dados, size_t n, const ParametrosBloco* parametros);
+
+/**
+ * @brief Tamanho do bloco no arquivo (cabeçalho + árvore + dados).
+ */
+unsigned long long int tamanhoBlocoCompactado(BlocoCompactado* b);
+
+/**
+ * @brief Grava o bloco compactado em @p saida.
+ * @return 0 em sucesso; -1 em erro de escrita.
+ */
+int gravaBlocoCompactado(BlocoCompactado* b, FILE* saida);
+
+/**
+ * @brief Copia o bloco compactado (cabeçalho, árvore e dados) para a memória.
+ * @param b Bloco compactado.
+ * @param destino Buffer com ao menos tamanhoBlocoCompactado(b) bytes.
+ */
+void copiaBlocoCompactado(BlocoCompactado* b, unsigned char* destino);
+
+/**
+ * @brief Copia só o corpo do bloco compactado (árvore, dados e CRC), sem o cabeçalho.
+ * @param b Bloco compactado.
+ * @param destino Buffer com ao menos tamanhoCorpoBloco(cabecalhoBlocoCompactado(b)) bytes.
+ */
+void copiaCorpoBlocoCompactado(BlocoCompactado* b, unsigned char* destino);
+
+/**
+ * @brief Libera a área de trabalho.
+ * @param b Bloco (pode ser NULL).
+ */
+void liberaBlocoCompactado(BlocoCompactado* b);
+
+/**
+ * @brief Acesso ao cabeçalho do último bloco compactado.
+ */
+const CabecalhoBloco* cabecalhoBlocoCompactado(BlocoCompactado* b);
+
+/**
+ * @brief Tempos por fase, histograma e bytes por comprimento de código do último bloco compactado
+ *        com @c medir; o conteúdo é indefinido sem ele.
+ */
+const Medicao* medicaoBlocoCompactado(BlocoCompactado* b);
+
+/**
+ * @brief Pontos de acesso do último bloco compactado: o bit dos dados em que começa cada byte
+ *        múltiplo do intervalo, numPontosBlocoCompactado(b) ao todo (ver container.h).
+ */
+const unsigned long long int* pontosBlocoCompactado(BlocoCompactado* b);
+
+/**
+ * @brief Quantidade de pontos de acesso do último bloco compactado: numPontosBloco(tamanhoOriginal,
+ *        intervaloPontos) se ele tiver um único fluxo de código, 0 nos tipos que não os usam
+ *        (armazenado, repetido, corridas, contexto e quatro fluxos).
+ */
+unsigned int numPontosBlocoCompactado(BlocoCompactado* b);
+
+/**
+ * @brief Carrega em @p d as tabelas de um bloco a partir da descrição do código no início do corpo.
+ * @param d Decodificador reaproveitado (ver criaDecodificadorVazio).
+ * @param c Cabeçalho do bloco (BLOCO_HUFFMAN, BLOCO_CANONICO ou BLOCO_CORRIDAS com literais).
+ * @param corpo Árvore serializada ou comprimentos, conforme o tipo (c->tamanhoArvore bits).
+ * @return 0 em sucesso; -1 se o bloco for inválido ou faltar memória.
+ */
+int carregaDecodificadorBloco(Decodificador* d, const CabecalhoBloco* c, const unsigned char* corpo);
+
+/**
+ * @brief Indica se o bloco é guardado sem código de Huffman, com campos coerentes: BLOCO_ARMAZENADO
+ *        (os bytes originais) ou BLOCO_REPETIDO (um único byte, repetido tamanhoOriginal vezes).
+ * @param c Cabeçalho do bloco.
+ * @return 1 se for um desses tipos; 0 caso contrário.
+ */
+int blocoSemCodigo(const CabecalhoBloco* c);
+
+/**
+ * @brief Indica se o bloco só pode ser decodificado inteiro, sem pontos de acesso nem decodificação
+ *        incremental: um BLOCO_CORRIDAS, um BLOCO_CONTEXTO ou um bloco em quatro fluxos.
+ * @param c Cabeçalho do bloco.
+ * @return 1 se for um desses; 0 caso contrário.
+ */
+int blocoLidoInteiro(const CabecalhoBloco* c);
+
+/**
+ * @brief Verifica se @p dicionario é o usado por um BLOCO_DICIONARIO.
+ * @param dicionario Dicionário disponível (pode ser NULL).
+ * @param c Cabeçalho do bloco.
+ * @param corpo Início do corpo do bloco.
+ * @return 1 se o bloco não usar dicionário ou se @p dicionario tiver o id gravado; 0 caso contrário.
+ */
+int dicionarioConfere(const Dicionario* dicionario, const CabecalhoBloco* c, const unsigned char* corpo);
+
+/**
+ * @brief Obtém as tabelas para decodificar um bloco de qualquer tipo.
+ * @details As de um BLOCO_DICIONARIO já estão prontas no dicionário; as dos demais são carregadas em @p d.
+ * @param d Decodificador reaproveitado (ver criaDecodificadorVazio).
+ * @param dicionario Dicionário disponível (pode ser NULL).
+ * @param c Cabeçalho do bloco.
+ * @param corpo Descrição do código no início do corpo (c->tamanhoArvore bits).
+ * @return Decodificador a usar (@p d ou o do dicionário); NULL se o bloco for inválido, se faltar
+ *         memória ou se o dicionário não conferir.
+ */
+Decodificador* decodificadorBloco(Decodificador* d, const Dicionario* dicionario, const CabecalhoBloco* c,
+                                  const unsigned char* corpo);
+
+/**
+ * @brief Cria o decodificador de um bloco a partir da descrição do código no início do corpo.
+ * @param c Cabeçalho do bloco (BLOCO_HUFFMAN ou BLOCO_CANONICO).
+ * @param corpo Árvore serializada ou comprimentos, conforme o tipo (c->tamanhoArvore bits).
+ * @return Decodificador (liberar com liberaDecodificador) ou NULL se o bloco for inválido.
+ */
+Decodificador* criaDecodificadorBloco(const CabecalhoBloco* c, const unsigned char* corpo);
+
+/**
+ * @brief Lê e valida a tabela no início dos dados de um BLOCO_CORRIDAS.
+ * @param c Cabeçalho do bloco.
+ * @param dados Início dos dados (após a descrição do código), com (c->bitsDados + 7) / 8 bytes.
+ * @param bytesTabela Recebe o tamanho da tabela.
+ * @return Quantidade de bytes literais do bloco; -1 se a tabela for inválida.
+ */
+long long int leTabelaCorridas(const CabecalhoBloco* c, const unsigned char* dados, size_t* bytesTabela);
+
+/**
+ * @brief Descompacta um bloco para a memória (blocos sem código são copiados ou preenchidos direto).
+ * @param d Decodificador usado como área de trabalho; suas tabelas são substituídas pelas do bloco.
+ * @param dicionario Dicionário para blocos BLOCO_DICIONARIO (pode ser NULL).
+ * @param c Cabeçalho do bloco.
+ * @param corpo Descrição do código seguida dos dados codificados (tamanhoCorpoBloco bytes).
+ * @param destino Buffer com ao menos c->tamanhoOriginal bytes.
+ * @param tempos Recebe o tempo das tabelas (FASE_ARVORE) e da decodificação (FASE_DECODIFICACAO);
+ *        NULL = sem medição.
+ * @return 0 em sucesso; -1 se o bloco estiver corrompido (inclusive se não produzir exatamente
+ *         c->tamanhoOriginal bytes); -2 se for decodificado mas o CRC32C gravado não conferir.
+ */
+int descompactaBloco(Decodificador* d, const Dicionario* dicionario, const CabecalhoBloco* c,
+                     const unsigned char* corpo, unsigned char* destino, TemposFases* tempos);
+
+#endif
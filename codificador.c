@@ -0,0 +1,293 @@
+#include "codificador.h"
+#include <stdlib.h>
+
+#define TAMANHO_BUFFER_SAIDA (1 << 20)
+#define TAMANHO_MAX_AGRUPADO 16     // códigos até este tamanho são agrupados antes de ir ao acumulador
+#define MINIMO_AGRUPADO 64          // abaixo disto não compensa montar a tabela compacta
+
+struct escritorBits {
+    FILE* saida;                          ///< NULL quando a saída fica em memória
+    unsigned char* buffer;                ///< bytes prontos para gravar
+    size_t usados;                        ///< bytes ocupados em buffer
+    size_t capacidade;                    ///< bytes alocados em buffer
+    int erro;                             ///< 1 se faltou memória para crescer o buffer
+    unsigned long long int acumulador;    ///< bits pendentes, alinhados à esquerda
+    int ocupados;                         ///< bits pendentes no acumulador
+    unsigned long long int totalBits;     ///< bits escritos desde a criação
+};
+
+/**
+ * @brief Cria um escritor de bits que acumula códigos em palavras de 64 bits e grava em @p saida
+ *        por um buffer de saída grande.
+ * @param saida Arquivo de saída aberto (binário), ou NULL para manter toda a saída em memória
+ *              (ver conteudoEscritorBits).
+ * @return Escritor criado ou NULL em falta de memória.
+ */
+EscritorBits* criaEscritorBits(FILE* saida) {
+    EscritorBits* e = (EscritorBits*) calloc(1, sizeof(EscritorBits));
+    if (e == NULL) {
+        return NULL;
+    }
+    e->buffer = (unsigned char*) malloc(TAMANHO_BUFFER_SAIDA);
+    if (e->buffer == NULL) {
+        free(e);
+        return NULL;
+    }
+    e->saida = saida;
+    e->capacidade = TAMANHO_BUFFER_SAIDA;
+    return e;
+}
+
+/**
+ * @brief Garante espaço para mais @p n bytes no buffer: grava o conteúdo no arquivo ou, em memória,
+ *        dobra a capacidade.
+ * @return 1 se há espaço; 0 em falta de memória.
+ */
+static int abreEspaco(EscritorBits* e, size_t n) {
+    if (e->saida) {
+        fwrite(e->buffer, sizeof(unsigned char), e->usados, e->saida);
+        e->usados = 0;
+        return 1;
+    }
+    size_t nova = e->capacidade * 2;
+    while (nova < e->usados + n) {
+        nova *= 2;
+    }
+    unsigned char* b = (unsigned char*) realloc(e->buffer, nova);
+    if (b == NULL) {
+        e->erro = 1;
+        return 0;
+    }
+    e->buffer = b;
+    e->capacidade = nova;
+    return 1;
+}
+
+/**
+ * @brief Copia a palavra de 64 bits para o buffer de saída (byte mais significativo primeiro).
+ */
+static inline void gravaPalavra(EscritorBits* e, unsigned long long int palavra) {
+    if (e->usados + 8 > e->capacidade && !abreEspaco(e, 8)) {
+        return;
+    }
+    unsigned char* p = e->buffer + e->usados;
+    for (int i = 0; i < 8; i++) {
+        p[i] = (unsigned char) (palavra >> (56 - 8 * i));
+    }
+    e->usados += 8;
+}
+
+/**
+ * @brief Acrescenta um código ao acumulador, gravando a palavra quando os 64 bits se completam.
+ */
+static inline void acrescentaBits(EscritorBits* e, unsigned long long int bits, int tamanho) {
+    int livres = 64 - e->ocupados;
+    if (tamanho < livres) {
+        e->acumulador |= bits << (livres - tamanho);
+        e->ocupados += tamanho;
+    } else {
+        int excedentes = tamanho - livres;
+        gravaPalavra(e, e->acumulador | (excedentes ? bits >> excedentes : bits));
+        e->acumulador = excedentes ? bits << (64 - excedentes) : 0;
+        e->ocupados = excedentes;
+    }
+}
+
+/**
+ * @brief Acrescenta os @p tamanho bits menos significativos de @p bits ao fluxo.
+ * @pre 1 <= tamanho <= TAMANHO_MAX_CODIGO
+ */
+void escreveBits(EscritorBits* e, unsigned long long int bits, int tamanho) {
+    acrescentaBits(e, bits, tamanho);
+    e->totalBits += tamanho;
+}
+
+/**
+ * @brief Monta a tabela compacta dos códigos usada pelos núcleos agrupados: bits nos 16 bits baixos e
+ *        tamanho nos 16 altos de cada entrada.
+ * @return 1 se todos os códigos couberem em TAMANHO_MAX_AGRUPADO bits; 0 caso contrário.
+ */
+static int montaTabelaAgrupada(const Codigo* dicionario, unsigned int* tabela) {
+    for (int i = 0; i < 256; i++) {
+        if (dicionario[i].tamanho > TAMANHO_MAX_AGRUPADO) {
+            return 0;
+        }
+        tabela[i] = (unsigned int) dicionario[i].bits | ((unsigned int) dicionario[i].tamanho << 16);
+    }
+    return 1;
+}
+
+/**
+ * @brief Núcleo escalar: junta os códigos de 4 bytes (no máximo 64 bits) com deslocamentos e os
+ *        acrescenta ao acumulador de uma vez.
+ * @return Bits acrescentados.
+ */
+static unsigned long long int codificaAgrupado(EscritorBits* e, const unsigned int* tabela,
+                                               const unsigned char* dados, size_t n) {
+    unsigned long long int total = 0;
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        unsigned int c0 = tabela[dados[i]], c1 = tabela[dados[i + 1]];
+        unsigned int c2 = tabela[dados[i + 2]], c3 = tabela[dados[i + 3]];
+        unsigned long long int bits = c0 & 0xFFFF;
+        bits = (bits << (c1 >> 16)) | (c1 & 0xFFFF);
+        bits = (bits << (c2 >> 16)) | (c2 & 0xFFFF);
+        bits = (bits << (c3 >> 16)) | (c3 & 0xFFFF);
+        int tamanho = (int) ((c0 >> 16) + (c1 >> 16) + (c2 >> 16) + (c3 >> 16));
+        acrescentaBits(e, bits, tamanho);
+        total += tamanho;
+    }
+    for (; i < n; i++) {
+        acrescentaBits(e, tabela[dados[i]] & 0xFFFF, (int) (tabela[dados[i]] >> 16));
+        total += tabela[dados[i]] >> 16;
+    }
+    return total;
+}
+
+/**
+ * @brief Codifica @p n bytes de @p dados pelo dicionário e acrescenta os códigos ao fluxo.
+ * @details Se nenhum código passar de 16 bits, os códigos de 4 bytes são juntados antes de entrar no
+ *          acumulador.
+ * @param e Escritor de bits.
+ * @param dicionario Vetor de 256 códigos (indexado pelo byte).
+ * @param dados Bytes a codificar.
+ * @param n Quantidade de bytes.
+ */
+void codificaBuffer(EscritorBits* e, const Codigo* dicionario, const unsigned char* dados, size_t n) {
+    unsigned int tabela[256];
+    if (n >= MINIMO_AGRUPADO && montaTabelaAgrupada(dicionario, tabela)) {
+        e->totalBits += codificaAgrupado(e, tabela, dados, n);
+        return;
+    }
+
+    // Códigos longos: um de cada vez
+    unsigned long long int total = 0;
+    for (size_t i = 0; i < n; i++) {
+        const Codigo c = dicionario[dados[i]];
+        acrescentaBits(e, c.bits, c.tamanho);
+        total += c.tamanho;
+    }
+    e->totalBits += total;
+}
+
+/**
+ * @brief Codifica @p n bytes de @p dados trocando de dicionário a cada byte, pelo byte anterior
+ *        (modelo de ordem 1; o primeiro byte usa o dicionário do contexto 0).
+ * @details Os códigos de 4 bytes são juntados antes de entrar no acumulador, como no núcleo escalar.
+ * @param e Escritor de bits.
+ * @param dicionarios Dicionário de cada contexto (256 códigos cada).
+ * @param dados Bytes a codificar.
+ * @param n Quantidade de bytes.
+ * @pre Nenhum código passa de 16 bits.
+ */
+void codificaBufferContexto(EscritorBits* e, const Codigo* const dicionarios[256], const unsigned char* dados,
+                            size_t n) {
+    unsigned long long int total = 0;
+    unsigned char anterior = 0;
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        Codigo c0 = dicionarios[anterior][dados[i]], c1 = dicionarios[dados[i]][dados[i + 1]];
+        Codigo c2 = dicionarios[dados[i + 1]][dados[i + 2]], c3 = dicionarios[dados[i + 2]][dados[i + 3]];
+        unsigned long long int bits = c0.bits;
+        bits = (bits << c1.tamanho) | c1.bits;
+        bits = (bits << c2.tamanho) | c2.bits;
+        bits = (bits << c3.tamanho) | c3.bits;
+        int tamanho = c0.tamanho + c1.tamanho + c2.tamanho + c3.tamanho;
+        acrescentaBits(e, bits, tamanho);
+        total += tamanho;
+        anterior = dados[i + 3];
+    }
+    for (; i < n; i++) {
+        Codigo c = dicionarios[anterior][dados[i]];
+        acrescentaBits(e, c.bits, c.tamanho);
+        total += c.tamanho;
+        anterior = dados[i];
+    }
+    e->totalBits += total;
+}
+
+/**
+ * @brief Grava os bits pendentes (completando o último byte com zeros).
+ * @param e Escritor de bits.
+ * @return Total de bits escritos desde a criação.
+ */
+unsigned long long int finalizaEscritorBits(EscritorBits* e) {
+    int bytesPendentes = (e->ocupados + 7) / 8;
+    if (e->usados + bytesPendentes > e->capacidade && !abreEspaco(e, bytesPendentes)) {
+        bytesPendentes = 0;
+    }
+    for (int i = 0; i < bytesPendentes; i++) {
+        e->buffer[e->usados++] = (unsigned char) (e->acumulador >> (56 - 8 * i));
+    }
+    if (e->saida) {
+        fwrite(e->buffer, sizeof(unsigned char), e->usados, e->saida);
+        e->usados = 0;
+    }
+    e->acumulador = 0;
+    e->ocupados = 0;
+    return e->totalBits;
+}
+
+/**
+ * @brief Total de bits escritos desde a criação ou o último reinício, incluindo os pendentes.
+ * @param e Escritor.
+ */
+unsigned long long int bitsEscritorBits(EscritorBits* e) {
+    return e->totalBits;
+}
+
+/**
+ * @brief Reserva espaço para @p bytes bytes de saída em memória, evitando realocações durante a codificação.
+ * @param e Escritor em memória.
+ * @param bytes Tamanho esperado da saída.
+ * @return 0 em sucesso; -1 em falta de memória.
+ */
+int reservaEscritorBits(EscritorBits* e, size_t bytes) {
+    if (e->saida == NULL && bytes > e->capacidade - e->usados) {
+        return abreEspaco(e, bytes) ? 0 : -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Retorna a saída acumulada por um escritor em memória (após finalizaEscritorBits).
+ * @param e Escritor criado com saída NULL.
+ * @param tamanho Recebe a quantidade de bytes.
+ * @return Bytes escritos, válidos até a próxima escrita ou reinício.
+ */
+const unsigned char* conteudoEscritorBits(EscritorBits* e, size_t* tamanho) {
+    *tamanho = e->usados;
+    return e->buffer;
+}
+
+/**
+ * @brief Descarta o conteúdo e zera o contador de bits, mantendo o buffer alocado para reutilização.
+ * @param e Escritor.
+ */
+void reiniciaEscritorBits(EscritorBits* e) {
+    e->usados = 0;
+    e->acumulador = 0;
+    e->ocupados = 0;
+    e->totalBits = 0;
+    e->erro = 0;
+}
+
+/**
+ * @brief Indica se faltou memória durante a escrita em memória.
+ * @param e Escritor.
+ * @return Diferente de zero em caso de erro.
+ */
+int erroEscritorBits(EscritorBits* e) {
+    return e->erro;
+}
+
+/**
+ * @brief Libera o escritor (não fecha o arquivo).
+ * @param e Escritor (pode ser NULL).
+ */
+void liberaEscritorBits(EscritorBits* e) {
+    if (e) {
+        free(e->buffer);
+        free(e);
+    }
+}
@@ -0,0 +1,106 @@
+#ifndef CODIFICADOR_H
+#define CODIFICADOR_H
+
+#include <stdio.h>
+#include <stddef.h>
+
+#define TAMANHO_MAX_CODIGO 64
+
+/**
+ * @brief Código de Huffman de um byte: os @c tamanho bits menos significativos de @c bits,
+ *        emitidos do mais significativo para o menos significativo.
+ */
+typedef struct {
+    unsigned long long int bits;
+    unsigned char tamanho;
+} Codigo;
+
+typedef struct escritorBits EscritorBits;
+
+/**
+ * @brief Cria um escritor de bits que acumula códigos em palavras de 64 bits e grava em @p saida
+ *        por um buffer de saída grande.
+ * @param saida Arquivo de saída aberto (binário), ou NULL para manter toda a saída em memória
+ *              (ver conteudoEscritorBits).
+ * @return Escritor criado ou NULL em falta de memória.
+ */
+EscritorBits* criaEscritorBits(FILE* saida);
+
+/**
+ * @brief Acrescenta os @p tamanho bits menos significativos de @p bits ao fluxo.
+ * @pre 1 <= tamanho <= TAMANHO_MAX_CODIGO
+ */
+void escreveBits(EscritorBits* e, unsigned long long int bits, int tamanho);
+
+/**
+ * @brief Codifica @p n bytes de @p dados pelo dicionário e acrescenta os códigos ao fluxo.
+ * @details Se nenhum código passar de 16 bits, os códigos de 4 bytes são juntados antes de entrar no
+ *          acumulador.
+ * @param e Escritor de bits.
+ * @param dicionario Vetor de 256 códigos (indexado pelo byte).
+ * @param dados Bytes a codificar.
+ * @param n Quantidade de bytes.
+ */
+void codificaBuffer(EscritorBits* e, const Codigo* dicionario, const unsigned char* dados, size_t n);
+
+/**
+ * @brief Codifica @p n bytes de @p dados trocando de dicionário a cada byte, pelo byte anterior
+ *        (modelo de ordem 1; o primeiro byte usa o dicionário do contexto 0).
+ * @param e Escritor de bits.
+ * @param dicionarios Dicionário de cada contexto (256 códigos cada).
+ * @param dados Bytes a codificar.
+ * @param n Quantidade de bytes.
+ * @pre Nenhum código passa de 16 bits.
+ */
+void codificaBufferContexto(EscritorBits* e, const Codigo* const dicionarios[256], const unsigned char* dados,
+                            size_t n);
+
+/**
+ * @brief Grava os bits pendentes (completando o último byte com zeros).
+ * @param e Escritor de bits.
+ * @return Total de bits escritos desde a criação.
+ */
+unsigned long long int finalizaEscritorBits(EscritorBits* e);
+
+/**
+ * @brief Total de bits escritos desde a criação ou o último reinício, incluindo os pendentes.
+ * @param e Escritor.
+ */
+unsigned long long int bitsEscritorBits(EscritorBits* e);
+
+/**
+ * @brief Reserva espaço para @p bytes bytes de saída em memória, evitando realocações durante a codificação.
+ * @param e Escritor em memória.
+ * @param bytes Tamanho esperado da saída.
+ * @return 0 em sucesso; -1 em falta de memória.
+ */
+int reservaEscritorBits(EscritorBits* e, size_t bytes);
+
+/**
+ * @brief Retorna a saída acumulada por um escritor em memória (após finalizaEscritorBits).
+ * @param e Escritor criado com saída NULL.
+ * @param tamanho Recebe a quantidade de bytes.
+ * @return Bytes escritos, válidos até a próxima escrita ou reinício.
+ */
+const unsigned char* conteudoEscritorBits(EscritorBits* e, size_t* tamanho);
+
+/**
+ * @brief Descarta o conteúdo e zera o contador de bits, mantendo o buffer alocado para reutilização.
+ * @param e Escritor.
+ */
+void reiniciaEscritorBits(EscritorBits* e);
+
+/**
+ * @brief Indica se faltou memória durante a escrita em memória.
+ * @param e Escritor.
+ * @return Diferente de zero em caso de erro.
+ */
+int erroEscritorBits(EscritorBits* e);
+
+/**
+ * @brief Libera o escritor (não fecha o arquivo).
+ * @param e Escritor (pode ser NULL).
+ */
+void liberaEscritorBits(EscritorBits* e);
+
+#endif
@@ -1,310 +1,335 @@
-#include "arvore.h"
-#include "lista.h"
+#include <errno.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include "bitmap.h"
+#include "libhuffman.h"
+#include "programas.h"
 
-#define ALTURA_MAX 256
+#define TAMANHO_BLOCO_MAX_MB (HUFFMAN_TAMANHO_BLOCO_MAX >> 20)
 
-// Protótipos das funções
-void calculaFrequencias(const char* nomeArquivo, unsigned long long int* arrayFrequencias);
-void gerarDicionario(char* dicionario[ALTURA_MAX], Arvore* raiz, unsigned long long int* frequencias);
-void preencherDicionarioRecursivo(Arvore* no, char* dicionario[ALTURA_MAX], char* caminhoAtual, int profundidade);
-void serializarArvore(Arvore* raiz, bitmap* bm);
-void compactarArquivo(const char* nomeArquivoEntrada, const char* nomeArquivoSaida, 
-                     Arvore* raiz, char* dicionario[], unsigned long long int* frequencias);
 /**
- * @brief Programa de compactação por Huffman.
- * @details Fluxo: calcula frequências; monta lista ordenada; constrói árvore; gera dicionário; serializa árvore;
- *          codifica entrada; grava cabeçalho e bitmaps no arquivo <entrada>.comp.
- * @param argc Espera 2 argumentos.
- * @param argv argv[1] = caminho do arquivo de entrada.
- * @return 0 em sucesso; 1 em erro de uso; aborta em erros de E/S.
+ * @brief Escreve o relatório de --stats: tempos por fase, bytes lidos e gravados, pico de memória,
+ *        distribuição dos comprimentos dos códigos e entropia contra os bits por byte obtidos.
+ * @details Os tempos das fases são somados entre blocos e threads; o total é o da execução inteira.
+ *          Os bits por byte do código contam só os bytes codificados; os do arquivo, o arquivo inteiro.
+ * @param destino Saída do relatório.
+ * @param formato ESTATISTICAS_TEXTO ou ESTATISTICAS_JSON.
+ * @param r Tamanhos lidos e gravados.
+ * @param lote Totais de um lote (NULL para um único arquivo).
+ * @param e Medições do contexto.
+ * @param segundos Tempo total de relógio.
  */
+static void escreveEstatisticas(FILE* destino, int formato, const ResultadoHuffman* r, const ResultadoLote* lote,
+                                const EstatisticasHuffman* e, double segundos) {
+    double segundosCpu;
+    long picoMemoriaKB;
+    usoProcesso(&segundosCpu, &picoMemoriaKB);
 
-int main(int argc, char *argv[]) {
-    if (argc != 2) {
-        printf("Uso: ./compacta <arquivo_entrada>\n");
-        return 1;
+    unsigned long long int codificados = 0, bitsCodigo = 0;
+    for (int k = 1; k <= HUFFMAN_BITS_CODIGO_MAX; k++) {
+        codificados += e->bytesPorComprimento[k];
+        bitsCodigo += e->bytesPorComprimento[k] * k;
     }
+    double entropia = entropiaHuffman(e);
+    double bitsPorByteCodigo = codificados > 0 ? (double) bitsCodigo / codificados : 0;
+    double bitsPorByteArquivo = r->tamanhoOriginal > 0 ? 8.0 * r->tamanhoCompactado / r->tamanhoOriginal : 0;
 
-    const char* nomeArquivo = argv[1];
-    unsigned long long int frequencias[256] = {0};
-    
-    // Etapa 1: Calcular frequências
-    calculaFrequencias(nomeArquivo, frequencias);
-    
-    unsigned long long int totalCaracteres = 0;
-    for (int i = 0; i < 256; i++) {
-        totalCaracteres += frequencias[i];
-    }
-
-    // Etapa 2: Criar lista ordenada com os nós folhas
-    Lista *listaHuffman = criaListaVazia();
-    int caracteresDistintos = 0;
-    
-    for (int i = 0; i < 256; i++) {
-        if (frequencias[i] > 0) {
-            Arvore* no_folha = criaArvore((unsigned char)i, frequencias[i], NULL, NULL);
-            listaHuffman = insereOrdenado(listaHuffman, no_folha);
-            caracteresDistintos++;
+    if (formato == ESTATISTICAS_JSON) {
+        fprintf(destino, "{\"operacao\": \"compactacao\", \"bytes_lidos\": %llu, \"bytes_gravados\": %llu, "
+                "\"blocos\": %llu,\n", r->tamanhoOriginal, r->tamanhoCompactado, e->blocos);
+        if (lote) {
+            fprintf(destino, " \"arquivos\": %llu, \"falhas\": %llu,\n", lote->arquivos, lote->falhas);
         }
-    }
-    
-    // Caso especial: arquivo com apenas 1 tipo de caractere
-    if (caracteresDistintos == 1) {
-        // Adiciona um nó fictício com frequência 0
-        unsigned char charFicticio = 0;
-        // Encontra um caractere não usado
-        for (int i = 0; i < 256; i++) {
-            if (frequencias[i] == 0) {
-                charFicticio = (unsigned char)i;
-                break;
+        fprintf(destino, " \"segundos\": %.6f, \"segundos_cpu\": %.6f, \"pico_memoria_kb\": %ld,\n",
+                segundos, segundosCpu, picoMemoriaKB);
+        fprintf(destino, " \"fases\": {");
+        for (int f = 0; f < HUFFMAN_NUM_FASES; f++) {
+            fprintf(destino, "%s\n  \"%s\": {\"segundos\": %.6f, \"segundos_cpu\": %.6f}", f ? "," : "",
+                    nomeFaseHuffman(f), e->segundos[f], e->segundosCpu[f]);
+        }
+        fprintf(destino, "},\n \"entropia_bits_byte\": %.4f, \"codigo_bits_byte\": %.4f, \"arquivo_bits_byte\": %.4f,\n",
+                entropia, bitsPorByteCodigo, bitsPorByteArquivo);
+        fprintf(destino, " \"bytes_por_comprimento\": {");
+        int primeiro = 1;
+        for (int k = 0; k <= HUFFMAN_BITS_CODIGO_MAX; k++) {
+            if (e->bytesPorComprimento[k] > 0) {
+                fprintf(destino, "%s\"%d\": %llu", primeiro ? "" : ", ", k, e->bytesPorComprimento[k]);
+                primeiro = 0;
             }
         }
-        Arvore* no_ficticio = criaArvore(charFicticio, 0, NULL, NULL);
-        listaHuffman = insereOrdenado(listaHuffman, no_ficticio);
-    }
-    
-    // Etapa 3: Construir a árvore de Huffman
-    while (!verificaListaUmElemento(listaHuffman)) {
-        Arvore* no1 = removePrimeiroLista(&listaHuffman);
-        Arvore* no2 = removePrimeiroLista(&listaHuffman);
-        
-        unsigned long long int freq_pai = frequenciaArvore(no1) + frequenciaArvore(no2);
-        Arvore* no_interno = criaArvore('\0', freq_pai, no1, no2);
-        listaHuffman = insereOrdenado(listaHuffman, no_interno);
+        fprintf(destino, "}}\n");
+        return;
     }
 
-    Arvore* arvoreHuffman = removePrimeiroLista(&listaHuffman);
-
-    // Etapa 4: Gerar dicionário de códigos
-    char* dicionario[ALTURA_MAX] = {NULL};
-    gerarDicionario(dicionario, arvoreHuffman, frequencias);
-
-    // Etapa 5: Compactar o arquivo
-    char nomeArquivoSaida[1024];
-    snprintf(nomeArquivoSaida, sizeof(nomeArquivoSaida), "%s.comp", nomeArquivo);
-    
-    compactarArquivo(nomeArquivo, nomeArquivoSaida, arvoreHuffman, dicionario, frequencias);
-
-    // Estatísticas
-    // printf("\n=== COMPACTAÇÃO CONCLUÍDA ===\n");
-    // printf("Arquivo original: %s\n", nomeArquivo);
-    // printf("Arquivo compactado: %s\n", nomeArquivoSaida);
-    // printf("Caracteres distintos: %d\n", caracteresDistintos);
-    // printf("Total de caracteres: %llu\n", totalCaracteres);
-    
-    // Limpeza de memória
-    liberaLista(listaHuffman);
-    liberaArvore(arvoreHuffman);
-    
-    for(int i = 0; i < ALTURA_MAX; i++) {
-        if(dicionario[i] != NULL) {
-            free(dicionario[i]);
+    fprintf(destino, "Estatísticas da compactação (%llu blocos):\n", e->blocos);
+    fprintf(destino, "  %-14s %13s %12s\n", "fase", "relógio (s)", "CPU (s)");  // "ó" ocupa dois bytes
+    for (int f = 0; f < HUFFMAN_NUM_FASES; f++) {
+        if (f != HUFFMAN_FASE_DECODIFICACAO) {
+            fprintf(destino, "  %-14s %12.6f %12.6f\n", nomeFaseHuffman(f), e->segundos[f], e->segundosCpu[f]);
+        }
+    }
+    fprintf(destino, "  %-14s %12.6f %12.6f\n", "total", segundos, segundosCpu);
+    fprintf(destino, "  Bytes lidos: %llu\n", r->tamanhoOriginal);
+    fprintf(destino, "  Bytes gravados: %llu\n", r->tamanhoCompactado);
+    fprintf(destino, "  Pico de memória: %ld KB\n", picoMemoriaKB);
+    fprintf(destino, "  Entropia (ordem 0): %.4f bits/byte\n", entropia);
+    fprintf(destino, "  Código (bytes codificados): %.4f bits/byte\n", bitsPorByteCodigo);
+    fprintf(destino, "  Arquivo: %.4f bits/byte\n", bitsPorByteArquivo);
+    fprintf(destino, "  Comprimentos dos códigos:\n");
+    for (int k = 0; k <= HUFFMAN_BITS_CODIGO_MAX; k++) {
+        if (e->bytesPorComprimento[k] > 0) {
+            double fracao = r->tamanhoOriginal > 0 ? 100.0 * e->bytesPorComprimento[k] / r->tamanhoOriginal : 0;
+            if (k == 0) {
+                fprintf(destino, "    sem código %15llu bytes (%.2f%%)\n", e->bytesPorComprimento[k], fracao);
+            } else {
+                fprintf(destino, "    %2d bits %18llu bytes (%.2f%%)\n", k, e->bytesPorComprimento[k], fracao);
+            }
         }
     }
-    
-    return 0;
 }
+
 /**
- * @brief Varre o arquivo e acumula em @p arrayFrequencias a contagem por byte (0..255).
- * @param nomeArquivo Caminho do arquivo a ler (modo binário).
- * @param arrayFrequencias Vetor de 256 posições (unsigned long long) inicializado com zeros.
+ * @brief Compacta um lote de arquivos e diretórios e informa os totais.
+ * @return Código de saída do programa: 0 se todos os arquivos foram compactados; 1 caso contrário.
  */
+static int compactaEmLote(ListaCaminhos* caminhos, const OpcoesHuffman* opcoes, const char* nomeDicionario,
+                          int numThreads, int estatisticas, double inicio) {
+    DicionarioHuffman* dicionario = NULL;
+    if (nomeDicionario) {
+        int codigo = carregaDicionarioArquivo(nomeDicionario, &dicionario);
+        if (codigo != HUFFMAN_OK) {
+            printf("Erro: dicionário %s: %s\n", nomeDicionario, mensagemErroHuffman(codigo));
+            exit(1);
+        }
+    }
 
-void calculaFrequencias(const char* nomeArquivo, unsigned long long int* arrayFrequencias) {
-    FILE* arquivo = fopen(nomeArquivo, "rb");
-    
-    if (arquivo == NULL) {
-        perror("Erro ao abrir o arquivo de entrada");
+    // Com --stats=json, a saída padrão recebe só o relatório
+    FILE* mensagens = estatisticas == ESTATISTICAS_JSON ? stderr : stdout;
+    ResultadoLote lote;
+    EstatisticasHuffman medicoes;
+    int codigo = compactaLote((const char* const*) caminhos->nomes, caminhos->quantidade, opcoes, dicionario,
+                              numThreads, informaArquivo, mensagens, &lote, estatisticas ? &medicoes : NULL);
+    liberaDicionarioHuffman(dicionario);
+    liberaCaminhos(caminhos);
+    if (codigo != HUFFMAN_OK) {
+        printf("Erro: %s\n", mensagemErroHuffman(codigo));
         exit(1);
     }
 
-    unsigned char byte;
-    while (fread(&byte, sizeof(unsigned char), 1, arquivo) == 1) {
-        arrayFrequencias[byte]++;
+    double segundos = agora() - inicio;
+    ResultadoHuffman totais = {lote.tamanhoOriginal, lote.tamanhoCompactado};
+    if (estatisticas == ESTATISTICAS_JSON) {
+        escreveEstatisticas(stdout, estatisticas, &totais, &lote, &medicoes, segundos);
+        return lote.falhas > 0;
     }
-
-    if (ferror(arquivo)) {
-        perror("Erro durante a leitura do arquivo");
-        fclose(arquivo);
-        exit(1);
+    double taxaCompressao = totais.tamanhoOriginal > totais.tamanhoCompactado ?
+        ((double)(totais.tamanhoOriginal - totais.tamanhoCompactado) / totais.tamanhoOriginal) * 100 : 0;
+    printf("Arquivos compactados: %llu (%llu com erro)\n", lote.arquivos, lote.falhas);
+    printf("Tamanho original: %llu bytes\n", totais.tamanhoOriginal);
+    printf("Tamanho comprimido: %llu bytes\n", totais.tamanhoCompactado);
+    printf("Taxa de compressão: %.2f%%\n", taxaCompressao);
+    printf("Vazão: %.1f MB/s (%.3f s)\n", segundos > 0 ? totais.tamanhoOriginal / segundos / 1e6 : 0, segundos);
+    if (estatisticas) {
+        escreveEstatisticas(stdout, estatisticas, &totais, &lote, &medicoes, segundos);
     }
-
-    fclose(arquivo);
+    return lote.falhas > 0;
 }
-/**
- * @brief Cria o dicionário de códigos binários para cada byte presente.
- * @details Caso a árvore possua uma única folha (apenas um símbolo), o símbolo recebe código "0" e um nó
- *          fictício é criado no compressor para viabilizar a codificação.
- * @param dicionario Vetor de 256 ponteiros para strings (serão alocadas com strdup).
- * @param raiz Raiz da árvore de Huffman.
- * @param frequencias Vetor de frequências para filtrar símbolos inexistentes.
- */
 
-void gerarDicionario(char* dicionario[], Arvore* raiz, unsigned long long int* frequencias) {
-    // Caso especial: árvore com apenas um nó (arquivo com 1 caractere único)
-    if (ehFolha(raiz)) {
-        unsigned char c = caractereArvore(raiz);
-        dicionario[c] = strdup("0");  // Código arbitrário "0"
-        return;
-    }
-    
-    char caminhoAtual[ALTURA_MAX];
-    preencherDicionarioRecursivo(raiz, dicionario, caminhoAtual, 0);
-}
 /**
- * @brief Percorre a árvore (pré-ordem) acumulando '0' (esq) e '1' (dir) até folhas.
- * @param no Nó atual.
- * @param dicionario Vetor de 256 strings a preencher.
- * @param caminhoAtual Buffer temporário (stack) contendo o caminho acumulado.
- * @param profundidade Posição atual no @p caminhoAtual.
+ * @brief Programa de compactação por Huffman, sobre a biblioteca (libhuffman.h).
+ * @details Por padrão a entrada é dividida em blocos independentes, compactados em paralelo e gravados
+ *          em ordem no formato em blocos (container.h), com um ponto de acesso aleatório a cada
+ *          -p KB da entrada (0 desativa). Com -l, os blocos usam códigos canônicos de até -l bits
+ *          e o cabeçalho de cada bloco traz só os comprimentos dos códigos. Com -D, os blocos usam os
+ *          códigos de um dicionário gerado por treina e o cabeçalho traz só o id dele. Com -f 4, cada
+ *          bloco é codificado em quatro fluxos, decodificados juntos e mais rápido, sem pontos de acesso.
+ *          Com -c, cada bloco em que compensar usa um modelo de ordem 1 (o código de cada byte depende
+ *          do anterior), que comprime melhor textos e logs e é decodificado inteiro, sem pontos de acesso.
+ *          Com --crc, cada bloco leva o CRC32C dos seus bytes originais, conferido na descompactação
+ *          e por descompacta -t.
+ *          A leitura dos próximos blocos e a gravação dos anteriores correm em segundo plano (io_uring,
+ *          quando disponível) enquanto os blocos são compactados; com --direto, os arquivos são lidos e
+ *          gravados com O_DIRECT, sem passar pelo cache de páginas.
+ *          Com --legado, gera o formato antigo: calcula
+ *          frequências; constrói árvore; gera dicionário; serializa árvore; codifica a entrada. Como a
+ *          entrada é lida duas vezes, pipes e FIFOs são recusados antes de qualquer leitura.
+ *          A saída é <entrada>.comp; com "-" no lugar do arquivo, funciona como filtro da entrada padrão
+ *          para a saída padrão, compactando cada bloco assim que chega, e as mensagens vão para a saída de erro.
+ *          Com vários arquivos, diretórios (percorridos recursivamente) ou uma lista de caminhos (-L, um
+ *          por linha), processa um lote: -j arquivos são compactados ao mesmo tempo, cada um gerando o
+ *          seu <arquivo>.comp, e ao final são informados os totais e a vazão.
+ *          Com --stats, informa ainda o tempo de cada fase, o pico de memória e a distribuição dos
+ *          comprimentos dos códigos; com --stats=json, o mesmo relatório em JSON, no lugar das mensagens.
+ * @param argc Quantidade de argumentos.
+ * @param argv [-b MB] [-p KB] [-l bits] [-f fluxos] [-c] [-D dicionario] [-j threads] [--crc] [--legado] [--direto]
+ *        [--stats[=json]] [-L lista] <arquivo_entrada | diretorio | ->....
+ * @return 0 em sucesso; 1 em erro de uso, de E/S ou de memória.
  */
 
-void preencherDicionarioRecursivo(Arvore* no, char* dicionario[], char* caminhoAtual, int profundidade) {
-    if (no == NULL) {
-        return;
-    }
+int main(int argc, char *argv[]) {
+    ListaCaminhos caminhos = {NULL, 0, 0};
+    const char* nomeLista = NULL;
+    const char* nomeDicionario = NULL;
+    int tamanhoBlocoMB = HUFFMAN_TAMANHO_BLOCO_PADRAO >> 20;
+    int intervaloPontosKB = HUFFMAN_INTERVALO_PONTOS_PADRAO >> 10;
+    int comprimentoMax = 0;
+    int fluxos = 1;
+    int numThreads = 0;
+    int legado = 0;
+    int contexto = 0;
+    int crc = 0;
+    int direto = 0;
+    int estatisticas = 0;
 
-    if (ehFolha(no)) {
-        unsigned char c = caractereArvore(no);
-        caminhoAtual[profundidade] = '\0';
-        
-        // Só adiciona ao dicionário se o caractere existe no arquivo
-        // (evita adicionar o nó fictício)
-        if (profundidade > 0 || caminhoAtual[0] != '\0') {
-            dicionario[c] = strdup(caminhoAtual);
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-b") == 0 && i + 1 < argc) {
+            tamanhoBlocoMB = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-p") == 0 && i + 1 < argc) {
+            intervaloPontosKB = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-l") == 0 && i + 1 < argc) {
+            comprimentoMax = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-f") == 0 && i + 1 < argc) {
+            fluxos = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-c") == 0) {
+            contexto = 1;
+        } else if (strcmp(argv[i], "-D") == 0 && i + 1 < argc) {
+            nomeDicionario = argv[++i];
+        } else if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+            numThreads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--crc") == 0) {
+            crc = 1;
+        } else if (strcmp(argv[i], "--legado") == 0) {
+            legado = 1;
+        } else if (strcmp(argv[i], "--direto") == 0) {
+            direto = 1;
+        } else if (strcmp(argv[i], "--stats") == 0) {
+            estatisticas = ESTATISTICAS_TEXTO;
+        } else if (strcmp(argv[i], "--stats=json") == 0) {
+            estatisticas = ESTATISTICAS_JSON;
+        } else if (strcmp(argv[i], "-L") == 0 && i + 1 < argc && nomeLista == NULL) {
+            nomeLista = argv[++i];
+        } else if (argv[i][0] != '-' || strcmp(argv[i], "-") == 0) {
+            acrescentaCaminho(&caminhos, argv[i]);
+        } else {
+            caminhos.quantidade = 0;
+            nomeLista = NULL;
+            break;
         }
-        return;
     }
 
-    // Navega para a esquerda com '0'
-    caminhoAtual[profundidade] = '0';
-    preencherDicionarioRecursivo(getEsq(no), dicionario, caminhoAtual, profundidade + 1);
+    // O filtro ("-") só vale sozinho
+    int filtro = caminhos.quantidade == 1 && nomeLista == NULL && strcmp(caminhos.nomes[0], "-") == 0;
+    int usoValido = filtro || nomeLista != NULL || caminhos.quantidade > 0;
+    for (int i = 0; i < caminhos.quantidade && !filtro; i++) {
+        usoValido = usoValido && strcmp(caminhos.nomes[i], "-") != 0;
+    }
+    if (!usoValido || tamanhoBlocoMB < 1 || tamanhoBlocoMB > (int) TAMANHO_BLOCO_MAX_MB ||
+        intervaloPontosKB < 0 || intervaloPontosKB > (int) TAMANHO_BLOCO_MAX_MB * 1024 || numThreads < 0 ||
+        (fluxos != 1 && fluxos != HUFFMAN_FLUXOS_INTERCALADOS) ||
+        (comprimentoMax != 0 && (comprimentoMax < HUFFMAN_COMPRIMENTO_MIN || comprimentoMax > HUFFMAN_COMPRIMENTO_MAX))) {
+        printf("Uso: ./compacta [-b <MB por bloco, 1-%d>] [-p <KB entre pontos de acesso, 0 = nenhum>] "
+               "[-l <bits por código, %d-%d>] [-f <fluxos, 1 ou %d>] [-c] [-D <dicionario>] [-j <threads>]\n"
+               "           [--crc] [--legado] [--direto] [--stats[=json]] [-L <lista>]\n"
+               "           <arquivo_entrada | diretorio | ->...\n",
+               (int) TAMANHO_BLOCO_MAX_MB, HUFFMAN_COMPRIMENTO_MIN, HUFFMAN_COMPRIMENTO_MAX,
+               HUFFMAN_FLUXOS_INTERCALADOS);
+        liberaCaminhos(&caminhos);
+        return 1;
+    }
+
+    OpcoesHuffman opcoes;
+    opcoesPadraoHuffman(&opcoes);
+    opcoes.tamanhoBloco = (unsigned int) tamanhoBlocoMB << 20;
+    opcoes.intervaloPontos = (unsigned int) intervaloPontosKB << 10;
+    opcoes.comprimentoMax = comprimentoMax;
+    opcoes.fluxos = fluxos;
+    opcoes.legado = legado;
+    opcoes.contexto = contexto;
+    opcoes.crc = crc;
+    opcoes.direto = direto;
 
-    // Navega para a direita com '1'
-    caminhoAtual[profundidade] = '1';
-    preencherDicionarioRecursivo(getDir(no), dicionario, caminhoAtual, profundidade + 1);
-}
-/**
- * @brief Serializa a árvore em pré-ordem no bitmap.
- * @details Protocolo: 1 bit = 1 para folha + 8 bits do caractere; 0 para nó interno.
- * @param raiz Raiz da árvore.
- * @param bm Bitmap de saída.
- */
+    // Como filtro, a saída padrão recebe os dados
+    FILE* mensagens = filtro ? stderr : stdout;
+    if (filtro && legado) {
+        fprintf(mensagens, "Erro: o formato antigo precisa do arquivo inteiro e não funciona como filtro\n");
+        exit(1);
+    }
+    if (nomeDicionario && legado) {
+        fprintf(mensagens, "Erro: o formato antigo não usa dicionário\n");
+        exit(1);
+    }
+    if (contexto && legado) {
+        fprintf(mensagens, "Erro: o formato antigo não usa contexto\n");
+        exit(1);
+    }
+    if (crc && legado) {
+        fprintf(mensagens, "Erro: o formato antigo não tem CRC\n");
+        exit(1);
+    }
 
-void serializarArvore(Arvore* raiz, bitmap* bm) {
-    if (raiz == NULL) {
-        return;
+    if (nomeLista && leListaCaminhos(&caminhos, nomeLista) < 0) {
+        fprintf(mensagens, "Erro: lista %s: %s\n", nomeLista, strerror(errno));
+        exit(1);
     }
+    double inicio = agora();
+    if (nomeLista || caminhos.quantidade > 1 || ehDiretorio(caminhos.nomes[0])) {
+        return compactaEmLote(&caminhos, &opcoes, nomeDicionario, numThreads, estatisticas, inicio);
+    }
+    const char* nomeArquivo = caminhos.nomes[0];
 
-    if (ehFolha(raiz)) {
-        // Bit 1 indica folha
-        bitmapAppendLeastSignificantBit(bm, 1);
-        
-        // Escreve o caractere (8 bits)
-        unsigned char c = caractereArvore(raiz);
-        for (int i = 7; i >= 0; i--) {
-            unsigned char bit = (c >> i) & 1;
-            bitmapAppendLeastSignificantBit(bm, bit);
-        }
-    } else {
-        // Bit 0 indica nó interno
-        bitmapAppendLeastSignificantBit(bm, 0);
-        serializarArvore(getEsq(raiz), bm);
-        serializarArvore(getDir(raiz), bm);
+    // O formato antigo é um único fluxo; não há blocos para distribuir entre threads
+    ContextoCompactacao* ctx = criaContextoCompactacao(legado ? 1 : numThreads);
+    if (ctx == NULL) {
+        fprintf(mensagens, "Erro de alocacao de memoria.\n");
+        exit(1);
     }
-}
-/**
- * @brief Gera o arquivo .comp: cabeçalho + árvore serializada + dados codificados.
- * @param nomeArquivoEntrada Caminho do arquivo original.
- * @param nomeArquivoSaida Caminho do arquivo de saída (.comp).
- * @param raiz Árvore de Huffman.
- * @param dicionario Tabela de códigos por byte.
- * @param frequencias Frequências por byte (para estimar tamanho e estatísticas).
- * @details Cabeçalho: [4 bytes: tamArvoreBits] [1 byte: bitsVálidosÚltimoByteDados].
- */
+    defineOpcoesCompactacao(ctx, &opcoes);
+    ativaEstatisticasCompactacao(ctx, estatisticas != 0);
 
-void compactarArquivo(const char* nomeArquivoEntrada, const char* nomeArquivoSaida, 
-                     Arvore* raiz, char* dicionario[], unsigned long long int* frequencias) {
-    
-    // 1. Serializar a árvore
-    bitmap* bitmapArvore = bitmapInit(256 * 9 + 256);  // Máximo: 256 folhas * 9 bits + nós internos
-    serializarArvore(raiz, bitmapArvore);
-    
-    // 2. Calcular tamanho necessário para os dados comprimidos
-    unsigned long long int tamanhoComprimidoBits = 0;
-    for (int i = 0; i < 256; i++) {
-        if (frequencias[i] > 0 && dicionario[i] != NULL) {
-            tamanhoComprimidoBits += frequencias[i] * strlen(dicionario[i]);
+    DicionarioHuffman* dicionario = NULL;
+    if (nomeDicionario) {
+        int codigo = carregaDicionarioArquivo(nomeDicionario, &dicionario);
+        if (codigo != HUFFMAN_OK) {
+            fprintf(mensagens, "Erro: dicionário %s: %s\n", nomeDicionario, mensagemErroHuffman(codigo));
+            exit(1);
         }
+        defineDicionarioCompactacao(ctx, dicionario);
     }
-    
-    // 3. Criar bitmap para os dados codificados
-    bitmap* bitmapDados = bitmapInit(tamanhoComprimidoBits + 8);
-    
-    // 4. Codificar o arquivo
-    FILE* arquivoEntrada = fopen(nomeArquivoEntrada, "rb");
-    if (!arquivoEntrada) {
-        perror("Erro ao reabrir arquivo de entrada");
+
+    char nomeArquivoSaida[1024];
+    snprintf(nomeArquivoSaida, sizeof(nomeArquivoSaida), "%s.comp", nomeArquivo);
+
+    ResultadoHuffman resultado;
+    int codigo = filtro ? compactaFluxoArquivo(ctx, stdin, stdout, &resultado) :
+                          compactaArquivo(ctx, nomeArquivo, nomeArquivoSaida, &resultado);
+    if (codigo == HUFFMAN_ERRO_ENTRADA || codigo == HUFFMAN_ERRO_SAIDA) {
+        fprintf(mensagens, "Erro: %s: %s\n", mensagemErroHuffman(codigo), strerror(errno));
         exit(1);
     }
-    
-    unsigned char byte;
-    while (fread(&byte, sizeof(unsigned char), 1, arquivoEntrada) == 1) {
-        char* codigo = dicionario[byte];
-        if (codigo != NULL) {
-            for (int i = 0; codigo[i] != '\0'; i++) {
-                bitmapAppendLeastSignificantBit(bitmapDados, codigo[i] - '0');
-            }
-        }
-    }
-    fclose(arquivoEntrada);
-    
-    // 5. Escrever arquivo compactado
-    FILE* arquivoSaida = fopen(nomeArquivoSaida, "wb");
-    if (!arquivoSaida) {
-        perror("Erro ao criar arquivo de saída");
+    if (codigo != HUFFMAN_OK) {
+        fprintf(mensagens, "Erro: %s\n", mensagemErroHuffman(codigo));
         exit(1);
     }
-    
-    // Escrever cabeçalho
-    unsigned int tamanhoArvore = bitmapGetLength(bitmapArvore);
-    unsigned int tamanhoDados = bitmapGetLength(bitmapDados);
-    
-    fwrite(&tamanhoArvore, sizeof(unsigned int), 1, arquivoSaida);
-    
-    // Escreve número de bits válidos no último byte dos dados
-    unsigned char bitsUltimoByte = tamanhoDados % 8;
-    if (bitsUltimoByte == 0) bitsUltimoByte = 8;
-    fwrite(&bitsUltimoByte, sizeof(unsigned char), 1, arquivoSaida);
-    
-    // Escreve a árvore serializada
-    unsigned int bytesArvore = (tamanhoArvore + 7) / 8;
-    fwrite(bitmapGetContents(bitmapArvore), sizeof(unsigned char), bytesArvore, arquivoSaida);
-    
-    // Escreve os dados codificados
-    unsigned int bytesDados = (tamanhoDados + 7) / 8;
-    fwrite(bitmapGetContents(bitmapDados), sizeof(unsigned char), bytesDados, arquivoSaida);
-    
-    fclose(arquivoSaida);
-    
-    // Calcular taxa de compressão
-    unsigned long long int tamanhoOriginal = 0;
-    for (int i = 0; i < 256; i++) {
-        tamanhoOriginal += frequencias[i];
+    EstatisticasHuffman medicoes;
+    estatisticasCompactacao(ctx, &medicoes);
+    liberaContextoCompactacao(ctx);
+    liberaDicionarioHuffman(dicionario);
+    if (estatisticas == ESTATISTICAS_JSON) {
+        escreveEstatisticas(mensagens, estatisticas, &resultado, NULL, &medicoes, agora() - inicio);
+        liberaCaminhos(&caminhos);
+        return 0;
+    }
+
+    double taxaCompressao = resultado.tamanhoOriginal > resultado.tamanhoCompactado ?
+        ((double)(resultado.tamanhoOriginal - resultado.tamanhoCompactado) / resultado.tamanhoOriginal) * 100 : 0;
+
+    fprintf(mensagens, "Tamanho original: %llu bytes\n", resultado.tamanhoOriginal);
+    fprintf(mensagens, "Tamanho comprimido: %llu bytes\n", resultado.tamanhoCompactado);
+    fprintf(mensagens, "Taxa de compressão: %.2f%%\n", taxaCompressao);
+    if (estatisticas) {
+        escreveEstatisticas(mensagens, estatisticas, &resultado, NULL, &medicoes, agora() - inicio);
     }
-    
-    unsigned long long int tamanhoComprimido = 5 + bytesArvore + bytesDados;  // 5 = cabeçalho
-    double taxaCompressao = ((double)(tamanhoOriginal - tamanhoComprimido) / tamanhoOriginal) * 100;
-    
-    printf("Tamanho original: %llu bytes\n", tamanhoOriginal);
-    printf("Tamanho comprimido: %llu bytes\n", tamanhoComprimido);
-    printf("Taxa de compressão: %.2f%%\n", taxaCompressao > 0 ? taxaCompressao : 0);
-    
-    // Liberar bitmaps
-    bitmapLibera(bitmapArvore);
-    bitmapLibera(bitmapDados);
-}
\ No newline at end of file
+    liberaCaminhos(&caminhos);
+
+    return 0;
+}
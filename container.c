@@ -0,0 +1,459 @@
+#define _FILE_OFFSET_BITS 64
+#include "container.h"
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+
+void escreveU16(unsigned char* p, unsigned int valor) {
+    p[0] = (unsigned char) valor;
+    p[1] = (unsigned char) (valor >> 8);
+}
+
+void escreveU32(unsigned char* p, unsigned int valor) {
+    for (int i = 0; i < 4; i++) {
+        p[i] = (unsigned char) (valor >> (8 * i));
+    }
+}
+
+void escreveU64(unsigned char* p, unsigned long long int valor) {
+    for (int i = 0; i < 8; i++) {
+        p[i] = (unsigned char) (valor >> (8 * i));
+    }
+}
+
+unsigned int leU16(const unsigned char* p) {
+    return p[0] | ((unsigned int) p[1] << 8);
+}
+
+unsigned int leU32(const unsigned char* p) {
+    unsigned int valor = 0;
+    for (int i = 3; i >= 0; i--) {
+        valor = (valor << 8) | p[i];
+    }
+    return valor;
+}
+
+unsigned long long int leU64(const unsigned char* p) {
+    unsigned long long int valor = 0;
+    for (int i = 7; i >= 0; i--) {
+        valor = (valor << 8) | p[i];
+    }
+    return valor;
+}
+
+/**
+ * @brief Verifica se os primeiros bytes de um arquivo identificam o formato em blocos.
+ * @param inicio Primeiros 4 bytes do arquivo.
+ * @return 1 se for o formato em blocos; 0 se for o formato antigo.
+ */
+int ehContainer(const unsigned char* inicio) {
+    return memcmp(inicio, MAGICO_CONTAINER, 4) == 0;
+}
+
+/**
+ * @brief Grava o cabeçalho do arquivo em @p p (TAMANHO_CABECALHO_CONTAINER bytes).
+ */
+void codificaCabecalhoContainer(unsigned char* p, unsigned int tamanhoBloco) {
+    memcpy(p, MAGICO_CONTAINER, 4);
+    p[4] = VERSAO_CONTAINER;
+    escreveU32(p + 5, tamanhoBloco);
+}
+
+/**
+ * @brief Interpreta o cabeçalho do arquivo.
+ * @param p TAMANHO_CABECALHO_CONTAINER bytes lidos do início do arquivo.
+ * @param tamanhoBloco Recebe o tamanho nominal dos blocos.
+ * @return 0 se válido; -1 se o número mágico ou a versão não forem reconhecidos.
+ */
+int decodificaCabecalhoContainer(const unsigned char* p, unsigned int* tamanhoBloco) {
+    if (!ehContainer(p) || p[4] != VERSAO_CONTAINER) {
+        return -1;
+    }
+    *tamanhoBloco = leU32(p + 5);
+    return 0;
+}
+
+/**
+ * @brief Grava o cabeçalho de bloco em @p p (TAMANHO_CABECALHO_BLOCO bytes; 1 byte para BLOCO_FIM).
+ * @return Quantidade de bytes gravados.
+ */
+int codificaCabecalhoBloco(unsigned char* p, const CabecalhoBloco* c) {
+    if (c->tipo == BLOCO_FIM) {
+        p[0] = BLOCO_FIM;
+        return 1;
+    }
+    p[0] = c->tipo | (c->fluxos == FLUXOS_INTERCALADOS ? BLOCO_QUATRO_FLUXOS : 0) | (c->crc ? BLOCO_COM_CRC : 0);
+    escreveU32(p + 1, c->tamanhoOriginal);
+    escreveU16(p + 5, c->tamanhoArvore);
+    escreveU64(p + 7, c->bitsDados);
+    return TAMANHO_CABECALHO_BLOCO;
+}
+
+/**
+ * @brief Interpreta um cabeçalho de bloco (exceto o BLOCO_FIM, que só tem o byte de tipo).
+ * @param p TAMANHO_CABECALHO_BLOCO bytes.
+ * @param c Cabeçalho de saída.
+ */
+void decodificaCabecalhoBloco(const unsigned char* p, CabecalhoBloco* c) {
+    c->tipo = p[0] & ~(BLOCO_QUATRO_FLUXOS | BLOCO_COM_CRC);
+    c->fluxos = p[0] & BLOCO_QUATRO_FLUXOS ? FLUXOS_INTERCALADOS : 1;
+    c->crc = (p[0] & BLOCO_COM_CRC) != 0;
+    c->tamanhoOriginal = leU32(p + 1);
+    c->tamanhoArvore = leU16(p + 5);
+    c->bitsDados = leU64(p + 7);
+}
+
+/**
+ * @brief Grava @p valor como varint em @p p.
+ * @return Quantidade de bytes gravados.
+ */
+static int escreveVarint(unsigned char* p, unsigned long long int valor) {
+    int n = 0;
+    while (valor >= 0x80) {
+        p[n++] = (unsigned char) (valor | 0x80);
+        valor >>= 7;
+    }
+    p[n++] = (unsigned char) valor;
+    return n;
+}
+
+/**
+ * @brief Lê um varint de até @p maxBits bits de p[*pos, n).
+ * @return 1 se lido (*pos avança); 0 se faltarem bytes; -1 se passar de @p maxBits bits.
+ */
+static int leVarint(const unsigned char* p, size_t n, size_t* pos, int maxBits, unsigned long long int* valor) {
+    unsigned long long int v = 0;
+    for (size_t k = 0; *pos + k < n; k++) {
+        int deslocamento = 7 * (int) k;
+        unsigned long long int parte = p[*pos + k] & 0x7F;
+        // O último byte só pode trazer os bits que faltam para maxBits
+        if (deslocamento >= maxBits || (maxBits - deslocamento < 7 && parte >> (maxBits - deslocamento) != 0)) {
+            return -1;
+        }
+        v |= parte << deslocamento;
+        if (!(p[*pos + k] & 0x80)) {
+            *pos += k + 1;
+            *valor = v;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Verifica se os primeiros bytes identificam um quadro único.
+ * @param inicio Primeiros bytes da entrada.
+ * @param n Quantidade de bytes disponíveis em @p inicio.
+ * @return 1 se for um quadro único; 0 caso contrário.
+ */
+int ehQuadroUnico(const unsigned char* inicio, size_t n) {
+    return n >= TAMANHO_MAGICO_QUADRO && memcmp(inicio, MAGICO_QUADRO, TAMANHO_MAGICO_QUADRO) == 0;
+}
+
+/**
+ * @brief Grava o cabeçalho do quadro único em @p p (até TAMANHO_MAX_CABECALHO_QUADRO bytes); com o tipo
+ *        BLOCO_FIM, o quadro de uma entrada vazia.
+ * @return Quantidade de bytes gravados.
+ */
+int codificaCabecalhoQuadro(unsigned char* p, const CabecalhoBloco* c) {
+    unsigned char cabecalho[TAMANHO_CABECALHO_BLOCO];
+    codificaCabecalhoBloco(cabecalho, c);
+    memcpy(p, MAGICO_QUADRO, TAMANHO_MAGICO_QUADRO);
+    p[TAMANHO_MAGICO_QUADRO] = cabecalho[0];
+    int n = TAMANHO_MAGICO_QUADRO + 1;
+    if (c->tipo == BLOCO_FIM) {
+        return n;
+    }
+    n += escreveVarint(p + n, c->tamanhoOriginal);
+    n += escreveVarint(p + n, c->tamanhoArvore);
+    n += escreveVarint(p + n, c->bitsDados);
+    return n;
+}
+
+/**
+ * @brief Interpreta o cabeçalho de um quadro único, que pode ainda estar incompleto.
+ * @param p Bytes do quadro, a partir do número mágico.
+ * @param n Quantidade de bytes disponíveis em @p p.
+ * @param c Cabeçalho de saída (tipo BLOCO_FIM para uma entrada vazia).
+ * @return Bytes do cabeçalho; 0 se faltarem bytes; -1 se for inválido.
+ */
+int decodificaCabecalhoQuadro(const unsigned char* p, size_t n, CabecalhoBloco* c) {
+    if (n < TAMANHO_MAGICO_QUADRO + 1) {
+        return 0;
+    }
+    if (!ehQuadroUnico(p, n)) {
+        return -1;
+    }
+    unsigned char cabecalho[TAMANHO_CABECALHO_BLOCO] = {p[TAMANHO_MAGICO_QUADRO]};
+    decodificaCabecalhoBloco(cabecalho, c);
+    size_t pos = TAMANHO_MAGICO_QUADRO + 1;
+    if (c->tipo == BLOCO_FIM) {
+        return cabecalho[0] == BLOCO_FIM ? (int) pos : -1;
+    }
+    unsigned long long int tamanhoOriginal, tamanhoArvore;
+    int lido;
+    if ((lido = leVarint(p, n, &pos, 32, &tamanhoOriginal)) <= 0 ||
+        (lido = leVarint(p, n, &pos, 16, &tamanhoArvore)) <= 0 ||
+        (lido = leVarint(p, n, &pos, 64, &c->bitsDados)) <= 0) {
+        return lido;
+    }
+    c->tamanhoOriginal = (unsigned int) tamanhoOriginal;
+    c->tamanhoArvore = (unsigned int) tamanhoArvore;
+    return (int) pos;
+}
+
+/**
+ * @brief Bytes que seguem o cabeçalho do bloco (árvore + dados + CRC, se houver).
+ */
+unsigned long long int tamanhoCorpoBloco(const CabecalhoBloco* c) {
+    return tamanhoCodificadoBloco(c) + (c->crc ? TAMANHO_CRC_BLOCO : 0);
+}
+
+/**
+ * @brief Bytes da árvore e dos dados do bloco (o corpo sem o CRC).
+ */
+unsigned long long int tamanhoCodificadoBloco(const CabecalhoBloco* c) {
+    return (c->tamanhoArvore + 7) / 8 + (c->bitsDados + 7) / 8;
+}
+
+/**
+ * @brief Quantidade de pontos de acesso de um bloco com @p tamanhoOriginal bytes.
+ * @param intervaloPontos Bytes originais entre pontos (0 = sem pontos).
+ */
+unsigned int numPontosBloco(unsigned int tamanhoOriginal, unsigned int intervaloPontos) {
+    if (intervaloPontos == 0 || tamanhoOriginal == 0) {
+        return 0;
+    }
+    return (tamanhoOriginal - 1) / intervaloPontos;
+}
+
+/**
+ * @brief Acrescenta um bloco ao índice em construção.
+ * @param indice Índice (iniciar zerado, com intervaloPontos definido).
+ * @param numPontos 0 ou numPontosBloco(tamanhoOriginal, indice->intervaloPontos).
+ * @param pontos Os @p numPontos pontos de acesso do bloco, ou NULL para preenchê-los depois em
+ *               indice->pontos.
+ * @return 0 em sucesso; -1 em falta de memória.
+ */
+int acrescentaIndice(IndiceBlocos* indice, unsigned long long int offset, unsigned long long int bitsDados,
+                     unsigned int tamanhoOriginal, unsigned int numPontos, const unsigned long long int* pontos) {
+    if (indice->numBlocos == indice->capacidade) {
+        unsigned long long int nova = indice->capacidade ? 2 * indice->capacidade : 64;
+        EntradaIndice* e = (EntradaIndice*) realloc(indice->entradas, nova * sizeof(EntradaIndice));
+        if (e == NULL) {
+            return -1;
+        }
+        indice->entradas = e;
+        indice->capacidade = nova;
+    }
+    if (indice->numPontos + numPontos > indice->capacidadePontos) {
+        unsigned long long int nova = indice->capacidadePontos ? 2 * indice->capacidadePontos : 1024;
+        while (nova < indice->numPontos + numPontos) {
+            nova *= 2;
+        }
+        unsigned long long int* p = (unsigned long long int*) realloc(indice->pontos,
+                                                                      nova * sizeof(unsigned long long int));
+        if (p == NULL) {
+            return -1;
+        }
+        indice->pontos = p;
+        indice->capacidadePontos = nova;
+    }
+    EntradaIndice* e = &indice->entradas[indice->numBlocos];
+    e->offset = offset;
+    e->bitsDados = bitsDados;
+    e->tamanhoOriginal = tamanhoOriginal;
+    e->offsetOriginal = indice->numBlocos == 0 ? 0 :
+        e[-1].offsetOriginal + e[-1].tamanhoOriginal;
+    e->numPontos = numPontos;
+    e->primeiroPonto = indice->numPontos;
+    if (numPontos > 0 && pontos != NULL) {
+        memcpy(indice->pontos + indice->numPontos, pontos, numPontos * sizeof(unsigned long long int));
+    }
+    indice->numPontos += numPontos;
+    indice->numBlocos++;
+    return 0;
+}
+
+/**
+ * @brief Bytes que o índice ocupa no arquivo, incluindo o rodapé.
+ */
+unsigned long long int tamanhoIndice(const IndiceBlocos* indice) {
+    return TAMANHO_CABECALHO_INDICE + indice->numBlocos * TAMANHO_ENTRADA_INDICE + indice->numPontos * 8 +
+           TAMANHO_RODAPE_INDICE;
+}
+
+/**
+ * @brief Localiza o bloco que contém o byte @p posicao da saída.
+ * @param indice Índice completo.
+ * @param posicao Posição nos dados originais.
+ * @return Índice da entrada ou -1 se @p posicao estiver além do fim.
+ */
+long long int buscaBlocoIndice(const IndiceBlocos* indice, unsigned long long int posicao) {
+    // Busca binária pelo último bloco que começa em ou antes de posicao
+    unsigned long long int ini = 0, fim = indice->numBlocos;
+    while (ini < fim) {
+        unsigned long long int meio = ini + (fim - ini) / 2;
+        if (indice->entradas[meio].offsetOriginal <= posicao) {
+            ini = meio + 1;
+        } else {
+            fim = meio;
+        }
+    }
+    if (ini == 0) {
+        return -1;
+    }
+    const EntradaIndice* e = &indice->entradas[ini - 1];
+    if (posicao >= e->offsetOriginal + e->tamanhoOriginal) {
+        return -1;
+    }
+    return (long long int) (ini - 1);
+}
+
+/**
+ * @brief Codifica o índice e o rodapé em memória.
+ * @param indice Índice completo.
+ * @param p Buffer com ao menos tamanhoIndice(indice) bytes.
+ * @param offsetIndice Posição do índice no arquivo (logo após o terminador).
+ */
+void codificaIndice(const IndiceBlocos* indice, unsigned char* p, unsigned long long int offsetIndice) {
+    escreveU64(p, indice->numBlocos);
+    escreveU32(p + 8, indice->intervaloPontos);
+    p += TAMANHO_CABECALHO_INDICE;
+    for (unsigned long long int i = 0; i < indice->numBlocos; i++) {
+        const EntradaIndice* e = &indice->entradas[i];
+        escreveU64(p, e->offset);
+        escreveU64(p + 8, e->bitsDados);
+        escreveU32(p + 16, e->tamanhoOriginal);
+        escreveU32(p + 20, e->numPontos);
+        p += TAMANHO_ENTRADA_INDICE;
+        for (unsigned int k = 0; k < e->numPontos; k++) {
+            escreveU64(p, indice->pontos[e->primeiroPonto + k]);
+            p += 8;
+        }
+    }
+    escreveU64(p, offsetIndice);
+    memcpy(p + 8, MAGICO_INDICE, 4);
+}
+
+/**
+ * @brief Grava o índice e o rodapé em @p saida.
+ * @param indice Índice completo.
+ * @param saida Arquivo posicionado logo após o terminador.
+ * @param offsetIndice Posição atual de @p saida.
+ * @return 0 em sucesso; -1 em erro de escrita ou falta de memória.
+ */
+int gravaIndice(const IndiceBlocos* indice, FILE* saida, unsigned long long int offsetIndice) {
+    unsigned long long int tamanho = tamanhoIndice(indice);
+    unsigned char* bytes = (unsigned char*) malloc(tamanho);
+    if (bytes == NULL) {
+        return -1;
+    }
+    codificaIndice(indice, bytes, offsetIndice);
+    int resultado = fwrite(bytes, 1, tamanho, saida) == tamanho ? 0 : -1;
+    free(bytes);
+    return resultado;
+}
+
+/**
+ * @brief Interpreta o índice lido para a memória, validando offsets e pontos de acesso.
+ * @return 0 em sucesso; -1 se for inconsistente ou faltar memória.
+ */
+static int interpretaIndice(const unsigned char* p, unsigned long long int tamanho,
+                            unsigned long long int offsetIndice, IndiceBlocos* indice) {
+    if (tamanho < TAMANHO_CABECALHO_INDICE) {
+        return -1;
+    }
+    unsigned long long int numBlocos = leU64(p);
+    indice->intervaloPontos = leU32(p + 8);
+    indice->offsetIndice = offsetIndice;
+    unsigned long long int pos = TAMANHO_CABECALHO_INDICE;
+    if (numBlocos > (tamanho - pos) / TAMANHO_ENTRADA_INDICE) {
+        return -1;
+    }
+
+    for (unsigned long long int i = 0; i < numBlocos; i++) {
+        if (tamanho - pos < TAMANHO_ENTRADA_INDICE) {
+            return -1;
+        }
+        const unsigned char* e = p + pos;
+        unsigned long long int bitsDados = leU64(e + 8);
+        unsigned int tamanhoOriginal = leU32(e + 16);
+        unsigned int numPontos = leU32(e + 20);
+        pos += TAMANHO_ENTRADA_INDICE;
+        if (leU64(e) >= offsetIndice || (tamanho - pos) / 8 < numPontos ||
+            (numPontos != 0 && numPontos != numPontosBloco(tamanhoOriginal, indice->intervaloPontos))) {
+            return -1;
+        }
+
+        // Os pontos são lidos direto do buffer; basta validar que crescem dentro dos dados do bloco
+        const unsigned char* pontos = p + pos;
+        unsigned long long int anterior = 0;
+        for (unsigned int k = 0; k < numPontos; k++) {
+            unsigned long long int ponto = leU64(pontos + 8 * k);
+            if (ponto < anterior || ponto > bitsDados) {
+                return -1;
+            }
+            anterior = ponto;
+        }
+        if (acrescentaIndice(indice, leU64(e), bitsDados, tamanhoOriginal, numPontos, NULL) < 0) {
+            return -1;
+        }
+        for (unsigned int k = 0; k < numPontos; k++) {
+            indice->pontos[indice->entradas[i].primeiroPonto + k] = leU64(pontos + 8 * k);
+        }
+        pos += 8ULL * numPontos;
+    }
+    return pos == tamanho ? 0 : -1;
+}
+
+/**
+ * @brief Lê o índice do fim de um arquivo no formato em blocos.
+ * @param entrada Arquivo aberto e posicionável; a posição é alterada.
+ * @param indice Recebe o índice (liberar com liberaIndice).
+ * @return 0 em sucesso; -1 se o arquivo não tiver índice ou ele for inconsistente.
+ */
+int leIndice(FILE* entrada, IndiceBlocos* indice) {
+    unsigned char bytes[TAMANHO_ENTRADA_INDICE];
+    memset(indice, 0, sizeof(IndiceBlocos));
+
+    if (fseeko(entrada, 0, SEEK_END) != 0) {
+        return -1;
+    }
+    off_t tamanhoArquivo = ftello(entrada);
+    if (tamanhoArquivo < TAMANHO_CABECALHO_CONTAINER + 1 + TAMANHO_CABECALHO_INDICE + TAMANHO_RODAPE_INDICE ||
+        fseeko(entrada, tamanhoArquivo - TAMANHO_RODAPE_INDICE, SEEK_SET) != 0 ||
+        fread(bytes, 1, TAMANHO_RODAPE_INDICE, entrada) != TAMANHO_RODAPE_INDICE ||
+        memcmp(bytes + 8, MAGICO_INDICE, 4) != 0) {
+        return -1;
+    }
+
+    unsigned long long int offsetIndice = leU64(bytes);
+    if (offsetIndice > (unsigned long long int) tamanhoArquivo - TAMANHO_RODAPE_INDICE - TAMANHO_CABECALHO_INDICE ||
+        fseeko(entrada, (off_t) offsetIndice, SEEK_SET) != 0) {
+        return -1;
+    }
+    unsigned long long int tamanho = (unsigned long long int) tamanhoArquivo - TAMANHO_RODAPE_INDICE - offsetIndice;
+    unsigned char* conteudo = (unsigned char*) malloc(tamanho);
+    if (conteudo == NULL) {
+        return -1;
+    }
+    int resultado = -1;
+    if (fread(conteudo, 1, tamanho, entrada) == tamanho) {
+        resultado = interpretaIndice(conteudo, tamanho, offsetIndice, indice);
+    }
+    free(conteudo);
+    if (resultado < 0) {
+        liberaIndice(indice);
+    }
+    return resultado;
+}
+
+/**
+ * @brief Libera as entradas e os pontos do índice.
+ */
+void liberaIndice(IndiceBlocos* indice) {
+    free(indice->entradas);
+    free(indice->pontos);
+    memset(indice, 0, sizeof(IndiceBlocos));
+}
@@ -0,0 +1,251 @@
+#ifndef CONTAINER_H
+#define CONTAINER_H
+
+#include <stddef.h>
+#include <stdio.h>
+
+/**
+ * @file container.h
+ * @brief Formato .comp em blocos (versão 3).
+ * @details Layout (inteiros little-endian):
+ *          [4 bytes: "HUFB"] [1 byte: versão] [4 bytes: tamanho do bloco]
+ *          blocos: [1 byte: tipo] [4 bytes: tamOriginal] [2 bytes: tamArvoreBits] [8 bytes: bitsDados]
+ *                  [árvore serializada] [dados codificados]
+ *          terminador: [1 byte: BLOCO_FIM]
+ *          índice: [8 bytes: numBlocos] [4 bytes: intervaloPontos]
+ *                  numBlocos * ([8 bytes: offset] [8 bytes: bitsDados] [4 bytes: tamOriginal]
+ *                               [4 bytes: numPontos] numPontos * [8 bytes: bit do ponto])
+ *                  [8 bytes: offset do índice] [4 bytes: "HUFI"]
+ *          O índice, no fim do arquivo, localiza cada bloco (offset do seu cabeçalho) e sua posição na
+ *          saída (soma dos tamanhos originais anteriores); leitores sequenciais param no terminador.
+ *          Os pontos de acesso de um bloco dão, para cada múltiplo k * intervaloPontos (k >= 1) dos
+ *          bytes originais do bloco, o bit dos dados codificados em que começa o código daquele byte;
+ *          numPontos é (tamOriginal - 1) / intervaloPontos (nenhum se intervaloPontos for 0) nos blocos
+ *          de um único fluxo de código (HUFFMAN, CANONICO e DICIONARIO) e 0 nos demais, que a extração
+ *          lê desde o início do bloco.
+ *          Cada bloco é independente e traz a descrição do próprio código: a árvore no formato de
+ *          serializarArvore (BLOCO_HUFFMAN) ou os comprimentos de códigos canônicos no formato de
+ *          serializarComprimentos (BLOCO_CANONICO); tamArvoreBits é o tamanho dessa descrição.
+ *          Um BLOCO_DICIONARIO usa códigos pré-treinados (dicionario.h) e traz no lugar da descrição
+ *          apenas o id do dicionário, em 4 bytes. Blocos que não compensam codificar são guardados
+ *          sem código: BLOCO_ARMAZENADO traz os bytes originais como dados (tamArvoreBits 0,
+ *          bitsDados = 8 * tamOriginal) e BLOCO_REPETIDO, de um único byte repetido, traz só esse
+ *          byte como descrição (tamArvoreBits 8, bitsDados 0). Um BLOCO_CORRIDAS tira do código as
+ *          corridas longas de um mesmo byte: a descrição são os comprimentos canônicos só dos literais
+ *          (tamArvoreBits 0 se não houver literais) e os dados começam, alinhados a byte, pela tabela
+ *          [4 bytes: numCorridas] numCorridas * ([4 bytes: literais antes] [4 bytes: comprimento]
+ *          [1 byte: valor]), seguida dos códigos dos literais; bitsDados inclui a tabela.
+ *          Um BLOCO_CONTEXTO (modelo de ordem 1) codifica cada byte com a tabela do byte anterior (0
+ *          para o primeiro): a descrição é o modelo no formato de serializarModeloContexto
+ *          (contexto.h) e os dados, um único fluxo.
+ *          Com o bit BLOCO_QUATRO_FLUXOS no byte de tipo, um bloco com código (HUFFMAN, CANONICO ou
+ *          DICIONARIO) divide os bytes em quatro quartos contíguos de (tamOriginal + 3) / 4 bytes (o
+ *          último pode ser menor ou vazio), cada um com um fluxo de bits próprio, iniciado em byte. Os
+ *          dados começam pela tabela de saltos [8 bytes: bits do fluxo] * 3 (o tamanho do quarto fluxo é
+ *          o que sobra de bitsDados); assim os quatro fluxos podem ser decodificados ao mesmo tempo.
+ *          Com o bit BLOCO_COM_CRC no byte de tipo, o corpo do bloco termina com [4 bytes: CRC32C dos
+ *          bytes originais] (crc.h), contado em tamanhoCorpoBloco mas não em bitsDados.
+ *          Uma entrada que cabe em um único bloco pode ser gravada no quadro único, sem cabeçalho do
+ *          arquivo, terminador nem índice:
+ *          [2 bytes: "Hq"] [1 byte: tipo] [varint: tamOriginal] [varint: tamArvoreBits]
+ *          [varint: bitsDados] [corpo do bloco, como acima]
+ *          (varint: 7 bits por byte, os menos significativos primeiro, bit 0x80 = há mais bytes). Uma
+ *          entrada vazia é só [2 bytes: "Hq"] [1 byte: BLOCO_FIM]. O quadro não tem pontos de acesso.
+ *          O formato antigo começa com o tamanho da árvore em 4 bytes (no máximo 2816), que nunca
+ *          coincide com nenhum dos números mágicos.
+ */
+
+#define MAGICO_CONTAINER "HUFB"
+#define VERSAO_CONTAINER 3
+#define TAMANHO_CABECALHO_CONTAINER 9
+#define TAMANHO_CABECALHO_BLOCO 15
+
+#define MAGICO_QUADRO "Hq"
+#define TAMANHO_MAGICO_QUADRO 2
+#define TAMANHO_MAX_CABECALHO_QUADRO 21   ///< número mágico, tipo e varints de 32, 16 e 64 bits
+
+#define MAGICO_INDICE "HUFI"
+#define TAMANHO_CABECALHO_INDICE 12
+#define TAMANHO_ENTRADA_INDICE 24
+#define TAMANHO_RODAPE_INDICE 12
+
+#define BLOCO_FIM 0
+#define BLOCO_HUFFMAN 1
+#define BLOCO_CANONICO 2
+#define BLOCO_DICIONARIO 3
+#define BLOCO_ARMAZENADO 4
+#define BLOCO_REPETIDO 5
+#define BLOCO_CORRIDAS 6
+#define BLOCO_CONTEXTO 7
+#define BLOCO_QUATRO_FLUXOS 0x80        ///< bit do byte de tipo: dados em FLUXOS_INTERCALADOS fluxos
+#define BLOCO_COM_CRC 0x40              ///< bit do byte de tipo: corpo terminado pelo CRC32C do original
+#define TAMANHO_CRC_BLOCO 4
+#define TAMANHO_ID_DICIONARIO_BITS 32
+#define TAMANHO_CORRIDA 9               ///< entrada da tabela de um BLOCO_CORRIDAS
+#define FLUXOS_INTERCALADOS 4
+#define TAMANHO_TABELA_FLUXOS 24        ///< tabela de saltos de um bloco em quatro fluxos
+
+typedef struct {
+    unsigned char tipo;                 ///< BLOCO_*, sem os bits BLOCO_QUATRO_FLUXOS e BLOCO_COM_CRC
+    unsigned char fluxos;               ///< fluxos de bits dos dados (1 ou FLUXOS_INTERCALADOS)
+    unsigned char crc;                  ///< 1 = corpo terminado pelo CRC32C (bit BLOCO_COM_CRC)
+    unsigned int tamanhoOriginal;       ///< bytes do bloco descompactado
+    unsigned int tamanhoArvore;         ///< bits da árvore serializada (ou dos comprimentos)
+    unsigned long long int bitsDados;   ///< bits dos dados codificados
+} CabecalhoBloco;
+
+typedef struct {
+    unsigned long long int offset;              ///< posição do cabeçalho do bloco no arquivo
+    unsigned long long int bitsDados;           ///< bits dos dados codificados
+    unsigned int tamanhoOriginal;               ///< bytes do bloco descompactado
+    unsigned long long int offsetOriginal;      ///< posição do bloco na saída (calculada na leitura)
+    unsigned int numPontos;                     ///< pontos de acesso do bloco (0 = ler desde o início)
+    unsigned long long int primeiroPonto;       ///< posição dos pontos do bloco em IndiceBlocos.pontos
+} EntradaIndice;
+
+typedef struct {
+    EntradaIndice* entradas;
+    unsigned long long int numBlocos;
+    unsigned long long int capacidade;
+    unsigned int intervaloPontos;               ///< bytes originais entre pontos de acesso (0 = sem pontos)
+    unsigned long long int* pontos;             ///< pontos de acesso de todos os blocos, em ordem
+    unsigned long long int numPontos;
+    unsigned long long int capacidadePontos;
+    unsigned long long int offsetIndice;        ///< posição do índice no arquivo, logo após o terminador (leIndice)
+} IndiceBlocos;
+
+void escreveU16(unsigned char* p, unsigned int valor);
+void escreveU32(unsigned char* p, unsigned int valor);
+void escreveU64(unsigned char* p, unsigned long long int valor);
+unsigned int leU16(const unsigned char* p);
+unsigned int leU32(const unsigned char* p);
+unsigned long long int leU64(const unsigned char* p);
+
+/**
+ * @brief Verifica se os primeiros bytes de um arquivo identificam o formato em blocos.
+ * @param inicio Primeiros 4 bytes do arquivo.
+ * @return 1 se for o formato em blocos; 0 se for o formato antigo.
+ */
+int ehContainer(const unsigned char* inicio);
+
+/**
+ * @brief Grava o cabeçalho do arquivo em @p p (TAMANHO_CABECALHO_CONTAINER bytes).
+ */
+void codificaCabecalhoContainer(unsigned char* p, unsigned int tamanhoBloco);
+
+/**
+ * @brief Interpreta o cabeçalho do arquivo.
+ * @param p TAMANHO_CABECALHO_CONTAINER bytes lidos do início do arquivo.
+ * @param tamanhoBloco Recebe o tamanho nominal dos blocos.
+ * @return 0 se válido; -1 se o número mágico ou a versão não forem reconhecidos.
+ */
+int decodificaCabecalhoContainer(const unsigned char* p, unsigned int* tamanhoBloco);
+
+/**
+ * @brief Grava o cabeçalho de bloco em @p p (TAMANHO_CABECALHO_BLOCO bytes; 1 byte para BLOCO_FIM).
+ * @return Quantidade de bytes gravados.
+ */
+int codificaCabecalhoBloco(unsigned char* p, const CabecalhoBloco* c);
+
+/**
+ * @brief Interpreta um cabeçalho de bloco (exceto o BLOCO_FIM, que só tem o byte de tipo).
+ * @param p TAMANHO_CABECALHO_BLOCO bytes.
+ * @param c Cabeçalho de saída.
+ */
+void decodificaCabecalhoBloco(const unsigned char* p, CabecalhoBloco* c);
+
+/**
+ * @brief Verifica se os primeiros bytes identificam um quadro único.
+ * @param inicio Primeiros bytes da entrada.
+ * @param n Quantidade de bytes disponíveis em @p inicio.
+ * @return 1 se for um quadro único; 0 caso contrário.
+ */
+int ehQuadroUnico(const unsigned char* inicio, size_t n);
+
+/**
+ * @brief Grava o cabeçalho do quadro único em @p p (até TAMANHO_MAX_CABECALHO_QUADRO bytes); com o tipo
+ *        BLOCO_FIM, o quadro de uma entrada vazia.
+ * @return Quantidade de bytes gravados.
+ */
+int codificaCabecalhoQuadro(unsigned char* p, const CabecalhoBloco* c);
+
+/**
+ * @brief Interpreta o cabeçalho de um quadro único, que pode ainda estar incompleto.
+ * @param p Bytes do quadro, a partir do número mágico.
+ * @param n Quantidade de bytes disponíveis em @p p.
+ * @param c Cabeçalho de saída (tipo BLOCO_FIM para uma entrada vazia).
+ * @return Bytes do cabeçalho; 0 se faltarem bytes; -1 se for inválido.
+ */
+int decodificaCabecalhoQuadro(const unsigned char* p, size_t n, CabecalhoBloco* c);
+
+/**
+ * @brief Bytes que seguem o cabeçalho do bloco (árvore + dados + CRC, se houver).
+ */
+unsigned long long int tamanhoCorpoBloco(const CabecalhoBloco* c);
+
+/**
+ * @brief Bytes da árvore e dos dados do bloco (o corpo sem o CRC).
+ */
+unsigned long long int tamanhoCodificadoBloco(const CabecalhoBloco* c);
+
+/**
+ * @brief Quantidade de pontos de acesso de um bloco com @p tamanhoOriginal bytes.
+ * @param intervaloPontos Bytes originais entre pontos (0 = sem pontos).
+ */
+unsigned int numPontosBloco(unsigned int tamanhoOriginal, unsigned int intervaloPontos);
+
+/**
+ * @brief Acrescenta um bloco ao índice em construção.
+ * @param indice Índice (iniciar zerado, com intervaloPontos definido).
+ * @param numPontos 0 ou numPontosBloco(tamanhoOriginal, indice->intervaloPontos).
+ * @param pontos Os @p numPontos pontos de acesso do bloco, ou NULL para preenchê-los depois em
+ *               indice->pontos.
+ * @return 0 em sucesso; -1 em falta de memória.
+ */
+int acrescentaIndice(IndiceBlocos* indice, unsigned long long int offset, unsigned long long int bitsDados,
+                     unsigned int tamanhoOriginal, unsigned int numPontos, const unsigned long long int* pontos);
+
+/**
+ * @brief Bytes que o índice ocupa no arquivo, incluindo o rodapé.
+ */
+unsigned long long int tamanhoIndice(const IndiceBlocos* indice);
+
+/**
+ * @brief Localiza o bloco que contém o byte @p posicao da saída.
+ * @param indice Índice completo.
+ * @param posicao Posição nos dados originais.
+ * @return Índice da entrada ou -1 se @p posicao estiver além do fim.
+ */
+long long int buscaBlocoIndice(const IndiceBlocos* indice, unsigned long long int posicao);
+
+/**
+ * @brief Codifica o índice e o rodapé em memória.
+ * @param indice Índice completo.
+ * @param p Buffer com ao menos tamanhoIndice(indice) bytes.
+ * @param offsetIndice Posição do índice no arquivo (logo após o terminador).
+ */
+void codificaIndice(const IndiceBlocos* indice, unsigned char* p, unsigned long long int offsetIndice);
+
+/**
+ * @brief Grava o índice e o rodapé em @p saida.
+ * @param indice Índice completo.
+ * @param saida Arquivo posicionado logo após o terminador.
+ * @param offsetIndice Posição atual de @p saida.
+ * @return 0 em sucesso; -1 em erro de escrita ou falta de memória.
+ */
+int gravaIndice(const IndiceBlocos* indice, FILE* saida, unsigned long long int offsetIndice);
+
+/**
+ * @brief Lê o índice do fim de um arquivo no formato em blocos.
+ * @param entrada Arquivo aberto e posicionável; a posição é alterada.
+ * @param indice Recebe o índice (liberar com liberaIndice).
+ * @return 0 em sucesso; -1 se o arquivo não tiver índice ou ele for inconsistente.
+ */
+int leIndice(FILE* entrada, IndiceBlocos* indice);
+
+/**
+ * @brief Libera as entradas e os pontos do índice.
+ */
+void liberaIndice(IndiceBlocos* indice);
+
+#endif
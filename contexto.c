@@ -0,0 +1,328 @@
+#include "contexto.h"
+#include <math.h>
+#include <string.h>
+
+#define RODADAS_AGRUPAMENTO 6   // rodadas de redistribuição dos contextos entre as tabelas
+
+/**
+ * @brief Conta cada par (byte anterior, byte) de @p dados; o primeiro byte conta no contexto 0.
+ * @param dados Bytes a contar.
+ * @param n Quantidade de bytes (cabe em 32 bits).
+ * @param frequencias Matriz 256 x 256 (contexto, byte), zerada antes da contagem.
+ */
+void contaFrequenciasContexto(const unsigned char* dados, size_t n, unsigned int (*frequencias)[256]) {
+    memset(frequencias, 0, 256 * sizeof(*frequencias));
+    unsigned char anterior = 0;
+    for (size_t i = 0; i < n; i++) {
+        frequencias[anterior][dados[i]]++;
+        anterior = dados[i];
+    }
+}
+
+/**
+ * @brief Bits do código ideal para o histograma: soma de h * log2(total / h).
+ */
+static double entropiaHistograma(const unsigned long long int* h) {
+    unsigned long long int total = 0;
+    double soma = 0;
+    for (int i = 0; i < 256; i++) {
+        if (h[i]) {
+            total += h[i];
+            soma += h[i] * log2((double) h[i]);
+        }
+    }
+    return total ? total * log2((double) total) - soma : 0;
+}
+
+/**
+ * @brief Bits que serializarComprimentos gasta com uma tabela em que só os bytes de @p h têm código.
+ */
+static unsigned int bitsDescricaoTabela(const unsigned long long int* h) {
+    unsigned int bits = 0;
+    int i = 0;
+    while (i < 256) {
+        if (h[i]) {
+            bits += 4;
+            i++;
+            continue;
+        }
+        int zeros = 1;
+        while (i + zeros < 256 && zeros < 16 && h[i + zeros] == 0) {
+            zeros++;
+        }
+        bits += 8;
+        i += zeros;
+    }
+    return bits;
+}
+
+/**
+ * @brief Recalcula o histograma de cada tabela a partir dos contextos atribuídos a ela e descarta as
+ *        tabelas que ficaram vazias, renumerando as demais.
+ * @return Quantidade de tabelas restantes.
+ */
+static int somaTabelas(unsigned int (*frequencias)[256], int* tabela, int numTabelas,
+                       unsigned long long int (*histogramas)[256]) {
+    memset(histogramas, 0, numTabelas * sizeof(*histogramas));
+    for (int c = 0; c < 256; c++) {
+        if (tabela[c] >= 0) {
+            for (int s = 0; s < 256; s++) {
+                histogramas[tabela[c]][s] += frequencias[c][s];
+            }
+        }
+    }
+    int novo[MAX_TABELAS_CONTEXTO];
+    int restantes = 0;
+    for (int k = 0; k < numTabelas; k++) {
+        unsigned long long int total = 0;
+        for (int s = 0; s < 256; s++) {
+            total += histogramas[k][s];
+        }
+        novo[k] = total ? restantes++ : -1;
+        if (total && novo[k] != k) {
+            memcpy(histogramas[novo[k]], histogramas[k], sizeof(*histogramas));
+        }
+    }
+    for (int c = 0; c < 256; c++) {
+        if (tabela[c] >= 0) {
+            tabela[c] = novo[tabela[c]];
+        }
+    }
+    return restantes;
+}
+
+/**
+ * @brief Variação de bits ao juntar as tabelas @p a e @p b: a entropia a mais nos dados menos a
+ *        descrição economizada (negativa quando juntar compensa).
+ */
+static double custoJuncao(unsigned long long int (*histogramas)[256], const double* entropias,
+                          const unsigned int* descricoes, int a, int b) {
+    unsigned long long int juntos[256];
+    for (int s = 0; s < 256; s++) {
+        juntos[s] = histogramas[a][s] + histogramas[b][s];
+    }
+    double dados = entropiaHistograma(juntos) - entropias[a] - entropias[b];
+    double descricao = (double) descricoes[a] + descricoes[b] - bitsDescricaoTabela(juntos);
+    return dados - descricao;
+}
+
+/**
+ * @brief Agrupa os contextos em tabelas e calcula os comprimentos dos códigos de cada uma.
+ * @details Os MAX_TABELAS_CONTEXTO contextos mais frequentes começam cada um uma tabela; em algumas
+ *          rodadas, cada contexto passa à tabela em que seus bytes custariam menos bits (pela entropia
+ *          estimada) e as tabelas são recontadas. Depois, enquanto juntar duas tabelas custar menos
+ *          bits nos dados do que a descrição de uma delas, as duas viram uma só.
+ * @param frequencias Matriz de contaFrequenciasContexto.
+ * @param comprimentoMax Limite dos códigos, de COMPRIMENTO_MIN_CANONICO a COMPRIMENTO_MAX_CANONICO.
+ * @param modelo Recebe as tabelas.
+ */
+void construirModeloContexto(unsigned int (*frequencias)[256], int comprimentoMax, ModeloContexto* modelo) {
+    unsigned long long int totais[256];
+    int ativos[256], numAtivos = 0;
+    for (int c = 0; c < 256; c++) {
+        totais[c] = 0;
+        for (int s = 0; s < 256; s++) {
+            totais[c] += frequencias[c][s];
+        }
+        if (totais[c]) {
+            // Inserção em ordem decrescente de total
+            int j = numAtivos++;
+            while (j > 0 && totais[ativos[j - 1]] < totais[c]) {
+                ativos[j] = ativos[j - 1];
+                j--;
+            }
+            ativos[j] = c;
+        }
+    }
+
+    // Sementes: cada um dos contextos mais frequentes em uma tabela; os demais entram na primeira rodada
+    int tabela[256];
+    int numTabelas = numAtivos < MAX_TABELAS_CONTEXTO ? numAtivos : MAX_TABELAS_CONTEXTO;
+    for (int c = 0; c < 256; c++) {
+        tabela[c] = -1;
+    }
+    for (int k = 0; k < numTabelas; k++) {
+        tabela[ativos[k]] = k;
+    }
+    unsigned long long int histogramas[MAX_TABELAS_CONTEXTO][256];
+    numTabelas = somaTabelas(frequencias, tabela, numTabelas, histogramas);
+
+    for (int rodada = 0; rodada < RODADAS_AGRUPAMENTO && numTabelas > 1; rodada++) {
+        // Custo estimado de cada byte em cada tabela, -log2(p); um byte ausente conta como meia ocorrência
+        double custo[MAX_TABELAS_CONTEXTO][256];
+        for (int k = 0; k < numTabelas; k++) {
+            unsigned long long int total = 0;
+            for (int s = 0; s < 256; s++) {
+                total += histogramas[k][s];
+            }
+            double log2Total = log2((double) total + 1);
+            for (int s = 0; s < 256; s++) {
+                custo[k][s] = log2Total - log2((double) histogramas[k][s] + 0.5);
+            }
+        }
+        int mudou = 0;
+        for (int a = 0; a < numAtivos; a++) {
+            int c = ativos[a];
+            int melhor = tabela[c];
+            double menor = -1;
+            for (int k = 0; k < numTabelas; k++) {
+                double bits = 0;
+                for (int s = 0; s < 256; s++) {
+                    if (frequencias[c][s]) {
+                        bits += frequencias[c][s] * custo[k][s];
+                    }
+                }
+                if (menor < 0 || bits < menor) {
+                    menor = bits;
+                    melhor = k;
+                }
+            }
+            mudou |= melhor != tabela[c];
+            tabela[c] = melhor;
+        }
+        numTabelas = somaTabelas(frequencias, tabela, numTabelas, histogramas);
+        if (!mudou) {
+            break;
+        }
+    }
+
+    // Junta pares de tabelas enquanto a descrição economizada pagar os bits a mais nos dados
+    double entropias[MAX_TABELAS_CONTEXTO];
+    unsigned int descricoes[MAX_TABELAS_CONTEXTO];
+    double juncao[MAX_TABELAS_CONTEXTO][MAX_TABELAS_CONTEXTO];
+    for (int k = 0; k < numTabelas; k++) {
+        entropias[k] = entropiaHistograma(histogramas[k]);
+        descricoes[k] = bitsDescricaoTabela(histogramas[k]);
+    }
+    for (int a = 0; a < numTabelas; a++) {
+        for (int b = a + 1; b < numTabelas; b++) {
+            juncao[a][b] = custoJuncao(histogramas, entropias, descricoes, a, b);
+        }
+    }
+    while (numTabelas > 1) {
+        int ma = -1, mb = -1;
+        double menor = 0;
+        for (int a = 0; a < numTabelas; a++) {
+            for (int b = a + 1; b < numTabelas; b++) {
+                if (juncao[a][b] < menor) {
+                    menor = juncao[a][b];
+                    ma = a;
+                    mb = b;
+                }
+            }
+        }
+        if (ma < 0) {
+            break;
+        }
+        // b entra em a; a última tabela passa para o lugar de b
+        int ultima = numTabelas - 1;
+        for (int s = 0; s < 256; s++) {
+            histogramas[ma][s] += histogramas[mb][s];
+        }
+        memcpy(histogramas[mb], histogramas[ultima], sizeof(histogramas[mb]));
+        entropias[mb] = entropias[ultima];
+        descricoes[mb] = descricoes[ultima];
+        for (int c = 0; c < 256; c++) {
+            if (tabela[c] == mb) {
+                tabela[c] = ma;
+            } else if (tabela[c] == ultima) {
+                tabela[c] = mb;
+            }
+        }
+        for (int k = 0; k < ultima; k++) {
+            if (k < mb) {
+                juncao[k][mb] = juncao[k][ultima];
+            } else if (k > mb) {
+                juncao[mb][k] = juncao[k][ultima];
+            }
+        }
+        numTabelas--;
+        entropias[ma] = entropiaHistograma(histogramas[ma]);
+        descricoes[ma] = bitsDescricaoTabela(histogramas[ma]);
+        for (int k = 0; k < numTabelas; k++) {
+            if (k != ma) {
+                int a = k < ma ? k : ma, b = k < ma ? ma : k;
+                juncao[a][b] = custoJuncao(histogramas, entropias, descricoes, a, b);
+            }
+        }
+    }
+
+    modelo->numTabelas = numTabelas > 0 ? numTabelas : 1;
+    for (int c = 0; c < 256; c++) {
+        modelo->tabelaDoContexto[c] = (unsigned char) (tabela[c] >= 0 ? tabela[c] : 0);
+    }
+    for (int k = 0; k < modelo->numTabelas; k++) {
+        if (k < numTabelas) {
+            calcularComprimentosLimitados(histogramas[k], comprimentoMax, modelo->comprimentos[k]);
+        } else {
+            memset(modelo->comprimentos[k], 0, sizeof(modelo->comprimentos[k]));
+        }
+    }
+}
+
+/**
+ * @brief Bits dos dados codificados com o modelo.
+ */
+unsigned long long int bitsDadosContexto(unsigned int (*frequencias)[256], const ModeloContexto* modelo) {
+    unsigned long long int bits = 0;
+    for (int c = 0; c < 256; c++) {
+        const unsigned char* comprimentos = modelo->comprimentos[modelo->tabelaDoContexto[c]];
+        for (int s = 0; s < 256; s++) {
+            bits += (unsigned long long int) frequencias[c][s] * comprimentos[s];
+        }
+    }
+    return bits;
+}
+
+/**
+ * @brief Acrescenta os 4 bits menos significativos de @p valor ao bitmap.
+ */
+static void acrescentaNibble(bitmap* bm, unsigned int valor) {
+    for (int i = 3; i >= 0; i--) {
+        bitmapAppendLeastSignificantBit(bm, (valor >> i) & 1);
+    }
+}
+
+/**
+ * @brief Serializa o modelo no bitmap (formato em contexto.h).
+ * @param bm Bitmap de saída (capacidade mínima TAMANHO_MAX_DESCRICAO_CONTEXTO_BITS).
+ */
+void serializarModeloContexto(const ModeloContexto* modelo, bitmap* bm) {
+    acrescentaNibble(bm, (unsigned int) modelo->numTabelas - 1);
+    for (int c = 0; c < 256; c++) {
+        acrescentaNibble(bm, modelo->tabelaDoContexto[c]);
+    }
+    for (int k = 0; k < modelo->numTabelas; k++) {
+        serializarComprimentos(modelo->comprimentos[k], bm);
+    }
+}
+
+/**
+ * @brief Lê o modelo gravado por serializarModeloContexto e valida cada tabela.
+ * @param bytes Descrição serializada (mais significativo primeiro em cada byte).
+ * @param tamanhoBits Quantidade de bits válidos.
+ * @param modelo Recebe o modelo.
+ * @return 0 em sucesso; -1 se os bits não descreverem exatamente um modelo válido.
+ */
+int leModeloContexto(const unsigned char* bytes, unsigned int tamanhoBits, ModeloContexto* modelo) {
+    if (tamanhoBits < 4 + 256 * 4) {
+        return -1;
+    }
+    // As 257 primeiras unidades de 4 bits: o byte i traz as unidades 2i e 2i + 1
+    modelo->numTabelas = (bytes[0] >> 4) + 1;
+    for (int c = 0; c < 256; c++) {
+        int unidade = c + 1;
+        unsigned char valor = (bytes[unidade / 2] >> (unidade % 2 ? 0 : 4)) & 0xF;
+        if (valor >= modelo->numTabelas) {
+            return -1;
+        }
+        modelo->tabelaDoContexto[c] = valor;
+    }
+    unsigned int posicao = 4 + 256 * 4;
+    for (int k = 0; k < modelo->numTabelas; k++) {
+        if (leComprimentosEm(bytes, tamanhoBits, &posicao, modelo->comprimentos[k]) < 0) {
+            return -1;
+        }
+    }
+    return posicao == tamanhoBits ? 0 : -1;
+}
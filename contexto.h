@@ -0,0 +1,70 @@
+#ifndef CONTEXTO_H
+#define CONTEXTO_H
+
+#include <stddef.h>
+#include "bitmap.h"
+#include "huffman.h"
+
+/**
+ * @file contexto.h
+ * @brief Modelo de ordem 1: o código de cada byte depende do byte anterior.
+ * @details Os 256 contextos (o byte anterior; 0 no início do bloco) são agrupados em até
+ *          MAX_TABELAS_CONTEXTO tabelas de códigos canônicos, para que a descrição no bloco não custe
+ *          mais do que o modelo economiza. Descrição (BLOCO_CONTEXTO, em unidades de 4 bits):
+ *          [4 bits: numTabelas - 1] 256 * [4 bits: tabela do contexto]
+ *          numTabelas * [comprimentos no formato de serializarComprimentos]
+ */
+
+#define MAX_TABELAS_CONTEXTO 16
+#define TAMANHO_MAX_DESCRICAO_CONTEXTO_BITS (4 + 256 * 4 + MAX_TABELAS_CONTEXTO * TAMANHO_MAX_COMPRIMENTOS_BITS)
+
+/**
+ * @brief Tabelas de um modelo de ordem 1 e a tabela usada em cada contexto.
+ */
+typedef struct {
+    int numTabelas;
+    unsigned char tabelaDoContexto[256];
+    unsigned char comprimentos[MAX_TABELAS_CONTEXTO][256];
+} ModeloContexto;
+
+/**
+ * @brief Conta cada par (byte anterior, byte) de @p dados; o primeiro byte conta no contexto 0.
+ * @param dados Bytes a contar.
+ * @param n Quantidade de bytes (cabe em 32 bits).
+ * @param frequencias Matriz 256 x 256 (contexto, byte), zerada antes da contagem.
+ */
+void contaFrequenciasContexto(const unsigned char* dados, size_t n, unsigned int (*frequencias)[256]);
+
+/**
+ * @brief Agrupa os contextos em tabelas e calcula os comprimentos dos códigos de cada uma.
+ * @details Os MAX_TABELAS_CONTEXTO contextos mais frequentes começam cada um uma tabela; em algumas
+ *          rodadas, cada contexto passa à tabela em que seus bytes custariam menos bits (pela entropia
+ *          estimada) e as tabelas são recontadas. Depois, enquanto juntar duas tabelas custar menos
+ *          bits nos dados do que a descrição de uma delas, as duas viram uma só.
+ * @param frequencias Matriz de contaFrequenciasContexto.
+ * @param comprimentoMax Limite dos códigos, de COMPRIMENTO_MIN_CANONICO a COMPRIMENTO_MAX_CANONICO.
+ * @param modelo Recebe as tabelas.
+ */
+void construirModeloContexto(unsigned int (*frequencias)[256], int comprimentoMax, ModeloContexto* modelo);
+
+/**
+ * @brief Bits dos dados codificados com o modelo.
+ */
+unsigned long long int bitsDadosContexto(unsigned int (*frequencias)[256], const ModeloContexto* modelo);
+
+/**
+ * @brief Serializa o modelo no bitmap (formato em contexto.h).
+ * @param bm Bitmap de saída (capacidade mínima TAMANHO_MAX_DESCRICAO_CONTEXTO_BITS).
+ */
+void serializarModeloContexto(const ModeloContexto* modelo, bitmap* bm);
+
+/**
+ * @brief Lê o modelo gravado por serializarModeloContexto e valida cada tabela.
+ * @param bytes Descrição serializada (mais significativo primeiro em cada byte).
+ * @param tamanhoBits Quantidade de bits válidos.
+ * @param modelo Recebe o modelo.
+ * @return 0 em sucesso; -1 se os bits não descreverem exatamente um modelo válido.
+ */
+int leModeloContexto(const unsigned char* bytes, unsigned int tamanhoBits, ModeloContexto* modelo);
+
+#endif
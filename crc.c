@@ -0,0 +1,124 @@
+#include "crc.h"
+#include <pthread.h>
+#include <string.h>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#define CRC_X86
+#elif defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#define CRC_ARM
+#endif
+
+#define POLINOMIO_CRC32C 0x82F63B78u    ///< Castagnoli, bits refletidos
+
+static pthread_once_t inicializacao = PTHREAD_ONCE_INIT;
+static unsigned int tabelas[8][256];
+static int acelerado = 0;
+
+/**
+ * @brief Monta as tabelas e consulta o CPUID uma única vez.
+ */
+static void inicializa(void) {
+    for (unsigned int i = 0; i < 256; i++) {
+        unsigned int crc = i;
+        for (int k = 0; k < 8; k++) {
+            crc = crc & 1 ? (crc >> 1) ^ POLINOMIO_CRC32C : crc >> 1;
+        }
+        tabelas[0][i] = crc;
+    }
+    // tabelas[k][i]: CRC do byte i seguido de k bytes zero
+    for (unsigned int i = 0; i < 256; i++) {
+        for (int k = 1; k < 8; k++) {
+            tabelas[k][i] = (tabelas[k - 1][i] >> 8) ^ tabelas[0][tabelas[k - 1][i] & 0xFF];
+        }
+    }
+#if defined(CRC_X86)
+    __builtin_cpu_init();
+    acelerado = __builtin_cpu_supports("sse4.2") != 0;
+#elif defined(CRC_ARM)
+    acelerado = 1;
+#endif
+}
+
+/**
+ * @brief CRC (já invertido) por tabelas, 8 bytes por passo.
+ */
+static unsigned int crcTabelas(unsigned int crc, const unsigned char* p, size_t n) {
+    while (n >= 8) {
+        crc ^= p[0] | ((unsigned int) p[1] << 8) | ((unsigned int) p[2] << 16) | ((unsigned int) p[3] << 24);
+        crc = tabelas[7][crc & 0xFF] ^ tabelas[6][(crc >> 8) & 0xFF] ^ tabelas[5][(crc >> 16) & 0xFF] ^
+              tabelas[4][crc >> 24] ^ tabelas[3][p[4]] ^ tabelas[2][p[5]] ^ tabelas[1][p[6]] ^ tabelas[0][p[7]];
+        p += 8;
+        n -= 8;
+    }
+    while (n-- > 0) {
+        crc = (crc >> 8) ^ tabelas[0][(crc ^ *p++) & 0xFF];
+    }
+    return crc;
+}
+
+#if defined(CRC_X86)
+/**
+ * @brief CRC (já invertido) pela instrução crc32 do SSE4.2.
+ */
+__attribute__((target("sse4.2")))
+static unsigned int crcInstrucao(unsigned int crc, const unsigned char* p, size_t n) {
+    unsigned long long int c = crc;
+    while (n >= 8) {
+        unsigned long long int palavra;
+        memcpy(&palavra, p, 8);
+        c = _mm_crc32_u64(c, palavra);
+        p += 8;
+        n -= 8;
+    }
+    crc = (unsigned int) c;
+    while (n-- > 0) {
+        crc = _mm_crc32_u8(crc, *p++);
+    }
+    return crc;
+}
+#elif defined(CRC_ARM)
+/**
+ * @brief CRC (já invertido) pelas instruções crc32c do ARMv8.
+ */
+static unsigned int crcInstrucao(unsigned int crc, const unsigned char* p, size_t n) {
+    while (n >= 8) {
+        unsigned long long int palavra;
+        memcpy(&palavra, p, 8);
+        crc = __crc32cd(crc, palavra);
+        p += 8;
+        n -= 8;
+    }
+    while (n-- > 0) {
+        crc = __crc32cb(crc, *p++);
+    }
+    return crc;
+}
+#endif
+
+/**
+ * @brief Acrescenta @p n bytes a um CRC32C.
+ * @details crc32c(crc32c(0, a, na), b, nb) == crc32c(0, a || b, na + nb).
+ * @param crc CRC dos bytes anteriores (0 no início).
+ * @param dados Bytes.
+ * @param n Quantidade de bytes.
+ * @return CRC de todos os bytes até aqui.
+ */
+unsigned int crc32c(unsigned int crc, const unsigned char* dados, size_t n) {
+    pthread_once(&inicializacao, inicializa);
+#if defined(CRC_X86) || defined(CRC_ARM)
+    if (acelerado) {
+        return ~crcInstrucao(~crc, dados, n);
+    }
+#endif
+    return ~crcTabelas(~crc, dados, n);
+}
+
+/**
+ * @brief Indica se o CRC32C usa a instrução do processador.
+ */
+int crc32cAcelerado(void) {
+    pthread_once(&inicializacao, inicializa);
+    return acelerado;
+}
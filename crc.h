@@ -0,0 +1,28 @@
+#ifndef CRC_H
+#define CRC_H
+
+#include <stddef.h>
+
+/**
+ * @file crc.h
+ * @brief CRC32C (Castagnoli) dos bytes originais de cada bloco (BLOCO_COM_CRC, container.h).
+ * @details Com SSE4.2 (detectado pelo CPUID na primeira chamada) ou com a extensão CRC do ARMv8, usa a
+ *          instrução do processador, 8 bytes por vez; sem elas, tabelas de 8 bytes por passo.
+ */
+
+/**
+ * @brief Acrescenta @p n bytes a um CRC32C.
+ * @details crc32c(crc32c(0, a, na), b, nb) == crc32c(0, a || b, na + nb).
+ * @param crc CRC dos bytes anteriores (0 no início).
+ * @param dados Bytes.
+ * @param n Quantidade de bytes.
+ * @return CRC de todos os bytes até aqui.
+ */
+unsigned int crc32c(unsigned int crc, const unsigned char* dados, size_t n);
+
+/**
+ * @brief Indica se o CRC32C usa a instrução do processador.
+ */
+int crc32cAcelerado(void);
+
+#endif
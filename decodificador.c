@@ -0,0 +1,985 @@
+#include "decodificador.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define LARGURA_PRIMARIA 11
+#define LARGURA_SUBTABELA 8
+#define TAMANHO_BUFFER_SAIDA (1 << 20)
+#define TAMANHO_BLOCO_ENTRADA (1 << 20)
+
+#define ENTRADA_INVALIDA 0
+#define ENTRADA_FOLHA 1
+#define ENTRADA_LINK 2
+
+/**
+ * @brief Entrada das tabelas em 4 bytes: [22 bits: valor] [4 bits: largura] [2 bits: tipo] [4 bits: bits].
+ * @details O valor é o símbolo (folha) ou o início da subtabela (link); bits, os consumidos pela entrada;
+ *          largura, a da subtabela apontada (link). Uma entrada zerada é ENTRADA_INVALIDA.
+ */
+typedef unsigned int Entrada;
+
+#define BITS_ENTRADA(e) ((int) ((e) & 15))
+#define TIPO_ENTRADA(e) (((e) >> 4) & 3)
+#define LARGURA_ENTRADA(e) ((int) (((e) >> 6) & 15))
+#define VALOR_ENTRADA(e) ((e) >> 10)
+#define MAX_ENTRADAS (1u << 22)   ///< limite do campo valor; o modelo de ordem 1 fica abaixo de 2^21
+
+/**
+ * @brief Entrada da tabela de pares: [8 bits: segundo símbolo] [8 bits: primeiro símbolo] [2 bits: vazio]
+ *        [2 bits: símbolos] [4 bits: bits dos dois códigos]. Zero (nenhum símbolo) remete às tabelas comuns.
+ */
+#define BITS_PAR(p) ((int) ((p) & 15))
+#define SIMBOLOS_PAR(p) ((int) (((p) >> 4) & 3))
+
+struct decodificador {
+    Entrada* tabelas;          ///< tabela primária seguida das subtabelas
+    unsigned int total;        ///< entradas em uso
+    unsigned int capacidade;   ///< entradas alocadas
+    int larguraPrimaria;       ///< bits que indexam a tabela primária
+    unsigned int pares[1 << LARGURA_PRIMARIA];  ///< um ou dois códigos resolvidos pela tabela primária
+    unsigned int primariaContexto[256];         ///< tabela primária de cada contexto (modelo de ordem 1)
+    unsigned char larguraContexto[256];         ///< bits que indexam essa tabela
+};
+
+/**
+ * @brief Leitor de bits com acumulador de 64 bits alinhado à esquerda.
+ * @details Lê o fluxo em blocos de TAMANHO_BLOCO_ENTRADA bytes. Enquanto o fim do arquivo não é
+ *          conhecido, o último byte do bloco fica retido, pois só o byte final do fluxo tem bits de
+ *          enchimento (apenas @c bitsUltimoByte dos seus bits são válidos).
+ */
+typedef struct {
+    FILE* arquivo;                      ///< origem dos blocos (NULL para um buffer em memória)
+    const unsigned char* dados;         ///< bloco atual
+    unsigned char* bloco;               ///< memória do bloco quando lido de arquivo
+    size_t tamanho;                     ///< bytes em dados
+    size_t pos;                         ///< próximo byte a carregar
+    int fim;                            ///< 1 se dados contém o byte final do fluxo
+    int erro;                           ///< 1 se houve erro de leitura
+    unsigned char bitsUltimoByte;       ///< bits válidos no byte final do fluxo
+    unsigned long long int acumulador;  ///< próximos bits, o mais significativo primeiro
+    int disponiveis;                    ///< bits válidos carregados no acumulador
+} LeitorBits;
+
+/**
+ * @brief Altura (em arestas) da subárvore de @p no.
+ */
+static int alturaArvore(const NoHuffman* nos, int no) {
+    if (nos[no].esq == NO_NULO) {
+        return 0;
+    }
+    int e = alturaArvore(nos, nos[no].esq);
+    int d = alturaArvore(nos, nos[no].dir);
+    return 1 + (e > d ? e : d);
+}
+
+/**
+ * @brief Monta uma entrada das tabelas.
+ */
+static inline Entrada criaEntrada(unsigned int valor, int bits, int largura, int tipo) {
+    return valor << 10 | (unsigned int) largura << 6 | (unsigned int) tipo << 4 | (unsigned int) bits;
+}
+
+/**
+ * @brief Reserva @p n entradas contíguas e retorna o índice da primeira (ou -1 em falta de memória).
+ */
+static long reservaEntradas(Decodificador* d, unsigned int n) {
+    if (d->total + n > MAX_ENTRADAS) {
+        return -1;
+    }
+    if (d->total + n > d->capacidade) {
+        unsigned int nova = d->capacidade ? d->capacidade : 1024;
+        while (nova < d->total + n) {
+            nova *= 2;
+        }
+        Entrada* t = (Entrada*) realloc(d->tabelas, nova * sizeof(Entrada));
+        if (t == NULL) {
+            return -1;
+        }
+        d->tabelas = t;
+        d->capacidade = nova;
+    }
+    long inicio = d->total;
+    memset(d->tabelas + inicio, 0, n * sizeof(Entrada));
+    d->total += n;
+    return inicio;
+}
+
+static long construirTabela(Decodificador* d, const NoHuffman* nos, int no, int largura);
+
+/**
+ * @brief Preenche a tabela que começa em @p base com a subárvore @p no, alcançada pelo prefixo dado.
+ * @details Uma folha na profundidade p ocupa 2^(largura-p) entradas consecutivas; um nó interno na
+ *          profundidade @p largura recebe uma subtabela própria.
+ * @return 0 em sucesso; -1 em falta de memória.
+ */
+static int preencherTabela(Decodificador* d, long base, int largura, const NoHuffman* nos, int no,
+                           unsigned int prefixo, int profundidade) {
+    unsigned int inicio = prefixo << (largura - profundidade);
+    unsigned int quantidade = 1u << (largura - profundidade);
+
+    if (nos[no].esq == NO_NULO) {
+        for (unsigned int i = 0; i < quantidade; i++) {
+            d->tabelas[base + inicio + i] = criaEntrada(nos[no].caractere, profundidade, 0, ENTRADA_FOLHA);
+        }
+        return 0;
+    }
+
+    if (profundidade == largura) {
+        int larguraSub = alturaArvore(nos, no);
+        if (larguraSub > LARGURA_SUBTABELA) {
+            larguraSub = LARGURA_SUBTABELA;
+        }
+        long sub = construirTabela(d, nos, no, larguraSub);
+        if (sub < 0) {
+            return -1;
+        }
+        d->tabelas[base + inicio] = criaEntrada((unsigned int) sub, largura, larguraSub, ENTRADA_LINK);
+        return 0;
+    }
+
+    if (preencherTabela(d, base, largura, nos, nos[no].esq, prefixo << 1, profundidade + 1) < 0) {
+        return -1;
+    }
+    return preencherTabela(d, base, largura, nos, nos[no].dir, (prefixo << 1) | 1, profundidade + 1);
+}
+
+/**
+ * @brief Cria uma tabela de 2^largura entradas para a subárvore @p no.
+ * @return Índice da tabela em d->tabelas ou -1 em falta de memória.
+ */
+static long construirTabela(Decodificador* d, const NoHuffman* nos, int no, int largura) {
+    long base = reservaEntradas(d, 1u << largura);
+    if (base < 0) {
+        return -1;
+    }
+    if (preencherTabela(d, base, largura, nos, no, 0, 0) < 0) {
+        return -1;
+    }
+    return base;
+}
+
+/**
+ * @brief Preenche a tabela de pares pela tabela primária: cada folha leva também o código seguinte
+ *        quando ele cabe inteiro nos bits que sobram da mesma consulta.
+ */
+static void construirPares(Decodificador* d) {
+    const Entrada* primaria = d->tabelas;
+    int largura = d->larguraPrimaria;
+    unsigned int mascara = (1u << largura) - 1;
+    for (unsigned int i = 0; i <= mascara; i++) {
+        Entrada e = primaria[i];
+        if (TIPO_ENTRADA(e) != ENTRADA_FOLHA) {
+            d->pares[i] = 0;
+            continue;
+        }
+        int bits = BITS_ENTRADA(e);
+        Entrada seguinte = primaria[(i << bits) & mascara];
+        if (TIPO_ENTRADA(seguinte) == ENTRADA_FOLHA && BITS_ENTRADA(seguinte) <= largura - bits) {
+            d->pares[i] = VALOR_ENTRADA(seguinte) << 16 | VALOR_ENTRADA(e) << 8 | 2u << 4 |
+                          (unsigned int) (bits + BITS_ENTRADA(seguinte));
+        } else {
+            d->pares[i] = VALOR_ENTRADA(e) << 8 | 1u << 4 | (unsigned int) bits;
+        }
+    }
+}
+
+/**
+ * @brief Cria um decodificador sem tabelas, a ser preenchido por carregaDecodificador ou
+ *        carregaDecodificadorCanonico.
+ * @return Decodificador vazio ou NULL em falta de memória.
+ */
+Decodificador* criaDecodificadorVazio(void) {
+    return (Decodificador*) calloc(1, sizeof(Decodificador));
+}
+
+/**
+ * @brief Constrói as tabelas de decodificação a partir da árvore de Huffman.
+ * @details Uma tabela primária indexada pelos próximos bits do fluxo resolve os códigos curtos em
+ *          uma única consulta; códigos mais longos seguem para subtabelas encadeadas. Uma tabela de
+ *          pares, do mesmo tamanho da primária, resolve de uma vez dois códigos curtos seguidos.
+ * @param arvore Árvore de Huffman (pode ser uma única folha).
+ * @return Decodificador pronto para uso ou NULL em falta de memória.
+ */
+Decodificador* criaDecodificador(const ArvoreHuffman* arvore) {
+    Decodificador* d = criaDecodificadorVazio();
+    if (d == NULL || carregaDecodificador(d, arvore) < 0) {
+        liberaDecodificador(d);
+        return NULL;
+    }
+    return d;
+}
+
+/**
+ * @brief Substitui as tabelas de @p d pelas da árvore @p arvore, reaproveitando a memória já alocada.
+ * @param d Decodificador (vazio ou já usado).
+ * @param arvore Árvore de Huffman (pode ser uma única folha).
+ * @return 0 em sucesso; -1 em falta de memória.
+ */
+int carregaDecodificador(Decodificador* d, const ArvoreHuffman* arvore) {
+    const NoHuffman* nos = arvore->nos;
+    int raiz = arvore->raiz;
+    d->total = 0;
+
+    // Caso especial: árvore com apenas uma folha. Cada bit, 0 ou 1, representa uma ocorrência do caractere.
+    if (nos[raiz].esq == NO_NULO) {
+        if (reservaEntradas(d, 2) < 0) {
+            return -1;
+        }
+        for (int i = 0; i < 2; i++) {
+            d->tabelas[i] = criaEntrada(nos[raiz].caractere, 1, 0, ENTRADA_FOLHA);
+        }
+        d->larguraPrimaria = 1;
+        construirPares(d);
+        return 0;
+    }
+
+    int largura = alturaArvore(nos, raiz);
+    if (largura > LARGURA_PRIMARIA) {
+        largura = LARGURA_PRIMARIA;
+    }
+    if (largura < 1) {
+        largura = 1;
+    }
+    d->larguraPrimaria = largura;
+
+    if (construirTabela(d, nos, raiz, largura) < 0) {
+        return -1;
+    }
+    construirPares(d);
+    return 0;
+}
+
+/**
+ * @brief Acrescenta às tabelas de @p d a tabela primária e as subtabelas de um código canônico.
+ * @param largura Recebe a largura da tabela primária.
+ * @return Índice da tabela primária em d->tabelas ou -1 em falta de memória.
+ */
+static long construirTabelaCanonica(Decodificador* d, const unsigned char comprimentos[], int* largura) {
+    // Símbolos em ordem canônica (comprimento, byte) e o código de cada um
+    unsigned char simbolos[256];
+    unsigned long long int codigos[256];
+    int n = 0, maior = 0;
+    for (int len = 1; len <= 32; len++) {
+        for (int i = 0; i < 256; i++) {
+            if (comprimentos[i] == len) {
+                simbolos[n++] = (unsigned char) i;
+                maior = len;
+            }
+        }
+    }
+    unsigned long long int codigo = 0;
+    for (int k = 0; k < n; k++) {
+        if (k > 0) {
+            codigo = (codigo + 1) << (comprimentos[simbolos[k]] - comprimentos[simbolos[k - 1]]);
+        }
+        codigos[k] = codigo;
+    }
+
+    *largura = maior < LARGURA_PRIMARIA ? maior : LARGURA_PRIMARIA;
+    if (*largura < 1) {
+        *largura = 1;
+    }
+    int primaria = *largura;
+    long base = reservaEntradas(d, 1u << primaria);
+    if (base < 0) {
+        return -1;
+    }
+
+    int k = 0;
+    while (k < n) {
+        int len = comprimentos[simbolos[k]];
+        if (len <= primaria) {
+            unsigned int inicio = (unsigned int) codigos[k] << (primaria - len);
+            for (unsigned int i = 0; i < (1u << (primaria - len)); i++) {
+                d->tabelas[base + inicio + i] = criaEntrada(simbolos[k], len, 0, ENTRADA_FOLHA);
+            }
+            k++;
+            continue;
+        }
+
+        // Grupo de códigos longos com o mesmo prefixo; o último é o mais longo
+        unsigned long long int prefixo = codigos[k] >> (len - primaria);
+        int fim = k;
+        while (fim < n && codigos[fim] >> (comprimentos[simbolos[fim]] - primaria) == prefixo) {
+            fim++;
+        }
+        int larguraSub = comprimentos[simbolos[fim - 1]] - primaria;
+        long sub = reservaEntradas(d, 1u << larguraSub);
+        if (sub < 0) {
+            return -1;
+        }
+        d->tabelas[base + prefixo] = criaEntrada((unsigned int) sub, primaria, larguraSub, ENTRADA_LINK);
+        for (; k < fim; k++) {
+            int resto = comprimentos[simbolos[k]] - primaria;
+            unsigned int sufixo = (unsigned int) (codigos[k] & ((1ULL << resto) - 1));
+            unsigned int inicio = sufixo << (larguraSub - resto);
+            for (unsigned int i = 0; i < (1u << (larguraSub - resto)); i++) {
+                d->tabelas[sub + inicio + i] = criaEntrada(simbolos[k], resto, 0, ENTRADA_FOLHA);
+            }
+        }
+    }
+    return base;
+}
+
+/**
+ * @brief Constrói as tabelas de decodificação de um código canônico a partir dos comprimentos.
+ * @details Os códigos de até LARGURA_PRIMARIA bits são resolvidos na tabela primária; os mais
+ *          longos que compartilham o mesmo prefixo primário (contíguos na ordem canônica) ganham uma
+ *          subtabela com a largura do maior deles. Com comprimentos limitados a 15 bits as tabelas
+ *          têm tamanho fixo, sem depender da forma de uma árvore.
+ * @param comprimentos Comprimento de cada byte (0 para ausentes), já validados por leComprimentos.
+ * @return Decodificador pronto para uso ou NULL em falta de memória.
+ */
+Decodificador* criaDecodificadorCanonico(const unsigned char comprimentos[]) {
+    Decodificador* d = criaDecodificadorVazio();
+    if (d == NULL || carregaDecodificadorCanonico(d, comprimentos) < 0) {
+        liberaDecodificador(d);
+        return NULL;
+    }
+    return d;
+}
+
+/**
+ * @brief Substitui as tabelas de @p d pelas do código canônico dado pelos comprimentos,
+ *        reaproveitando a memória já alocada.
+ * @param d Decodificador (vazio ou já usado).
+ * @param comprimentos Comprimento de cada byte (0 para ausentes), já validados por leComprimentos.
+ * @return 0 em sucesso; -1 em falta de memória.
+ */
+int carregaDecodificadorCanonico(Decodificador* d, const unsigned char comprimentos[]) {
+    d->total = 0;
+    if (construirTabelaCanonica(d, comprimentos, &d->larguraPrimaria) < 0) {
+        return -1;
+    }
+    construirPares(d);
+    return 0;
+}
+
+/**
+ * @brief Substitui as tabelas de @p d pelas de um modelo de ordem 1: uma tabela canônica por código,
+ *        todas no mesmo vetor, e a tabela primária de cada contexto (ver decodificaContexto).
+ * @param d Decodificador (vazio ou já usado).
+ * @param numTabelas Quantidade de códigos.
+ * @param comprimentos Comprimentos de cada código, já validados por leComprimentos.
+ * @param tabelaDoContexto Código usado em cada contexto (menor que @p numTabelas).
+ * @return 0 em sucesso; -1 em falta de memória.
+ */
+int carregaDecodificadorContexto(Decodificador* d, int numTabelas, const unsigned char (*comprimentos)[256],
+                                 const unsigned char tabelaDoContexto[256]) {
+    long bases[256];
+    int larguras[256];
+    d->total = 0;
+    for (int k = 0; k < numTabelas; k++) {
+        bases[k] = construirTabelaCanonica(d, comprimentos[k], &larguras[k]);
+        if (bases[k] < 0) {
+            return -1;
+        }
+    }
+    for (int c = 0; c < 256; c++) {
+        d->primariaContexto[c] = (unsigned int) bases[tabelaDoContexto[c]];
+        d->larguraContexto[c] = (unsigned char) larguras[tabelaDoContexto[c]];
+    }
+    d->larguraPrimaria = larguras[0];
+    construirPares(d);
+    return 0;
+}
+
+/**
+ * @brief Libera as tabelas do decodificador.
+ * @param d Decodificador (pode ser NULL).
+ */
+void liberaDecodificador(Decodificador* d) {
+    if (d) {
+        free(d->tabelas);
+        free(d);
+    }
+}
+
+/**
+ * @brief Descarta os bytes já consumidos do bloco e lê o próximo trecho do arquivo em seguida ao byte retido.
+ */
+static void carregaBloco(LeitorBits* l) {
+    size_t retidos = l->tamanho - l->pos;
+    memmove(l->bloco, l->bloco + l->pos, retidos);
+    size_t pedidos = TAMANHO_BLOCO_ENTRADA - retidos;
+    size_t lidos = fread(l->bloco + retidos, sizeof(unsigned char), pedidos, l->arquivo);
+    l->tamanho = retidos + lidos;
+    l->pos = 0;
+    if (lidos < pedidos) {
+        l->fim = 1;
+        l->erro = ferror(l->arquivo) != 0;
+    }
+}
+
+/**
+ * @brief Completa o acumulador com bytes inteiros até ter mais de 56 bits ou esgotar o fluxo.
+ */
+static inline void recarregaLeitor(LeitorBits* l) {
+    // Caminho rápido: 8 bytes que certamente não incluem o byte final
+    if (l->pos + 8 < l->tamanho) {
+        unsigned long long int palavra = 0;
+        for (int i = 0; i < 8; i++) {
+            palavra = (palavra << 8) | l->dados[l->pos + i];
+        }
+        l->acumulador |= palavra >> l->disponiveis;
+        l->pos += (63 - l->disponiveis) >> 3;
+        l->disponiveis |= 56;
+        return;
+    }
+    while (l->disponiveis <= 56) {
+        if (l->pos + 1 >= l->tamanho && !l->fim) {
+            carregaBloco(l);
+            continue;
+        }
+        if (l->pos == l->tamanho) {
+            return;  // Fluxo esgotado
+        }
+        unsigned char byte = l->dados[l->pos++];
+        l->acumulador |= (unsigned long long int) byte << (56 - l->disponiveis);
+        l->disponiveis += (l->fim && l->pos == l->tamanho) ? l->bitsUltimoByte : 8;
+    }
+}
+
+static inline void consomeBits(LeitorBits* l, int n) {
+    l->acumulador <<= n;
+    l->disponiveis -= n;
+}
+
+/**
+ * @brief Estado de um fluxo nos laços rápidos (decodificaRapido e o laço conjunto de
+ *        decodificaFluxosIndependentes), mantido fora do LeitorBits para que o compilador o guarde em
+ *        registradores.
+ */
+typedef struct {
+    const unsigned char* p;             ///< próximo byte a carregar
+    unsigned long long int acumulador;  ///< próximos bits, o mais significativo primeiro
+    int disponiveis;                    ///< bits válidos carregados no acumulador
+} EstadoFluxo;
+
+/**
+ * @brief Completa o acumulador com 8 bytes de uma vez, como o caminho rápido de recarregaLeitor.
+ */
+static inline void recarregaFluxo(EstadoFluxo* f) {
+    unsigned long long int palavra = 0;
+    for (int i = 0; i < 8; i++) {
+        palavra = (palavra << 8) | f->p[i];
+    }
+    f->acumulador |= palavra >> f->disponiveis;
+    f->p += (63 - f->disponiveis) >> 3;
+    f->disponiveis |= 56;
+}
+
+/**
+ * @brief Decodifica um ou dois códigos pela tabela de pares, sem verificar o fim do fluxo nem do destino;
+ *        @p f deve ter ao menos LARGURA_PRIMARIA bits carregados e @p destino, espaço para dois bytes.
+ * @return Bytes produzidos (1 ou 2); 0 se o código precisa das subtabelas, sem consumir bits.
+ */
+static inline int passoPar(const unsigned int* pares, int deslocPrimario, EstadoFluxo* f, unsigned char* destino) {
+    unsigned int par = pares[f->acumulador >> deslocPrimario];
+    destino[0] = (unsigned char) (par >> 8);
+    destino[1] = (unsigned char) (par >> 16);
+    f->acumulador <<= BITS_PAR(par);
+    f->disponiveis -= BITS_PAR(par);
+    return SIMBOLOS_PAR(par);
+}
+
+/**
+ * @brief Caminho rápido de decodificaLeitor: enquanto a entrada está a mais de 8 bytes do fim do bloco e
+ *        o destino tem espaço para 8 bytes, cada recarga alimenta quatro consultas à tabela de pares,
+ *        com um único desvio para o código que precisa das subtabelas.
+ * @details Longe do fim, os bits carregados nunca incluem o byte final do fluxo, e todos os códigos
+ *          lidos aqui também seriam lidos, um a um, pelo laço comum.
+ * @return Bytes produzidos em @p destino.
+ */
+static size_t decodificaRapido(const Decodificador* d, LeitorBits* leitor, unsigned char* destino,
+                               size_t capacidade) {
+    if (leitor->tamanho <= 8) {
+        return 0;
+    }
+    const unsigned char* limite = leitor->dados + leitor->tamanho - 8;
+    const unsigned int* pares = d->pares;
+    const int deslocPrimario = 64 - d->larguraPrimaria;
+    EstadoFluxo f = {leitor->dados + leitor->pos, leitor->acumulador, leitor->disponiveis};
+    size_t usados = 0;
+    while (f.p < limite && capacidade - usados >= 8) {
+        // Após a recarga há ao menos 56 bits, o bastante para quatro consultas de LARGURA_PRIMARIA bits
+        recarregaFluxo(&f);
+        usados += (size_t) passoPar(pares, deslocPrimario, &f, destino + usados);
+        usados += (size_t) passoPar(pares, deslocPrimario, &f, destino + usados);
+        usados += (size_t) passoPar(pares, deslocPrimario, &f, destino + usados);
+        int n = passoPar(pares, deslocPrimario, &f, destino + usados);
+        usados += (size_t) n;
+        // Uma consulta sem símbolos não consome bits: as seguintes repetem a mesma e também falham
+        if (n == 0) {
+            break;
+        }
+    }
+    leitor->pos = (size_t) (f.p - leitor->dados);
+    leitor->acumulador = f.acumulador;
+    leitor->disponiveis = f.disponiveis;
+    return usados;
+}
+
+/**
+ * @brief Decodifica todo o fluxo do leitor para @p buffer.
+ * @details Com @p saida, o buffer é gravado no arquivo sempre que enche; sem arquivo, o buffer é o
+ *          destino final e a decodificação para quando ele enche.
+ * @param produzidos Recebe o total de bytes decodificados (pode ser NULL).
+ * @return 0 se todos os bits formaram códigos completos; 1 se terminou no meio de um código;
+ *         2 se o destino em memória encheu antes do fim do fluxo; -1 se encontrou um caminho
+ *         inexistente na árvore ou erro de leitura.
+ */
+static int decodificaLeitor(Decodificador* d, LeitorBits* leitor, unsigned char* buffer, size_t capacidade,
+                            FILE* saida, unsigned long long int* produzidos) {
+    const Entrada* tabelas = d->tabelas;
+    const int deslocPrimario = 64 - d->larguraPrimaria;
+    size_t usados = 0;
+    unsigned long long int total = 0;
+    int resultado = 0;
+
+    for (;;) {
+        usados += decodificaRapido(d, leitor, buffer + usados, capacidade - usados);
+        // Após a recarga há ao menos 57 bits, a menos que o fluxo tenha acabado
+        if (leitor->disponiveis < 32) {
+            recarregaLeitor(leitor);
+            if (leitor->disponiveis == 0) {
+                break;
+            }
+        }
+        Entrada e = tabelas[leitor->acumulador >> deslocPrimario];
+
+        while (TIPO_ENTRADA(e) == ENTRADA_LINK) {
+            if (BITS_ENTRADA(e) > leitor->disponiveis) {
+                break;
+            }
+            consomeBits(leitor, BITS_ENTRADA(e));
+            recarregaLeitor(leitor);
+            e = tabelas[VALOR_ENTRADA(e) + (leitor->acumulador >> (64 - LARGURA_ENTRADA(e)))];
+        }
+
+        if (TIPO_ENTRADA(e) == ENTRADA_INVALIDA) {
+            resultado = -1;
+            break;
+        }
+        if (TIPO_ENTRADA(e) == ENTRADA_LINK || BITS_ENTRADA(e) > leitor->disponiveis) {
+            // Os bits restantes não completam um código
+            resultado = 1;
+            break;
+        }
+
+        if (usados == capacidade) {
+            if (saida == NULL) {
+                resultado = 2;
+                break;
+            }
+            fwrite(buffer, sizeof(unsigned char), usados, saida);
+            total += usados;
+            usados = 0;
+        }
+        consomeBits(leitor, BITS_ENTRADA(e));
+        buffer[usados++] = (unsigned char) VALOR_ENTRADA(e);
+    }
+
+    if (saida) {
+        fwrite(buffer, sizeof(unsigned char), usados, saida);
+    }
+    total += usados;
+    if (produzidos) {
+        *produzidos = total;
+    }
+    if (leitor->erro) {
+        resultado = -1;
+    }
+    return resultado;
+}
+
+/**
+ * @brief Decodifica para a saída em arquivo usando um buffer temporário de TAMANHO_BUFFER_SAIDA bytes.
+ */
+static int decodificaLeitorArquivo(Decodificador* d, LeitorBits* leitor, FILE* saida,
+                                   unsigned long long int* produzidos) {
+    unsigned char* buffer = (unsigned char*) malloc(TAMANHO_BUFFER_SAIDA);
+    if (buffer == NULL) {
+        return -1;
+    }
+    int resultado = decodificaLeitor(d, leitor, buffer, TAMANHO_BUFFER_SAIDA, saida, produzidos);
+    free(buffer);
+    return resultado;
+}
+
+/**
+ * @brief Decodifica @p numBits bits de @p dados e grava os bytes resultantes em @p saida.
+ * @param d Decodificador.
+ * @param dados Bits codificados (mais significativo primeiro em cada byte).
+ * @param numBits Número de bits válidos em @p dados.
+ * @param saida Arquivo de saída aberto (binário).
+ * @return 0 se todos os bits formaram códigos completos; 1 se terminou no meio de um código;
+ *         -1 se encontrou um caminho inexistente na árvore.
+ */
+int decodificaBuffer(Decodificador* d, const unsigned char* dados, unsigned long long int numBits, FILE* saida) {
+    LeitorBits leitor = {0};
+    leitor.dados = dados;
+    leitor.tamanho = (numBits + 7) / 8;
+    leitor.fim = 1;
+    leitor.bitsUltimoByte = numBits % 8 ? numBits % 8 : 8;
+    return decodificaLeitorArquivo(d, &leitor, saida, NULL);
+}
+
+/**
+ * @brief Decodifica @p numBits bits de @p dados para a memória.
+ * @param d Decodificador.
+ * @param dados Bits codificados (mais significativo primeiro em cada byte).
+ * @param numBits Número de bits válidos em @p dados.
+ * @param destino Buffer de saída.
+ * @param capacidade Bytes disponíveis em @p destino.
+ * @return Quantidade de bytes decodificados; -1 se os dados estiverem corrompidos, terminarem no meio
+ *         de um código ou não couberem em @p destino.
+ */
+long long int decodificaParaMemoria(Decodificador* d, const unsigned char* dados, unsigned long long int numBits,
+                                    unsigned char* destino, size_t capacidade) {
+    LeitorBits leitor = {0};
+    leitor.dados = dados;
+    leitor.tamanho = (numBits + 7) / 8;
+    leitor.fim = 1;
+    leitor.bitsUltimoByte = numBits % 8 ? numBits % 8 : 8;
+    unsigned long long int produzidos;
+    if (decodificaLeitor(d, &leitor, destino, capacidade, NULL, &produzidos) != 0) {
+        return -1;
+    }
+    return (long long int) produzidos;
+}
+
+/**
+ * @brief Decodifica @p quantidade bytes a partir do bit @p bitInicial de @p dados, sem percorrer o
+ *        fluxo anterior.
+ * @details @p bitInicial deve ser o início de um código, como os pontos de acesso gravados no índice.
+ * @param d Decodificador.
+ * @param dados Bits codificados (mais significativo primeiro em cada byte).
+ * @param numBits Número de bits válidos em @p dados.
+ * @param bitInicial Bit de @p dados em que começa o primeiro código.
+ * @param destino Buffer com ao menos @p quantidade bytes.
+ * @param quantidade Bytes a decodificar.
+ * @return 0 se produziu exatamente @p quantidade bytes; -1 se os dados estiverem corrompidos ou
+ *         acabarem antes.
+ */
+int decodificaTrecho(Decodificador* d, const unsigned char* dados, unsigned long long int numBits,
+                     unsigned long long int bitInicial, unsigned char* destino, size_t quantidade) {
+    if (quantidade == 0) {
+        return 0;
+    }
+    if (bitInicial >= numBits) {
+        return -1;
+    }
+    LeitorBits leitor = {0};
+    leitor.dados = dados + bitInicial / 8;
+    leitor.tamanho = (numBits + 7) / 8 - bitInicial / 8;
+    leitor.fim = 1;
+    leitor.bitsUltimoByte = numBits % 8 ? numBits % 8 : 8;
+    recarregaLeitor(&leitor);
+    consomeBits(&leitor, (int) (bitInicial % 8));
+
+    unsigned long long int produzidos;
+    int resultado = decodificaLeitor(d, &leitor, destino, quantidade, NULL, &produzidos);
+    if (resultado < 0 || produzidos != quantidade) {
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Decodifica exatamente @p quantidade bytes com as tabelas de carregaDecodificadorContexto,
+ *        trocando de tabela a cada byte pelo byte anterior (o primeiro usa a do contexto 0).
+ * @param d Decodificador com um modelo de ordem 1.
+ * @param dados Bits codificados (mais significativo primeiro em cada byte).
+ * @param numBits Número de bits válidos em @p dados.
+ * @param destino Buffer com ao menos @p quantidade bytes.
+ * @param quantidade Bytes a decodificar.
+ * @return 0 se os bits formaram exatamente @p quantidade códigos; -1 caso contrário.
+ */
+int decodificaContexto(Decodificador* d, const unsigned char* dados, unsigned long long int numBits,
+                       unsigned char* destino, size_t quantidade) {
+    const Entrada* tabelas = d->tabelas;
+    LeitorBits leitor = {0};
+    leitor.dados = dados;
+    leitor.tamanho = (numBits + 7) / 8;
+    leitor.fim = 1;
+    leitor.bitsUltimoByte = numBits % 8 ? numBits % 8 : 8;
+    unsigned char anterior = 0;
+
+    for (size_t i = 0; i < quantidade; i++) {
+        // Um código tem no máximo COMPRIMENTO_MAX_CANONICO bits; após a recarga há ao menos 57
+        if (leitor.disponiveis < 32) {
+            recarregaLeitor(&leitor);
+        }
+        Entrada e = tabelas[d->primariaContexto[anterior] +
+                            (leitor.acumulador >> (64 - d->larguraContexto[anterior]))];
+        if (TIPO_ENTRADA(e) == ENTRADA_LINK) {
+            if (BITS_ENTRADA(e) > leitor.disponiveis) {
+                return -1;
+            }
+            consomeBits(&leitor, BITS_ENTRADA(e));
+            e = tabelas[VALOR_ENTRADA(e) + (leitor.acumulador >> (64 - LARGURA_ENTRADA(e)))];
+        }
+        if (TIPO_ENTRADA(e) != ENTRADA_FOLHA || BITS_ENTRADA(e) > leitor.disponiveis) {
+            return -1;
+        }
+        consomeBits(&leitor, BITS_ENTRADA(e));
+        anterior = (unsigned char) VALOR_ENTRADA(e);
+        destino[i] = anterior;
+    }
+    return leitor.disponiveis == 0 && leitor.pos == leitor.tamanho ? 0 : -1;
+}
+
+/**
+ * @brief Bytes que um passo pode ler a partir do próximo byte a carregar: um código tem no máximo
+ *        TAMANHO_MAX_CODIGO bits (a árvore lida é recusada acima disso), o acumulador carrega até 8
+ *        bytes além do primeiro bit não consumido e cada recarga lê uma palavra de 8 bytes. O laço
+ *        conjunto só roda com ao menos isso restando em cada fluxo.
+ */
+#define MARGEM_FLUXO (TAMANHO_MAX_CODIGO / 8 + 8 + 8)
+
+/**
+ * @brief Decodifica um ou dois bytes do fluxo @p f, que deve ter ao menos MARGEM_FLUXO bytes restantes,
+ *        para *@p destino, que avança sobre eles e deve ter espaço para dois bytes.
+ * @return 0 em sucesso; -1 se encontrou um caminho inexistente na árvore.
+ */
+static inline int passoFluxo(const Entrada* tabelas, const unsigned int* pares, int deslocPrimario, EstadoFluxo* f,
+                             unsigned char** destino) {
+    if (f->disponiveis < 32) {
+        recarregaFluxo(f);
+    }
+    int n = passoPar(pares, deslocPrimario, f, *destino);
+    if (n > 0) {
+        *destino += n;
+        return 0;
+    }
+    Entrada e = tabelas[f->acumulador >> deslocPrimario];
+    while (TIPO_ENTRADA(e) == ENTRADA_LINK) {
+        f->acumulador <<= BITS_ENTRADA(e);
+        f->disponiveis -= BITS_ENTRADA(e);
+        recarregaFluxo(f);
+        e = tabelas[VALOR_ENTRADA(e) + (f->acumulador >> (64 - LARGURA_ENTRADA(e)))];
+    }
+    f->acumulador <<= BITS_ENTRADA(e);
+    f->disponiveis -= BITS_ENTRADA(e);
+    *(*destino)++ = (unsigned char) VALOR_ENTRADA(e);
+    return TIPO_ENTRADA(e) == ENTRADA_INVALIDA ? -1 : 0;
+}
+
+/**
+ * @brief Decodifica FLUXOS_INDEPENDENTES fluxos com o mesmo código, cada um para o seu destino.
+ * @details Enquanto todos estão longe do fim, cada passo decodifica um ou dois bytes de cada fluxo: as
+ *          quatro cadeias de consultas às tabelas não dependem umas das outras e o processador as sobrepõe.
+ *          O final de cada fluxo é decodificado em separado.
+ * @param d Decodificador.
+ * @param dados Início de cada fluxo (mais significativo primeiro em cada byte).
+ * @param numBits Bits válidos de cada fluxo.
+ * @param destinos Destino de cada fluxo.
+ * @param quantidades Bytes que cada fluxo deve produzir.
+ * @return 0 se cada fluxo produziu exatamente a sua quantidade e terminou em um código completo;
+ *         -1 caso contrário.
+ */
+int decodificaFluxosIndependentes(Decodificador* d, const unsigned char* const dados[FLUXOS_INDEPENDENTES],
+                                  const unsigned long long int numBits[FLUXOS_INDEPENDENTES],
+                                  unsigned char* const destinos[FLUXOS_INDEPENDENTES],
+                                  const size_t quantidades[FLUXOS_INDEPENDENTES]) {
+    // Laço conjunto: cada fluxo em variáveis próprias, com o fim verificado uma vez por passo
+    const Entrada* tabelas = d->tabelas;
+    const unsigned int* pares = d->pares;
+    const int deslocPrimario = 64 - d->larguraPrimaria;
+    EstadoFluxo f0 = {dados[0], 0, 0}, f1 = {dados[1], 0, 0}, f2 = {dados[2], 0, 0}, f3 = {dados[3], 0, 0};
+    unsigned char* s0 = destinos[0];
+    unsigned char* s1 = destinos[1];
+    unsigned char* s2 = destinos[2];
+    unsigned char* s3 = destinos[3];
+    int erro = 0;
+    if (numBits[0] >= 8 * MARGEM_FLUXO && numBits[1] >= 8 * MARGEM_FLUXO &&
+        numBits[2] >= 8 * MARGEM_FLUXO && numBits[3] >= 8 * MARGEM_FLUXO &&
+        quantidades[0] >= 2 && quantidades[1] >= 2 && quantidades[2] >= 2 && quantidades[3] >= 2) {
+        // Só aqui os fins recuados pela margem ficam dentro de cada fluxo e de cada destino; um passo
+        // produz até dois bytes por fluxo
+        const unsigned char* fim0 = dados[0] + (numBits[0] + 7) / 8 - MARGEM_FLUXO;
+        const unsigned char* fim1 = dados[1] + (numBits[1] + 7) / 8 - MARGEM_FLUXO;
+        const unsigned char* fim2 = dados[2] + (numBits[2] + 7) / 8 - MARGEM_FLUXO;
+        const unsigned char* fim3 = dados[3] + (numBits[3] + 7) / 8 - MARGEM_FLUXO;
+        const unsigned char* limite0 = destinos[0] + quantidades[0] - 1;
+        const unsigned char* limite1 = destinos[1] + quantidades[1] - 1;
+        const unsigned char* limite2 = destinos[2] + quantidades[2] - 1;
+        const unsigned char* limite3 = destinos[3] + quantidades[3] - 1;
+        while (f0.p < fim0 && f1.p < fim1 && f2.p < fim2 && f3.p < fim3 && s0 < limite0 && s1 < limite1 &&
+               s2 < limite2 && s3 < limite3) {
+            erro |= passoFluxo(tabelas, pares, deslocPrimario, &f0, &s0);
+            erro |= passoFluxo(tabelas, pares, deslocPrimario, &f1, &s1);
+            erro |= passoFluxo(tabelas, pares, deslocPrimario, &f2, &s2);
+            erro |= passoFluxo(tabelas, pares, deslocPrimario, &f3, &s3);
+        }
+    }
+    if (erro) {
+        return -1;
+    }
+
+    // O restante de cada fluxo segue pelo leitor comum, a partir do estado do laço conjunto
+    const EstadoFluxo* estados[FLUXOS_INDEPENDENTES] = {&f0, &f1, &f2, &f3};
+    unsigned char* const saidas[FLUXOS_INDEPENDENTES] = {s0, s1, s2, s3};
+    for (int k = 0; k < FLUXOS_INDEPENDENTES; k++) {
+        LeitorBits leitor = {0};
+        leitor.dados = dados[k];
+        leitor.tamanho = (numBits[k] + 7) / 8;
+        leitor.pos = (size_t) (estados[k]->p - dados[k]);
+        leitor.fim = 1;
+        leitor.bitsUltimoByte = numBits[k] % 8 ? numBits[k] % 8 : 8;
+        leitor.acumulador = estados[k]->acumulador;
+        leitor.disponiveis = estados[k]->disponiveis;
+        size_t feitos = (size_t) (saidas[k] - destinos[k]);
+        unsigned long long int produzidos;
+        if (decodificaLeitor(d, &leitor, saidas[k], quantidades[k] - feitos, NULL, &produzidos) != 0 ||
+            produzidos != quantidades[k] - feitos) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Prepara @p e para decodificar um fluxo de @p numBits bits.
+ */
+void iniciaEstadoDecodificacao(EstadoDecodificacao* e, unsigned long long int numBits) {
+    e->acumulador = 0;
+    e->disponiveis = 0;
+    e->bitsRestantes = numBits;
+}
+
+/**
+ * @brief Completa o acumulador do estado com os bytes do pedaço até ter mais de 56 bits.
+ */
+static inline void recarregaEstado(EstadoDecodificacao* e, const unsigned char** dados, size_t* tamanho) {
+    // Caminho rápido: 8 bytes do pedaço, todos dentro do fluxo
+    if (*tamanho >= 8 && e->bitsRestantes >= 64 && e->disponiveis < 56) {
+        unsigned long long int palavra = 0;
+        for (int i = 0; i < 8; i++) {
+            palavra = (palavra << 8) | (*dados)[i];
+        }
+        int bytes = (63 - e->disponiveis) >> 3;
+        e->acumulador |= palavra >> e->disponiveis;
+        e->disponiveis += 8 * bytes;
+        e->bitsRestantes -= 8 * bytes;
+        *dados += bytes;
+        *tamanho -= bytes;
+        return;
+    }
+    while (e->disponiveis <= 56 && *tamanho > 0 && e->bitsRestantes > 0) {
+        int bits = e->bitsRestantes < 8 ? (int) e->bitsRestantes : 8;
+        e->acumulador |= (unsigned long long int) **dados << (56 - e->disponiveis);
+        e->disponiveis += bits;
+        e->bitsRestantes -= bits;
+        (*dados)++;
+        (*tamanho)--;
+    }
+}
+
+/**
+ * @brief Decodifica o que for possível de um pedaço do fluxo, retomando de onde a chamada anterior parou
+ *        (inclusive no meio de um código).
+ * @details Um código só é consumido quando todos os seus bits já chegaram; as subtabelas são
+ *          consultadas sem consumir os bits do prefixo, então nada se perde ao parar no meio de um código.
+ * @param d Decodificador.
+ * @param e Estado iniciado com iniciaEstadoDecodificacao.
+ * @param dados Próximos bytes do fluxo; avança sobre os bytes consumidos.
+ * @param tamanho Bytes em @p dados; diminui com o consumo. Só os bytes do fluxo são consumidos.
+ * @param destino Buffer de saída.
+ * @param capacidade Bytes disponíveis em @p destino.
+ * @param produzidos Recebe a quantidade de bytes decodificados.
+ * @return 1 se o fluxo terminou em um código completo; 0 se faltam bytes de entrada ou espaço de saída;
+ *         -1 se os dados estiverem corrompidos.
+ */
+int decodificaIncremental(Decodificador* d, EstadoDecodificacao* e, const unsigned char** dados, size_t* tamanho,
+                          unsigned char* destino, size_t capacidade, size_t* produzidos) {
+    const Entrada* tabelas = d->tabelas;
+    const unsigned int* pares = d->pares;
+    const int deslocPrimario = 64 - d->larguraPrimaria;
+    size_t usados = 0;
+    int resultado;
+
+    for (;;) {
+        if (e->disponiveis < 32) {
+            recarregaEstado(e, dados, tamanho);
+        }
+        if (e->disponiveis == 0 && e->bitsRestantes == 0) {
+            resultado = 1;
+            break;
+        }
+        if (usados == capacidade) {
+            resultado = 0;
+            break;
+        }
+
+        // Caminho rápido: com 8 bytes do fluxo no pedaço e espaço para 8 bytes no destino, cada recarga
+        // alimenta quatro consultas à tabela de pares
+        if (*tamanho >= 8 && e->bitsRestantes >= 64 && capacidade - usados >= 8) {
+            recarregaEstado(e, dados, tamanho);
+            EstadoFluxo f = {*dados, e->acumulador, e->disponiveis};
+            usados += (size_t) passoPar(pares, deslocPrimario, &f, destino + usados);
+            usados += (size_t) passoPar(pares, deslocPrimario, &f, destino + usados);
+            usados += (size_t) passoPar(pares, deslocPrimario, &f, destino + usados);
+            int n = passoPar(pares, deslocPrimario, &f, destino + usados);
+            usados += (size_t) n;
+            e->acumulador = f.acumulador;
+            e->disponiveis = f.disponiveis;
+            if (n > 0) {
+                continue;
+            }
+        }
+
+        // Percorre as subtabelas sem consumir bits até achar a folha
+        Entrada entrada = tabelas[e->acumulador >> deslocPrimario];
+        int prefixo = 0;
+        while (TIPO_ENTRADA(entrada) == ENTRADA_LINK && prefixo + BITS_ENTRADA(entrada) < 64) {
+            prefixo += BITS_ENTRADA(entrada);
+            entrada = tabelas[VALOR_ENTRADA(entrada) + ((e->acumulador << prefixo) >> (64 - LARGURA_ENTRADA(entrada)))];
+        }
+        if (TIPO_ENTRADA(entrada) != ENTRADA_FOLHA || prefixo + BITS_ENTRADA(entrada) > e->disponiveis) {
+            // Com o acumulador incompleto, a consulta usou zeros no lugar dos bits que ainda não chegaram
+            if (e->bitsRestantes == 0 || e->disponiveis > 56) {
+                resultado = -1;
+                break;
+            }
+            if (*tamanho == 0) {
+                resultado = 0;
+                break;
+            }
+            recarregaEstado(e, dados, tamanho);
+            continue;
+        }
+        e->acumulador <<= prefixo + BITS_ENTRADA(entrada);
+        e->disponiveis -= prefixo + BITS_ENTRADA(entrada);
+        destino[usados++] = (unsigned char) VALOR_ENTRADA(entrada);
+    }
+
+    *produzidos = usados;
+    return resultado;
+}
+
+/**
+ * @brief Decodifica o restante de @p entrada, lendo-o em blocos de tamanho fixo.
+ * @param d Decodificador.
+ * @param entrada Arquivo posicionado no início dos dados codificados (vão até o fim do arquivo).
+ * @param bitsUltimoByte Bits válidos no último byte do arquivo (1 a 8).
+ * @param saida Arquivo de saída aberto (binário).
+ * @param produzidos Recebe o total de bytes decodificados (pode ser NULL).
+ * @return 0 se todos os bits formaram códigos completos; 1 se terminou no meio de um código;
+ *         -1 se encontrou um caminho inexistente na árvore ou erro de leitura/memória.
+ */
+int decodificaArquivo(Decodificador* d, FILE* entrada, unsigned char bitsUltimoByte, FILE* saida,
+                      unsigned long long int* produzidos) {
+    LeitorBits leitor = {0};
+    leitor.arquivo = entrada;
+    leitor.bloco = (unsigned char*) malloc(TAMANHO_BLOCO_ENTRADA);
+    if (leitor.bloco == NULL) {
+        return -1;
+    }
+    leitor.dados = leitor.bloco;
+    leitor.bitsUltimoByte = bitsUltimoByte;
+    int resultado = decodificaLeitorArquivo(d, &leitor, saida, produzidos);
+    free(leitor.bloco);
+    return resultado;
+}
@@ -0,0 +1,189 @@
+#ifndef DECODIFICADOR_H
+#define DECODIFICADOR_H
+
+#include <stdio.h>
+#include "huffman.h"
+
+#define FLUXOS_INDEPENDENTES 4
+
+typedef struct decodificador Decodificador;
+
+/**
+ * @brief Estado da decodificação incremental de um fluxo de bits entregue em pedaços.
+ * @details Os bits de um código incompleto ficam no acumulador até a chegada do pedaço seguinte.
+ */
+typedef struct {
+    unsigned long long int acumulador;      ///< próximos bits, o mais significativo primeiro
+    int disponiveis;                        ///< bits válidos no acumulador
+    unsigned long long int bitsRestantes;   ///< bits do fluxo ainda não carregados no acumulador
+} EstadoDecodificacao;
+
+/**
+ * @brief Cria um decodificador sem tabelas, a ser preenchido por carregaDecodificador ou
+ *        carregaDecodificadorCanonico.
+ * @return Decodificador vazio ou NULL em falta de memória.
+ */
+Decodificador* criaDecodificadorVazio(void);
+
+/**
+ * @brief Constrói as tabelas de decodificação a partir da árvore de Huffman.
+ * @details Uma tabela primária indexada pelos próximos bits do fluxo resolve os códigos curtos em
+ *          uma única consulta; códigos mais longos seguem para subtabelas encadeadas. Uma tabela de
+ *          pares, do mesmo tamanho da primária, resolve de uma vez dois códigos curtos seguidos.
+ * @param arvore Árvore de Huffman (pode ser uma única folha).
+ * @return Decodificador pronto para uso ou NULL em falta de memória.
+ */
+Decodificador* criaDecodificador(const ArvoreHuffman* arvore);
+
+/**
+ * @brief Substitui as tabelas de @p d pelas da árvore @p arvore, reaproveitando a memória já alocada.
+ * @param d Decodificador (vazio ou já usado).
+ * @param arvore Árvore de Huffman (pode ser uma única folha).
+ * @return 0 em sucesso; -1 em falta de memória.
+ */
+int carregaDecodificador(Decodificador* d, const ArvoreHuffman* arvore);
+
+/**
+ * @brief Constrói as tabelas de decodificação de um código canônico a partir dos comprimentos.
+ * @details Os códigos de até LARGURA_PRIMARIA bits são resolvidos na tabela primária; os mais
+ *          longos que compartilham o mesmo prefixo primário (contíguos na ordem canônica) ganham uma
+ *          subtabela com a largura do maior deles. Com comprimentos limitados a 15 bits as tabelas
+ *          têm tamanho fixo, sem depender da forma de uma árvore.
+ * @param comprimentos Comprimento de cada byte (0 para ausentes), já validados por leComprimentos.
+ * @return Decodificador pronto para uso ou NULL em falta de memória.
+ */
+Decodificador* criaDecodificadorCanonico(const unsigned char comprimentos[]);
+
+/**
+ * @brief Substitui as tabelas de @p d pelas do código canônico dado pelos comprimentos,
+ *        reaproveitando a memória já alocada.
+ * @param d Decodificador (vazio ou já usado).
+ * @param comprimentos Comprimento de cada byte (0 para ausentes), já validados por leComprimentos.
+ * @return 0 em sucesso; -1 em falta de memória.
+ */
+int carregaDecodificadorCanonico(Decodificador* d, const unsigned char comprimentos[]);
+
+/**
+ * @brief Substitui as tabelas de @p d pelas de um modelo de ordem 1: uma tabela canônica por código,
+ *        todas no mesmo vetor, e a tabela primária de cada contexto (ver decodificaContexto).
+ * @param d Decodificador (vazio ou já usado).
+ * @param numTabelas Quantidade de códigos.
+ * @param comprimentos Comprimentos de cada código, já validados por leComprimentos.
+ * @param tabelaDoContexto Código usado em cada contexto (menor que @p numTabelas).
+ * @return 0 em sucesso; -1 em falta de memória.
+ */
+int carregaDecodificadorContexto(Decodificador* d, int numTabelas, const unsigned char (*comprimentos)[256],
+                                 const unsigned char tabelaDoContexto[256]);
+
+/**
+ * @brief Libera as tabelas do decodificador.
+ * @param d Decodificador (pode ser NULL).
+ */
+void liberaDecodificador(Decodificador* d);
+
+/**
+ * @brief Decodifica @p numBits bits de @p dados e grava os bytes resultantes em @p saida.
+ * @param d Decodificador.
+ * @param dados Bits codificados (mais significativo primeiro em cada byte).
+ * @param numBits Número de bits válidos em @p dados.
+ * @param saida Arquivo de saída aberto (binário).
+ * @return 0 se todos os bits formaram códigos completos; 1 se terminou no meio de um código;
+ *         -1 se encontrou um caminho inexistente na árvore.
+ */
+int decodificaBuffer(Decodificador* d, const unsigned char* dados, unsigned long long int numBits, FILE* saida);
+
+/**
+ * @brief Decodifica @p numBits bits de @p dados para a memória.
+ * @param d Decodificador.
+ * @param dados Bits codificados (mais significativo primeiro em cada byte).
+ * @param numBits Número de bits válidos em @p dados.
+ * @param destino Buffer de saída.
+ * @param capacidade Bytes disponíveis em @p destino.
+ * @return Quantidade de bytes decodificados; -1 se os dados estiverem corrompidos, terminarem no meio
+ *         de um código ou não couberem em @p destino.
+ */
+long long int decodificaParaMemoria(Decodificador* d, const unsigned char* dados, unsigned long long int numBits,
+                                    unsigned char* destino, size_t capacidade);
+
+/**
+ * @brief Decodifica @p quantidade bytes a partir do bit @p bitInicial de @p dados, sem percorrer o
+ *        fluxo anterior.
+ * @details @p bitInicial deve ser o início de um código, como os pontos de acesso gravados no índice.
+ * @param d Decodificador.
+ * @param dados Bits codificados (mais significativo primeiro em cada byte).
+ * @param numBits Número de bits válidos em @p dados.
+ * @param bitInicial Bit de @p dados em que começa o primeiro código.
+ * @param destino Buffer com ao menos @p quantidade bytes.
+ * @param quantidade Bytes a decodificar.
+ * @return 0 se produziu exatamente @p quantidade bytes; -1 se os dados estiverem corrompidos ou
+ *         acabarem antes.
+ */
+int decodificaTrecho(Decodificador* d, const unsigned char* dados, unsigned long long int numBits,
+                     unsigned long long int bitInicial, unsigned char* destino, size_t quantidade);
+
+/**
+ * @brief Decodifica exatamente @p quantidade bytes com as tabelas de carregaDecodificadorContexto,
+ *        trocando de tabela a cada byte pelo byte anterior (o primeiro usa a do contexto 0).
+ * @param d Decodificador com um modelo de ordem 1.
+ * @param dados Bits codificados (mais significativo primeiro em cada byte).
+ * @param numBits Número de bits válidos em @p dados.
+ * @param destino Buffer com ao menos @p quantidade bytes.
+ * @param quantidade Bytes a decodificar.
+ * @return 0 se os bits formaram exatamente @p quantidade códigos; -1 caso contrário.
+ */
+int decodificaContexto(Decodificador* d, const unsigned char* dados, unsigned long long int numBits,
+                       unsigned char* destino, size_t quantidade);
+
+/**
+ * @brief Decodifica FLUXOS_INDEPENDENTES fluxos com o mesmo código, cada um para o seu destino.
+ * @details Enquanto todos estão longe do fim, cada passo decodifica um byte de cada fluxo: as quatro
+ *          cadeias de consultas às tabelas não dependem umas das outras e o processador as sobrepõe.
+ *          O final de cada fluxo é decodificado em separado.
+ * @param d Decodificador.
+ * @param dados Início de cada fluxo (mais significativo primeiro em cada byte).
+ * @param numBits Bits válidos de cada fluxo.
+ * @param destinos Destino de cada fluxo.
+ * @param quantidades Bytes que cada fluxo deve produzir.
+ * @return 0 se cada fluxo produziu exatamente a sua quantidade e terminou em um código completo;
+ *         -1 caso contrário.
+ */
+int decodificaFluxosIndependentes(Decodificador* d, const unsigned char* const dados[FLUXOS_INDEPENDENTES],
+                                  const unsigned long long int numBits[FLUXOS_INDEPENDENTES],
+                                  unsigned char* const destinos[FLUXOS_INDEPENDENTES],
+                                  const size_t quantidades[FLUXOS_INDEPENDENTES]);
+
+/**
+ * @brief Prepara @p e para decodificar um fluxo de @p numBits bits.
+ */
+void iniciaEstadoDecodificacao(EstadoDecodificacao* e, unsigned long long int numBits);
+
+/**
+ * @brief Decodifica o que for possível de um pedaço do fluxo, retomando de onde a chamada anterior parou
+ *        (inclusive no meio de um código).
+ * @param d Decodificador.
+ * @param e Estado iniciado com iniciaEstadoDecodificacao.
+ * @param dados Próximos bytes do fluxo; avança sobre os bytes consumidos.
+ * @param tamanho Bytes em @p dados; diminui com o consumo. Só os bytes do fluxo são consumidos.
+ * @param destino Buffer de saída.
+ * @param capacidade Bytes disponíveis em @p destino.
+ * @param produzidos Recebe a quantidade de bytes decodificados.
+ * @return 1 se o fluxo terminou em um código completo; 0 se faltam bytes de entrada ou espaço de saída;
+ *         -1 se os dados estiverem corrompidos.
+ */
+int decodificaIncremental(Decodificador* d, EstadoDecodificacao* e, const unsigned char** dados, size_t* tamanho,
+                          unsigned char* destino, size_t capacidade, size_t* produzidos);
+
+/**
+ * @brief Decodifica o restante de @p entrada, lendo-o em blocos de tamanho fixo.
+ * @param d Decodificador.
+ * @param entrada Arquivo posicionado no início dos dados codificados (vão até o fim do arquivo).
+ * @param bitsUltimoByte Bits válidos no último byte do arquivo (1 a 8).
+ * @param saida Arquivo de saída aberto (binário).
+ * @param produzidos Recebe o total de bytes decodificados (pode ser NULL).
+ * @return 0 se todos os bits formaram códigos completos; 1 se terminou no meio de um código;
+ *         -1 se encontrou um caminho inexistente na árvore ou erro de leitura/memória.
+ */
+int decodificaArquivo(Decodificador* d, FILE* entrada, unsigned char bitsUltimoByte, FILE* saida,
+                      unsigned long long int* produzidos);
+
+#endif
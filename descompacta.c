@@ -1,233 +1,359 @@
-#include "arvore.h"
-#include "bitmap.h"
+#include <errno.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include "libhuffman.h"
+#include "programas.h"
 
-// Protótipos
-Arvore* desserializarArvore(bitmap* bm, unsigned int* posicao);
-void descompactarArquivo(const char* nomeArquivoEntrada, const char* nomeArquivoSaida);
-void decodificarDados(FILE* arquivoSaida, bitmap* bitmapDados, Arvore* raiz, unsigned int numBitsValidos);
 /**
- * @brief Programa de descompactação do formato .comp gerado por compacta.c.
- * @param argc Espera 2 argumentos.
- * @param argv argv[1] = caminho do arquivo .comp.
- * @return 0 em sucesso; 1 em erro de uso/extensão; aborta em erros de E/S.
+ * @brief Escreve o relatório de --stats: tempos por fase, bytes lidos e gravados, pico de memória e
+ *        bits por byte do arquivo.
+ * @details Os tempos das fases são somados entre blocos e threads; o total é o da execução inteira.
+ *          No filtro, a decodificação de cada bloco não é separada da montagem das tabelas.
+ * @param destino Saída do relatório.
+ * @param formato ESTATISTICAS_TEXTO ou ESTATISTICAS_JSON.
+ * @param lidos Bytes compactados lidos.
+ * @param gravados Bytes descompactados gravados.
+ * @param lote Totais de um lote (NULL para um único arquivo).
+ * @param e Medições do contexto.
+ * @param segundos Tempo total de relógio.
  */
+static void escreveEstatisticas(FILE* destino, int formato, unsigned long long int lidos,
+                                unsigned long long int gravados, const ResultadoLote* lote,
+                                const EstatisticasHuffman* e, double segundos) {
+    double segundosCpu;
+    long picoMemoriaKB;
+    usoProcesso(&segundosCpu, &picoMemoriaKB);
+    double bitsPorByteArquivo = gravados > 0 ? 8.0 * lidos / gravados : 0;
 
-int main(int argc, char* argv[]) {
-    if (argc != 2) {
-        printf("Uso: ./descompacta <arquivo.comp>\n");
-        return 1;
+    if (formato == ESTATISTICAS_JSON) {
+        fprintf(destino, "{\"operacao\": \"descompactacao\", \"bytes_lidos\": %llu, \"bytes_gravados\": %llu, "
+                "\"blocos\": %llu,\n", lidos, gravados, e->blocos);
+        if (lote) {
+            fprintf(destino, " \"arquivos\": %llu, \"falhas\": %llu,\n", lote->arquivos, lote->falhas);
+        }
+        fprintf(destino, " \"segundos\": %.6f, \"segundos_cpu\": %.6f, \"pico_memoria_kb\": %ld,\n",
+                segundos, segundosCpu, picoMemoriaKB);
+        fprintf(destino, " \"fases\": {");
+        for (int f = 0; f < HUFFMAN_NUM_FASES; f++) {
+            fprintf(destino, "%s\n  \"%s\": {\"segundos\": %.6f, \"segundos_cpu\": %.6f}", f ? "," : "",
+                    nomeFaseHuffman(f), e->segundos[f], e->segundosCpu[f]);
+        }
+        fprintf(destino, "},\n \"arquivo_bits_byte\": %.4f}\n", bitsPorByteArquivo);
+        return;
     }
-    
-    const char* nomeArquivoCompactado = argv[1];
-    
-    // Verifica se o arquivo termina com .comp
-    int len = strlen(nomeArquivoCompactado);
-    if (len < 5 || strcmp(nomeArquivoCompactado + len - 5, ".comp") != 0) {
-        printf("Erro: O arquivo deve ter extensão .comp\n");
-        return 1;
+
+    fprintf(destino, "Estatísticas da descompactação (%llu blocos):\n", e->blocos);
+    fprintf(destino, "  %-14s %13s %12s\n", "fase", "relógio (s)", "CPU (s)");  // "ó" ocupa dois bytes
+    for (int f = 0; f < HUFFMAN_NUM_FASES; f++) {
+        if (f == HUFFMAN_FASE_LEITURA || f == HUFFMAN_FASE_ARVORE || f == HUFFMAN_FASE_DECODIFICACAO ||
+            f == HUFFMAN_FASE_ESCRITA) {
+            fprintf(destino, "  %-14s %12.6f %12.6f\n", nomeFaseHuffman(f), e->segundos[f], e->segundosCpu[f]);
+        }
     }
-    
-    // Remove a extensão .comp para gerar o nome do arquivo de saída
-    char nomeArquivoSaida[1024];
-    strncpy(nomeArquivoSaida, nomeArquivoCompactado, len - 5);
-    nomeArquivoSaida[len - 5] = '\0';
-    
-    // Descompacta o arquivo
-    descompactarArquivo(nomeArquivoCompactado, nomeArquivoSaida);
-    
+    fprintf(destino, "  %-14s %12.6f %12.6f\n", "total", segundos, segundosCpu);
+    fprintf(destino, "  Bytes lidos: %llu\n", lidos);
+    fprintf(destino, "  Bytes gravados: %llu\n", gravados);
+    fprintf(destino, "  Pico de memória: %ld KB\n", picoMemoriaKB);
+    if (lidos > 0) {
+        fprintf(destino, "  Arquivo: %.4f bits/byte\n", bitsPorByteArquivo);
+    }
+}
+
+/**
+ * @brief Interpreta um tamanho em bytes com sufixo opcional K, M ou G.
+ * @return 0 em sucesso; -1 se o texto não for um tamanho válido.
+ */
+static int leTamanho(const char* texto, unsigned long long int* valor) {
+    char* fim;
+    if (texto[0] < '0' || texto[0] > '9') {
+        return -1;
+    }
+    *valor = strtoull(texto, &fim, 10);
+    int deslocamento = 0;
+    switch (*fim) {
+        case 'k': case 'K': deslocamento = 10; fim++; break;
+        case 'm': case 'M': deslocamento = 20; fim++; break;
+        case 'g': case 'G': deslocamento = 30; fim++; break;
+    }
+    if (*fim != '\0' || *valor > (~0ULL >> deslocamento)) {
+        return -1;
+    }
+    *valor <<= deslocamento;
     return 0;
 }
+
 /**
- * @brief Reconstrói a árvore a partir do bitmap serializado (pré-ordem).
- * @param bm Bitmap contendo a árvore.
- * @param posicao Índice do próximo bit a ler (atualizado por referência).
- * @return Raiz da árvore reconstruída ou NULL em erro.
+ * @brief Escreve em @p destino a mensagem de um código de erro da biblioteca e encerra o programa.
  */
+static void encerraComErro(FILE* destino, int codigo) {
+    if (codigo == HUFFMAN_ERRO_ENTRADA || codigo == HUFFMAN_ERRO_SAIDA) {
+        fprintf(destino, "Erro: %s: %s\n", mensagemErroHuffman(codigo), strerror(errno));
+    } else {
+        fprintf(destino, "Erro: %s\n", mensagemErroHuffman(codigo));
+    }
+    exit(1);
+}
 
-Arvore* desserializarArvore(bitmap* bm, unsigned int* posicao) {
-    // Verifica se ainda há bits para ler
-    if (*posicao >= bitmapGetLength(bm)) {
-        return NULL;
-    }
-    
-    // Lê o próximo bit
-    unsigned char bit = bitmapGetBit(bm, (*posicao)++);
-    
-    if (bit == 1) {
-        // É uma folha - lê o caractere (8 bits)
-        unsigned char caractere = 0;
-        for (int i = 7; i >= 0; i--) {
-            if (*posicao >= bitmapGetLength(bm)) {
-                printf("Erro: Fim inesperado do bitmap ao ler caractere\n");
-                return NULL;
-            }
-            unsigned char b = bitmapGetBit(bm, (*posicao)++);
-            caractere |= (b << i);
-        }
-        // Cria nó folha (frequência não importa na descompactação)
-        return criaArvore(caractere, 0, NULL, NULL);
+/**
+ * @brief Informa os arquivos de um lote que falharam ou terminaram com aviso, explicando o caminho
+ *        explícito sem a extensão .comp.
+ */
+static void informaArquivoDescompactado(void* arg, const char* nome, int codigo, const ResultadoHuffman* resultado) {
+    if (codigo == HUFFMAN_ERRO_PARAMETRO) {
+        fprintf((FILE*) arg, "Erro: %s: O arquivo deve ter extensão .comp\n", nome);
     } else {
-        // É um nó interno - desserializa recursivamente
-        Arvore* esq = desserializarArvore(bm, posicao);
-        Arvore* dir = desserializarArvore(bm, posicao);
-        return criaArvore('\0', 0, esq, dir);
+        informaArquivo(arg, nome, codigo, resultado);
     }
 }
+
 /**
- * @brief Lê o arquivo .comp e reconstroi árvore e dados, gerando o arquivo original.
- * @param nomeArquivoEntrada Caminho do .comp.
- * @param nomeArquivoSaida Caminho do arquivo de saída (sem .comp).
- * @details Fluxo: cabeçalho → bitmap da árvore → desserialização → bitmap dos dados → decodificação.
+ * @brief Descompacta (ou, com @p verificar, só verifica) um lote de arquivos .comp e diretórios e
+ *        informa os totais.
+ * @return Código de saída do programa: 0 se todos os arquivos foram processados; 1 caso contrário.
  */
+static int descompactaEmLote(ListaCaminhos* caminhos, const char* nomeDicionario, int numThreads, int verificar,
+                             int estatisticas, double inicio) {
+    DicionarioHuffman* dicionario = NULL;
+    if (nomeDicionario) {
+        int codigo = carregaDicionarioArquivo(nomeDicionario, &dicionario);
+        if (codigo != HUFFMAN_OK) {
+            printf("Erro: dicionário %s: %s\n", nomeDicionario, mensagemErroHuffman(codigo));
+            exit(1);
+        }
+    }
+
+    // Com --stats=json, a saída padrão recebe só o relatório
+    FILE* mensagens = estatisticas == ESTATISTICAS_JSON ? stderr : stdout;
+    ResultadoLote lote;
+    EstatisticasHuffman medicoes;
+    int codigo = (verificar ? verificaLote : descompactaLote)((const char* const*) caminhos->nomes,
+                                                              caminhos->quantidade, dicionario, numThreads,
+                                                              informaArquivoDescompactado, mensagens, &lote,
+                                                              estatisticas ? &medicoes : NULL);
+    liberaDicionarioHuffman(dicionario);
+    liberaCaminhos(caminhos);
+    if (codigo != HUFFMAN_OK) {
+        encerraComErro(stdout, codigo);
+    }
 
-void descompactarArquivo(const char* nomeArquivoEntrada, const char* nomeArquivoSaida) {
-    FILE* arquivoEntrada = fopen(nomeArquivoEntrada, "rb");
-    if (!arquivoEntrada) {
-        perror("Erro ao abrir arquivo compactado");
-        exit(1);
-    }
-    
-    // 1. Ler cabeçalho
-    unsigned int tamanhoArvore;
-    unsigned char bitsUltimoByte;
-    
-    if (fread(&tamanhoArvore, sizeof(unsigned int), 1, arquivoEntrada) != 1) {
-        printf("Erro ao ler tamanho da árvore\n");
-        fclose(arquivoEntrada);
-        exit(1);
-    }
-    
-    if (fread(&bitsUltimoByte, sizeof(unsigned char), 1, arquivoEntrada) != 1) {
-        printf("Erro ao ler bits do último byte\n");
-        fclose(arquivoEntrada);
-        exit(1);
-    }
-    
-    // 2. Ler a árvore serializada
-    unsigned int bytesArvore = (tamanhoArvore + 7) / 8;
-    unsigned char* bufferArvore = (unsigned char*)malloc(bytesArvore);
-    
-    if (fread(bufferArvore, sizeof(unsigned char), bytesArvore, arquivoEntrada) != bytesArvore) {
-        printf("Erro ao ler árvore serializada\n");
-        free(bufferArvore);
-        fclose(arquivoEntrada);
-        exit(1);
-    }
-    
-    // 3. Criar bitmap da árvore
-    bitmap* bitmapArvore = bitmapInit(tamanhoArvore);
-    for (unsigned int i = 0; i < tamanhoArvore; i++) {
-        unsigned int byteIndex = i / 8;
-        unsigned int bitIndex = 7 - (i % 8);
-        unsigned char bit = (bufferArvore[byteIndex] >> bitIndex) & 1;
-        bitmapAppendLeastSignificantBit(bitmapArvore, bit);
-    }
-    free(bufferArvore);
-    
-    // 4. Desserializar a árvore
-    unsigned int posicao = 0;
-    Arvore* raiz = desserializarArvore(bitmapArvore, &posicao);
-    bitmapLibera(bitmapArvore);
-    
-    if (raiz == NULL) {
-        printf("Erro ao desserializar árvore\n");
-        fclose(arquivoEntrada);
-        exit(1);
-    }
-    
-    // 5. Ler os dados comprimidos
-    // Primeiro, descobre o tamanho dos dados
-    long posicaoAtual = ftell(arquivoEntrada);
-    fseek(arquivoEntrada, 0, SEEK_END);
-    long tamanhoArquivo = ftell(arquivoEntrada);
-    fseek(arquivoEntrada, posicaoAtual, SEEK_SET);
-    
-    unsigned int bytesDados = tamanhoArquivo - posicaoAtual;
-    unsigned char* bufferDados = (unsigned char*)malloc(bytesDados);
-    
-    if (fread(bufferDados, sizeof(unsigned char), bytesDados, arquivoEntrada) != bytesDados) {
-        printf("Erro ao ler dados comprimidos\n");
-        free(bufferDados);
-        liberaArvore(raiz);
-        fclose(arquivoEntrada);
-        exit(1);
-    }
-    fclose(arquivoEntrada);
-    
-    // 6. Criar bitmap dos dados
-    unsigned int totalBitsDados = (bytesDados - 1) * 8 + bitsUltimoByte;
-    bitmap* bitmapDados = bitmapInit(totalBitsDados);
-    
-    for (unsigned int i = 0; i < totalBitsDados; i++) {
-        unsigned int byteIndex = i / 8;
-        unsigned int bitIndex = 7 - (i % 8);
-        unsigned char bit = (bufferDados[byteIndex] >> bitIndex) & 1;
-        bitmapAppendLeastSignificantBit(bitmapDados, bit);
-    }
-    free(bufferDados);
-    
-    // 7. Decodificar e escrever arquivo de saída
-    FILE* arquivoSaida = fopen(nomeArquivoSaida, "wb");
-    if (!arquivoSaida) {
-        perror("Erro ao criar arquivo de saída");
-        bitmapLibera(bitmapDados);
-        liberaArvore(raiz);
-        exit(1);
-    }
-    
-    decodificarDados(arquivoSaida, bitmapDados, raiz, totalBitsDados);
-    
-    // 8. Limpeza
-    fclose(arquivoSaida);
-    bitmapLibera(bitmapDados);
-    liberaArvore(raiz);
-    
+    double segundos = agora() - inicio;
+    if (estatisticas == ESTATISTICAS_JSON) {
+        escreveEstatisticas(stdout, estatisticas, lote.tamanhoCompactado, lote.tamanhoOriginal, &lote, &medicoes,
+                            segundos);
+        return lote.falhas > 0;
+    }
+    printf("Arquivos %s: %llu (%llu com erro)\n", verificar ? "verificados" : "descompactados", lote.arquivos,
+           lote.falhas);
+    printf("Bytes lidos: %llu\n", lote.tamanhoCompactado);
+    printf("Bytes %s: %llu\n", verificar ? "verificados" : "gravados", lote.tamanhoOriginal);
+    printf("Vazão: %.1f MB/s (%.3f s)\n", segundos > 0 ? lote.tamanhoOriginal / segundos / 1e6 : 0, segundos);
+    if (estatisticas) {
+        escreveEstatisticas(stdout, estatisticas, lote.tamanhoCompactado, lote.tamanhoOriginal, &lote, &medicoes,
+                            segundos);
+    }
+    return lote.falhas > 0;
 }
+
 /**
- * @brief Interpreta os bits de dados caminhando pela árvore e escreve bytes decodificados.
- * @param arquivoSaida Arquivo de saída aberto (binário).
- * @param bitmapDados Bits dos dados comprimidos.
- * @param raiz Árvore de Huffman.
- * @param numBitsValidos Número de bits válidos em bitmapDados.
+ * @brief Programa de descompactação do formato .comp gerado por compacta.c, sobre a biblioteca
+ *        (libhuffman.h).
+ * @details Com -x, apenas os bytes [inicio, inicio + tamanho) do original são descompactados e
+ *          gravados na saída padrão. Os valores aceitam os sufixos K, M e G (potências de 1024).
+ *          Com "-" no lugar do arquivo, funciona como filtro do formato em blocos, da entrada padrão para
+ *          a saída padrão, decodificando cada bloco à medida que chega.
+ *          Com -D, informa o dicionário usado na compactação (treina).
+ *          Com -t, só verifica a integridade: todos os blocos são decodificados em paralelo e os CRC32C
+ *          gravados com compacta --crc são conferidos, sem gravar nada; vale também para lotes.
+ *          Nesses casos as mensagens de erro vão para a saída de erro, pois a saída padrão recebe os dados.
+ *          Com índice, os blocos são lidos e gravados em segundo plano (io_uring, quando disponível)
+ *          enquanto outros são decodificados; com --direto, a saída é gravada com O_DIRECT.
+ *          Com vários arquivos, diretórios (percorridos recursivamente, atrás dos .comp) ou uma lista de
+ *          caminhos (-L, um por linha), processa um lote: -j arquivos são descompactados ao mesmo tempo e
+ *          ao final são informados os totais e a vazão.
+ *          Com --stats, informa o tempo de cada fase, os bytes lidos e gravados e o pico de memória
+ *          (--stats=json: em JSON); na extração, só os totais.
+ * @param argc Quantidade de argumentos.
+ * @param argv [-j threads] [-D dicionario] [-x inicio tamanho] [-t] [--direto] [--stats[=json]] [-L lista]
+ *        <arquivo.comp | diretorio | ->....
+ * @return 0 em sucesso; 1 em erro de uso/extensão, de E/S ou de dados corrompidos (inclusive CRC32C diferente).
  */
 
-void decodificarDados(FILE* arquivoSaida, bitmap* bitmapDados, Arvore* raiz, unsigned int numBitsValidos) {
-    // Caso especial: árvore com apenas um nó (arquivo original tinha 1 caractere único)
-    if (ehFolha(raiz)) {
-        unsigned char c = caractereArvore(raiz);
-        // Cada bit representa uma ocorrência do caractere
-        for (unsigned int i = 0; i < numBitsValidos; i++) {
-            fwrite(&c, sizeof(unsigned char), 1, arquivoSaida);
+int main(int argc, char* argv[]) {
+    ListaCaminhos caminhos = {NULL, 0, 0};
+    const char* nomeLista = NULL;
+    const char* nomeDicionario = NULL;
+    int numThreads = 0;
+    int extrair = 0;
+    int verificar = 0;
+    int direto = 0;
+    unsigned long long int inicio = 0, tamanho = 0;
+    int estatisticas = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+            numThreads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-D") == 0 && i + 1 < argc) {
+            nomeDicionario = argv[++i];
+        } else if (strcmp(argv[i], "-x") == 0 && i + 2 < argc) {
+            if (leTamanho(argv[i + 1], &inicio) < 0 || leTamanho(argv[i + 2], &tamanho) < 0) {
+                caminhos.quantidade = 0;
+                nomeLista = NULL;
+                break;
+            }
+            extrair = 1;
+            i += 2;
+        } else if (strcmp(argv[i], "-t") == 0) {
+            verificar = 1;
+        } else if (strcmp(argv[i], "--direto") == 0) {
+            direto = 1;
+        } else if (strcmp(argv[i], "--stats") == 0) {
+            estatisticas = ESTATISTICAS_TEXTO;
+        } else if (strcmp(argv[i], "--stats=json") == 0) {
+            estatisticas = ESTATISTICAS_JSON;
+        } else if (strcmp(argv[i], "-L") == 0 && i + 1 < argc && nomeLista == NULL) {
+            nomeLista = argv[++i];
+        } else if (argv[i][0] != '-' || strcmp(argv[i], "-") == 0) {
+            acrescentaCaminho(&caminhos, argv[i]);
+        } else {
+            caminhos.quantidade = 0;
+            nomeLista = NULL;
+            break;
         }
-        return;
     }
-    
-    // Percorre a árvore seguindo os bits
-    Arvore* noAtual = raiz;
-    
-    for (unsigned int i = 0; i < numBitsValidos; i++) {
-        unsigned char bit = bitmapGetBit(bitmapDados, i);
-        
-        // Navega na árvore: 0 = esquerda, 1 = direita
-        if (bit == 0) {
-            noAtual = getEsq(noAtual);
-        } else {
-            noAtual = getDir(noAtual);
+
+    // O filtro ("-") e a extração valem para um único arquivo
+    int filtro = caminhos.quantidade == 1 && nomeLista == NULL && strcmp(caminhos.nomes[0], "-") == 0;
+    int lote = nomeLista != NULL || caminhos.quantidade > 1 ||
+               (caminhos.quantidade == 1 && !filtro && ehDiretorio(caminhos.nomes[0]));
+    int usoValido = (caminhos.quantidade > 0 || nomeLista != NULL) && numThreads >= 0 &&
+                    !(filtro && extrair) && !(lote && extrair) && !(verificar && (filtro || extrair)) &&
+                    !(direto && (filtro || extrair || verificar || lote));
+    for (int i = 0; i < caminhos.quantidade && !filtro; i++) {
+        usoValido = usoValido && strcmp(caminhos.nomes[i], "-") != 0;
+    }
+    if (!usoValido) {
+        printf("Uso: ./descompacta [-j <threads>] [-D <dicionario>] [-x <inicio> <tamanho>] [-t] [--direto]\n"
+               "                   [--stats[=json]] [-L <lista>] <arquivo.comp | diretorio | ->...\n");
+        liberaCaminhos(&caminhos);
+        return 1;
+    }
+
+    double inicioExecucao = agora();
+    if (lote) {
+        if (nomeLista && leListaCaminhos(&caminhos, nomeLista) < 0) {
+            printf("Erro: lista %s: %s\n", nomeLista, strerror(errno));
+            exit(1);
+        }
+        return descompactaEmLote(&caminhos, nomeDicionario, numThreads, verificar, estatisticas, inicioExecucao);
+    }
+    const char* nomeArquivoCompactado = caminhos.nomes[0];
+
+    // A extração e o filtro leem os blocos em sequência
+    ContextoDescompactacao* ctx = criaContextoDescompactacao(extrair || filtro ? 1 : numThreads);
+    if (ctx == NULL) {
+        encerraComErro(stderr, HUFFMAN_ERRO_MEMORIA);
+    }
+    ativaEstatisticasDescompactacao(ctx, estatisticas != 0);
+    ativaSaidaDiretaDescompactacao(ctx, direto);
+    EstatisticasHuffman medicoes;
+    DicionarioHuffman* dicionario = NULL;
+    if (nomeDicionario) {
+        int codigo = carregaDicionarioArquivo(nomeDicionario, &dicionario);
+        if (codigo != HUFFMAN_OK) {
+            fprintf(stderr, "Erro: dicionário %s: %s\n", nomeDicionario, mensagemErroHuffman(codigo));
+            exit(1);
+        }
+        defineDicionarioDescompactacao(ctx, dicionario);
+    }
+    if (filtro) {
+        ResultadoHuffman resultado;
+        int codigo = descompactaFluxoArquivo(ctx, stdin, stdout, &resultado);
+        if (codigo != HUFFMAN_OK) {
+            encerraComErro(stderr, codigo);
+        }
+        if (estatisticas) {
+            estatisticasDescompactacao(ctx, &medicoes);
+            escreveEstatisticas(stderr, estatisticas, resultado.tamanhoCompactado, resultado.tamanhoOriginal,
+                                NULL, &medicoes, agora() - inicioExecucao);
+        }
+        liberaContextoDescompactacao(ctx);
+        liberaDicionarioHuffman(dicionario);
+        liberaCaminhos(&caminhos);
+        return 0;
+    }
+    if (extrair) {
+        unsigned long long int extraidos = 0;
+        int codigo = extraiTrechoArquivo(ctx, nomeArquivoCompactado, inicio, tamanho, stdout, &extraidos);
+        if (codigo == HUFFMAN_OK && fflush(stdout) != 0) {
+            codigo = HUFFMAN_ERRO_SAIDA;
+        }
+        if (codigo != HUFFMAN_OK) {
+            encerraComErro(stderr, codigo);
         }
-        
-        // Se chegou numa folha, escreve o caractere e volta para a raiz
-        if (ehFolha(noAtual)) {
-            unsigned char c = caractereArvore(noAtual);
-            fwrite(&c, sizeof(unsigned char), 1, arquivoSaida);
-            noAtual = raiz;  // Volta para a raiz para decodificar o próximo caractere
+        if (estatisticas) {
+            // Só os blocos do trecho são lidos: os bytes lidos não são contados
+            estatisticasDescompactacao(ctx, &medicoes);
+            escreveEstatisticas(stderr, estatisticas, 0, extraidos, NULL, &medicoes, agora() - inicioExecucao);
         }
+        liberaContextoDescompactacao(ctx);
+        liberaDicionarioHuffman(dicionario);
+        liberaCaminhos(&caminhos);
+        return 0;
     }
-    
-    // Verifica se terminou no meio de uma decodificação (não deveria acontecer)
-    if (noAtual != raiz) {
-        printf("Aviso: Decodificação terminou no meio de um caminho\n");
+
+    if (verificar) {
+        // Com --stats=json, a saída padrão recebe só o relatório
+        FILE* mensagens = estatisticas == ESTATISTICAS_JSON ? stderr : stdout;
+        ResultadoHuffman resultado;
+        int codigo = verificaArquivo(ctx, nomeArquivoCompactado, &resultado);
+        if (codigo == HUFFMAN_AVISO_CODIGO_INCOMPLETO || codigo == HUFFMAN_AVISO_SEM_CRC) {
+            fprintf(mensagens, "Aviso: %s\n", mensagemErroHuffman(codigo));
+        } else if (codigo != HUFFMAN_OK) {
+            encerraComErro(mensagens, codigo);
+        }
+        fprintf(mensagens, "Arquivo íntegro: %s (%llu bytes)\n", nomeArquivoCompactado, resultado.tamanhoOriginal);
+        if (estatisticas) {
+            estatisticasDescompactacao(ctx, &medicoes);
+            escreveEstatisticas(stdout, estatisticas, resultado.tamanhoCompactado, resultado.tamanhoOriginal,
+                                NULL, &medicoes, agora() - inicioExecucao);
+        }
+        liberaContextoDescompactacao(ctx);
+        liberaDicionarioHuffman(dicionario);
+        liberaCaminhos(&caminhos);
+        return 0;
+    }
+
+    // Verifica se o arquivo termina com .comp
+    int len = strlen(nomeArquivoCompactado);
+    if (len < 5 || strcmp(nomeArquivoCompactado + len - 5, ".comp") != 0) {
+        printf("Erro: O arquivo deve ter extensão .comp\n");
+        liberaContextoDescompactacao(ctx);
+        liberaDicionarioHuffman(dicionario);
+        liberaCaminhos(&caminhos);
+        return 1;
     }
-}
\ No newline at end of file
+
+    // Remove a extensão .comp para gerar o nome do arquivo de saída
+    char nomeArquivoSaida[1024];
+    snprintf(nomeArquivoSaida, sizeof(nomeArquivoSaida), "%.*s", len - 5, nomeArquivoCompactado);
+
+    // Descompacta o arquivo
+    ResultadoHuffman resultado;
+    int codigo = descompactaArquivo(ctx, nomeArquivoCompactado, nomeArquivoSaida, &resultado);
+    if (codigo == HUFFMAN_AVISO_CODIGO_INCOMPLETO) {
+        printf("Aviso: %s\n", mensagemErroHuffman(codigo));
+    } else if (codigo != HUFFMAN_OK) {
+        encerraComErro(stdout, codigo);
+    }
+    if (estatisticas) {
+        estatisticasDescompactacao(ctx, &medicoes);
+        escreveEstatisticas(stdout, estatisticas, resultado.tamanhoCompactado, resultado.tamanhoOriginal,
+                            NULL, &medicoes, agora() - inicioExecucao);
+    }
+    liberaContextoDescompactacao(ctx);
+    liberaDicionarioHuffman(dicionario);
+    liberaCaminhos(&caminhos);
+
+    return 0;
+}
@@ -0,0 +1,137 @@
+#include "dicionario.h"
+#include <stdlib.h>
+#include <string.h>
+#include "bitmap.h"
+#include "container.h"
+#include "huffman.h"
+
+struct dicionario {
+    unsigned int id;
+    unsigned char comprimentos[256];
+    Codigo codigos[256];
+    Decodificador* decodificador;
+};
+
+/**
+ * @brief Monta as tabelas de codificação e decodificação a partir dos comprimentos.
+ * @return Dicionário ou NULL em falta de memória.
+ */
+static Dicionario* montaDicionario(const unsigned char comprimentos[], unsigned int id) {
+    Dicionario* d = (Dicionario*) calloc(1, sizeof(Dicionario));
+    if (d == NULL) {
+        return NULL;
+    }
+    d->id = id;
+    memcpy(d->comprimentos, comprimentos, sizeof(d->comprimentos));
+    gerarDicionarioCanonico(d->codigos, d->comprimentos);
+    d->decodificador = criaDecodificadorCanonico(d->comprimentos);
+    if (d->decodificador == NULL) {
+        liberaDicionario(d);
+        return NULL;
+    }
+    return d;
+}
+
+/**
+ * @brief Cria um dicionário com códigos canônicos para as frequências de uma amostra.
+ * @details Cada frequência é acrescida de 1 antes do cálculo, para que bytes ausentes da amostra
+ *          também recebam código.
+ * @param frequencias Vetor de 256 frequências somadas sobre a amostra.
+ * @param id Identificador gravado nos blocos compactados com o dicionário.
+ * @param comprimentoMax Limite dos códigos, de COMPRIMENTO_MIN_CANONICO a COMPRIMENTO_MAX_CANONICO.
+ * @return Dicionário ou NULL em falta de memória.
+ */
+Dicionario* criaDicionario(const unsigned long long int* frequencias, unsigned int id, int comprimentoMax) {
+    unsigned long long int suavizadas[256];
+    unsigned char comprimentos[256];
+    for (int i = 0; i < 256; i++) {
+        suavizadas[i] = frequencias[i] + 1;
+    }
+    calcularComprimentosLimitados(suavizadas, comprimentoMax, comprimentos);
+    return montaDicionario(comprimentos, id);
+}
+
+/**
+ * @brief Grava o dicionário em @p saida.
+ * @return 0 em sucesso; -1 em erro de escrita ou falta de memória.
+ */
+int gravaDicionario(const Dicionario* d, FILE* saida) {
+    unsigned char cabecalho[TAMANHO_CABECALHO_DICIONARIO];
+    bitmap* bm = bitmapInit(TAMANHO_MAX_COMPRIMENTOS_BITS);
+    if (bm == NULL) {
+        return -1;
+    }
+    serializarComprimentos(d->comprimentos, bm);
+    unsigned int bits = (unsigned int) bitmapGetLength(bm);
+    size_t bytes = (bits + 7) / 8;
+
+    memcpy(cabecalho, MAGICO_DICIONARIO, 4);
+    cabecalho[4] = VERSAO_DICIONARIO;
+    escreveU32(cabecalho + 5, d->id);
+    escreveU16(cabecalho + 9, bits);
+    int resultado = fwrite(cabecalho, 1, TAMANHO_CABECALHO_DICIONARIO, saida) == TAMANHO_CABECALHO_DICIONARIO &&
+                    fwrite(bitmapGetContents(bm), 1, bytes, saida) == bytes ? 0 : -1;
+    bitmapLibera(bm);
+    return resultado;
+}
+
+/**
+ * @brief Lê um dicionário gravado por gravaDicionario e monta suas tabelas.
+ * @param entrada Arquivo posicionado no início do dicionário.
+ * @return Dicionário ou NULL se o arquivo for inválido, incompleto ou faltar memória.
+ */
+Dicionario* leDicionario(FILE* entrada) {
+    unsigned char cabecalho[TAMANHO_CABECALHO_DICIONARIO];
+    unsigned char bytes[(TAMANHO_MAX_COMPRIMENTOS_BITS + 7) / 8];
+    unsigned char comprimentos[256];
+
+    if (fread(cabecalho, 1, TAMANHO_CABECALHO_DICIONARIO, entrada) != TAMANHO_CABECALHO_DICIONARIO ||
+        memcmp(cabecalho, MAGICO_DICIONARIO, 4) != 0 || cabecalho[4] != VERSAO_DICIONARIO) {
+        return NULL;
+    }
+    unsigned int bits = leU16(cabecalho + 9);
+    if (bits > TAMANHO_MAX_COMPRIMENTOS_BITS ||
+        fread(bytes, 1, (bits + 7) / 8, entrada) != (bits + 7) / 8 ||
+        leComprimentos(bytes, bits, comprimentos) < 0) {
+        return NULL;
+    }
+    // Um dicionário precisa codificar qualquer byte
+    for (int i = 0; i < 256; i++) {
+        if (comprimentos[i] == 0) {
+            return NULL;
+        }
+    }
+    return montaDicionario(comprimentos, leU32(cabecalho + 5));
+}
+
+/**
+ * @brief Identificador do dicionário.
+ */
+unsigned int idDicionario(const Dicionario* d) {
+    return d->id;
+}
+
+/**
+ * @brief Códigos dos 256 bytes, prontos para codificaBuffer.
+ */
+const Codigo* codigosDicionario(const Dicionario* d) {
+    return d->codigos;
+}
+
+/**
+ * @brief Tabelas de decodificação do dicionário; só são lidas, podendo ser usadas por várias threads.
+ */
+Decodificador* decodificadorDicionario(const Dicionario* d) {
+    return d->decodificador;
+}
+
+/**
+ * @brief Libera o dicionário.
+ * @param d Dicionário (pode ser NULL).
+ */
+void liberaDicionario(Dicionario* d) {
+    if (d) {
+        liberaDecodificador(d->decodificador);
+        free(d);
+    }
+}
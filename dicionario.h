@@ -0,0 +1,71 @@
+#ifndef DICIONARIO_H
+#define DICIONARIO_H
+
+#include <stdio.h>
+#include "codificador.h"
+#include "decodificador.h"
+
+/**
+ * @file dicionario.h
+ * @brief Códigos de Huffman pré-treinados, compartilhados por várias mensagens.
+ * @details Para mensagens pequenas a descrição do código em cada bloco custa mais do que economiza;
+ *          com um dicionário, os blocos (BLOCO_DICIONARIO) trazem só o identificador dele, e as
+ *          tabelas de codificação e decodificação são montadas uma única vez.
+ *          Arquivo (inteiros little-endian):
+ *          [4 bytes: "HUFD"] [1 byte: versão] [4 bytes: id] [2 bytes: bits dos comprimentos]
+ *          [comprimentos no formato de serializarComprimentos]
+ *          Todos os 256 bytes têm código, de modo que qualquer mensagem pode ser compactada.
+ */
+
+#define MAGICO_DICIONARIO "HUFD"
+#define VERSAO_DICIONARIO 1
+#define TAMANHO_CABECALHO_DICIONARIO 11
+
+typedef struct dicionario Dicionario;
+
+/**
+ * @brief Cria um dicionário com códigos canônicos para as frequências de uma amostra.
+ * @details Cada frequência é acrescida de 1 antes do cálculo, para que bytes ausentes da amostra
+ *          também recebam código.
+ * @param frequencias Vetor de 256 frequências somadas sobre a amostra.
+ * @param id Identificador gravado nos blocos compactados com o dicionário.
+ * @param comprimentoMax Limite dos códigos, de COMPRIMENTO_MIN_CANONICO a COMPRIMENTO_MAX_CANONICO.
+ * @return Dicionário ou NULL em falta de memória.
+ */
+Dicionario* criaDicionario(const unsigned long long int* frequencias, unsigned int id, int comprimentoMax);
+
+/**
+ * @brief Grava o dicionário em @p saida.
+ * @return 0 em sucesso; -1 em erro de escrita ou falta de memória.
+ */
+int gravaDicionario(const Dicionario* d, FILE* saida);
+
+/**
+ * @brief Lê um dicionário gravado por gravaDicionario e monta suas tabelas.
+ * @param entrada Arquivo posicionado no início do dicionário.
+ * @return Dicionário ou NULL se o arquivo for inválido, incompleto ou faltar memória.
+ */
+Dicionario* leDicionario(FILE* entrada);
+
+/**
+ * @brief Identificador do dicionário.
+ */
+unsigned int idDicionario(const Dicionario* d);
+
+/**
+ * @brief Códigos dos 256 bytes, prontos para codificaBuffer.
+ */
+const Codigo* codigosDicionario(const Dicionario* d);
+
+/**
+ * @brief Tabelas de decodificação do dicionário; só são lidas, podendo ser usadas por várias threads.
+ */
+Decodificador* decodificadorDicionario(const Dicionario* d);
+
+/**
+ * @brief Libera o dicionário.
+ * @param d Dicionário (pode ser NULL).
+ */
+void liberaDicionario(Dicionario* d);
+
+#endif
@@ -0,0 +1,195 @@
+#include "entrada.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define USA_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#define TAMANHO_BLOCO_ENTRADA (1 << 20)
+
+struct arquivoEntrada {
+    FILE* arquivo;                  ///< usado quando o mapeamento não é possível
+    unsigned char* buffer;          ///< buffer de leitura do modo fread
+    const unsigned char* mapa;      ///< arquivo mapeado (NULL no modo fread)
+    size_t tamanhoMapa;             ///< bytes mapeados
+    size_t pos;                     ///< próximo byte do mapeamento
+    int erro;                       ///< 1 se houve erro de leitura
+};
+
+#ifdef USA_MMAP
+/**
+ * @brief Tenta mapear o arquivo inteiro; retorna 1 em sucesso (arquivos vazios contam como sucesso).
+ */
+static int mapeiaArquivo(ArquivoEntrada* a, int fd) {
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        return 0;
+    }
+    if (st.st_size == 0) {
+        a->mapa = (const unsigned char*) "";
+        a->tamanhoMapa = 0;
+        return 1;
+    }
+    void* p = mmap(NULL, (size_t) st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (p == MAP_FAILED) {
+        return 0;
+    }
+    madvise(p, (size_t) st.st_size, MADV_SEQUENTIAL);
+    a->mapa = (const unsigned char*) p;
+    a->tamanhoMapa = (size_t) st.st_size;
+    return 1;
+}
+
+/**
+ * @brief Como abreArquivoEntrada, para um descritor já aberto para leitura (sistemas POSIX).
+ * @details Um pipe ou FIFO é lido pelo mesmo descritor, sem reabrir o caminho (o que perderia os
+ *          dados já enviados e poderia encerrar quem escreve).
+ * @param fd Descritor; passa a pertencer ao arquivo, inclusive em caso de erro.
+ * @return Arquivo aberto ou NULL em erro (errno indica a causa).
+ */
+ArquivoEntrada* abreDescritorEntrada(int fd) {
+    ArquivoEntrada* a = (ArquivoEntrada*) calloc(1, sizeof(ArquivoEntrada));
+    if (a == NULL) {
+        close(fd);
+        return NULL;
+    }
+    if (mapeiaArquivo(a, fd)) {
+        close(fd);
+        return a;
+    }
+    a->arquivo = fdopen(fd, "rb");
+    a->buffer = (unsigned char*) malloc(TAMANHO_BLOCO_ENTRADA);
+    if (a->arquivo == NULL || a->buffer == NULL) {
+        if (a->arquivo == NULL) {
+            close(fd);
+        }
+        fechaArquivoEntrada(a);
+        return NULL;
+    }
+    return a;
+}
+#endif
+
+/**
+ * @brief Abre um arquivo para leitura sequencial em blocos grandes.
+ * @details Sempre que possível o arquivo é mapeado em memória e os blocos são fatias do mapeamento,
+ *          sem cópia; caso contrário, os blocos são lidos com fread para um buffer interno.
+ * @param nomeArquivo Caminho do arquivo.
+ * @return Arquivo aberto ou NULL em erro (errno indica a causa).
+ */
+ArquivoEntrada* abreArquivoEntrada(const char* nomeArquivo) {
+#ifdef USA_MMAP
+    // Um único open: reabrir um FIFO perderia o que já foi escrito nele
+    int fd = open(nomeArquivo, O_RDONLY);
+    return fd < 0 ? NULL : abreDescritorEntrada(fd);
+#else
+    ArquivoEntrada* a = (ArquivoEntrada*) calloc(1, sizeof(ArquivoEntrada));
+    if (a == NULL) {
+        return NULL;
+    }
+    a->arquivo = fopen(nomeArquivo, "rb");
+    a->buffer = (unsigned char*) malloc(TAMANHO_BLOCO_ENTRADA);
+    if (a->arquivo == NULL || a->buffer == NULL) {
+        fechaArquivoEntrada(a);
+        return NULL;
+    }
+    return a;
+#endif
+}
+
+/**
+ * @brief Obtém o próximo bloco do arquivo.
+ * @param a Arquivo aberto.
+ * @param bloco Recebe o endereço do bloco (válido até a próxima chamada).
+ * @return Quantidade de bytes no bloco; 0 no fim do arquivo.
+ */
+size_t leBlocoEntrada(ArquivoEntrada* a, const unsigned char** bloco) {
+    return leTrechoEntrada(a, TAMANHO_BLOCO_ENTRADA, a->buffer, bloco);
+}
+
+/**
+ * @brief Obtém os próximos @p tamanho bytes do arquivo (menos apenas no fim).
+ * @details Com o arquivo mapeado o trecho aponta para o mapeamento; caso contrário os bytes são lidos
+ *          em @p destino, que deve ter ao menos @p tamanho bytes.
+ * @param a Arquivo aberto.
+ * @param tamanho Bytes desejados.
+ * @param destino Buffer usado quando o arquivo não está mapeado.
+ * @param trecho Recebe o endereço dos bytes.
+ * @return Quantidade de bytes obtidos; 0 no fim do arquivo.
+ */
+size_t leTrechoEntrada(ArquivoEntrada* a, size_t tamanho, unsigned char* destino, const unsigned char** trecho) {
+    if (a->mapa) {
+        size_t n = a->tamanhoMapa - a->pos;
+        if (n > tamanho) {
+            n = tamanho;
+        }
+        *trecho = a->mapa + a->pos;
+        a->pos += n;
+        return n;
+    }
+    size_t lidos = fread(destino, sizeof(unsigned char), tamanho, a->arquivo);
+    if (lidos < tamanho && ferror(a->arquivo)) {
+        a->erro = 1;
+    }
+    *trecho = destino;
+    return lidos;
+}
+
+/**
+ * @brief Indica se os trechos apontam para o arquivo mapeado (sem necessidade de buffer próprio).
+ * @param a Arquivo aberto.
+ * @return 1 se mapeado; 0 caso contrário.
+ */
+int entradaMapeada(ArquivoEntrada* a) {
+    return a->mapa != NULL;
+}
+
+/**
+ * @brief Volta a leitura para o início do arquivo.
+ * @details Pipes e FIFOs não voltam: quem lê a entrada duas vezes deve chamar esta função antes da
+ *          primeira leitura, para recusá-los sem consumir nada.
+ * @param a Arquivo aberto.
+ * @return 0 em sucesso; -1 se o arquivo não for posicionável (errno indica a causa).
+ */
+int reiniciaArquivoEntrada(ArquivoEntrada* a) {
+    if (a->mapa) {
+        a->pos = 0;
+        return 0;
+    }
+    // Ao contrário de rewind, fseeko informa a falha (ESPIPE em pipes)
+    return fseeko(a->arquivo, 0, SEEK_SET) == 0 ? 0 : -1;
+}
+
+/**
+ * @brief Indica se houve erro de leitura.
+ * @param a Arquivo aberto.
+ * @return Diferente de zero em caso de erro.
+ */
+int erroArquivoEntrada(ArquivoEntrada* a) {
+    return a->erro;
+}
+
+/**
+ * @brief Desfaz o mapeamento (ou fecha o arquivo) e libera a estrutura.
+ * @param a Arquivo (pode ser NULL).
+ */
+void fechaArquivoEntrada(ArquivoEntrada* a) {
+    if (a == NULL) {
+        return;
+    }
+#ifdef USA_MMAP
+    if (a->mapa && a->tamanhoMapa > 0) {
+        munmap((void*) a->mapa, a->tamanhoMapa);
+    }
+#endif
+    if (a->arquivo) {
+        fclose(a->arquivo);
+    }
+    free(a->buffer);
+    free(a);
+}
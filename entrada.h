@@ -0,0 +1,75 @@
+#ifndef ENTRADA_H
+#define ENTRADA_H
+
+#include <stddef.h>
+
+typedef struct arquivoEntrada ArquivoEntrada;
+
+/**
+ * @brief Abre um arquivo para leitura sequencial em blocos grandes.
+ * @details Sempre que possível o arquivo é mapeado em memória e os blocos são fatias do mapeamento,
+ *          sem cópia; caso contrário, os blocos são lidos com fread para um buffer interno.
+ * @param nomeArquivo Caminho do arquivo.
+ * @return Arquivo aberto ou NULL em erro (errno indica a causa).
+ */
+ArquivoEntrada* abreArquivoEntrada(const char* nomeArquivo);
+
+/**
+ * @brief Como abreArquivoEntrada, para um descritor já aberto para leitura (sistemas POSIX).
+ * @details Um pipe ou FIFO é lido pelo mesmo descritor, sem reabrir o caminho (o que perderia os
+ *          dados já enviados e poderia encerrar quem escreve).
+ * @param fd Descritor; passa a pertencer ao arquivo, inclusive em caso de erro.
+ * @return Arquivo aberto ou NULL em erro (errno indica a causa).
+ */
+ArquivoEntrada* abreDescritorEntrada(int fd);
+
+/**
+ * @brief Obtém o próximo bloco do arquivo.
+ * @param a Arquivo aberto.
+ * @param bloco Recebe o endereço do bloco (válido até a próxima chamada).
+ * @return Quantidade de bytes no bloco; 0 no fim do arquivo.
+ */
+size_t leBlocoEntrada(ArquivoEntrada* a, const unsigned char** bloco);
+
+/**
+ * @brief Obtém os próximos @p tamanho bytes do arquivo (menos apenas no fim).
+ * @details Com o arquivo mapeado o trecho aponta para o mapeamento; caso contrário os bytes são lidos
+ *          em @p destino, que deve ter ao menos @p tamanho bytes.
+ * @param a Arquivo aberto.
+ * @param tamanho Bytes desejados.
+ * @param destino Buffer usado quando o arquivo não está mapeado.
+ * @param trecho Recebe o endereço dos bytes.
+ * @return Quantidade de bytes obtidos; 0 no fim do arquivo.
+ */
+size_t leTrechoEntrada(ArquivoEntrada* a, size_t tamanho, unsigned char* destino, const unsigned char** trecho);
+
+/**
+ * @brief Indica se os trechos apontam para o arquivo mapeado (sem necessidade de buffer próprio).
+ * @param a Arquivo aberto.
+ * @return 1 se mapeado; 0 caso contrário.
+ */
+int entradaMapeada(ArquivoEntrada* a);
+
+/**
+ * @brief Volta a leitura para o início do arquivo.
+ * @details Pipes e FIFOs não voltam: quem lê a entrada duas vezes deve chamar esta função antes da
+ *          primeira leitura, para recusá-los sem consumir nada.
+ * @param a Arquivo aberto.
+ * @return 0 em sucesso; -1 se o arquivo não for posicionável (errno indica a causa).
+ */
+int reiniciaArquivoEntrada(ArquivoEntrada* a);
+
+/**
+ * @brief Indica se houve erro de leitura.
+ * @param a Arquivo aberto.
+ * @return Diferente de zero em caso de erro.
+ */
+int erroArquivoEntrada(ArquivoEntrada* a);
+
+/**
+ * @brief Desfaz o mapeamento (ou fecha o arquivo) e libera a estrutura.
+ * @param a Arquivo (pode ser NULL).
+ */
+void fechaArquivoEntrada(ArquivoEntrada* a);
+
+#endif
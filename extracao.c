@@ -0,0 +1,163 @@
+#define _FILE_OFFSET_BITS 64
+#include "extracao.h"
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include "bloco.h"
+
+/**
+ * @brief Lê @p n bytes a partir de @p offset.
+ * @return 0 em sucesso; -1 em erro ou fim prematuro do arquivo.
+ */
+static int leEm(FILE* entrada, unsigned long long int offset, unsigned char* destino, size_t n) {
+    if (fseeko(entrada, (off_t) offset, SEEK_SET) != 0 || fread(destino, 1, n, entrada) != n) {
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Grava em @p saida os bytes [de, ate) de um bloco sem código: lidos direto de um
+ *        BLOCO_ARMAZENADO ou preenchidos com o byte de um BLOCO_REPETIDO.
+ * @return 0 em sucesso; -1 em erro de E/S ou falta de memória.
+ */
+static int extraiSemCodigo(FILE* entrada, const EntradaIndice* e, const CabecalhoBloco* c,
+                           unsigned int de, unsigned int ate, FILE* saida) {
+    size_t n = ate - de;
+    unsigned char* destino = (unsigned char*) malloc(n);
+    int resultado = -1;
+    if (destino == NULL) {
+        return -1;
+    }
+    if (c->tipo == BLOCO_ARMAZENADO) {
+        resultado = leEm(entrada, e->offset + TAMANHO_CABECALHO_BLOCO + de, destino, n);
+    } else if ((resultado = leEm(entrada, e->offset + TAMANHO_CABECALHO_BLOCO, destino, 1)) == 0) {
+        memset(destino, destino[0], n);
+    }
+    if (resultado == 0 && fwrite(destino, 1, n, saida) != n) {
+        resultado = -1;
+    }
+    free(destino);
+    return resultado;
+}
+
+/**
+ * @brief Grava em @p saida os bytes [de, ate) de um bloco sem pontos de acesso (ver blocoLidoInteiro):
+ *        o corpo é lido e descompactado inteiro.
+ * @return 0 em sucesso; -1 se o bloco estiver corrompido, houver erro de E/S ou faltar memória.
+ */
+static int extraiBlocoInteiro(Decodificador* d, const Dicionario* dicionario, FILE* entrada, const EntradaIndice* e,
+                              const CabecalhoBloco* c, unsigned int de, unsigned int ate, FILE* saida) {
+    size_t tamanhoCorpo = (size_t) tamanhoCorpoBloco(c);
+    if (tamanhoCodificadoBloco(c) >= c->tamanhoOriginal) {
+        return -1;
+    }
+    unsigned char* corpo = (unsigned char*) malloc(tamanhoCorpo);
+    unsigned char* destino = (unsigned char*) malloc(c->tamanhoOriginal);
+    int resultado = -1;
+
+    if (corpo && destino && leEm(entrada, e->offset + TAMANHO_CABECALHO_BLOCO, corpo, tamanhoCorpo) == 0 &&
+        descompactaBloco(d, dicionario, c, corpo, destino, NULL) == 0) {
+        size_t n = ate - de;
+        resultado = fwrite(destino + de, 1, n, saida) == n ? 0 : -1;
+    }
+    free(corpo);
+    free(destino);
+    return resultado;
+}
+
+/**
+ * @brief Grava em @p saida os bytes [de, ate) do bloco @p e, decodificando a partir do ponto de acesso
+ *        mais próximo.
+ * @return 0 em sucesso; -1 se o bloco estiver corrompido ou houver erro de E/S.
+ */
+static int extraiDoBloco(Decodificador* d, const Dicionario* dicionario, FILE* entrada, const IndiceBlocos* indice,
+                         const EntradaIndice* e, unsigned int de, unsigned int ate, FILE* saida) {
+    unsigned char bytesCabecalho[TAMANHO_CABECALHO_BLOCO];
+    CabecalhoBloco c;
+    if (leEm(entrada, e->offset, bytesCabecalho, TAMANHO_CABECALHO_BLOCO) < 0) {
+        return -1;
+    }
+    decodificaCabecalhoBloco(bytesCabecalho, &c);
+    if (c.tamanhoOriginal != e->tamanhoOriginal || c.bitsDados != e->bitsDados) {
+        return -1;
+    }
+
+    if (blocoSemCodigo(&c)) {
+        return extraiSemCodigo(entrada, e, &c, de, ate, saida);
+    }
+    if (blocoLidoInteiro(&c)) {
+        return extraiBlocoInteiro(d, dicionario, entrada, e, &c, de, ate, saida);
+    }
+
+    // Trecho dos dados entre o ponto anterior a 'de' e o ponto seguinte a 'ate - 1'; um bloco sem
+    // pontos é lido desde o início
+    unsigned int intervalo = indice->intervaloPontos;
+    unsigned int numPontos = e->numPontos;
+    const unsigned long long int* pontos = indice->pontos + e->primeiroPonto;
+    unsigned int primeiro = numPontos > 0 ? de / intervalo : 0;
+    unsigned int ultimo = numPontos > 0 ? (ate - 1) / intervalo + 1 : 1;
+    unsigned long long int bitInicial = primeiro > 0 ? pontos[primeiro - 1] : 0;
+    unsigned long long int bitFinal = ultimo <= numPontos ? pontos[ultimo - 1] : c.bitsDados;
+    unsigned int simboloInicial = primeiro * intervalo;
+
+    size_t bytesArvore = (c.tamanhoArvore + 7) / 8;
+    unsigned long long int byteInicial = bitInicial / 8;
+    size_t bytesDados = (size_t) ((bitFinal + 7) / 8 - byteInicial);
+    size_t bytesSaida = ate - simboloInicial;
+    unsigned char* arvore = (unsigned char*) malloc(bytesArvore > 0 ? bytesArvore : 1);
+    unsigned char* dados = (unsigned char*) malloc(bytesDados > 0 ? bytesDados : 1);
+    unsigned char* destino = (unsigned char*) malloc(bytesSaida);
+    int resultado = -1;
+
+    if (arvore && dados && destino &&
+        leEm(entrada, e->offset + TAMANHO_CABECALHO_BLOCO, arvore, bytesArvore) == 0 &&
+        leEm(entrada, e->offset + TAMANHO_CABECALHO_BLOCO + bytesArvore + byteInicial, dados, bytesDados) == 0) {
+        Decodificador* tabelas = decodificadorBloco(d, dicionario, &c, arvore);
+        if (tabelas != NULL &&
+            decodificaTrecho(tabelas, dados, bitFinal - 8 * byteInicial, bitInicial % 8, destino, bytesSaida) == 0) {
+            size_t n = ate - de;
+            resultado = fwrite(destino + (de - simboloInicial), 1, n, saida) == n ? 0 : -1;
+        }
+    }
+    free(arvore);
+    free(dados);
+    free(destino);
+    return resultado;
+}
+
+/**
+ * @brief Descompacta apenas os bytes [inicio, inicio + tamanho) do original.
+ * @details Localiza pelo índice os blocos que cobrem o intervalo e, em cada um, começa no ponto de
+ *          acesso anterior ao primeiro byte pedido; só são lidos a árvore do bloco e os dados entre
+ *          esse ponto e o ponto seguinte ao último byte pedido.
+ * @param d Decodificador usado como área de trabalho (ver criaDecodificadorVazio).
+ * @param dicionario Dicionário para blocos BLOCO_DICIONARIO (pode ser NULL).
+ * @param entrada Arquivo no formato em blocos, aberto e posicionável; a posição é alterada.
+ * @param indice Índice lido com leIndice.
+ * @param inicio Posição do primeiro byte nos dados originais.
+ * @param tamanho Quantidade de bytes; o intervalo é limitado ao fim dos dados.
+ * @param saida Arquivo de saída aberto (binário).
+ * @return Quantidade de bytes gravados; -1 se o arquivo estiver corrompido ou houver erro de E/S.
+ */
+long long int extraiTrecho(Decodificador* d, const Dicionario* dicionario, FILE* entrada, const IndiceBlocos* indice,
+                           unsigned long long int inicio, unsigned long long int tamanho, FILE* saida) {
+    long long int i = buscaBlocoIndice(indice, inicio);
+    if (i < 0 || tamanho == 0) {
+        return 0;
+    }
+    unsigned long long int fim = inicio + tamanho < inicio ? ~0ULL : inicio + tamanho;
+    unsigned long long int pos = inicio;
+
+    for (; (unsigned long long int) i < indice->numBlocos && pos < fim; i++) {
+        const EntradaIndice* e = &indice->entradas[i];
+        unsigned long long int fimBloco = e->offsetOriginal + e->tamanhoOriginal;
+        unsigned int de = (unsigned int) (pos - e->offsetOriginal);
+        unsigned int ate = (unsigned int) ((fim < fimBloco ? fim : fimBloco) - e->offsetOriginal);
+        if (de < ate && extraiDoBloco(d, dicionario, entrada, indice, e, de, ate, saida) < 0) {
+            return -1;
+        }
+        pos = e->offsetOriginal + ate;
+    }
+    return (long long int) (pos - inicio);
+}
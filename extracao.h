@@ -0,0 +1,26 @@
+#ifndef EXTRACAO_H
+#define EXTRACAO_H
+
+#include <stdio.h>
+#include "container.h"
+#include "decodificador.h"
+#include "dicionario.h"
+
+/**
+ * @brief Descompacta apenas os bytes [inicio, inicio + tamanho) do original.
+ * @details Localiza pelo índice os blocos que cobrem o intervalo e, em cada um, começa no ponto de
+ *          acesso anterior ao primeiro byte pedido; só são lidos a árvore do bloco e os dados entre
+ *          esse ponto e o ponto seguinte ao último byte pedido.
+ * @param d Decodificador usado como área de trabalho (ver criaDecodificadorVazio).
+ * @param dicionario Dicionário para blocos BLOCO_DICIONARIO (pode ser NULL).
+ * @param entrada Arquivo no formato em blocos, aberto e posicionável; a posição é alterada.
+ * @param indice Índice lido com leIndice.
+ * @param inicio Posição do primeiro byte nos dados originais.
+ * @param tamanho Quantidade de bytes; o intervalo é limitado ao fim dos dados.
+ * @param saida Arquivo de saída aberto (binário).
+ * @return Quantidade de bytes gravados; -1 se o arquivo estiver corrompido ou houver erro de E/S.
+ */
+long long int extraiTrecho(Decodificador* d, const Dicionario* dicionario, FILE* entrada, const IndiceBlocos* indice,
+                           unsigned long long int inicio, unsigned long long int tamanho, FILE* saida);
+
+#endif
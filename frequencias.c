@@ -0,0 +1,50 @@
+#include "frequencias.h"
+#include <string.h>
+
+#define HISTOGRAMAS 8
+#define MAX_POR_LOTE (1u << 30)  // Limite por lote para os contadores de 32 bits não transbordarem
+
+/**
+ * @brief Conta um lote de até MAX_POR_LOTE bytes nos histogramas intercalados.
+ */
+static void contaLote(const unsigned char* dados, size_t n, unsigned int hist[HISTOGRAMAS][256]) {
+    size_t i = 0;
+    // 16 bytes por iteração, distribuídos entre os 8 histogramas
+    for (; i + 16 <= n; i += 16) {
+        const unsigned char* p = dados + i;
+        hist[0][p[0]]++;  hist[1][p[1]]++;  hist[2][p[2]]++;  hist[3][p[3]]++;
+        hist[4][p[4]]++;  hist[5][p[5]]++;  hist[6][p[6]]++;  hist[7][p[7]]++;
+        hist[0][p[8]]++;  hist[1][p[9]]++;  hist[2][p[10]]++; hist[3][p[11]]++;
+        hist[4][p[12]]++; hist[5][p[13]]++; hist[6][p[14]]++; hist[7][p[15]]++;
+    }
+    for (; i < n; i++) {
+        hist[0][dados[i]]++;
+    }
+}
+
+/**
+ * @brief Acumula em @p frequencias a contagem de cada byte (0..255) de @p dados.
+ * @details Usa oito histogramas intercalados, somados ao final, para que bytes repetidos em
+ *          sequência não fiquem esperando o incremento anterior do mesmo contador.
+ * @param dados Bytes a contar.
+ * @param n Quantidade de bytes.
+ * @param frequencias Vetor de 256 posições; os valores são somados ao conteúdo atual.
+ */
+void contaFrequencias(const unsigned char* dados, size_t n, unsigned long long int* frequencias) {
+    unsigned int hist[HISTOGRAMAS][256];
+
+    while (n > 0) {
+        size_t lote = n < MAX_POR_LOTE ? n : MAX_POR_LOTE;
+        memset(hist, 0, sizeof(hist));
+        contaLote(dados, lote, hist);
+        for (int c = 0; c < 256; c++) {
+            unsigned long long int soma = 0;
+            for (int h = 0; h < HISTOGRAMAS; h++) {
+                soma += hist[h][c];
+            }
+            frequencias[c] += soma;
+        }
+        dados += lote;
+        n -= lote;
+    }
+}
@@ -0,0 +1,16 @@
+#ifndef FREQUENCIAS_H
+#define FREQUENCIAS_H
+
+#include <stddef.h>
+
+/**
+ * @brief Acumula em @p frequencias a contagem de cada byte (0..255) de @p dados.
+ * @details Usa oito histogramas intercalados, somados ao final, para que bytes repetidos em
+ *          sequência não fiquem esperando o incremento anterior do mesmo contador.
+ * @param dados Bytes a contar.
+ * @param n Quantidade de bytes.
+ * @param frequencias Vetor de 256 posições; os valores são somados ao conteúdo atual.
+ */
+void contaFrequencias(const unsigned char* dados, size_t n, unsigned long long int* frequencias);
+
+#endif
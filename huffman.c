@@ -0,0 +1,468 @@
+#include "huffman.h"
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Ordem das folhas: frequência crescente e, em empate, byte crescente.
+ */
+static int comparaFolhas(const void* a, const void* b) {
+    const NoHuffman* x = (const NoHuffman*) a;
+    const NoHuffman* y = (const NoHuffman*) b;
+    if (x->frequencia != y->frequencia) {
+        return x->frequencia < y->frequencia ? -1 : 1;
+    }
+    return (int) x->caractere - (int) y->caractere;
+}
+
+/**
+ * @brief Insere o nó @p no na fila ordem[inicio..*fim), ordenada por frequência, na posição em que a
+ *        lista encadeada do formato antigo o punha.
+ * @details Um nó de frequência menor que a do primeiro entra no início; senão, entra antes do primeiro
+ *          nó seguinte ao primeiro com frequência maior ou igual. É essa ordem entre empates que
+ *          decide a forma da árvore, e com ela os bytes do formato --legado.
+ */
+static void insereOrdenado(const NoHuffman* nos, short* ordem, int inicio, int* fim, short no) {
+    unsigned long long int frequencia = nos[no].frequencia;
+    int pos = inicio;
+    if (inicio < *fim && frequencia >= nos[ordem[inicio]].frequencia) {
+        // Busca binária do primeiro nó, depois do primeiro, com frequência >= a do novo
+        int a = inicio + 1, b = *fim;
+        while (a < b) {
+            int meio = a + (b - a) / 2;
+            if (nos[ordem[meio]].frequencia < frequencia) {
+                a = meio + 1;
+            } else {
+                b = meio;
+            }
+        }
+        pos = a;
+    }
+    memmove(ordem + pos + 1, ordem + pos, (size_t) (*fim - pos) * sizeof(short));
+    ordem[pos] = no;
+    (*fim)++;
+}
+
+/**
+ * @brief Constrói a árvore de Huffman para as frequências dadas.
+ * @details Os nós ficam num vetor de índices ordenado por frequência, com os empates na ordem da lista
+ *          encadeada original (insereOrdenado): as folhas entram em ordem de byte e cada nó interno
+ *          une os dois primeiros. Assim a árvore, e a saída do formato antigo, é a mesma de antes.
+ *          Com um único símbolo presente, um nó fictício de frequência 0 é acrescentado para que o
+ *          símbolo receba um código de 1 bit; sem nenhum símbolo, a árvore é uma folha '\0'.
+ * @param frequencias Vetor de 256 frequências.
+ * @param arvore Árvore de saída.
+ */
+void construirArvoreHuffman(const unsigned long long int* frequencias, ArvoreHuffman* arvore) {
+    NoHuffman* nos = arvore->nos;
+    // Cada nó entra uma vez e sai do início: a fila só avança
+    short ordem[MAX_NOS_HUFFMAN + 1];
+    int inicio = 0, fim = 0;
+    int numFolhas = 0;
+
+    for (int i = 0; i < 256; i++) {
+        if (frequencias[i] > 0) {
+            nos[numFolhas].frequencia = frequencias[i];
+            nos[numFolhas].caractere = (unsigned char) i;
+            nos[numFolhas].esq = nos[numFolhas].dir = NO_NULO;
+            insereOrdenado(nos, ordem, inicio, &fim, (short) numFolhas);
+            numFolhas++;
+        }
+    }
+
+    // Caso especial: arquivo vazio ou com apenas 1 tipo de caractere
+    if (numFolhas < 2) {
+        // Adiciona um nó fictício com frequência 0, usando o primeiro caractere não usado
+        unsigned char charFicticio = 0;
+        for (int i = 0; i < 256; i++) {
+            if (frequencias[i] == 0) {
+                charFicticio = (unsigned char) i;
+                break;
+            }
+        }
+        nos[numFolhas].frequencia = 0;
+        nos[numFolhas].caractere = charFicticio;
+        nos[numFolhas].esq = nos[numFolhas].dir = NO_NULO;
+        insereOrdenado(nos, ordem, inicio, &fim, (short) numFolhas);
+        numFolhas++;
+        if (numFolhas == 1) {
+            arvore->numNos = 1;
+            arvore->raiz = 0;
+            return;
+        }
+    }
+
+    int numNos = numFolhas;
+    while (fim - inicio > 1) {
+        short esq = ordem[inicio++];
+        short dir = ordem[inicio++];
+        nos[numNos].frequencia = nos[esq].frequencia + nos[dir].frequencia;
+        nos[numNos].caractere = '\0';
+        nos[numNos].esq = esq;
+        nos[numNos].dir = dir;
+        insereOrdenado(nos, ordem, inicio, &fim, (short) numNos);
+        numNos++;
+    }
+
+    arvore->numNos = (short) numNos;
+    arvore->raiz = (short) (numNos - 1);
+}
+/**
+ * @brief Percorre a árvore (pré-ordem) acumulando 0 (esq) e 1 (dir) até folhas.
+ * @param nos Nós da árvore.
+ * @param no Índice do nó atual.
+ * @param dicionario Vetor de 256 códigos a preencher.
+ * @param caminhoAtual Bits do caminho acumulado (o último passo no bit menos significativo).
+ * @param profundidade Quantidade de bits em @p caminhoAtual.
+ * @return 0 em sucesso; -1 se o caminho passar de TAMANHO_MAX_CODIGO bits.
+ */
+
+static int preencherDicionarioRecursivo(const NoHuffman* nos, int no, Codigo dicionario[],
+                                        unsigned long long int caminhoAtual, int profundidade) {
+    if (nos[no].esq == NO_NULO) {
+        unsigned char c = nos[no].caractere;
+        dicionario[c].bits = caminhoAtual;
+        dicionario[c].tamanho = (unsigned char) profundidade;
+        return 0;
+    }
+
+    if (profundidade == TAMANHO_MAX_CODIGO) {
+        return -1;
+    }
+
+    // Navega para a esquerda com 0
+    if (preencherDicionarioRecursivo(nos, nos[no].esq, dicionario, caminhoAtual << 1, profundidade + 1) < 0) {
+        return -1;
+    }
+
+    // Navega para a direita com 1
+    return preencherDicionarioRecursivo(nos, nos[no].dir, dicionario, (caminhoAtual << 1) | 1, profundidade + 1);
+}
+/**
+ * @brief Cria o dicionário de códigos binários (bits e tamanho) para cada byte presente.
+ * @details Caso a árvore possua uma única folha (apenas um símbolo), o símbolo recebe código "0".
+ * @param dicionario Vetor de 256 códigos; símbolos ausentes ficam com tamanho 0.
+ * @param arvore Árvore de Huffman.
+ * @return 0 em sucesso; -1 se algum código passar de TAMANHO_MAX_CODIGO bits.
+ */
+
+int gerarDicionario(Codigo dicionario[], const ArvoreHuffman* arvore) {
+    const NoHuffman* raiz = &arvore->nos[arvore->raiz];
+
+    // Caso especial: árvore com apenas um nó (arquivo vazio)
+    if (raiz->esq == NO_NULO) {
+        dicionario[raiz->caractere].bits = 0;  // Código arbitrário "0"
+        dicionario[raiz->caractere].tamanho = 1;
+        return 0;
+    }
+    
+    return preencherDicionarioRecursivo(arvore->nos, arvore->raiz, dicionario, 0, 0);
+}
+/**
+ * @brief Acrescenta a subárvore de @p no ao bitmap, em pré-ordem.
+ */
+
+static void serializarNo(const NoHuffman* nos, int no, bitmap* bm) {
+    if (nos[no].esq == NO_NULO) {
+        // Bit 1 indica folha
+        bitmapAppendLeastSignificantBit(bm, 1);
+        
+        // Escreve o caractere (8 bits)
+        unsigned char c = nos[no].caractere;
+        for (int i = 7; i >= 0; i--) {
+            unsigned char bit = (c >> i) & 1;
+            bitmapAppendLeastSignificantBit(bm, bit);
+        }
+    } else {
+        // Bit 0 indica nó interno
+        bitmapAppendLeastSignificantBit(bm, 0);
+        serializarNo(nos, nos[no].esq, bm);
+        serializarNo(nos, nos[no].dir, bm);
+    }
+}
+/**
+ * @brief Serializa a árvore em pré-ordem no bitmap.
+ * @details Protocolo: 1 bit = 1 para folha + 8 bits do caractere; 0 para nó interno.
+ * @param arvore Árvore de Huffman.
+ * @param bm Bitmap de saída (capacidade mínima TAMANHO_MAX_ARVORE_BITS).
+ */
+
+void serializarArvore(const ArvoreHuffman* arvore, bitmap* bm) {
+    serializarNo(arvore->nos, arvore->raiz, bm);
+}
+/**
+ * @brief Lê o bit @p posicao de @p bytes (mais significativo primeiro em cada byte).
+ */
+static inline int bitSerializado(const unsigned char* bytes, unsigned int posicao) {
+    return (bytes[posicao >> 3] >> (7 - (posicao & 7))) & 1;
+}
+
+/**
+ * @brief Reconstrói a árvore gravada por serializarArvore, validando a estrutura durante a leitura.
+ * @details Percorre a pré-ordem sem recursão: uma pilha guarda os nós internos que ainda esperam
+ *          um filho, e cada nó lido vira o filho esquerdo (ou, se esse já existe, o direito) do nó do
+ *          topo. A leitura para quando a raiz fica completa. A árvore é rejeitada se os bits acabarem
+ *          antes disso ou sobrarem depois, se passar de MAX_NOS_HUFFMAN nós ou de TAMANHO_MAX_CODIGO
+ *          níveis, ou se um byte aparecer em duas folhas. Não usa memória dinâmica.
+ * @param bytes Árvore serializada (mais significativo primeiro em cada byte).
+ * @param tamanhoBits Quantidade de bits válidos.
+ * @param arvore Recebe a árvore (frequências zeradas; a raiz é o nó 0).
+ * @return 0 em sucesso; -1 se os bits não descreverem uma árvore válida.
+ */
+
+int leArvoreHuffman(const unsigned char* bytes, unsigned int tamanhoBits, ArvoreHuffman* arvore) {
+    NoHuffman* nos = arvore->nos;
+    // Nós internos à espera de filhos: estão todos no caminho da raiz ao próximo nó, um por nível
+    short pendentes[TAMANHO_MAX_CODIGO + 1];
+    unsigned char profundidade[MAX_NOS_HUFFMAN];
+    int topo = 0;
+    unsigned char vistos[256] = {0};
+    unsigned int posicao = 0;
+    int numNos = 0;
+
+    do {
+        if (posicao >= tamanhoBits || numNos == MAX_NOS_HUFFMAN) {
+            return -1;
+        }
+        NoHuffman* no = &nos[numNos];
+        no->frequencia = 0;
+        no->esq = NO_NULO;
+        no->dir = NO_NULO;
+        no->caractere = 0;
+        int folha = bitSerializado(bytes, posicao++);
+        if (folha) {
+            if (tamanhoBits - posicao < 8) {
+                return -1;
+            }
+            unsigned int caractere = 0;
+            for (int i = 0; i < 8; i++) {
+                caractere = (caractere << 1) | (unsigned int) bitSerializado(bytes, posicao++);
+            }
+            if (vistos[caractere]) {
+                return -1;
+            }
+            vistos[caractere] = 1;
+            no->caractere = (unsigned char) caractere;
+        }
+
+        // Liga o nó ao pai; um pai com os dois filhos sai da pilha
+        profundidade[numNos] = 0;
+        if (topo > 0) {
+            NoHuffman* pai = &nos[pendentes[topo - 1]];
+            profundidade[numNos] = profundidade[pendentes[topo - 1]] + 1;
+            if (profundidade[numNos] > TAMANHO_MAX_CODIGO) {
+                return -1;
+            }
+            if (pai->esq == NO_NULO) {
+                pai->esq = (short) numNos;
+            } else {
+                pai->dir = (short) numNos;
+                topo--;
+            }
+        }
+        if (!folha) {
+            pendentes[topo++] = (short) numNos;
+        }
+        numNos++;
+    } while (topo > 0);
+
+    if (posicao != tamanhoBits) {
+        return -1;
+    }
+    arvore->numNos = (short) numNos;
+    arvore->raiz = 0;
+    return 0;
+}
+/**
+ * @brief Calcula comprimentos de código ótimos limitados a @p comprimentoMax bits (package-merge).
+ * @details Os símbolos presentes são ordenados por (frequência, byte). Para cada nível, de baixo para
+ *          cima, os itens do nível inferior são agrupados em pares ("pacotes") e intercalados com as
+ *          folhas; os 2n-2 primeiros itens do nível mais alto, expandidos, dizem quantas vezes cada
+ *          folha aparece, que é o comprimento do seu código. Com um único símbolo presente, ele recebe
+ *          comprimento 1.
+ * @param frequencias Vetor de 256 frequências.
+ * @param comprimentoMax Limite, de COMPRIMENTO_MIN_CANONICO a COMPRIMENTO_MAX_CANONICO.
+ * @param comprimentos Recebe o comprimento de cada byte (0 para ausentes).
+ */
+
+void calcularComprimentosLimitados(const unsigned long long int* frequencias, int comprimentoMax,
+                                   unsigned char comprimentos[]) {
+    NoHuffman folhas[256];
+    int n = 0;
+    for (int i = 0; i < 256; i++) {
+        comprimentos[i] = 0;
+        if (frequencias[i] > 0) {
+            folhas[n].frequencia = frequencias[i];
+            folhas[n].caractere = (unsigned char) i;
+            n++;
+        }
+    }
+    if (n < 2) {
+        if (n == 1) {
+            comprimentos[folhas[0].caractere] = 1;
+        }
+        return;
+    }
+    qsort(folhas, n, sizeof(NoHuffman), comparaFolhas);
+
+    // Nível 0 é o mais profundo; cada nível guarda o peso de cada item e se ele é um pacote
+    unsigned long long int pesos[COMPRIMENTO_MAX_CANONICO][2 * 256];
+    unsigned char ehPacote[COMPRIMENTO_MAX_CANONICO][2 * 256];
+    int tamanho[COMPRIMENTO_MAX_CANONICO];
+
+    for (int i = 0; i < n; i++) {
+        pesos[0][i] = folhas[i].frequencia;
+        ehPacote[0][i] = 0;
+    }
+    tamanho[0] = n;
+    for (int nivel = 1; nivel < comprimentoMax; nivel++) {
+        const unsigned long long int* abaixo = pesos[nivel - 1];
+        int numPacotes = tamanho[nivel - 1] / 2;
+        int f = 0, p = 0, t = 0;
+        while (f < n || p < numPacotes) {
+            unsigned long long int pesoPacote = p < numPacotes ? abaixo[2 * p] + abaixo[2 * p + 1] : 0;
+            if (p == numPacotes || (f < n && folhas[f].frequencia <= pesoPacote)) {
+                pesos[nivel][t] = folhas[f++].frequencia;
+                ehPacote[nivel][t++] = 0;
+            } else {
+                pesos[nivel][t] = pesoPacote;
+                ehPacote[nivel][t++] = 1;
+                p++;
+            }
+        }
+        tamanho[nivel] = t;
+    }
+
+    // Os pacotes escolhidos em um nível são sempre os primeiros pares do nível inferior
+    int escolhidos = 2 * n - 2;
+    for (int nivel = comprimentoMax - 1; nivel >= 0 && escolhidos > 0; nivel--) {
+        int folha = 0, pacotes = 0;
+        for (int i = 0; i < escolhidos; i++) {
+            if (ehPacote[nivel][i]) {
+                pacotes++;
+            } else {
+                comprimentos[folhas[folha++].caractere]++;
+            }
+        }
+        escolhidos = 2 * pacotes;
+    }
+}
+/**
+ * @brief Atribui os códigos canônicos: em ordem de (comprimento, byte), cada código é o anterior
+ *        mais 1, deslocado à esquerda quando o comprimento aumenta.
+ * @param dicionario Vetor de 256 códigos; símbolos ausentes ficam com tamanho 0.
+ * @param comprimentos Comprimento de cada byte (0 para ausentes).
+ */
+
+void gerarDicionarioCanonico(Codigo dicionario[], const unsigned char comprimentos[]) {
+    unsigned int quantidade[COMPRIMENTO_MAX_CANONICO + 1] = {0};
+    unsigned long long int proximo[COMPRIMENTO_MAX_CANONICO + 1];
+    for (int i = 0; i < 256; i++) {
+        quantidade[comprimentos[i]]++;
+    }
+    unsigned long long int codigo = 0;
+    quantidade[0] = 0;
+    for (int len = 1; len <= COMPRIMENTO_MAX_CANONICO; len++) {
+        codigo = (codigo + quantidade[len - 1]) << 1;
+        proximo[len] = codigo;
+    }
+    for (int i = 0; i < 256; i++) {
+        dicionario[i].tamanho = comprimentos[i];
+        dicionario[i].bits = comprimentos[i] ? proximo[comprimentos[i]]++ : 0;
+    }
+}
+/**
+ * @brief Acrescenta os 4 bits menos significativos de @p valor ao bitmap.
+ */
+
+static void acrescentaNibble(bitmap* bm, unsigned int valor) {
+    for (int i = 3; i >= 0; i--) {
+        bitmapAppendLeastSignificantBit(bm, (valor >> i) & 1);
+    }
+}
+/**
+ * @brief Serializa os 256 comprimentos em 4 bits cada; um 0 é seguido de 4 bits com a quantidade
+ *        de zeros adicionais (0 a 15), de modo que alfabetos esparsos ocupam pouco.
+ * @param comprimentos Comprimento de cada byte (no máximo COMPRIMENTO_MAX_CANONICO).
+ * @param bm Bitmap de saída (capacidade mínima TAMANHO_MAX_COMPRIMENTOS_BITS).
+ */
+
+void serializarComprimentos(const unsigned char comprimentos[], bitmap* bm) {
+    int i = 0;
+    while (i < 256) {
+        if (comprimentos[i] != 0) {
+            acrescentaNibble(bm, comprimentos[i++]);
+            continue;
+        }
+        int zeros = 1;
+        while (i + zeros < 256 && zeros < 16 && comprimentos[i + zeros] == 0) {
+            zeros++;
+        }
+        acrescentaNibble(bm, 0);
+        acrescentaNibble(bm, zeros - 1);
+        i += zeros;
+    }
+}
+/**
+ * @brief Lê os comprimentos gravados por serializarComprimentos a partir do bit @p posicao e valida o
+ *        código resultante.
+ * @param bytes Bits serializados (mais significativo primeiro em cada byte).
+ * @param tamanhoBits Quantidade de bits válidos em @p bytes.
+ * @param posicao Bit inicial, múltiplo de 4; recebe o bit seguinte aos comprimentos.
+ * @param comprimentos Recebe os 256 comprimentos.
+ * @return 0 em sucesso; -1 se os bits acabarem antes dos 256 comprimentos ou se eles não formarem
+ *         um código de prefixo.
+ */
+
+int leComprimentosEm(const unsigned char* bytes, unsigned int tamanhoBits, unsigned int* posicao,
+                     unsigned char comprimentos[]) {
+    unsigned int p = *posicao;
+    int i = 0;
+    while (i < 256) {
+        if (p + 4 > tamanhoBits) {
+            return -1;
+        }
+        unsigned int valor = (bytes[p / 8] >> (4 - p % 8)) & 0xF;
+        p += 4;
+        if (valor != 0) {
+            comprimentos[i++] = (unsigned char) valor;
+            continue;
+        }
+        if (p + 4 > tamanhoBits) {
+            return -1;
+        }
+        int zeros = ((bytes[p / 8] >> (4 - p % 8)) & 0xF) + 1;
+        p += 4;
+        if (i + zeros > 256) {
+            return -1;
+        }
+        while (zeros-- > 0) {
+            comprimentos[i++] = 0;
+        }
+    }
+    *posicao = p;
+
+    // Desigualdade de Kraft: a soma de 2^-comprimento não pode passar de 1
+    unsigned long long int kraft = 0;
+    for (i = 0; i < 256; i++) {
+        if (comprimentos[i]) {
+            kraft += 1ULL << (COMPRIMENTO_MAX_CANONICO - comprimentos[i]);
+        }
+    }
+    return kraft <= (1ULL << COMPRIMENTO_MAX_CANONICO) ? 0 : -1;
+}
+/**
+ * @brief Lê os comprimentos gravados por serializarComprimentos e valida o código resultante.
+ * @param bytes Comprimentos serializados (mais significativo primeiro em cada byte).
+ * @param tamanhoBits Quantidade de bits válidos.
+ * @param comprimentos Recebe os 256 comprimentos.
+ * @return 0 em sucesso; -1 se os bits não descreverem exatamente 256 comprimentos ou se os
+ *         comprimentos não formarem um código de prefixo.
+ */
+
+int leComprimentos(const unsigned char* bytes, unsigned int tamanhoBits, unsigned char comprimentos[]) {
+    unsigned int posicao = 0;
+    if (leComprimentosEm(bytes, tamanhoBits, &posicao, comprimentos) < 0) {
+        return -1;
+    }
+    return posicao == tamanhoBits ? 0 : -1;
+}
@@ -0,0 +1,128 @@
+#ifndef HUFFMAN_H
+#define HUFFMAN_H
+
+#include "bitmap.h"
+#include "codificador.h"
+
+#define TAMANHO_MAX_ARVORE_BITS (256 * 9 + 256)  // 256 folhas * 9 bits + nós internos
+#define MAX_NOS_HUFFMAN (2 * 256 - 1)
+#define NO_NULO (-1)
+#define COMPRIMENTO_MIN_CANONICO 8     // 256 símbolos sempre cabem em códigos de 8 bits
+#define COMPRIMENTO_MAX_CANONICO 15    // cada comprimento ocupa 4 bits no cabeçalho
+#define TAMANHO_MAX_COMPRIMENTOS_BITS (384 * 4)  // pior caso de serializarComprimentos
+
+/**
+ * @brief Nó da árvore de Huffman em construção; os filhos são índices em ArvoreHuffman.nos.
+ */
+typedef struct {
+    unsigned long long int frequencia;
+    short esq;                  ///< filho esquerdo (NO_NULO nas folhas)
+    short dir;                  ///< filho direito (NO_NULO nas folhas)
+    unsigned char caractere;    ///< byte da folha
+} NoHuffman;
+
+/**
+ * @brief Árvore de Huffman em um vetor de tamanho fixo: as folhas, em ordem de byte, seguidas dos nós
+ *        internos na ordem de criação. Não usa memória dinâmica.
+ */
+typedef struct {
+    NoHuffman nos[MAX_NOS_HUFFMAN];
+    short numNos;
+    short raiz;
+} ArvoreHuffman;
+
+/**
+ * @brief Constrói a árvore de Huffman para as frequências dadas.
+ * @details Os nós ficam num vetor de índices ordenado por frequência, com os empates na ordem da lista
+ *          encadeada original (insereOrdenado): as folhas entram em ordem de byte e cada nó interno
+ *          une os dois primeiros. Assim a árvore, e a saída do formato antigo, é a mesma de antes.
+ *          Com um único símbolo presente, um nó fictício de frequência 0 é acrescentado para que o
+ *          símbolo receba um código de 1 bit; sem nenhum símbolo, a árvore é uma folha '\0'.
+ * @param frequencias Vetor de 256 frequências.
+ * @param arvore Árvore de saída.
+ */
+void construirArvoreHuffman(const unsigned long long int* frequencias, ArvoreHuffman* arvore);
+
+/**
+ * @brief Cria o dicionário de códigos binários (bits e tamanho) para cada byte presente.
+ * @details Caso a árvore possua uma única folha (apenas um símbolo), o símbolo recebe código "0".
+ * @param dicionario Vetor de 256 códigos; símbolos ausentes ficam com tamanho 0.
+ * @param arvore Árvore de Huffman.
+ * @return 0 em sucesso; -1 se algum código passar de TAMANHO_MAX_CODIGO bits.
+ */
+int gerarDicionario(Codigo dicionario[], const ArvoreHuffman* arvore);
+
+/**
+ * @brief Serializa a árvore em pré-ordem no bitmap.
+ * @details Protocolo: 1 bit = 1 para folha + 8 bits do caractere; 0 para nó interno.
+ * @param arvore Árvore de Huffman.
+ * @param bm Bitmap de saída (capacidade mínima TAMANHO_MAX_ARVORE_BITS).
+ */
+void serializarArvore(const ArvoreHuffman* arvore, bitmap* bm);
+
+/**
+ * @brief Reconstrói a árvore gravada por serializarArvore, validando a estrutura durante a leitura.
+ * @details Percorre a pré-ordem sem recursão e sem memória dinâmica. A árvore é rejeitada se os bits
+ *          acabarem antes dela ou sobrarem depois, se passar de MAX_NOS_HUFFMAN nós ou de
+ *          TAMANHO_MAX_CODIGO níveis, ou se um byte aparecer em duas folhas.
+ * @param bytes Árvore serializada (mais significativo primeiro em cada byte).
+ * @param tamanhoBits Quantidade de bits válidos.
+ * @param arvore Recebe a árvore (frequências zeradas; a raiz é o nó 0).
+ * @return 0 em sucesso; -1 se os bits não descreverem uma árvore válida.
+ */
+int leArvoreHuffman(const unsigned char* bytes, unsigned int tamanhoBits, ArvoreHuffman* arvore);
+
+/**
+ * @brief Calcula comprimentos de código ótimos limitados a @p comprimentoMax bits (package-merge).
+ * @details Os símbolos presentes são ordenados por (frequência, byte). Para cada nível, de baixo para
+ *          cima, os itens do nível inferior são agrupados em pares ("pacotes") e intercalados com as
+ *          folhas; os 2n-2 primeiros itens do nível mais alto, expandidos, dizem quantas vezes cada
+ *          folha aparece, que é o comprimento do seu código. Com um único símbolo presente, ele recebe
+ *          comprimento 1.
+ * @param frequencias Vetor de 256 frequências.
+ * @param comprimentoMax Limite, de COMPRIMENTO_MIN_CANONICO a COMPRIMENTO_MAX_CANONICO.
+ * @param comprimentos Recebe o comprimento de cada byte (0 para ausentes).
+ */
+void calcularComprimentosLimitados(const unsigned long long int* frequencias, int comprimentoMax,
+                                   unsigned char comprimentos[]);
+
+/**
+ * @brief Atribui os códigos canônicos: em ordem de (comprimento, byte), cada código é o anterior
+ *        mais 1, deslocado à esquerda quando o comprimento aumenta.
+ * @param dicionario Vetor de 256 códigos; símbolos ausentes ficam com tamanho 0.
+ * @param comprimentos Comprimento de cada byte (0 para ausentes).
+ */
+void gerarDicionarioCanonico(Codigo dicionario[], const unsigned char comprimentos[]);
+
+/**
+ * @brief Serializa os 256 comprimentos em 4 bits cada; um 0 é seguido de 4 bits com a quantidade
+ *        de zeros adicionais (0 a 15), de modo que alfabetos esparsos ocupam pouco.
+ * @param comprimentos Comprimento de cada byte (no máximo COMPRIMENTO_MAX_CANONICO).
+ * @param bm Bitmap de saída (capacidade mínima TAMANHO_MAX_COMPRIMENTOS_BITS).
+ */
+void serializarComprimentos(const unsigned char comprimentos[], bitmap* bm);
+
+/**
+ * @brief Lê os comprimentos gravados por serializarComprimentos a partir do bit @p posicao e valida o
+ *        código resultante.
+ * @param bytes Bits serializados (mais significativo primeiro em cada byte).
+ * @param tamanhoBits Quantidade de bits válidos em @p bytes.
+ * @param posicao Bit inicial, múltiplo de 4; recebe o bit seguinte aos comprimentos.
+ * @param comprimentos Recebe os 256 comprimentos.
+ * @return 0 em sucesso; -1 se os bits acabarem antes dos 256 comprimentos ou se eles não formarem
+ *         um código de prefixo.
+ */
+int leComprimentosEm(const unsigned char* bytes, unsigned int tamanhoBits, unsigned int* posicao,
+                     unsigned char comprimentos[]);
+
+/**
+ * @brief Lê os comprimentos gravados por serializarComprimentos e valida o código resultante.
+ * @param bytes Comprimentos serializados (mais significativo primeiro em cada byte).
+ * @param tamanhoBits Quantidade de bits válidos.
+ * @param comprimentos Recebe os 256 comprimentos.
+ * @return 0 em sucesso; -1 se os bits não descreverem exatamente 256 comprimentos ou se os
+ *         comprimentos não formarem um código de prefixo.
+ */
+int leComprimentos(const unsigned char* bytes, unsigned int tamanhoBits, unsigned char comprimentos[]);
+
+#endif
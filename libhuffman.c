@@ -0,0 +1,2767 @@
+#define _FILE_OFFSET_BITS 64
+#include "libhuffman.h"
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "bitmap.h"
+#include "bloco.h"
+#include "codificador.h"
+#include "container.h"
+#include "crc.h"
+#include "decodificador.h"
+#include "dicionario.h"
+#include "entrada.h"
+#include "extracao.h"
+#include "frequencias.h"
+#include "huffman.h"
+#include "medicao.h"
+#include "pool.h"
+#include "transferencia.h"
+
+#if HUFFMAN_FASE_LEITURA != FASE_LEITURA || HUFFMAN_FASE_FREQUENCIAS != FASE_FREQUENCIAS || \
+    HUFFMAN_FASE_ARVORE != FASE_ARVORE || HUFFMAN_FASE_DICIONARIO != FASE_DICIONARIO || \
+    HUFFMAN_FASE_CODIFICACAO != FASE_CODIFICACAO || HUFFMAN_FASE_DECODIFICACAO != FASE_DECODIFICACAO || \
+    HUFFMAN_FASE_ESCRITA != FASE_ESCRITA || HUFFMAN_NUM_FASES != NUM_FASES || HUFFMAN_BITS_CODIGO_MAX != TAMANHO_MAX_CODIGO
+#error "as fases e os comprimentos de libhuffman.h devem coincidir com os de medicao.h"
+#endif
+
+/**
+ * @brief Bloco da entrada em processamento por uma thread do pool.
+ */
+typedef struct {
+    Tarefa tarefa;
+    const unsigned char* dados;     ///< bytes do bloco (na origem, no mapeamento ou em copia)
+    size_t tamanho;
+    unsigned char* copia;           ///< buffer de leitura quando a entrada não está mapeada
+    size_t capacidadeCopia;
+    BlocoCompactado* bloco;         ///< resultado, reaproveitado entre blocos
+    const ParametrosBloco* parametros;
+    int resultado;
+} TarefaBloco;
+
+/**
+ * @brief Bloco em descompactação: lido e gravado pela fila de transferências e decodificado por uma
+ *        thread do pool; os buffers são reaproveitados entre blocos.
+ */
+typedef struct {
+    Tarefa tarefa;
+    const EntradaIndice* entrada;   ///< bloco a descompactar
+    size_t tamanhoArquivo;          ///< bytes do bloco no arquivo (cabeçalho + corpo), pelo índice
+    unsigned char* corpo;           ///< cabeçalho + árvore + dados lidos do arquivo
+    size_t capacidadeCorpo;
+    unsigned char* saida;           ///< bytes descompactados (alinhados para O_DIRECT)
+    size_t capacidadeSaida;
+    Transferencia leitura;
+    Transferencia gravacao;
+    int lendo;                      ///< 1 com a leitura submetida
+    int decodificando;              ///< 1 com a tarefa submetida ao pool
+    int gravando;                   ///< 1 com a gravação submetida
+    Decodificador* decodificador;   ///< tabelas reaproveitadas entre blocos
+    const Dicionario* dicionario;   ///< para blocos BLOCO_DICIONARIO (pode ser NULL)
+    int medir;
+    TemposFases tempos;             ///< do último bloco, somados ao contexto por quem aguarda a tarefa
+    int semCrc;                     ///< 1 se o último bloco não tinha CRC32C
+    int resultado;
+} TarefaDescompactacao;
+
+#define TAMANHO_BUFFER_FLUXO (1 << 20)
+#define LEITURAS_ANTECIPADAS 2              ///< blocos da entrada lidos à frente da janela de compactação
+#define BUFFERS_GRAVACAO 4                  ///< buffers do gravador adiado com threads
+#define TAMANHO_BUFFER_GRAVACAO (2 << 20)
+
+#define FLUXO_INATIVO 0
+#define FLUXO_ATIVO 1           ///< compactação: recebendo entrada
+#define FLUXO_CABECALHO 2       ///< descompactação: cabeçalho do formato em blocos
+#define FLUXO_QUADRO 3          ///< descompactação: cabeçalho do quadro único
+#define FLUXO_BLOCO 4           ///< descompactação: cabeçalho de um bloco ou terminador
+#define FLUXO_DESCRICAO 5       ///< descompactação: árvore ou comprimentos do bloco
+#define FLUXO_DADOS 6           ///< descompactação: dados codificados do bloco
+#define FLUXO_CRC 7             ///< descompactação: CRC32C de um bloco decodificado aos poucos
+#define FLUXO_CONCLUIDO 8
+
+struct contextoCompactacao {
+    OpcoesHuffman opcoes;
+    ParametrosBloco parametros;
+    PoolThreads* pool;
+    TarefaBloco* tarefas;           ///< janela de 2 * numThreads blocos
+    int janela;
+    FilaTransferencias* fila;       ///< leituras antecipadas e gravações adiadas dos arquivos
+    int leiturasAntecipadas;        ///< blocos lidos à frente da janela (0 sem threads)
+    int buffersGravacao;
+    unsigned char* serializado;     ///< bloco ou índice montado para o gravador adiado
+    size_t capacidadeSerializado;
+    IndiceBlocos indice;            ///< entradas e pontos reaproveitados entre compactações
+    Medicao medicao;                ///< acumulada com parametros.medir
+
+    // Fluxo incremental (compactaFluxo)
+    int estadoFluxo;
+    size_t preenchido;              ///< bytes do bloco em preenchimento, tarefas[enviados % janela]
+    unsigned long long int enviados;
+    unsigned long long int gravados;
+    unsigned long long int offsetFluxo;     ///< bytes gerados (entregues ou pendentes)
+    unsigned char* pendente;        ///< saída gerada e ainda não entregue
+    size_t capacidadePendente;
+    size_t tamanhoPendente;
+    size_t posPendente;
+};
+
+struct contextoDescompactacao {
+    PoolThreads* pool;
+    TarefaDescompactacao* tarefas;  ///< janela de 2 * numThreads blocos
+    int janela;
+    FilaTransferencias* fila;       ///< leituras dos blocos e gravações da saída (com índice)
+    int direto;                     ///< 1 = saída com O_DIRECT nos blocos alinhados
+    Decodificador* decodificador;   ///< usado na descompactação sequencial e no fluxo
+    unsigned char* corpo;
+    size_t capacidadeCorpo;
+    const Dicionario* dicionario;   ///< para blocos BLOCO_DICIONARIO (pode ser NULL)
+    int medir;
+    Medicao medicao;
+    unsigned long long int blocosSemCrc;    ///< da última descompactação de arquivo
+
+    // Fluxo incremental (descompactaFluxo)
+    int estadoFluxo;
+    unsigned char cabecalhoFluxo[TAMANHO_MAX_CABECALHO_QUADRO];    ///< também o de um bloco ou do arquivo
+    int quadroFluxo;                ///< 1 = quadro único: termina com o bloco
+    unsigned int tamanhoBlocoFluxo; ///< limite do tamanho original de cada bloco, do cabeçalho do arquivo
+    size_t lidosFluxo;              ///< bytes já recebidos do cabeçalho ou da descrição em leitura
+    CabecalhoBloco blocoFluxo;
+    Decodificador* tabelasFluxo;    ///< decodificador do bloco atual (o do contexto ou o do dicionário)
+    EstadoDecodificacao bitsFluxo;
+    unsigned long long int produzidosBloco;
+    unsigned int crcFluxo;          ///< CRC32C do que o bloco atual já produziu
+    unsigned char* saidaFluxo;      ///< bloco lido inteiro já descompactado, entregue aos poucos
+    size_t capacidadeSaidaFluxo;
+};
+
+/**
+ * @brief Origem dos blocos a compactar: um arquivo ou um buffer em memória.
+ */
+typedef struct {
+    ArquivoEntrada* arquivo;        ///< NULL para um buffer em memória ou com leitor
+    const unsigned char* memoria;
+    size_t tamanho;
+    size_t pos;
+    LeitorAntecipado* leitor;       ///< arquivo regular lido à frente pela fila de transferências
+} FonteBlocos;
+
+/**
+ * @brief Destino do formato em blocos: um arquivo ou um buffer em memória.
+ */
+typedef struct {
+    FILE* arquivo;                  ///< NULL para um buffer em memória ou com gravador
+    unsigned char* memoria;
+    size_t capacidade;
+    unsigned long long int pos;     ///< bytes gravados
+    GravadorAdiado* gravador;       ///< arquivo regular gravado em segundo plano
+} SaidaBlocos;
+
+/**
+ * @brief Preenche @p opcoes com os valores padrão (blocos de 4 MB, pontos a cada 64 KB, árvore por bloco).
+ */
+void opcoesPadraoHuffman(OpcoesHuffman* opcoes) {
+    opcoes->tamanhoBloco = HUFFMAN_TAMANHO_BLOCO_PADRAO;
+    opcoes->intervaloPontos = HUFFMAN_INTERVALO_PONTOS_PADRAO;
+    opcoes->comprimentoMax = 0;
+    opcoes->legado = 0;
+    opcoes->fluxos = 1;
+    opcoes->contexto = 0;
+    opcoes->crc = 0;
+    opcoes->direto = 0;
+}
+
+/**
+ * @brief Texto descritivo de um código de retorno.
+ * @param codigo Código HUFFMAN_*.
+ * @return Texto estático.
+ */
+const char* mensagemErroHuffman(int codigo) {
+    switch (codigo) {
+        case HUFFMAN_OK: return "sucesso";
+        case HUFFMAN_AVISO_CODIGO_INCOMPLETO: return "decodificação terminou no meio de um caminho";
+        case HUFFMAN_FIM_FLUXO: return "fim do fluxo";
+        case HUFFMAN_ERRO_PARAMETRO: return "parâmetro inválido";
+        case HUFFMAN_ERRO_MEMORIA: return "erro de alocação de memória";
+        case HUFFMAN_ERRO_ENTRADA: return "erro ao ler o arquivo de entrada";
+        case HUFFMAN_ERRO_SAIDA: return "erro ao gravar o arquivo de saída";
+        case HUFFMAN_ERRO_FORMATO: return "formato do arquivo compactado não reconhecido";
+        case HUFFMAN_ERRO_CORROMPIDO: return "dados compactados corrompidos";
+        case HUFFMAN_ERRO_DESTINO_PEQUENO: return "buffer de destino pequeno demais";
+        case HUFFMAN_ERRO_CODIGO_LONGO: return "código de Huffman com mais de 64 bits";
+        case HUFFMAN_ERRO_SEM_INDICE: return "a extração de trechos requer o formato em blocos com índice";
+        case HUFFMAN_ERRO_DICIONARIO: return "dicionário ausente ou diferente do usado na compactação";
+        case HUFFMAN_ERRO_CRC: return "CRC32C de um bloco não confere: dados corrompidos";
+        case HUFFMAN_AVISO_SEM_CRC: return "há blocos sem CRC32C, verificados só pela decodificação";
+    }
+    return "erro desconhecido";
+}
+
+/**
+ * @brief Nome de uma fase das estatísticas.
+ * @param fase HUFFMAN_FASE_*.
+ * @return Texto estático ("?" fora dos limites).
+ */
+const char* nomeFaseHuffman(int fase) {
+    static const char* const nomes[NUM_FASES] = {
+        "leitura", "frequencias", "arvore", "dicionario", "codificacao", "decodificacao", "escrita"
+    };
+    return fase >= 0 && fase < NUM_FASES ? nomes[fase] : "?";
+}
+
+/**
+ * @brief Entropia de ordem 0 do histograma das estatísticas, o mínimo em bits por byte de qualquer código
+ *        de prefixo com um único código para os dados inteiros.
+ * @return Bits por byte (0 sem dados).
+ */
+double entropiaHuffman(const EstatisticasHuffman* estatisticas) {
+    unsigned long long int total = 0;
+    for (int i = 0; i < 256; i++) {
+        total += estatisticas->frequencias[i];
+    }
+    double entropia = 0;
+    for (int i = 0; i < 256; i++) {
+        if (estatisticas->frequencias[i] > 0) {
+            double p = (double) estatisticas->frequencias[i] / total;
+            entropia -= p * log2(p);
+        }
+    }
+    return entropia;
+}
+
+/**
+ * @brief Copia uma medição interna para a estrutura pública.
+ */
+static void copiaEstatisticas(const Medicao* medicao, EstatisticasHuffman* estatisticas) {
+    memcpy(estatisticas->segundos, medicao->tempos.segundos, sizeof(estatisticas->segundos));
+    memcpy(estatisticas->segundosCpu, medicao->tempos.segundosCpu, sizeof(estatisticas->segundosCpu));
+    estatisticas->blocos = medicao->blocos;
+    memcpy(estatisticas->frequencias, medicao->frequencias, sizeof(estatisticas->frequencias));
+    memcpy(estatisticas->bytesPorComprimento, medicao->bytesPorComprimento, sizeof(estatisticas->bytesPorComprimento));
+}
+
+/**
+ * @brief Garante que @p buffer tenha ao menos @p tamanho bytes.
+ * @return 0 em sucesso; -1 em falta de memória.
+ */
+static int garanteCapacidade(unsigned char** buffer, size_t* capacidade, size_t tamanho) {
+    if (tamanho <= *capacidade) {
+        return 0;
+    }
+    unsigned char* novo = (unsigned char*) realloc(*buffer, tamanho);
+    if (novo == NULL) {
+        return -1;
+    }
+    *buffer = novo;
+    *capacidade = tamanho;
+    return 0;
+}
+
+/**
+ * @brief Compacta um bloco na thread do pool.
+ */
+static void executaTarefaBloco(void* arg) {
+    TarefaBloco* t = (TarefaBloco*) arg;
+    t->resultado = compactaBloco(t->bloco, t->dados, t->tamanho, t->parametros);
+}
+
+/**
+ * @brief Cria um contexto de compactação cujo pool tem @p numThreads threads.
+ * @param numThreads 0 = sem threads: cada bloco é compactado na própria thread da chamada (lotes).
+ * @return Contexto ou NULL em falta de memória.
+ */
+static ContextoCompactacao* criaContextoCompactacaoPool(int numThreads) {
+    ContextoCompactacao* ctx = (ContextoCompactacao*) calloc(1, sizeof(ContextoCompactacao));
+    if (ctx == NULL) {
+        return NULL;
+    }
+    ctx->janela = numThreads > 0 ? 2 * numThreads : 1;
+    ctx->pool = criaPoolThreads(numThreads);
+    ctx->tarefas = (TarefaBloco*) calloc(ctx->janela, sizeof(TarefaBloco));
+    // Sem threads (lotes), a fila é síncrona: a sobreposição vem dos vários arquivos ao mesmo tempo
+    ctx->leiturasAntecipadas = numThreads > 0 ? LEITURAS_ANTECIPADAS : 0;
+    ctx->buffersGravacao = numThreads > 0 ? BUFFERS_GRAVACAO : 1;
+    ctx->fila = criaFilaTransferencias(numThreads > 0 ? ctx->janela + ctx->leiturasAntecipadas + ctx->buffersGravacao : 0);
+    if (ctx->pool == NULL || ctx->tarefas == NULL || ctx->fila == NULL) {
+        liberaContextoCompactacao(ctx);
+        return NULL;
+    }
+    for (int i = 0; i < ctx->janela; i++) {
+        TarefaBloco* t = &ctx->tarefas[i];
+        t->bloco = criaBlocoCompactado();
+        if (t->bloco == NULL) {
+            liberaContextoCompactacao(ctx);
+            return NULL;
+        }
+        t->parametros = &ctx->parametros;
+        t->tarefa.funcao = executaTarefaBloco;
+        t->tarefa.arg = t;
+    }
+    OpcoesHuffman opcoes;
+    opcoesPadraoHuffman(&opcoes);
+    defineOpcoesCompactacao(ctx, &opcoes);
+    return ctx;
+}
+
+/**
+ * @brief Cria um contexto de compactação com as opções padrão.
+ * @param numThreads Threads para compactar blocos em paralelo (0 = número de processadores).
+ * @return Contexto ou NULL em falta de memória.
+ */
+ContextoCompactacao* criaContextoCompactacao(int numThreads) {
+    return criaContextoCompactacaoPool(numThreads > 0 ? numThreads : numeroProcessadores());
+}
+
+/**
+ * @brief Indica se todas as opções estão dentro dos limites.
+ */
+static int opcoesValidas(const OpcoesHuffman* opcoes) {
+    return opcoes->tamanhoBloco >= 1 && opcoes->tamanhoBloco <= HUFFMAN_TAMANHO_BLOCO_MAX &&
+           opcoes->intervaloPontos <= HUFFMAN_TAMANHO_BLOCO_MAX &&
+           (opcoes->comprimentoMax == 0 || (opcoes->comprimentoMax >= HUFFMAN_COMPRIMENTO_MIN &&
+                                            opcoes->comprimentoMax <= HUFFMAN_COMPRIMENTO_MAX)) &&
+           (opcoes->legado == 0 || opcoes->legado == 1) &&
+           (opcoes->fluxos == 1 || opcoes->fluxos == HUFFMAN_FLUXOS_INTERCALADOS) &&
+           (opcoes->contexto == 0 || (opcoes->contexto == 1 && !opcoes->legado)) &&
+           (opcoes->crc == 0 || (opcoes->crc == 1 && !opcoes->legado)) &&
+           (opcoes->direto == 0 || opcoes->direto == 1);
+}
+
+/**
+ * @brief Troca as opções usadas nas próximas compactações.
+ * @param ctx Contexto.
+ * @param opcoes Novas opções.
+ * @return HUFFMAN_OK ou HUFFMAN_ERRO_PARAMETRO se alguma opção estiver fora dos limites.
+ */
+int defineOpcoesCompactacao(ContextoCompactacao* ctx, const OpcoesHuffman* opcoes) {
+    if (!opcoesValidas(opcoes)) {
+        return HUFFMAN_ERRO_PARAMETRO;
+    }
+    ctx->opcoes = *opcoes;
+    ctx->parametros.intervaloPontos = opcoes->intervaloPontos;
+    ctx->parametros.comprimentoMax = opcoes->comprimentoMax;
+    ctx->parametros.fluxos = opcoes->fluxos == HUFFMAN_FLUXOS_INTERCALADOS ? FLUXOS_INTERCALADOS : 1;
+    ctx->parametros.contexto = opcoes->contexto;
+    ctx->parametros.crc = opcoes->crc;
+    return HUFFMAN_OK;
+}
+
+/**
+ * @brief Passa a compactar com os códigos de um dicionário, gravando nos blocos só o seu id.
+ * @details O dicionário não é copiado e deve existir enquanto o contexto o usar. O formato antigo o ignora.
+ * @param ctx Contexto.
+ * @param dicionario Dicionário, ou NULL para voltar ao código próprio de cada bloco.
+ * @return HUFFMAN_OK.
+ */
+int defineDicionarioCompactacao(ContextoCompactacao* ctx, const DicionarioHuffman* dicionario) {
+    ctx->parametros.dicionario = dicionario;
+    return HUFFMAN_OK;
+}
+
+/**
+ * @brief Maior tamanho possível da saída de compactaMemoria para @p tamanho bytes de entrada.
+ * @details Um código de Huffman ótimo nunca passa de 8 bits por byte em média (o código fixo de 8 bits
+ *          é sempre viável, inclusive com o limite de comprimento), então os dados de um bloco ocupam
+ *          no máximo o tamanho original mais o byte incompleto.
+ * @param ctx Contexto (as opções atuais determinam o número de blocos e pontos).
+ * @param tamanho Bytes da entrada.
+ */
+size_t limiteCompactacao(const ContextoCompactacao* ctx, size_t tamanho) {
+    size_t blocos = tamanho / ctx->opcoes.tamanhoBloco + (tamanho % ctx->opcoes.tamanhoBloco != 0);
+    size_t pontos = ctx->opcoes.intervaloPontos > 0 ? tamanho / ctx->opcoes.intervaloPontos : 0;
+    size_t descricao = (TAMANHO_MAX_ARVORE_BITS + 7) / 8;   // maior que TAMANHO_MAX_COMPRIMENTOS_BITS
+    return TAMANHO_CABECALHO_CONTAINER + tamanho + 1 + TAMANHO_CABECALHO_INDICE + TAMANHO_RODAPE_INDICE +
+           blocos * (TAMANHO_CABECALHO_BLOCO + descricao + 1 + TAMANHO_CRC_BLOCO + TAMANHO_ENTRADA_INDICE) + 8 * pontos;
+}
+
+/**
+ * @brief Obtém o próximo bloco da origem em @p t (tamanho 0 no fim).
+ */
+static void proximoBloco(FonteBlocos* f, size_t tamanhoBloco, TarefaBloco* t) {
+    if (f->leitor) {
+        t->tamanho = proximoTrecho(f->leitor, &t->dados);
+        return;
+    }
+    if (f->arquivo) {
+        t->tamanho = leTrechoEntrada(f->arquivo, tamanhoBloco, t->copia, &t->dados);
+        return;
+    }
+    t->tamanho = f->tamanho - f->pos < tamanhoBloco ? f->tamanho - f->pos : tamanhoBloco;
+    t->dados = f->memoria + f->pos;
+    f->pos += t->tamanho;
+}
+
+/**
+ * @brief Acrescenta @p n bytes ao destino.
+ * @return HUFFMAN_OK, HUFFMAN_ERRO_SAIDA ou HUFFMAN_ERRO_DESTINO_PEQUENO.
+ */
+static int gravaSaida(SaidaBlocos* s, const void* bytes, size_t n) {
+    if (s->gravador) {
+        if (gravaAdiado(s->gravador, bytes, n) < 0) {
+            return HUFFMAN_ERRO_SAIDA;
+        }
+    } else if (s->arquivo) {
+        if (fwrite(bytes, 1, n, s->arquivo) != n) {
+            return HUFFMAN_ERRO_SAIDA;
+        }
+    } else {
+        if (n > s->capacidade - s->pos) {
+            return HUFFMAN_ERRO_DESTINO_PEQUENO;
+        }
+        memcpy(s->memoria + s->pos, bytes, n);
+    }
+    s->pos += n;
+    return HUFFMAN_OK;
+}
+
+/**
+ * @brief Acrescenta um bloco compactado ao destino; para o gravador adiado, o bloco é montado antes
+ *        em ctx->serializado.
+ */
+static int gravaBlocoSaida(ContextoCompactacao* ctx, SaidaBlocos* s, BlocoCompactado* b) {
+    unsigned long long int tamanho = tamanhoBlocoCompactado(b);
+    if (s->gravador) {
+        if (garanteCapacidade(&ctx->serializado, &ctx->capacidadeSerializado, tamanho) < 0) {
+            return HUFFMAN_ERRO_MEMORIA;
+        }
+        copiaBlocoCompactado(b, ctx->serializado);
+        return gravaSaida(s, ctx->serializado, tamanho);
+    }
+    if (s->arquivo) {
+        if (gravaBlocoCompactado(b, s->arquivo) < 0) {
+            return HUFFMAN_ERRO_SAIDA;
+        }
+    } else {
+        if (tamanho > s->capacidade - s->pos) {
+            return HUFFMAN_ERRO_DESTINO_PEQUENO;
+        }
+        copiaBlocoCompactado(b, s->memoria + s->pos);
+    }
+    s->pos += tamanho;
+    return HUFFMAN_OK;
+}
+
+/**
+ * @brief Acrescenta o índice e o rodapé ao destino.
+ */
+static int gravaIndiceSaida(ContextoCompactacao* ctx, SaidaBlocos* s, const IndiceBlocos* indice) {
+    unsigned long long int tamanho = tamanhoIndice(indice);
+    if (s->gravador) {
+        if (garanteCapacidade(&ctx->serializado, &ctx->capacidadeSerializado, tamanho) < 0) {
+            return HUFFMAN_ERRO_MEMORIA;
+        }
+        codificaIndice(indice, ctx->serializado, s->pos);
+        return gravaSaida(s, ctx->serializado, tamanho);
+    }
+    if (s->arquivo) {
+        if (gravaIndice(indice, s->arquivo, s->pos) < 0) {
+            return HUFFMAN_ERRO_SAIDA;
+        }
+    } else {
+        if (tamanho > s->capacidade - s->pos) {
+            return HUFFMAN_ERRO_DESTINO_PEQUENO;
+        }
+        codificaIndice(indice, s->memoria + s->pos, s->pos);
+    }
+    s->pos += tamanho;
+    return HUFFMAN_OK;
+}
+
+/**
+ * @brief Aguarda a compactação de um bloco e acrescenta sua entrada ao índice do contexto.
+ * @param offset Posição em que o bloco será gravado.
+ * @return HUFFMAN_OK ou HUFFMAN_ERRO_MEMORIA.
+ */
+static int concluiBloco(ContextoCompactacao* ctx, TarefaBloco* t, unsigned long long int offset) {
+    aguardaTarefa(ctx->pool, &t->tarefa);
+    if (t->resultado < 0 ||
+        acrescentaIndice(&ctx->indice, offset, cabecalhoBlocoCompactado(t->bloco)->bitsDados,
+                         (unsigned int) t->tamanho, numPontosBlocoCompactado(t->bloco),
+                         pontosBlocoCompactado(t->bloco)) < 0) {
+        return HUFFMAN_ERRO_MEMORIA;
+    }
+    if (ctx->parametros.medir) {
+        somaMedicao(&ctx->medicao, medicaoBlocoCompactado(t->bloco));
+    }
+    return HUFFMAN_OK;
+}
+
+/**
+ * @brief Esvazia o índice do contexto, mantendo a memória já alocada.
+ */
+static void reiniciaIndiceContexto(ContextoCompactacao* ctx) {
+    ctx->indice.numBlocos = 0;
+    ctx->indice.numPontos = 0;
+    ctx->indice.intervaloPontos = ctx->parametros.intervaloPontos;
+}
+
+/**
+ * @brief Encerra um fluxo em andamento, aguardando os blocos ainda no pool.
+ */
+static void abandonaFluxo(ContextoCompactacao* ctx) {
+    for (; ctx->gravados < ctx->enviados; ctx->gravados++) {
+        aguardaTarefa(ctx->pool, &ctx->tarefas[ctx->gravados % ctx->janela].tarefa);
+    }
+    ctx->estadoFluxo = FLUXO_INATIVO;
+}
+
+/**
+ * @brief Gera o formato em blocos, compactando os blocos em paralelo.
+ * @details Até 2 * numThreads blocos ficam em processamento ao mesmo tempo; os resultados são
+ *          gravados na ordem da entrada assim que o bloco seguinte da sequência fica pronto. A memória
+ *          usada depende do tamanho do bloco e do número de threads, não do tamanho da entrada.
+ *          Com leitor e gravador adiado, os blocos seguintes são lidos e os anteriores gravados pela
+ *          fila de transferências enquanto o pool compacta os da janela.
+ *          Em caso de erro, os blocos já enviados ao pool são aguardados antes de retornar.
+ * @param ctx Contexto.
+ * @param fonte Origem dos dados.
+ * @param saida Destino do formato em blocos.
+ * @param tamanhoOriginal Recebe o total de bytes lidos.
+ * @return HUFFMAN_OK ou código de erro.
+ */
+static int compactaBlocos(ContextoCompactacao* ctx, FonteBlocos* fonte, SaidaBlocos* saida,
+                          unsigned long long int* tamanhoOriginal) {
+    unsigned int tamanhoBloco = ctx->opcoes.tamanhoBloco;
+    TemposFases* tempos = ctx->parametros.medir ? &ctx->medicao.tempos : NULL;
+    MarcaTempo marca;
+    abandonaFluxo(ctx);
+    if (fonte->arquivo && !entradaMapeada(fonte->arquivo)) {
+        for (int i = 0; i < ctx->janela; i++) {
+            if (garanteCapacidade(&ctx->tarefas[i].copia, &ctx->tarefas[i].capacidadeCopia, tamanhoBloco) < 0) {
+                return HUFFMAN_ERRO_MEMORIA;
+            }
+        }
+    }
+
+    unsigned char cabecalho[TAMANHO_CABECALHO_CONTAINER];
+    codificaCabecalhoContainer(cabecalho, tamanhoBloco);
+    int resultado = gravaSaida(saida, cabecalho, TAMANHO_CABECALHO_CONTAINER);
+
+    reiniciaIndiceContexto(ctx);
+    *tamanhoOriginal = 0;
+    unsigned long long int enviados = 0, gravados = 0;
+    int fimEntrada = 0;
+
+    for (;;) {
+        // Mantém a janela cheia enquanto houver entrada
+        while (resultado == HUFFMAN_OK && !fimEntrada && enviados - gravados < (unsigned long long int) ctx->janela) {
+            TarefaBloco* t = &ctx->tarefas[enviados % ctx->janela];
+            iniciaMedicao(tempos, &marca);
+            proximoBloco(fonte, tamanhoBloco, t);
+            encerraFase(tempos, FASE_LEITURA, &marca);
+            if (t->tamanho == 0) {
+                fimEntrada = 1;
+                break;
+            }
+            submeteTarefa(ctx->pool, &t->tarefa);
+            enviados++;
+        }
+        if (gravados == enviados) {
+            break;
+        }
+
+        // Grava o próximo bloco da sequência
+        TarefaBloco* t = &ctx->tarefas[gravados % ctx->janela];
+        gravados++;
+        if (resultado != HUFFMAN_OK) {
+            aguardaTarefa(ctx->pool, &t->tarefa);
+            if (fonte->leitor) {
+                devolveTrecho(fonte->leitor);
+            }
+            continue;
+        }
+        resultado = concluiBloco(ctx, t, saida->pos);
+        if (resultado == HUFFMAN_OK) {
+            iniciaMedicao(tempos, &marca);
+            resultado = gravaBlocoSaida(ctx, saida, t->bloco);
+            encerraFase(tempos, FASE_ESCRITA, &marca);
+            *tamanhoOriginal += t->tamanho;
+        }
+        if (fonte->leitor) {
+            // Só depois da gravação: um bloco armazenado aponta para os bytes do trecho
+            devolveTrecho(fonte->leitor);   // o buffer passa a ler um bloco à frente
+        }
+    }
+    if (resultado != HUFFMAN_OK) {
+        return resultado;
+    }
+    if ((fonte->arquivo && erroArquivoEntrada(fonte->arquivo)) ||
+        (fonte->leitor && erroLeitorAntecipado(fonte->leitor))) {
+        return HUFFMAN_ERRO_ENTRADA;
+    }
+
+    // Terminador seguido do índice de blocos
+    unsigned char terminador = BLOCO_FIM;
+    iniciaMedicao(tempos, &marca);
+    resultado = gravaSaida(saida, &terminador, 1);
+    if (resultado == HUFFMAN_OK) {
+        resultado = gravaIndiceSaida(ctx, saida, &ctx->indice);
+    }
+    if (resultado == HUFFMAN_OK && saida->gravador && concluiGravadorAdiado(saida->gravador) < 0) {
+        resultado = HUFFMAN_ERRO_SAIDA;
+    }
+    encerraFase(tempos, FASE_ESCRITA, &marca);
+    return resultado;
+}
+
+/**
+ * @brief Monta em @p cabecalho o cabeçalho do quadro único do bloco já compactado em @p t (tamanho 0 =
+ *        entrada vazia, sem bloco).
+ * @param tamanhoCabecalho Recebe os bytes do cabeçalho.
+ * @return Bytes do quadro inteiro (cabeçalho + corpo do bloco).
+ */
+static size_t cabecalhoQuadroUnico(TarefaBloco* t, unsigned char* cabecalho, int* tamanhoCabecalho) {
+    CabecalhoBloco vazio = {BLOCO_FIM, 1, 0, 0, 0, 0};
+    const CabecalhoBloco* c = t->tamanho > 0 ? cabecalhoBlocoCompactado(t->bloco) : &vazio;
+    *tamanhoCabecalho = codificaCabecalhoQuadro(cabecalho, c);
+    return (size_t) *tamanhoCabecalho + (t->tamanho > 0 ? (size_t) tamanhoCorpoBloco(c) : 0);
+}
+
+/**
+ * @brief Copia para @p destino o quadro único do bloco em @p t (ver cabecalhoQuadroUnico).
+ */
+static void copiaQuadroUnico(TarefaBloco* t, unsigned char* destino, const unsigned char* cabecalho,
+                             int tamanhoCabecalho) {
+    memcpy(destino, cabecalho, tamanhoCabecalho);
+    if (t->tamanho > 0) {
+        copiaCorpoBlocoCompactado(t->bloco, destino + tamanhoCabecalho);
+    }
+}
+
+/**
+ * @brief Compacta em um quadro único uma entrada que cabe em um bloco, na própria thread da chamada.
+ * @return HUFFMAN_OK ou código de erro.
+ */
+static int compactaQuadroUnico(ContextoCompactacao* ctx, const unsigned char* origem, size_t tamanho,
+                               SaidaBlocos* saida) {
+    TemposFases* tempos = ctx->parametros.medir ? &ctx->medicao.tempos : NULL;
+    MarcaTempo marca;
+    abandonaFluxo(ctx);
+    reiniciaIndiceContexto(ctx);
+    TarefaBloco* t = &ctx->tarefas[0];
+    t->dados = origem;
+    t->tamanho = tamanho;
+    if (tamanho > 0) {
+        executaTarefaBloco(t);
+        if (t->resultado < 0) {
+            return HUFFMAN_ERRO_MEMORIA;
+        }
+        if (ctx->parametros.medir) {
+            somaMedicao(&ctx->medicao, medicaoBlocoCompactado(t->bloco));
+        }
+    }
+
+    unsigned char cabecalho[TAMANHO_MAX_CABECALHO_QUADRO];
+    int tamanhoCabecalho;
+    size_t total = cabecalhoQuadroUnico(t, cabecalho, &tamanhoCabecalho);
+    if (total > saida->capacidade) {
+        return HUFFMAN_ERRO_DESTINO_PEQUENO;
+    }
+    iniciaMedicao(tempos, &marca);
+    copiaQuadroUnico(t, saida->memoria, cabecalho, tamanhoCabecalho);
+    saida->pos = total;
+    encerraFase(tempos, FASE_ESCRITA, &marca);
+    return HUFFMAN_OK;
+}
+
+/**
+ * @brief Compacta um buffer para o formato em blocos, em memória.
+ * @details Uma entrada que cabe em um único bloco (ou vazia) sai em um quadro único, sem cabeçalho do
+ *          arquivo nem índice (container.h).
+ * @param ctx Contexto.
+ * @param origem Bytes a compactar.
+ * @param tamanho Quantidade de bytes.
+ * @param destino Buffer de saída (limiteCompactacao bytes sempre bastam).
+ * @param capacidade Bytes disponíveis em @p destino.
+ * @param tamanhoSaida Recebe a quantidade de bytes gravados.
+ * @return HUFFMAN_OK ou código de erro (HUFFMAN_ERRO_PARAMETRO com a opção legado).
+ */
+int compactaMemoria(ContextoCompactacao* ctx, const void* origem, size_t tamanho,
+                    void* destino, size_t capacidade, size_t* tamanhoSaida) {
+    if (ctx->opcoes.legado || (origem == NULL && tamanho > 0) || destino == NULL) {
+        return HUFFMAN_ERRO_PARAMETRO;
+    }
+    FonteBlocos fonte = {NULL, (const unsigned char*) origem, tamanho, 0, NULL};
+    SaidaBlocos saida = {NULL, (unsigned char*) destino, capacidade, 0, NULL};
+    unsigned long long int tamanhoOriginal;
+
+    int resultado = tamanho <= ctx->opcoes.tamanhoBloco ? compactaQuadroUnico(ctx, fonte.memoria, tamanho, &saida) :
+                    compactaBlocos(ctx, &fonte, &saida, &tamanhoOriginal);
+    *tamanhoSaida = (size_t) saida.pos;
+    return resultado;
+}
+
+/**
+ * @brief Reserva @p n bytes no fim da saída pendente do fluxo.
+ * @return Início da área reservada ou NULL em falta de memória.
+ */
+static unsigned char* reservaPendente(ContextoCompactacao* ctx, size_t n) {
+    if (garanteCapacidade(&ctx->pendente, &ctx->capacidadePendente, ctx->tamanhoPendente + n) < 0) {
+        return NULL;
+    }
+    unsigned char* p = ctx->pendente + ctx->tamanhoPendente;
+    ctx->tamanhoPendente += n;
+    ctx->offsetFluxo += n;
+    return p;
+}
+
+/**
+ * @brief Entrega ao chamador o quanto couber da saída pendente.
+ * @return Bytes que continuam pendentes.
+ */
+static size_t entregaPendente(ContextoCompactacao* ctx, FluxoHuffman* f) {
+    size_t n = ctx->tamanhoPendente - ctx->posPendente;
+    if (n > f->disponivelSaida) {
+        n = f->disponivelSaida;
+    }
+    memcpy(f->saida, ctx->pendente + ctx->posPendente, n);
+    f->saida += n;
+    f->disponivelSaida -= n;
+    f->totalSaida += n;
+    ctx->posPendente += n;
+    if (ctx->posPendente == ctx->tamanhoPendente) {
+        ctx->posPendente = 0;
+        ctx->tamanhoPendente = 0;
+    }
+    return ctx->tamanhoPendente - ctx->posPendente;
+}
+
+/**
+ * @brief Envia ao pool o bloco em preenchimento no fluxo.
+ */
+static void submeteBlocoFluxo(ContextoCompactacao* ctx) {
+    TarefaBloco* t = &ctx->tarefas[ctx->enviados % ctx->janela];
+    t->dados = t->copia;
+    t->tamanho = ctx->preenchido;
+    submeteTarefa(ctx->pool, &t->tarefa);
+    ctx->enviados++;
+    ctx->preenchido = 0;
+}
+
+/**
+ * @brief Começa uma compactação incremental; um fluxo anterior ainda em andamento é abandonado.
+ * @details A saída é a mesma de compactaMemoria com as opções atuais: o cabeçalho do formato só é
+ *          gerado quando há um segundo bloco, e uma entrada de até um bloco sai em um quadro único.
+ * @param ctx Contexto.
+ * @return HUFFMAN_OK ou código de erro (HUFFMAN_ERRO_PARAMETRO com a opção legado).
+ */
+int iniciaCompactacaoFluxo(ContextoCompactacao* ctx) {
+    abandonaFluxo(ctx);
+    if (ctx->opcoes.legado) {
+        return HUFFMAN_ERRO_PARAMETRO;
+    }
+    for (int i = 0; i < ctx->janela; i++) {
+        TarefaBloco* t = &ctx->tarefas[i];
+        if (garanteCapacidade(&t->copia, &t->capacidadeCopia, ctx->opcoes.tamanhoBloco) < 0) {
+            return HUFFMAN_ERRO_MEMORIA;
+        }
+    }
+    reiniciaIndiceContexto(ctx);
+    ctx->preenchido = 0;
+    ctx->enviados = 0;
+    ctx->gravados = 0;
+    ctx->offsetFluxo = 0;
+    ctx->tamanhoPendente = 0;
+    ctx->posPendente = 0;
+    ctx->estadoFluxo = FLUXO_ATIVO;
+    return HUFFMAN_OK;
+}
+
+/**
+ * @brief Consome entrada e produz saída do fluxo iniciado com iniciaCompactacaoFluxo.
+ * @details Cada bloco completo é compactado com seu próprio código assim que chega, em paralelo com os
+ *          seguintes; a entrada nunca é lida duas vezes. A chamada retorna quando a entrada acaba ou
+ *          a saída enche; os blocos compactados que não couberem ficam guardados no contexto.
+ * @param ctx Contexto.
+ * @param f Buffers de entrada e saída; avançam sobre o que foi consumido e produzido.
+ * @param finalizar 1 quando @p f traz o fim da entrada: o último bloco, o terminador e o índice (ou o
+ *        quadro único) são gerados, e a função deve ser chamada de novo enquanto retornar HUFFMAN_OK.
+ * @return HUFFMAN_OK, HUFFMAN_FIM_FLUXO quando toda a saída foi entregue, ou código de erro (o fluxo
+ *         é abandonado).
+ */
+int compactaFluxo(ContextoCompactacao* ctx, FluxoHuffman* f, int finalizar) {
+    if (ctx->estadoFluxo == FLUXO_INATIVO) {
+        return HUFFMAN_ERRO_PARAMETRO;
+    }
+    for (;;) {
+        if (entregaPendente(ctx, f) > 0) {
+            return HUFFMAN_OK;
+        }
+        if (ctx->estadoFluxo == FLUXO_CONCLUIDO) {
+            return HUFFMAN_FIM_FLUXO;
+        }
+
+        int livre = ctx->enviados - ctx->gravados < (unsigned long long int) ctx->janela;
+        if (livre && f->disponivelEntrada > 0) {
+            // Completa o bloco em preenchimento
+            TarefaBloco* t = &ctx->tarefas[ctx->enviados % ctx->janela];
+            size_t n = ctx->opcoes.tamanhoBloco - ctx->preenchido;
+            if (n > f->disponivelEntrada) {
+                n = f->disponivelEntrada;
+            }
+            memcpy(t->copia + ctx->preenchido, f->entrada, n);
+            f->entrada += n;
+            f->disponivelEntrada -= n;
+            f->totalEntrada += n;
+            ctx->preenchido += n;
+            if (ctx->preenchido == ctx->opcoes.tamanhoBloco) {
+                submeteBlocoFluxo(ctx);
+            }
+        } else if (livre && finalizar && ctx->preenchido > 0) {
+            submeteBlocoFluxo(ctx);
+        } else if (ctx->gravados < ctx->enviados && (!livre || finalizar) && (ctx->gravados > 0 || ctx->enviados > 1 ||
+                   ctx->preenchido > 0 || f->disponivelEntrada > 0 || finalizar)) {
+            // Serializa o bloco mais antigo na saída pendente; o primeiro espera até se saber se é o único
+            TarefaBloco* t = &ctx->tarefas[ctx->gravados % ctx->janela];
+            int unico = ctx->enviados == 1 && ctx->preenchido == 0 && f->disponivelEntrada == 0 && finalizar;
+            if (ctx->gravados == 0 && !unico) {
+                unsigned char* inicio = reservaPendente(ctx, TAMANHO_CABECALHO_CONTAINER);
+                if (inicio == NULL) {
+                    abandonaFluxo(ctx);
+                    return HUFFMAN_ERRO_MEMORIA;
+                }
+                codificaCabecalhoContainer(inicio, ctx->opcoes.tamanhoBloco);
+            }
+            ctx->gravados++;
+            int resultado = concluiBloco(ctx, t, ctx->offsetFluxo);
+            unsigned char cabecalho[TAMANHO_MAX_CABECALHO_QUADRO];
+            int tamanhoCabecalho = 0;
+            size_t tamanho = unico ? cabecalhoQuadroUnico(t, cabecalho, &tamanhoCabecalho) :
+                                     (size_t) tamanhoBlocoCompactado(t->bloco);
+            unsigned char* p = resultado == HUFFMAN_OK ? reservaPendente(ctx, tamanho) : NULL;
+            if (p == NULL) {
+                abandonaFluxo(ctx);
+                return HUFFMAN_ERRO_MEMORIA;
+            }
+            if (unico) {
+                copiaQuadroUnico(t, p, cabecalho, tamanhoCabecalho);
+                ctx->estadoFluxo = FLUXO_CONCLUIDO;
+            } else {
+                copiaBlocoCompactado(t->bloco, p);
+            }
+        } else if (finalizar && ctx->enviados == 0) {
+            // Entrada vazia: o quadro único sem bloco
+            TarefaBloco* t = &ctx->tarefas[0];
+            unsigned char cabecalho[TAMANHO_MAX_CABECALHO_QUADRO];
+            int tamanhoCabecalho;
+            t->tamanho = 0;
+            unsigned char* p = reservaPendente(ctx, cabecalhoQuadroUnico(t, cabecalho, &tamanhoCabecalho));
+            if (p == NULL) {
+                abandonaFluxo(ctx);
+                return HUFFMAN_ERRO_MEMORIA;
+            }
+            copiaQuadroUnico(t, p, cabecalho, tamanhoCabecalho);
+            ctx->estadoFluxo = FLUXO_CONCLUIDO;
+        } else if (finalizar) {
+            unsigned char* p = reservaPendente(ctx, 1 + (size_t) tamanhoIndice(&ctx->indice));
+            if (p == NULL) {
+                abandonaFluxo(ctx);
+                return HUFFMAN_ERRO_MEMORIA;
+            }
+            p[0] = BLOCO_FIM;
+            codificaIndice(&ctx->indice, p + 1, ctx->offsetFluxo - tamanhoIndice(&ctx->indice));
+            ctx->estadoFluxo = FLUXO_CONCLUIDO;
+        } else {
+            return HUFFMAN_OK;
+        }
+    }
+}
+
+/**
+ * @brief Compacta tudo o que for lido de @p entrada até o fim, gravando em @p saida à medida que os
+ *        blocos ficam prontos (entradas sem tamanho conhecido, como pipes).
+ * @param ctx Contexto.
+ * @param entrada Arquivo aberto para leitura (binário).
+ * @param saida Arquivo aberto para escrita (binário).
+ * @param resultado Recebe os tamanhos (pode ser NULL).
+ * @return HUFFMAN_OK ou código de erro.
+ */
+int compactaFluxoArquivo(ContextoCompactacao* ctx, FILE* entrada, FILE* saida, ResultadoHuffman* resultado) {
+    unsigned char* bufferEntrada = (unsigned char*) malloc(TAMANHO_BUFFER_FLUXO);
+    unsigned char* bufferSaida = (unsigned char*) malloc(TAMANHO_BUFFER_FLUXO);
+    FluxoHuffman f = {NULL, 0, NULL, 0, 0, 0};
+    int codigo = bufferEntrada && bufferSaida ? iniciaCompactacaoFluxo(ctx) : HUFFMAN_ERRO_MEMORIA;
+    int fim = 0;
+    TemposFases* tempos = ctx->parametros.medir ? &ctx->medicao.tempos : NULL;
+    MarcaTempo marca;
+
+    while (codigo == HUFFMAN_OK) {
+        if (f.disponivelEntrada == 0 && !fim) {
+            f.entrada = bufferEntrada;
+            iniciaMedicao(tempos, &marca);
+            f.disponivelEntrada = fread(bufferEntrada, sizeof(unsigned char), TAMANHO_BUFFER_FLUXO, entrada);
+            encerraFase(tempos, FASE_LEITURA, &marca);
+            if (ferror(entrada)) {
+                abandonaFluxo(ctx);
+                codigo = HUFFMAN_ERRO_ENTRADA;
+                break;
+            }
+            fim = feof(entrada);
+        }
+        f.saida = bufferSaida;
+        f.disponivelSaida = TAMANHO_BUFFER_FLUXO;
+        codigo = compactaFluxo(ctx, &f, fim);
+        size_t n = TAMANHO_BUFFER_FLUXO - f.disponivelSaida;
+        iniciaMedicao(tempos, &marca);
+        if (fwrite(bufferSaida, sizeof(unsigned char), n, saida) != n) {
+            abandonaFluxo(ctx);
+            codigo = HUFFMAN_ERRO_SAIDA;
+        }
+        encerraFase(tempos, FASE_ESCRITA, &marca);
+    }
+    if (codigo == HUFFMAN_FIM_FLUXO) {
+        codigo = fflush(saida) == 0 ? HUFFMAN_OK : HUFFMAN_ERRO_SAIDA;
+    }
+
+    free(bufferEntrada);
+    free(bufferSaida);
+    if (resultado) {
+        resultado->tamanhoOriginal = f.totalEntrada;
+        resultado->tamanhoCompactado = f.totalSaida;
+    }
+    return codigo;
+}
+
+/**
+ * @brief Varre o arquivo em blocos grandes e acumula em @p arrayFrequencias a contagem por byte (0..255).
+ * @param arquivo Arquivo de entrada aberto; a leitura começa da posição atual e vai até o fim.
+ * @param arrayFrequencias Vetor de 256 posições (unsigned long long) inicializado com zeros.
+ * @return HUFFMAN_OK ou HUFFMAN_ERRO_ENTRADA.
+ */
+static int calculaFrequencias(ArquivoEntrada* arquivo, unsigned long long int* arrayFrequencias) {
+    const unsigned char* bloco;
+    size_t lidos;
+
+    while ((lidos = leBlocoEntrada(arquivo, &bloco)) > 0) {
+        contaFrequencias(bloco, lidos, arrayFrequencias);
+    }
+    return erroArquivoEntrada(arquivo) ? HUFFMAN_ERRO_ENTRADA : HUFFMAN_OK;
+}
+
+/**
+ * @brief Gera o arquivo .comp no formato antigo: cabeçalho + árvore serializada + dados codificados.
+ * @details Um único fluxo para o arquivo inteiro: calcula frequências; constrói árvore; gera
+ *          dicionário; serializa árvore; codifica a entrada.
+ *          Cabeçalho: [4 bytes: tamArvoreBits] [1 byte: bitsVálidosÚltimoByteDados].
+ *          O tamanho dos dados não é gravado (vai até o fim do arquivo), então não há limite de 32 bits.
+ *          A entrada é lida em blocos e os códigos são gravados por um EscritorBits com buffer fixo,
+ *          de modo que a memória usada não depende do tamanho da entrada.
+ * @param arquivoEntrada Arquivo original aberto (lido duas vezes desde o início; um pipe é recusado
+ *        com HUFFMAN_ERRO_ENTRADA e errno ESPIPE antes de qualquer leitura).
+ * @param nomeArquivoSaida Caminho do arquivo de saída (.comp).
+ * @param resultado Recebe os tamanhos.
+ * @param medicao Recebe os tempos, o histograma e os comprimentos (NULL = sem medição); a leitura da
+ *        entrada entra nas frequências e na codificação, e a gravação dos códigos na codificação.
+ * @return HUFFMAN_OK ou código de erro.
+ */
+static int compactaLegado(ArquivoEntrada* arquivoEntrada, const char* nomeArquivoSaida, ResultadoHuffman* resultado,
+                          Medicao* medicao) {
+    TemposFases* tempos = medicao ? &medicao->tempos : NULL;
+    MarcaTempo marca;
+    iniciaMedicao(tempos, &marca);
+
+    // 1. Calcular frequências (a entrada será lida de novo: precisa ser posicionável)
+    unsigned long long int frequencias[256] = {0};
+    if (reiniciaArquivoEntrada(arquivoEntrada) < 0 || calculaFrequencias(arquivoEntrada, frequencias) != HUFFMAN_OK) {
+        return HUFFMAN_ERRO_ENTRADA;
+    }
+    encerraFase(tempos, FASE_FREQUENCIAS, &marca);
+
+    // 2. Construir a árvore e gerar o dicionário de códigos
+    ArvoreHuffman arvore;
+    construirArvoreHuffman(frequencias, &arvore);
+    encerraFase(tempos, FASE_ARVORE, &marca);
+    Codigo dicionario[256] = {{0, 0}};
+    if (gerarDicionario(dicionario, &arvore) < 0) {
+        return HUFFMAN_ERRO_CODIGO_LONGO;
+    }
+    encerraFase(tempos, FASE_DICIONARIO, &marca);
+    if (medicao) {
+        for (int i = 0; i < 256; i++) {
+            medicao->frequencias[i] += frequencias[i];
+            medicao->bytesPorComprimento[dicionario[i].tamanho] += frequencias[i];
+        }
+    }
+
+    // 3. Calcular o tamanho dos dados comprimidos (necessário para o cabeçalho, gravado antes dos dados)
+    unsigned long long int tamanhoComprimidoBits = 0;
+    resultado->tamanhoOriginal = 0;
+    for (int i = 0; i < 256; i++) {
+        tamanhoComprimidoBits += frequencias[i] * dicionario[i].tamanho;
+        resultado->tamanhoOriginal += frequencias[i];
+    }
+
+    // 4. Serializar a árvore e escrever o cabeçalho
+    if (reiniciaArquivoEntrada(arquivoEntrada) < 0) {
+        return HUFFMAN_ERRO_ENTRADA;
+    }
+    FILE* arquivoSaida = fopen(nomeArquivoSaida, "wb");
+    if (!arquivoSaida) {
+        return HUFFMAN_ERRO_SAIDA;
+    }
+    bitmap* bitmapArvore = bitmapInit(TAMANHO_MAX_ARVORE_BITS);
+    serializarArvore(&arvore, bitmapArvore);
+    unsigned int tamanhoArvore = bitmapGetLength(bitmapArvore);
+    unsigned int bytesArvore = (tamanhoArvore + 7) / 8;
+    unsigned char cabecalho[5];
+    escreveU32(cabecalho, tamanhoArvore);
+    cabecalho[4] = tamanhoComprimidoBits % 8 == 0 ? 8 : tamanhoComprimidoBits % 8;   // bits válidos no último byte
+    fwrite(cabecalho, sizeof(unsigned char), 5, arquivoSaida);
+    fwrite(bitmapGetContents(bitmapArvore), sizeof(unsigned char), bytesArvore, arquivoSaida);
+    bitmapLibera(bitmapArvore);
+    encerraFase(tempos, FASE_ARVORE, &marca);
+
+    // 5. Codificar o arquivo em blocos; o escritor grava palavras de 64 bits à medida que se completam
+    EscritorBits* escritor = criaEscritorBits(arquivoSaida);
+    if (escritor == NULL) {
+        fclose(arquivoSaida);
+        return HUFFMAN_ERRO_MEMORIA;
+    }
+    const unsigned char* bloco;
+    size_t lidos;
+    while ((lidos = leBlocoEntrada(arquivoEntrada, &bloco)) > 0) {
+        codificaBuffer(escritor, dicionario, bloco, lidos);
+    }
+
+    // 6. Gravar os bits pendentes (último byte possivelmente incompleto)
+    unsigned long long int bytesDados = (finalizaEscritorBits(escritor) + 7) / 8;
+    liberaEscritorBits(escritor);
+    resultado->tamanhoCompactado = 5 + bytesArvore + bytesDados;
+    encerraFase(tempos, FASE_CODIFICACAO, &marca);
+
+    int erroEscrita = ferror(arquivoSaida);
+    if (fclose(arquivoSaida) != 0 || erroEscrita) {
+        return HUFFMAN_ERRO_SAIDA;
+    }
+    encerraFase(tempos, FASE_ESCRITA, &marca);
+    return erroArquivoEntrada(arquivoEntrada) ? HUFFMAN_ERRO_ENTRADA : HUFFMAN_OK;
+}
+
+/**
+ * @brief Abre a origem dos blocos de um arquivo: leitura antecipada pela fila de transferências para
+ *        arquivos regulares; leitura sequencial (abreArquivoEntrada) para pipes e dispositivos.
+ * @param fd Recebe o descritor do leitor (-1 sem leitor).
+ * @return HUFFMAN_OK, HUFFMAN_ERRO_ENTRADA ou HUFFMAN_ERRO_MEMORIA.
+ */
+static int abreFonteArquivo(ContextoCompactacao* ctx, const char* nomeEntrada, FonteBlocos* fonte, int* fd) {
+    // Com O_DIRECT cada bloco é uma leitura, então o tamanho do bloco precisa ser alinhado
+    int direto = ctx->opcoes.direto && ctx->opcoes.tamanhoBloco % ALINHAMENTO_TRANSFERENCIA == 0;
+    struct stat st;
+    *fd = abreArquivoTransferencia(nomeEntrada, O_RDONLY, direto, NULL);
+    if (*fd < 0 || fstat(*fd, &st) != 0) {
+        if (*fd >= 0) {
+            close(*fd);
+        }
+        *fd = -1;
+        return HUFFMAN_ERRO_ENTRADA;
+    }
+    if (!S_ISREG(st.st_mode)) {
+        // O mesmo descritor, sem O_DIRECT: reabrir um FIFO perderia o que já foi escrito nele
+#ifdef O_DIRECT
+        int flags = fcntl(*fd, F_GETFL);
+        if (direto && flags >= 0) {
+            fcntl(*fd, F_SETFL, flags & ~O_DIRECT);
+        }
+#endif
+        fonte->arquivo = abreDescritorEntrada(*fd);
+        *fd = -1;
+        return fonte->arquivo ? HUFFMAN_OK : HUFFMAN_ERRO_ENTRADA;
+    }
+    fonte->leitor = criaLeitorAntecipado(ctx->fila, *fd, (unsigned long long int) st.st_size, ctx->opcoes.tamanhoBloco,
+                                         ctx->janela + ctx->leiturasAntecipadas);
+    return fonte->leitor ? HUFFMAN_OK : HUFFMAN_ERRO_MEMORIA;
+}
+
+/**
+ * @brief Abre o destino dos blocos de um arquivo: gravação adiada pela fila de transferências para
+ *        arquivos regulares; fwrite para pipes e dispositivos.
+ * @param fd Recebe o descritor do gravador (-1 sem gravador).
+ * @return HUFFMAN_OK, HUFFMAN_ERRO_SAIDA ou HUFFMAN_ERRO_MEMORIA.
+ */
+static int abreSaidaArquivo(ContextoCompactacao* ctx, const char* nomeSaida, SaidaBlocos* saida, int* fd) {
+    int direto;
+    struct stat st;
+    *fd = abreArquivoTransferencia(nomeSaida, O_WRONLY | O_CREAT | O_TRUNC, ctx->opcoes.direto, &direto);
+    if (*fd < 0 || fstat(*fd, &st) != 0) {
+        if (*fd >= 0) {
+            close(*fd);
+        }
+        *fd = -1;
+        return HUFFMAN_ERRO_SAIDA;
+    }
+    if (!S_ISREG(st.st_mode)) {
+        saida->arquivo = fdopen(*fd, "wb");
+        if (saida->arquivo == NULL) {
+            close(*fd);
+        }
+        *fd = -1;
+        return saida->arquivo ? HUFFMAN_OK : HUFFMAN_ERRO_SAIDA;
+    }
+    saida->gravador = criaGravadorAdiado(ctx->fila, *fd, TAMANHO_BUFFER_GRAVACAO, ctx->buffersGravacao, direto);
+    return saida->gravador ? HUFFMAN_OK : HUFFMAN_ERRO_MEMORIA;
+}
+
+/**
+ * @brief Compacta um arquivo.
+ * @details No formato em blocos, a leitura dos blocos seguintes e a gravação dos anteriores correm
+ *          em segundo plano (io_uring ou threads com pread/pwrite) enquanto os da janela são
+ *          compactados. No formato antigo, a entrada é mapeada (quando possível) e lida duas vezes.
+ * @param ctx Contexto.
+ * @param nomeEntrada Caminho do arquivo original.
+ * @param nomeSaida Caminho do arquivo compactado (criado ou sobrescrito).
+ * @param resultado Recebe os tamanhos (pode ser NULL).
+ * @return HUFFMAN_OK ou código de erro.
+ */
+int compactaArquivo(ContextoCompactacao* ctx, const char* nomeEntrada, const char* nomeSaida,
+                    ResultadoHuffman* resultado) {
+    ResultadoHuffman r = {0, 0};
+    int codigo;
+    if (ctx->opcoes.legado) {
+        ArquivoEntrada* arquivoEntrada = abreArquivoEntrada(nomeEntrada);
+        if (arquivoEntrada == NULL) {
+            return HUFFMAN_ERRO_ENTRADA;
+        }
+        codigo = compactaLegado(arquivoEntrada, nomeSaida, &r, ctx->parametros.medir ? &ctx->medicao : NULL);
+        fechaArquivoEntrada(arquivoEntrada);
+    } else {
+        FonteBlocos fonte = {NULL, NULL, 0, 0, NULL};
+        SaidaBlocos saida = {NULL, NULL, 0, 0, NULL};
+        int fdEntrada = -1, fdSaida = -1;
+        codigo = abreFonteArquivo(ctx, nomeEntrada, &fonte, &fdEntrada);
+        if (codigo == HUFFMAN_OK) {
+            codigo = abreSaidaArquivo(ctx, nomeSaida, &saida, &fdSaida);
+        }
+        if (codigo == HUFFMAN_OK) {
+            codigo = compactaBlocos(ctx, &fonte, &saida, &r.tamanhoOriginal);
+            r.tamanhoCompactado = saida.pos;
+        }
+
+        liberaLeitorAntecipado(fonte.leitor);
+        fechaArquivoEntrada(fonte.arquivo);
+        if (fdEntrada >= 0) {
+            close(fdEntrada);
+        }
+        liberaGravadorAdiado(saida.gravador);
+        if (fdSaida >= 0 && close(fdSaida) != 0 && codigo == HUFFMAN_OK) {
+            codigo = HUFFMAN_ERRO_SAIDA;
+        }
+        if (saida.arquivo) {
+            int erroEscrita = ferror(saida.arquivo);
+            if ((fclose(saida.arquivo) != 0 || erroEscrita) && codigo == HUFFMAN_OK) {
+                codigo = HUFFMAN_ERRO_SAIDA;
+            }
+        }
+    }
+    if (resultado) {
+        *resultado = r;
+    }
+    return codigo;
+}
+
+/**
+ * @brief Liga ou desliga a medição das próximas compactações; as medições anteriores são zeradas.
+ * @details Desligada (o padrão), nenhum relógio é lido.
+ * @param ctx Contexto.
+ * @param ativa 1 para medir; 0 para não medir.
+ */
+void ativaEstatisticasCompactacao(ContextoCompactacao* ctx, int ativa) {
+    ctx->parametros.medir = ativa != 0;
+    memset(&ctx->medicao, 0, sizeof(Medicao));
+}
+
+/**
+ * @brief Medições acumuladas desde ativaEstatisticasCompactacao.
+ * @param ctx Contexto.
+ * @param estatisticas Recebe as medições.
+ */
+void estatisticasCompactacao(const ContextoCompactacao* ctx, EstatisticasHuffman* estatisticas) {
+    copiaEstatisticas(&ctx->medicao, estatisticas);
+}
+
+/**
+ * @brief Libera o contexto, suas threads e áreas de trabalho.
+ * @param ctx Contexto (pode ser NULL).
+ */
+void liberaContextoCompactacao(ContextoCompactacao* ctx) {
+    if (ctx == NULL) {
+        return;
+    }
+    if (ctx->pool) {
+        abandonaFluxo(ctx);
+        liberaPoolThreads(ctx->pool);
+    }
+    if (ctx->tarefas) {
+        for (int i = 0; i < ctx->janela; i++) {
+            liberaBlocoCompactado(ctx->tarefas[i].bloco);
+            free(ctx->tarefas[i].copia);
+        }
+        free(ctx->tarefas);
+    }
+    liberaFilaTransferencias(ctx->fila);
+    liberaIndice(&ctx->indice);
+    free(ctx->pendente);
+    free(ctx->serializado);
+    free(ctx);
+}
+
+/**
+ * @brief Código de erro de um bloco que não pôde ser descompactado.
+ * @param resultado Retorno de descompactaBloco (-1 também para as demais falhas do bloco).
+ * @return HUFFMAN_ERRO_CRC se o CRC32C não conferiu; HUFFMAN_ERRO_DICIONARIO se o bloco usar um
+ *         dicionário ausente ou diferente; HUFFMAN_ERRO_CORROMPIDO caso contrário.
+ */
+static int erroBloco(int resultado, const Dicionario* dicionario, const CabecalhoBloco* c, const unsigned char* corpo) {
+    if (resultado == -2) {
+        return HUFFMAN_ERRO_CRC;
+    }
+    return dicionarioConfere(dicionario, c, corpo) ? HUFFMAN_ERRO_CORROMPIDO : HUFFMAN_ERRO_DICIONARIO;
+}
+
+/**
+ * @brief Descompacta, na thread do pool, um bloco já lido em t->corpo (cabeçalho + corpo).
+ */
+static void executaTarefaDescompactacao(void* arg) {
+    TarefaDescompactacao* t = (TarefaDescompactacao*) arg;
+    const EntradaIndice* e = t->entrada;
+    TemposFases* tempos = t->medir ? &t->tempos : NULL;
+    CabecalhoBloco c;
+
+    decodificaCabecalhoBloco(t->corpo, &c);
+    t->semCrc = !c.crc;
+    t->resultado = HUFFMAN_ERRO_CORROMPIDO;
+    if (c.tamanhoOriginal != e->tamanhoOriginal || c.bitsDados != e->bitsDados ||
+        TAMANHO_CABECALHO_BLOCO + tamanhoCorpoBloco(&c) != t->tamanhoArquivo) {
+        return;
+    }
+    t->resultado = HUFFMAN_ERRO_MEMORIA;
+    if (garanteBufferAlinhado(&t->saida, &t->capacidadeSaida, c.tamanhoOriginal) < 0) {
+        return;
+    }
+    const unsigned char* corpo = t->corpo + TAMANHO_CABECALHO_BLOCO;
+    int decodificado = descompactaBloco(t->decodificador, t->dicionario, &c, corpo, t->saida, tempos);
+    t->resultado = decodificado < 0 ? erroBloco(decodificado, t->dicionario, &c, corpo) : HUFFMAN_OK;
+}
+
+/**
+ * @brief Cria um contexto de descompactação cujo pool tem @p numThreads threads.
+ * @param numThreads 0 = sem threads: cada bloco é descompactado na própria thread da chamada (lotes).
+ * @return Contexto ou NULL em falta de memória.
+ */
+static ContextoDescompactacao* criaContextoDescompactacaoPool(int numThreads) {
+    ContextoDescompactacao* ctx = (ContextoDescompactacao*) calloc(1, sizeof(ContextoDescompactacao));
+    if (ctx == NULL) {
+        return NULL;
+    }
+    ctx->janela = numThreads > 0 ? 2 * numThreads : 1;
+    ctx->pool = criaPoolThreads(numThreads);
+    ctx->tarefas = (TarefaDescompactacao*) calloc(ctx->janela, sizeof(TarefaDescompactacao));
+    ctx->decodificador = criaDecodificadorVazio();
+    ctx->fila = criaFilaTransferencias(numThreads > 0 ? 2 * ctx->janela : 0);
+    if (ctx->pool == NULL || ctx->tarefas == NULL || ctx->decodificador == NULL || ctx->fila == NULL) {
+        liberaContextoDescompactacao(ctx);
+        return NULL;
+    }
+    for (int i = 0; i < ctx->janela; i++) {
+        TarefaDescompactacao* t = &ctx->tarefas[i];
+        t->decodificador = criaDecodificadorVazio();
+        if (t->decodificador == NULL) {
+            liberaContextoDescompactacao(ctx);
+            return NULL;
+        }
+        t->tarefa.funcao = executaTarefaDescompactacao;
+        t->tarefa.arg = t;
+    }
+    return ctx;
+}
+
+/**
+ * @brief Cria um contexto de descompactação.
+ * @param numThreads Threads para descompactar blocos em paralelo (0 = número de processadores).
+ * @return Contexto ou NULL em falta de memória.
+ */
+ContextoDescompactacao* criaContextoDescompactacao(int numThreads) {
+    return criaContextoDescompactacaoPool(numThreads > 0 ? numThreads : numeroProcessadores());
+}
+
+/**
+ * @brief Informa o dicionário dos blocos compactados com um (BLOCO_DICIONARIO); as tabelas dele são
+ *        usadas diretamente, sem montar nada por bloco.
+ * @details O dicionário não é copiado e deve existir enquanto o contexto o usar.
+ * @param ctx Contexto.
+ * @param dicionario Dicionário (NULL remove o atual).
+ * @return HUFFMAN_OK.
+ */
+int defineDicionarioDescompactacao(ContextoDescompactacao* ctx, const DicionarioHuffman* dicionario) {
+    ctx->dicionario = dicionario;
+    return HUFFMAN_OK;
+}
+
+/**
+ * @brief Percorre os blocos de um buffer no formato em blocos.
+ * @param origem Bytes compactados.
+ * @param tamanho Quantidade de bytes.
+ * @param pos Posição do próximo bloco; avança para o seguinte.
+ * @param c Recebe o cabeçalho do bloco (tipo BLOCO_FIM no terminador).
+ * @return HUFFMAN_OK ou HUFFMAN_ERRO_CORROMPIDO se o bloco ultrapassar o buffer.
+ */
+static int proximoBlocoMemoria(const unsigned char* origem, size_t tamanho, size_t* pos, CabecalhoBloco* c) {
+    if (*pos >= tamanho) {
+        return HUFFMAN_ERRO_CORROMPIDO;
+    }
+    if (origem[*pos] == BLOCO_FIM) {
+        c->tipo = BLOCO_FIM;
+        *pos += 1;
+        return HUFFMAN_OK;
+    }
+    if (tamanho - *pos < TAMANHO_CABECALHO_BLOCO) {
+        return HUFFMAN_ERRO_CORROMPIDO;
+    }
+    decodificaCabecalhoBloco(origem + *pos, c);
+    *pos += TAMANHO_CABECALHO_BLOCO;
+    if (tamanhoCorpoBloco(c) > tamanho - *pos) {
+        return HUFFMAN_ERRO_CORROMPIDO;
+    }
+    return HUFFMAN_OK;
+}
+
+/**
+ * @brief Valida o cabeçalho de um buffer no formato em blocos.
+ * @return HUFFMAN_OK ou HUFFMAN_ERRO_FORMATO.
+ */
+static int verificaCabecalhoMemoria(const unsigned char* origem, size_t tamanho) {
+    unsigned int tamanhoBloco;
+    if (origem == NULL || tamanho < TAMANHO_CABECALHO_CONTAINER || !ehContainer(origem) ||
+        decodificaCabecalhoContainer(origem, &tamanhoBloco) < 0) {
+        return HUFFMAN_ERRO_FORMATO;
+    }
+    return HUFFMAN_OK;
+}
+
+/**
+ * @brief Interpreta o cabeçalho de um quadro único em memória.
+ * @param c Recebe o cabeçalho do bloco (tipo BLOCO_FIM para uma entrada vazia).
+ * @param pos Recebe a posição do corpo do bloco.
+ * @return HUFFMAN_OK ou HUFFMAN_ERRO_CORROMPIDO se o cabeçalho for inválido ou o corpo do bloco não
+ *         ocupar exatamente o resto do buffer.
+ */
+static int leQuadroMemoria(const unsigned char* origem, size_t tamanho, CabecalhoBloco* c, size_t* pos) {
+    int n = decodificaCabecalhoQuadro(origem, tamanho, c);
+    if (n <= 0) {
+        return HUFFMAN_ERRO_CORROMPIDO;
+    }
+    *pos = (size_t) n;
+    unsigned long long int corpo = c->tipo == BLOCO_FIM ? 0 : tamanhoCorpoBloco(c);
+    return corpo == tamanho - *pos ? HUFFMAN_OK : HUFFMAN_ERRO_CORROMPIDO;
+}
+
+/**
+ * @brief Tamanho original dos dados em um buffer no formato em blocos (somando os cabeçalhos dos blocos)
+ *        ou em um quadro único.
+ * @param origem Bytes compactados.
+ * @param tamanho Quantidade de bytes.
+ * @param tamanhoOriginal Recebe o tamanho descompactado.
+ * @return HUFFMAN_OK, HUFFMAN_ERRO_FORMATO ou HUFFMAN_ERRO_CORROMPIDO.
+ */
+int tamanhoDescompactado(const void* origem, size_t tamanho, unsigned long long int* tamanhoOriginal) {
+    const unsigned char* p = (const unsigned char*) origem;
+    size_t pos = TAMANHO_CABECALHO_CONTAINER;
+    CabecalhoBloco c;
+
+    *tamanhoOriginal = 0;
+    if (p != NULL && ehQuadroUnico(p, tamanho)) {
+        int resultado = leQuadroMemoria(p, tamanho, &c, &pos);
+        *tamanhoOriginal = resultado == HUFFMAN_OK && c.tipo != BLOCO_FIM ? c.tamanhoOriginal : 0;
+        return resultado;
+    }
+    int resultado = verificaCabecalhoMemoria(p, tamanho);
+    while (resultado == HUFFMAN_OK && (resultado = proximoBlocoMemoria(p, tamanho, &pos, &c)) == HUFFMAN_OK &&
+           c.tipo != BLOCO_FIM) {
+        *tamanhoOriginal += c.tamanhoOriginal;
+        pos += tamanhoCorpoBloco(&c);
+    }
+    return resultado;
+}
+
+/**
+ * @brief Descompacta um buffer no formato em blocos ou em um quadro único, em memória.
+ * @details Os blocos são decodificados em sequência direto da origem para o destino, com as tabelas
+ *          do contexto.
+ * @param ctx Contexto.
+ * @param origem Bytes compactados.
+ * @param tamanho Quantidade de bytes.
+ * @param destino Buffer de saída (tamanhoDescompactado bytes).
+ * @param capacidade Bytes disponíveis em @p destino.
+ * @param tamanhoSaida Recebe a quantidade de bytes gravados.
+ * @return HUFFMAN_OK ou código de erro (o formato antigo só é aceito por descompactaArquivo).
+ */
+int descompactaMemoria(ContextoDescompactacao* ctx, const void* origem, size_t tamanho,
+                       void* destino, size_t capacidade, size_t* tamanhoSaida) {
+    const unsigned char* p = (const unsigned char*) origem;
+    unsigned char* saida = (unsigned char*) destino;
+    int quadro = p != NULL && ehQuadroUnico(p, tamanho);
+    int resultado = quadro ? HUFFMAN_OK : verificaCabecalhoMemoria(p, tamanho);
+    size_t pos = TAMANHO_CABECALHO_CONTAINER;
+    CabecalhoBloco c;
+
+    *tamanhoSaida = 0;
+    while (resultado == HUFFMAN_OK &&
+           (resultado = quadro ? leQuadroMemoria(p, tamanho, &c, &pos) : proximoBlocoMemoria(p, tamanho, &pos, &c)) ==
+           HUFFMAN_OK && c.tipo != BLOCO_FIM) {
+        if (c.tamanhoOriginal > capacidade - *tamanhoSaida) {
+            return HUFFMAN_ERRO_DESTINO_PEQUENO;
+        }
+        int decodificado = descompactaBloco(ctx->decodificador, ctx->dicionario, &c, p + pos, saida + *tamanhoSaida,
+                                            ctx->medir ? &ctx->medicao.tempos : NULL);
+        if (decodificado < 0) {
+            return erroBloco(decodificado, ctx->dicionario, &c, p + pos);
+        }
+        ctx->medicao.blocos += ctx->medir;
+        *tamanhoSaida += c.tamanhoOriginal;
+        pos += tamanhoCorpoBloco(&c);
+        if (quadro) {
+            break;      // o quadro único tem um só bloco
+        }
+    }
+    return resultado;
+}
+
+/**
+ * @brief Junta em @p destino os bytes de uma estrutura que pode chegar dividida entre chamadas.
+ * @param destino Buffer da estrutura.
+ * @param lidos Bytes já recebidos; avança.
+ * @param total Tamanho da estrutura.
+ * @param f Fluxo de onde os bytes são consumidos.
+ * @return 1 quando a estrutura está completa; 0 se faltar entrada.
+ */
+static int acumulaFluxo(unsigned char* destino, size_t* lidos, size_t total, FluxoHuffman* f) {
+    size_t n = total - *lidos;
+    if (n > f->disponivelEntrada) {
+        n = f->disponivelEntrada;
+    }
+    if (n > 0) {
+        memcpy(destino + *lidos, f->entrada, n);
+    }
+    f->entrada += n;
+    f->disponivelEntrada -= n;
+    f->totalEntrada += n;
+    *lidos += n;
+    return *lidos == total;
+}
+
+/**
+ * @brief Começa uma descompactação incremental do formato em blocos.
+ * @param ctx Contexto.
+ * @return HUFFMAN_OK.
+ */
+int iniciaDescompactacaoFluxo(ContextoDescompactacao* ctx) {
+    ctx->estadoFluxo = FLUXO_CABECALHO;
+    ctx->lidosFluxo = 0;
+    ctx->quadroFluxo = 0;
+    // O quadro único não declara o tamanho do bloco: vale o máximo das opções
+    ctx->tamanhoBlocoFluxo = HUFFMAN_TAMANHO_BLOCO_MAX;
+    return HUFFMAN_OK;
+}
+
+/**
+ * @brief Bytes do corpo acumulados antes de decodificar um bloco do fluxo: a descrição do código, ou o
+ *        corpo inteiro de um bloco lido inteiro (blocoLidoInteiro).
+ */
+static size_t descricaoFluxo(const CabecalhoBloco* c) {
+    return blocoLidoInteiro(c) ? (size_t) tamanhoCorpoBloco(c) : (c->tamanhoArvore + 7) / 8;
+}
+
+/**
+ * @brief Prepara a leitura do corpo do bloco cujo cabeçalho está em ctx->blocoFluxo.
+ * @return HUFFMAN_OK ou código de erro (o fluxo é abandonado).
+ */
+static int iniciaBlocoFluxo(ContextoDescompactacao* ctx) {
+    const CabecalhoBloco* c = &ctx->blocoFluxo;
+    ctx->medicao.blocos += ctx->medir;
+    // Um bloco lido inteiro (blocoLidoInteiro) é descompactado de uma vez (é sempre
+    // menor que o original); nenhum bloco passa do tamanho declarado no cabeçalho do arquivo
+    if (c->tamanhoOriginal > ctx->tamanhoBlocoFluxo ||
+        (blocoLidoInteiro(c) && tamanhoCodificadoBloco(c) >= c->tamanhoOriginal)) {
+        ctx->estadoFluxo = FLUXO_INATIVO;
+        return HUFFMAN_ERRO_CORROMPIDO;
+    }
+    if (garanteCapacidade(&ctx->corpo, &ctx->capacidadeCorpo, descricaoFluxo(c)) < 0 ||
+        (blocoLidoInteiro(c) &&
+         garanteCapacidade(&ctx->saidaFluxo, &ctx->capacidadeSaidaFluxo, c->tamanhoOriginal) < 0)) {
+        ctx->estadoFluxo = FLUXO_INATIVO;
+        return HUFFMAN_ERRO_MEMORIA;
+    }
+    ctx->lidosFluxo = 0;
+    ctx->estadoFluxo = FLUXO_DESCRICAO;
+    return HUFFMAN_OK;
+}
+
+/**
+ * @brief Estado do fluxo ao fim de um bloco: o próximo cabeçalho, ou o fim do quadro único.
+ */
+static int estadoAposBloco(const ContextoDescompactacao* ctx) {
+    return ctx->quadroFluxo ? FLUXO_CONCLUIDO : FLUXO_BLOCO;
+}
+
+/**
+ * @brief Consome entrada e produz saída do fluxo iniciado com iniciaDescompactacaoFluxo.
+ * @details Cabeçalhos, descrições de código e dados podem chegar divididos em qualquer ponto, inclusive
+ *          no meio de um código: o estado da decodificação é guardado no contexto. O índice após o
+ *          terminador não é necessário e não é consumido. O CRC32C de um bloco é conferido ao fim dele,
+ *          depois que seus bytes já saíram: o erro HUFFMAN_ERRO_CRC invalida a saída do bloco.
+ * @param ctx Contexto.
+ * @param f Buffers de entrada e saída; avançam sobre o que foi consumido e produzido.
+ * @return HUFFMAN_OK quando precisa de mais entrada ou espaço na saída, HUFFMAN_FIM_FLUXO após o
+ *         terminador ou o fim do quadro único, ou código de erro (HUFFMAN_ERRO_FORMATO para o formato antigo, que não tem fim
+ *         marcado; o fluxo é abandonado).
+ */
+int descompactaFluxo(ContextoDescompactacao* ctx, FluxoHuffman* f) {
+    CabecalhoBloco* c = &ctx->blocoFluxo;
+    int resultado;
+    for (;;) {
+        switch (ctx->estadoFluxo) {
+            case FLUXO_CABECALHO: {
+                // Os primeiros bytes distinguem o quadro único do container
+                if (ctx->lidosFluxo < TAMANHO_MAGICO_QUADRO) {
+                    if (!acumulaFluxo(ctx->cabecalhoFluxo, &ctx->lidosFluxo, TAMANHO_MAGICO_QUADRO, f)) {
+                        return HUFFMAN_OK;
+                    }
+                    if (ehQuadroUnico(ctx->cabecalhoFluxo, ctx->lidosFluxo)) {
+                        ctx->quadroFluxo = 1;
+                        ctx->estadoFluxo = FLUXO_QUADRO;
+                        break;
+                    }
+                }
+                if (!acumulaFluxo(ctx->cabecalhoFluxo, &ctx->lidosFluxo, TAMANHO_CABECALHO_CONTAINER, f)) {
+                    return HUFFMAN_OK;
+                }
+                if (!ehContainer(ctx->cabecalhoFluxo) ||
+                    decodificaCabecalhoContainer(ctx->cabecalhoFluxo, &ctx->tamanhoBlocoFluxo) < 0 ||
+                    ctx->tamanhoBlocoFluxo > HUFFMAN_TAMANHO_BLOCO_MAX) {
+                    ctx->estadoFluxo = FLUXO_INATIVO;
+                    return HUFFMAN_ERRO_FORMATO;
+                }
+                ctx->lidosFluxo = 0;
+                ctx->estadoFluxo = FLUXO_BLOCO;
+                break;
+            }
+            case FLUXO_QUADRO: {
+                // O cabeçalho tem tamanho variável: os bytes entram um a um até ele se completar
+                int n;
+                while ((n = decodificaCabecalhoQuadro(ctx->cabecalhoFluxo, ctx->lidosFluxo, c)) == 0) {
+                    if (!acumulaFluxo(ctx->cabecalhoFluxo, &ctx->lidosFluxo, ctx->lidosFluxo + 1, f)) {
+                        return HUFFMAN_OK;
+                    }
+                }
+                if (n < 0) {
+                    ctx->estadoFluxo = FLUXO_INATIVO;
+                    return HUFFMAN_ERRO_CORROMPIDO;
+                }
+                if (c->tipo == BLOCO_FIM) {
+                    ctx->estadoFluxo = FLUXO_CONCLUIDO;
+                    break;
+                }
+                resultado = iniciaBlocoFluxo(ctx);
+                if (resultado != HUFFMAN_OK) {
+                    return resultado;
+                }
+                break;
+            }
+            case FLUXO_BLOCO:
+                if (ctx->lidosFluxo == 0 && f->disponivelEntrada > 0 && f->entrada[0] == BLOCO_FIM) {
+                    f->entrada++;
+                    f->disponivelEntrada--;
+                    f->totalEntrada++;
+                    ctx->estadoFluxo = FLUXO_CONCLUIDO;
+                    break;
+                }
+                if (!acumulaFluxo(ctx->cabecalhoFluxo, &ctx->lidosFluxo, TAMANHO_CABECALHO_BLOCO, f)) {
+                    return HUFFMAN_OK;
+                }
+                decodificaCabecalhoBloco(ctx->cabecalhoFluxo, c);
+                resultado = iniciaBlocoFluxo(ctx);
+                if (resultado != HUFFMAN_OK) {
+                    return resultado;
+                }
+                break;
+            case FLUXO_DESCRICAO:
+                if (!acumulaFluxo(ctx->corpo, &ctx->lidosFluxo, descricaoFluxo(c), f)) {
+                    return HUFFMAN_OK;
+                }
+                ctx->produzidosBloco = 0;
+                ctx->crcFluxo = 0;
+                if (blocoLidoInteiro(c)) {
+                    int decodificado = descompactaBloco(ctx->decodificador, ctx->dicionario, c, ctx->corpo,
+                                                        ctx->saidaFluxo, NULL);
+                    if (decodificado < 0) {
+                        ctx->estadoFluxo = FLUXO_INATIVO;
+                        return erroBloco(decodificado, ctx->dicionario, c, ctx->corpo);
+                    }
+                }
+                if (blocoSemCodigo(c) || blocoLidoInteiro(c)) {
+                    ctx->estadoFluxo = FLUXO_DADOS;
+                    break;
+                }
+                ctx->tabelasFluxo = decodificadorBloco(ctx->decodificador, ctx->dicionario, c, ctx->corpo);
+                if (ctx->tabelasFluxo == NULL) {
+                    ctx->estadoFluxo = FLUXO_INATIVO;
+                    return erroBloco(-1, ctx->dicionario, c, ctx->corpo);
+                }
+                iniciaEstadoDecodificacao(&ctx->bitsFluxo, c->bitsDados);
+                ctx->estadoFluxo = FLUXO_DADOS;
+                break;
+            case FLUXO_DADOS: {
+                // O bloco não pode produzir mais que tamanhoOriginal bytes
+                size_t capacidade = f->disponivelSaida;
+                if (capacidade > c->tamanhoOriginal - ctx->produzidosBloco) {
+                    capacidade = (size_t) (c->tamanhoOriginal - ctx->produzidosBloco);
+                }
+                if (blocoSemCodigo(c) || blocoLidoInteiro(c)) {
+                    size_t n = capacidade;
+                    if (blocoLidoInteiro(c)) {
+                        memcpy(f->saida, ctx->saidaFluxo + ctx->produzidosBloco, n);
+                    } else if (c->tipo == BLOCO_ARMAZENADO) {
+                        n = n < f->disponivelEntrada ? n : f->disponivelEntrada;
+                        memcpy(f->saida, f->entrada, n);
+                        f->entrada += n;
+                        f->disponivelEntrada -= n;
+                        f->totalEntrada += n;
+                    } else {
+                        memset(f->saida, ctx->corpo[0], n);
+                    }
+                    // O bloco lido inteiro já foi conferido por descompactaBloco
+                    if (c->crc && !blocoLidoInteiro(c)) {
+                        ctx->crcFluxo = crc32c(ctx->crcFluxo, f->saida, n);
+                    }
+                    f->saida += n;
+                    f->disponivelSaida -= n;
+                    f->totalSaida += n;
+                    ctx->produzidosBloco += n;
+                    if (ctx->produzidosBloco < c->tamanhoOriginal) {
+                        return HUFFMAN_OK;
+                    }
+                    ctx->lidosFluxo = 0;
+                    ctx->estadoFluxo = c->crc && !blocoLidoInteiro(c) ? FLUXO_CRC : estadoAposBloco(ctx);
+                    break;
+                }
+                const unsigned char* inicio = f->entrada;
+                size_t produzidos;
+                int r = decodificaIncremental(ctx->tabelasFluxo, &ctx->bitsFluxo, &f->entrada,
+                                              &f->disponivelEntrada, f->saida, capacidade, &produzidos);
+                f->totalEntrada += (size_t) (f->entrada - inicio);
+                if (c->crc) {
+                    ctx->crcFluxo = crc32c(ctx->crcFluxo, f->saida, produzidos);
+                }
+                f->saida += produzidos;
+                f->disponivelSaida -= produzidos;
+                f->totalSaida += produzidos;
+                ctx->produzidosBloco += produzidos;
+                if (r < 0 || (r == 1 && ctx->produzidosBloco != c->tamanhoOriginal) ||
+                    (r == 0 && ctx->produzidosBloco == c->tamanhoOriginal)) {
+                    ctx->estadoFluxo = FLUXO_INATIVO;
+                    return HUFFMAN_ERRO_CORROMPIDO;
+                }
+                if (r == 0) {
+                    return HUFFMAN_OK;
+                }
+                ctx->lidosFluxo = 0;
+                ctx->estadoFluxo = c->crc ? FLUXO_CRC : estadoAposBloco(ctx);
+                break;
+            }
+            case FLUXO_CRC:
+                if (!acumulaFluxo(ctx->cabecalhoFluxo, &ctx->lidosFluxo, TAMANHO_CRC_BLOCO, f)) {
+                    return HUFFMAN_OK;
+                }
+                if (leU32(ctx->cabecalhoFluxo) != ctx->crcFluxo) {
+                    ctx->estadoFluxo = FLUXO_INATIVO;
+                    return HUFFMAN_ERRO_CRC;
+                }
+                ctx->lidosFluxo = 0;
+                ctx->estadoFluxo = estadoAposBloco(ctx);
+                break;
+            case FLUXO_CONCLUIDO:
+                return HUFFMAN_FIM_FLUXO;
+            default:
+                return HUFFMAN_ERRO_PARAMETRO;
+        }
+    }
+}
+
+/**
+ * @brief Descompacta o formato em blocos lido de @p entrada, gravando em @p saida à medida que os
+ *        blocos são decodificados (entradas sem posicionamento, como pipes).
+ * @details Após o terminador, o resto da entrada (o índice) é lido e descartado.
+ * @param ctx Contexto.
+ * @param entrada Arquivo aberto para leitura (binário).
+ * @param saida Arquivo aberto para escrita (binário).
+ * @param resultado Recebe os tamanhos (pode ser NULL).
+ * @return HUFFMAN_OK ou código de erro (HUFFMAN_ERRO_CORROMPIDO se a entrada acabar antes do terminador).
+ */
+int descompactaFluxoArquivo(ContextoDescompactacao* ctx, FILE* entrada, FILE* saida, ResultadoHuffman* resultado) {
+    unsigned char* bufferEntrada = (unsigned char*) malloc(TAMANHO_BUFFER_FLUXO);
+    unsigned char* bufferSaida = (unsigned char*) malloc(TAMANHO_BUFFER_FLUXO);
+    FluxoHuffman f = {NULL, 0, NULL, 0, 0, 0};
+    int codigo = bufferEntrada && bufferSaida ? iniciaDescompactacaoFluxo(ctx) : HUFFMAN_ERRO_MEMORIA;
+    int fim = 0, saidaCheia = 0;
+    // A decodificação incremental mistura as fases de cada bloco: só a E/S é separada
+    TemposFases* tempos = ctx->medir ? &ctx->medicao.tempos : NULL;
+    MarcaTempo marca;
+
+    while (codigo == HUFFMAN_OK) {
+        if (f.disponivelEntrada == 0 && !saidaCheia) {
+            if (fim) {
+                codigo = HUFFMAN_ERRO_CORROMPIDO;
+                break;
+            }
+            f.entrada = bufferEntrada;
+            iniciaMedicao(tempos, &marca);
+            f.disponivelEntrada = fread(bufferEntrada, sizeof(unsigned char), TAMANHO_BUFFER_FLUXO, entrada);
+            encerraFase(tempos, FASE_LEITURA, &marca);
+            if (ferror(entrada)) {
+                codigo = HUFFMAN_ERRO_ENTRADA;
+                break;
+            }
+            fim = feof(entrada);
+        }
+        f.saida = bufferSaida;
+        f.disponivelSaida = TAMANHO_BUFFER_FLUXO;
+        iniciaMedicao(tempos, &marca);
+        codigo = descompactaFluxo(ctx, &f);
+        encerraFase(tempos, FASE_DECODIFICACAO, &marca);
+        saidaCheia = f.disponivelSaida == 0;
+        size_t n = TAMANHO_BUFFER_FLUXO - f.disponivelSaida;
+        if (fwrite(bufferSaida, sizeof(unsigned char), n, saida) != n) {
+            codigo = HUFFMAN_ERRO_SAIDA;
+        }
+        encerraFase(tempos, FASE_ESCRITA, &marca);
+    }
+    if (codigo == HUFFMAN_FIM_FLUXO) {
+        codigo = fflush(saida) == 0 ? HUFFMAN_OK : HUFFMAN_ERRO_SAIDA;
+        // Consome o índice para não interromper quem escreve na outra ponta de um pipe
+        f.totalEntrada += f.disponivelEntrada;
+        while (codigo == HUFFMAN_OK && !fim) {
+            f.totalEntrada += fread(bufferEntrada, sizeof(unsigned char), TAMANHO_BUFFER_FLUXO, entrada);
+            fim = feof(entrada) || ferror(entrada);
+        }
+    }
+
+    free(bufferEntrada);
+    free(bufferSaida);
+    if (resultado) {
+        resultado->tamanhoOriginal = f.totalSaida;
+        resultado->tamanhoCompactado = f.totalEntrada;
+    }
+    return codigo;
+}
+
+/**
+ * @brief Descompacta um arquivo no formato em blocos, bloco a bloco.
+ * @details Apenas um bloco compactado fica em memória por vez. Conta em ctx->blocosSemCrc os blocos
+ *          sem CRC32C.
+ * @param ctx Contexto (buffers e tabelas reaproveitados).
+ * @param arquivoEntrada Arquivo .comp posicionado no início.
+ * @param arquivoSaida Arquivo de saída aberto (binário), ou NULL para só verificar.
+ * @param tamanhoOriginal Recebe o total de bytes descompactados.
+ * @return HUFFMAN_OK ou código de erro.
+ */
+static int descompactaContainer(ContextoDescompactacao* ctx, FILE* arquivoEntrada, FILE* arquivoSaida,
+                                unsigned long long int* tamanhoOriginal) {
+    unsigned char cabecalho[TAMANHO_CABECALHO_CONTAINER];
+    unsigned int tamanhoBloco;
+
+    if (fread(cabecalho, sizeof(unsigned char), TAMANHO_CABECALHO_CONTAINER, arquivoEntrada) != TAMANHO_CABECALHO_CONTAINER ||
+        decodificaCabecalhoContainer(cabecalho, &tamanhoBloco) < 0) {
+        return HUFFMAN_ERRO_FORMATO;
+    }
+    // Em um arquivo regular, o corpo de cada bloco não pode passar do que resta dele
+    struct stat st;
+    int regular = fstat(fileno(arquivoEntrada), &st) == 0 && S_ISREG(st.st_mode);
+
+    unsigned char* bufferSaida = NULL;
+    size_t capacidadeSaida = 0;
+    int resultado = HUFFMAN_OK;
+    TemposFases* tempos = ctx->medir ? &ctx->medicao.tempos : NULL;
+    MarcaTempo marca;
+    *tamanhoOriginal = 0;
+
+    while (resultado == HUFFMAN_OK) {
+        unsigned char bytesCabecalho[TAMANHO_CABECALHO_BLOCO];
+        iniciaMedicao(tempos, &marca);
+        if (fread(bytesCabecalho, sizeof(unsigned char), 1, arquivoEntrada) != 1) {
+            resultado = HUFFMAN_ERRO_CORROMPIDO;
+            break;
+        }
+        if (bytesCabecalho[0] == BLOCO_FIM) {
+            break;
+        }
+        if (fread(bytesCabecalho + 1, sizeof(unsigned char), TAMANHO_CABECALHO_BLOCO - 1, arquivoEntrada) != TAMANHO_CABECALHO_BLOCO - 1) {
+            resultado = HUFFMAN_ERRO_CORROMPIDO;
+            break;
+        }
+
+        CabecalhoBloco c;
+        decodificaCabecalhoBloco(bytesCabecalho, &c);
+        unsigned long long int tamanhoCorpo = tamanhoCorpoBloco(&c);
+        off_t pos = regular ? ftello(arquivoEntrada) : -1;
+        if (c.tamanhoOriginal > tamanhoBloco ||
+            (pos >= 0 && tamanhoCorpo > (unsigned long long int) (st.st_size > pos ? st.st_size - pos : 0))) {
+            resultado = HUFFMAN_ERRO_CORROMPIDO;
+            break;
+        }
+        if (garanteCapacidade(&ctx->corpo, &ctx->capacidadeCorpo, tamanhoCorpo) < 0 ||
+            garanteCapacidade(&bufferSaida, &capacidadeSaida, c.tamanhoOriginal) < 0) {
+            resultado = HUFFMAN_ERRO_MEMORIA;
+        } else if (fread(ctx->corpo, sizeof(unsigned char), tamanhoCorpo, arquivoEntrada) != tamanhoCorpo) {
+            resultado = HUFFMAN_ERRO_CORROMPIDO;
+        } else {
+            encerraFase(tempos, FASE_LEITURA, &marca);
+            int decodificado = descompactaBloco(ctx->decodificador, ctx->dicionario, &c, ctx->corpo, bufferSaida,
+                                                tempos);
+            if (decodificado < 0) {
+                resultado = erroBloco(decodificado, ctx->dicionario, &c, ctx->corpo);
+            } else {
+                ctx->blocosSemCrc += !c.crc;
+                iniciaMedicao(tempos, &marca);
+                if (arquivoSaida &&
+                    fwrite(bufferSaida, sizeof(unsigned char), c.tamanhoOriginal, arquivoSaida) != c.tamanhoOriginal) {
+                    resultado = HUFFMAN_ERRO_SAIDA;
+                }
+                encerraFase(tempos, FASE_ESCRITA, &marca);
+                ctx->medicao.blocos += ctx->medir;
+            }
+        }
+        *tamanhoOriginal += c.tamanhoOriginal;
+    }
+
+    free(bufferSaida);
+    return resultado;
+}
+
+/**
+ * @brief Submete a leitura do bloco @p k do índice (cabeçalho + corpo, até o início do bloco seguinte
+ *        ou até o terminador).
+ * @details Um tamanho impossível para o bloco deixa t->resultado com o erro, sem leitura.
+ */
+static void iniciaLeituraBloco(ContextoDescompactacao* ctx, TarefaDescompactacao* t, const IndiceBlocos* indice,
+                               unsigned long long int k, int fdEntrada) {
+    const EntradaIndice* e = &indice->entradas[k];
+    unsigned long long int fim = k + 1 < indice->numBlocos ? indice->entradas[k + 1].offset : indice->offsetIndice - 1;
+    unsigned long long int maximo = TAMANHO_CABECALHO_BLOCO + (0xFFFF + 7) / 8 + (e->bitsDados + 7) / 8 + TAMANHO_CRC_BLOCO;
+    t->entrada = e;
+    t->semCrc = 0;
+    t->decodificando = 0;
+    t->gravando = 0;
+    t->lendo = 0;
+    t->resultado = HUFFMAN_ERRO_CORROMPIDO;
+    if (fim <= e->offset || fim - e->offset < TAMANHO_CABECALHO_BLOCO || fim - e->offset > maximo) {
+        return;
+    }
+    t->tamanhoArquivo = (size_t) (fim - e->offset);
+    t->resultado = HUFFMAN_ERRO_MEMORIA;
+    if (garanteCapacidade(&t->corpo, &t->capacidadeCorpo, t->tamanhoArquivo) < 0) {
+        return;
+    }
+    t->resultado = HUFFMAN_OK;
+    t->leitura.fd = fdEntrada;
+    t->leitura.buffer = t->corpo;
+    t->leitura.tamanho = t->tamanhoArquivo;
+    t->leitura.offset = e->offset;
+    t->leitura.gravacao = 0;
+    submeteTransferencia(ctx->fila, &t->leitura);
+    t->lendo = 1;
+}
+
+/**
+ * @brief Submete a gravação de um bloco descompactado na sua posição final; com @p fdDireto (O_DIRECT),
+ *        se a posição e o tamanho forem alinhados.
+ */
+static void iniciaGravacaoBloco(ContextoDescompactacao* ctx, TarefaDescompactacao* t, int fdSaida, int fdDireto) {
+    const EntradaIndice* e = t->entrada;
+    int alinhado = e->offsetOriginal % ALINHAMENTO_TRANSFERENCIA == 0 &&
+                   e->tamanhoOriginal % ALINHAMENTO_TRANSFERENCIA == 0;
+    t->gravacao.fd = fdDireto >= 0 && alinhado ? fdDireto : fdSaida;
+    t->gravacao.buffer = t->saida;
+    t->gravacao.tamanho = e->tamanhoOriginal;
+    t->gravacao.offset = e->offsetOriginal;
+    t->gravacao.gravacao = 1;
+    submeteTransferencia(ctx->fila, &t->gravacao);
+    t->gravando = 1;
+}
+
+/**
+ * @brief Descompacta os blocos listados no índice em paralelo, gravando cada um na sua posição final.
+ * @details Cada bloco da janela (2 * numThreads) passa por leitura, decodificação e gravação: as
+ *          leituras e gravações correm na fila de transferências (io_uring ou threads com
+ *          pread/pwrite) enquanto o pool decodifica, e o bloco seguinte entra na janela quando a
+ *          gravação do mais antigo termina. Sem nada pronto para avançar, espera a etapa do bloco
+ *          mais antigo. Em caso de erro, os blocos já iniciados são aguardados antes de retornar.
+ *          Conta em ctx->blocosSemCrc os blocos sem CRC32C.
+ * @param ctx Contexto.
+ * @param arquivoEntrada Arquivo .comp aberto (lido com pread).
+ * @param indice Índice lido do fim do arquivo.
+ * @param nomeArquivoSaida Caminho do arquivo de saída, criado já com o tamanho final; NULL para só
+ *        verificar os blocos.
+ * @param tamanhoOriginal Recebe o tamanho descompactado.
+ * @return HUFFMAN_OK ou código de erro.
+ */
+static int descompactaContainerParalelo(ContextoDescompactacao* ctx, FILE* arquivoEntrada, const IndiceBlocos* indice,
+                                        const char* nomeArquivoSaida, unsigned long long int* tamanhoOriginal) {
+    TemposFases* tempos = ctx->medir ? &ctx->medicao.tempos : NULL;
+    MarcaTempo marca;
+    *tamanhoOriginal = 0;
+    if (indice->numBlocos > 0) {
+        const EntradaIndice* ultima = &indice->entradas[indice->numBlocos - 1];
+        *tamanhoOriginal = ultima->offsetOriginal + ultima->tamanhoOriginal;
+    }
+
+    int fdSaida = -1, fdDireto = -1;
+    if (nomeArquivoSaida) {
+        fdSaida = open(nomeArquivoSaida, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fdSaida < 0) {
+            return HUFFMAN_ERRO_SAIDA;
+        }
+        if (ftruncate(fdSaida, (off_t) *tamanhoOriginal) != 0) {
+            close(fdSaida);
+            return HUFFMAN_ERRO_SAIDA;
+        }
+        int direto = 0;
+        if (ctx->direto) {
+            fdDireto = abreArquivoTransferencia(nomeArquivoSaida, O_WRONLY, 1, &direto);
+        }
+        if (fdDireto >= 0 && !direto) {
+            close(fdDireto);
+            fdDireto = -1;
+        }
+    }
+    int fdEntrada = fileno(arquivoEntrada);
+    for (int i = 0; i < ctx->janela; i++) {
+        ctx->tarefas[i].dicionario = ctx->dicionario;
+        ctx->tarefas[i].medir = ctx->medir;
+    }
+
+    // Blocos [concluidos, gravados) gravando, [gravados, decodificados) no pool, [decodificados, lidos) lendo
+    int resultado = HUFFMAN_OK;
+    unsigned long long int lidos = 0, decodificados = 0, gravados = 0, concluidos = 0;
+    while (concluidos < lidos || (resultado == HUFFMAN_OK && concluidos < indice->numBlocos)) {
+        int avancou = 0;
+        while (resultado == HUFFMAN_OK && lidos < indice->numBlocos &&
+               lidos - concluidos < (unsigned long long int) ctx->janela) {
+            iniciaLeituraBloco(ctx, &ctx->tarefas[lidos % ctx->janela], indice, lidos, fdEntrada);
+            lidos++;
+            avancou = 1;
+        }
+        while (decodificados < lidos) {
+            TarefaDescompactacao* t = &ctx->tarefas[decodificados % ctx->janela];
+            if (t->lendo) {
+                if (!transferenciaConcluida(ctx->fila, &t->leitura)) {
+                    break;
+                }
+                if (aguardaTransferencia(ctx->fila, &t->leitura) < 0) {
+                    t->resultado = HUFFMAN_ERRO_ENTRADA;
+                } else if (t->leitura.transferidos < t->tamanhoArquivo) {
+                    t->resultado = HUFFMAN_ERRO_CORROMPIDO;
+                }
+                t->lendo = 0;
+            }
+            if (t->resultado == HUFFMAN_OK) {
+                submeteTarefa(ctx->pool, &t->tarefa);
+                t->decodificando = 1;
+            }
+            decodificados++;
+            avancou = 1;
+        }
+        while (gravados < decodificados) {
+            TarefaDescompactacao* t = &ctx->tarefas[gravados % ctx->janela];
+            if (t->decodificando) {
+                if (!tarefaConcluida(ctx->pool, &t->tarefa)) {
+                    break;
+                }
+                t->decodificando = 0;
+                if (t->resultado == HUFFMAN_OK && fdSaida >= 0) {
+                    iniciaGravacaoBloco(ctx, t, fdSaida, fdDireto);
+                }
+            }
+            gravados++;
+            avancou = 1;
+        }
+        while (concluidos < gravados) {
+            TarefaDescompactacao* t = &ctx->tarefas[concluidos % ctx->janela];
+            if (t->gravando) {
+                if (!transferenciaConcluida(ctx->fila, &t->gravacao)) {
+                    break;
+                }
+                if (aguardaTransferencia(ctx->fila, &t->gravacao) < 0) {
+                    t->resultado = HUFFMAN_ERRO_SAIDA;
+                }
+                t->gravando = 0;
+            }
+            if (resultado == HUFFMAN_OK) {
+                resultado = t->resultado;
+            }
+            ctx->blocosSemCrc += t->semCrc;
+            if (t->medir) {
+                somaTempos(&ctx->medicao.tempos, &t->tempos);
+                memset(&t->tempos, 0, sizeof(TemposFases));
+                ctx->medicao.blocos++;
+            }
+            concluidos++;
+            avancou = 1;
+        }
+        if (avancou) {
+            continue;
+        }
+
+        // Nada pronto: espera a etapa em andamento do bloco mais antigo
+        iniciaMedicao(tempos, &marca);
+        if (concluidos < gravados) {
+            aguardaTransferencia(ctx->fila, &ctx->tarefas[concluidos % ctx->janela].gravacao);
+            encerraFase(tempos, FASE_ESCRITA, &marca);
+        } else if (gravados < decodificados) {
+            aguardaTarefa(ctx->pool, &ctx->tarefas[gravados % ctx->janela].tarefa);
+        } else {
+            aguardaTransferencia(ctx->fila, &ctx->tarefas[decodificados % ctx->janela].leitura);
+            encerraFase(tempos, FASE_LEITURA, &marca);
+        }
+    }
+
+    if (fdDireto >= 0 && close(fdDireto) != 0 && resultado == HUFFMAN_OK) {
+        resultado = HUFFMAN_ERRO_SAIDA;
+    }
+    if (fdSaida >= 0 && close(fdSaida) != 0 && resultado == HUFFMAN_OK) {
+        resultado = HUFFMAN_ERRO_SAIDA;
+    }
+    return resultado;
+}
+
+/**
+ * @brief Descompacta um arquivo no formato antigo: cabeçalho → árvore → desserialização →
+ *        decodificação dos dados em blocos, sem carregar o restante do arquivo em memória.
+ * @param ctx Contexto (tabelas reaproveitadas).
+ * @param arquivoEntrada Arquivo .comp posicionado logo após o tamanho da árvore.
+ * @param tamanhoArvore Tamanho da árvore serializada em bits.
+ * @param nomeArquivoSaida Caminho do arquivo de saída.
+ * @param tamanhoOriginal Recebe o total de bytes descompactados.
+ * @return HUFFMAN_OK, HUFFMAN_AVISO_CODIGO_INCOMPLETO ou código de erro.
+ */
+static int descompactaLegado(ContextoDescompactacao* ctx, FILE* arquivoEntrada, unsigned int tamanhoArvore,
+                             const char* nomeArquivoSaida, unsigned long long int* tamanhoOriginal) {
+    unsigned char bitsUltimoByte;
+    unsigned char bufferArvore[(TAMANHO_MAX_ARVORE_BITS + 7) / 8];
+    unsigned int bytesArvore = (tamanhoArvore + 7) / 8;
+    TemposFases* tempos = ctx->medir ? &ctx->medicao.tempos : NULL;
+    MarcaTempo marca;
+    iniciaMedicao(tempos, &marca);
+
+    // 1. Ler os bits do último byte e a árvore serializada
+    if (tamanhoArvore == 0 || tamanhoArvore > TAMANHO_MAX_ARVORE_BITS ||
+        fread(&bitsUltimoByte, sizeof(unsigned char), 1, arquivoEntrada) != 1 ||
+        fread(bufferArvore, sizeof(unsigned char), bytesArvore, arquivoEntrada) != bytesArvore) {
+        return HUFFMAN_ERRO_FORMATO;
+    }
+    encerraFase(tempos, FASE_LEITURA, &marca);
+
+    // 2. Desserializar a árvore e construir as tabelas
+    ArvoreHuffman arvore;
+    if (leArvoreHuffman(bufferArvore, tamanhoArvore, &arvore) < 0) {
+        return HUFFMAN_ERRO_FORMATO;
+    }
+    if (carregaDecodificador(ctx->decodificador, &arvore) < 0) {
+        return HUFFMAN_ERRO_MEMORIA;
+    }
+    encerraFase(tempos, FASE_ARVORE, &marca);
+
+    // 3. Decodificar os dados (lidos em blocos até o fim do arquivo) e escrever arquivo de saída
+    FILE* arquivoSaida = fopen(nomeArquivoSaida, "wb");
+    if (!arquivoSaida) {
+        return HUFFMAN_ERRO_SAIDA;
+    }
+    // A leitura e a gravação dos dados são intercaladas com a decodificação e medidas junto com ela
+    // Conta os bytes na decodificação: na verificação a saída é /dev/null, onde ftello não serve
+    int decodificado = decodificaArquivo(ctx->decodificador, arquivoEntrada, bitsUltimoByte, arquivoSaida,
+                                         tamanhoOriginal);
+    encerraFase(tempos, FASE_DECODIFICACAO, &marca);
+    int erroEscrita = ferror(arquivoSaida);
+    if (fclose(arquivoSaida) != 0 || erroEscrita) {
+        return HUFFMAN_ERRO_SAIDA;
+    }
+    encerraFase(tempos, FASE_ESCRITA, &marca);
+    if (decodificado < 0) {
+        return HUFFMAN_ERRO_CORROMPIDO;
+    }
+    return decodificado == 1 ? HUFFMAN_AVISO_CODIGO_INCOMPLETO : HUFFMAN_OK;
+}
+
+/**
+ * @brief Descompacta um arquivo com um quadro único, pela descompactação incremental (o quadro não tem
+ *        índice nem blocos para paralelizar).
+ * @param arquivoEntrada Arquivo posicionável; é lido desde o início.
+ * @param nomeArquivoSaida Caminho do arquivo descompactado.
+ * @param tamanhoOriginal Recebe o total de bytes descompactados.
+ * @return HUFFMAN_OK ou código de erro.
+ */
+static int descompactaQuadroArquivo(ContextoDescompactacao* ctx, FILE* arquivoEntrada, const char* nomeArquivoSaida,
+                                    unsigned long long int* tamanhoOriginal) {
+    FILE* arquivoSaida = fopen(nomeArquivoSaida, "wb");
+    if (!arquivoSaida) {
+        return HUFFMAN_ERRO_SAIDA;
+    }
+    ResultadoHuffman r = {0, 0};
+    rewind(arquivoEntrada);
+    int codigo = descompactaFluxoArquivo(ctx, arquivoEntrada, arquivoSaida, &r);
+    int erroEscrita = ferror(arquivoSaida);
+    if ((fclose(arquivoSaida) != 0 || erroEscrita) && codigo == HUFFMAN_OK) {
+        codigo = HUFFMAN_ERRO_SAIDA;
+    }
+    ctx->blocosSemCrc = ctx->blocoFluxo.tipo != BLOCO_FIM && !ctx->blocoFluxo.crc;
+    *tamanhoOriginal = r.tamanhoOriginal;
+    return codigo;
+}
+
+/**
+ * @brief Corpo de descompactaArquivo e verificaArquivo; conta em ctx->blocosSemCrc os blocos sem CRC32C
+ *        (o formato antigo conta como um).
+ * @param nomeSaida Caminho do arquivo descompactado, ou NULL para descartar a saída.
+ */
+static int processaArquivoCompactado(ContextoDescompactacao* ctx, const char* nomeEntrada, const char* nomeSaida,
+                                     ResultadoHuffman* resultado) {
+    ResultadoHuffman r = {0, 0};
+    ctx->blocosSemCrc = 0;
+    FILE* arquivoEntrada = fopen(nomeEntrada, "rb");
+    if (!arquivoEntrada) {
+        return HUFFMAN_ERRO_ENTRADA;
+    }
+    struct stat st;
+    if (fstat(fileno(arquivoEntrada), &st) == 0) {
+        r.tamanhoCompactado = (unsigned long long int) st.st_size;
+    }
+
+    int codigo;
+    unsigned char inicio[4];
+    size_t lidos = fread(inicio, sizeof(unsigned char), 4, arquivoEntrada);
+    if (ehQuadroUnico(inicio, lidos)) {
+        codigo = descompactaQuadroArquivo(ctx, arquivoEntrada, nomeSaida ? nomeSaida : "/dev/null", &r.tamanhoOriginal);
+    } else if (lidos != 4) {
+        codigo = HUFFMAN_ERRO_FORMATO;
+    } else if (!ehContainer(inicio)) {
+        // Sem blocos nem índice, o formato antigo só é verificado decodificando tudo para o descarte
+        codigo = descompactaLegado(ctx, arquivoEntrada, leU32(inicio), nomeSaida ? nomeSaida : "/dev/null",
+                                   &r.tamanhoOriginal);
+        ctx->blocosSemCrc = 1;
+    } else {
+        IndiceBlocos indice;
+        if (leIndice(arquivoEntrada, &indice) == 0) {
+            codigo = descompactaContainerParalelo(ctx, arquivoEntrada, &indice, nomeSaida, &r.tamanhoOriginal);
+            liberaIndice(&indice);
+        } else if (nomeSaida == NULL) {
+            rewind(arquivoEntrada);
+            codigo = descompactaContainer(ctx, arquivoEntrada, NULL, &r.tamanhoOriginal);
+        } else {
+            FILE* arquivoSaida = fopen(nomeSaida, "wb");
+            if (!arquivoSaida) {
+                codigo = HUFFMAN_ERRO_SAIDA;
+            } else {
+                rewind(arquivoEntrada);
+                codigo = descompactaContainer(ctx, arquivoEntrada, arquivoSaida, &r.tamanhoOriginal);
+                int erroEscrita = ferror(arquivoSaida);
+                if ((fclose(arquivoSaida) != 0 || erroEscrita) && codigo == HUFFMAN_OK) {
+                    codigo = HUFFMAN_ERRO_SAIDA;
+                }
+            }
+        }
+    }
+    fclose(arquivoEntrada);
+    if (resultado) {
+        *resultado = r;
+    }
+    return codigo;
+}
+
+/**
+ * @brief Descompacta um arquivo em qualquer dos formatos .comp.
+ * @details Os primeiros bytes distinguem o formato em blocos e o quadro único do antigo. Com índice, os
+ *          blocos são descompactados em paralelo e gravados nas posições finais; sem índice, em
+ *          sequência. Os blocos gravados com CRC32C são conferidos.
+ * @param ctx Contexto.
+ * @param nomeEntrada Caminho do arquivo compactado.
+ * @param nomeSaida Caminho do arquivo descompactado (criado ou sobrescrito).
+ * @param resultado Recebe os tamanhos (pode ser NULL).
+ * @return HUFFMAN_OK, HUFFMAN_AVISO_CODIGO_INCOMPLETO ou código de erro.
+ */
+int descompactaArquivo(ContextoDescompactacao* ctx, const char* nomeEntrada, const char* nomeSaida,
+                       ResultadoHuffman* resultado) {
+    return processaArquivoCompactado(ctx, nomeEntrada, nomeSaida, resultado);
+}
+
+/**
+ * @brief Verifica a integridade de um arquivo .comp: decodifica todos os blocos, em paralelo se houver
+ *        índice, e confere os CRC32C, sem gravar a saída.
+ * @details Um bloco sem CRC32C só é conferido pela decodificação (códigos válidos e tamanho exato). O
+ *          formato antigo é decodificado inteiro e descartado; o seu tamanho original é o dos bytes decodificados.
+ * @param ctx Contexto.
+ * @param nomeEntrada Caminho do arquivo compactado.
+ * @param resultado Recebe os tamanhos (pode ser NULL).
+ * @return HUFFMAN_OK se todos os blocos conferiram; HUFFMAN_AVISO_SEM_CRC se todos foram decodificados
+ *         mas algum não tinha CRC32C; HUFFMAN_AVISO_CODIGO_INCOMPLETO ou código de erro
+ *         (HUFFMAN_ERRO_CRC se um CRC32C não conferiu).
+ */
+int verificaArquivo(ContextoDescompactacao* ctx, const char* nomeEntrada, ResultadoHuffman* resultado) {
+    int codigo = processaArquivoCompactado(ctx, nomeEntrada, NULL, resultado);
+    return codigo == HUFFMAN_OK && ctx->blocosSemCrc > 0 ? HUFFMAN_AVISO_SEM_CRC : codigo;
+}
+
+/**
+ * @brief Descompacta apenas os bytes [inicio, inicio + tamanho) do original (limitados ao fim dos dados).
+ * @details Só os blocos decodificados inteiros têm o CRC32C conferido; um trecho de bloco com pontos de
+ *          acesso não cobre todos os bytes do CRC.
+ * @param ctx Contexto.
+ * @param nomeEntrada Caminho do arquivo no formato em blocos, com índice.
+ * @param inicio Posição do primeiro byte nos dados originais.
+ * @param tamanho Quantidade de bytes.
+ * @param saida Arquivo de saída aberto (binário).
+ * @param extraidos Recebe a quantidade de bytes gravados (pode ser NULL).
+ * @return HUFFMAN_OK ou código de erro (HUFFMAN_ERRO_SEM_INDICE se o arquivo não tiver índice, como
+ *         um quadro único).
+ */
+int extraiTrechoArquivo(ContextoDescompactacao* ctx, const char* nomeEntrada, unsigned long long int inicio,
+                        unsigned long long int tamanho, FILE* saida, unsigned long long int* extraidos) {
+    FILE* arquivoEntrada = fopen(nomeEntrada, "rb");
+    if (!arquivoEntrada) {
+        return HUFFMAN_ERRO_ENTRADA;
+    }
+
+    unsigned char inicioArquivo[4];
+    IndiceBlocos indice;
+    if (fread(inicioArquivo, sizeof(unsigned char), 4, arquivoEntrada) != 4 || !ehContainer(inicioArquivo) ||
+        leIndice(arquivoEntrada, &indice) < 0) {
+        fclose(arquivoEntrada);
+        return HUFFMAN_ERRO_SEM_INDICE;
+    }
+
+    long long int n = extraiTrecho(ctx->decodificador, ctx->dicionario, arquivoEntrada, &indice, inicio, tamanho, saida);
+    liberaIndice(&indice);
+    fclose(arquivoEntrada);
+    if (n < 0) {
+        return HUFFMAN_ERRO_CORROMPIDO;
+    }
+    if (extraidos) {
+        *extraidos = (unsigned long long int) n;
+    }
+    return HUFFMAN_OK;
+}
+
+/**
+ * @brief Liga ou desliga a medição das próximas descompactações; as medições anteriores são zeradas.
+ * @details A extração de trechos não é medida.
+ * @param ctx Contexto.
+ * @param ativa 1 para medir; 0 para não medir.
+ */
+void ativaEstatisticasDescompactacao(ContextoDescompactacao* ctx, int ativa) {
+    ctx->medir = ativa != 0;
+    memset(&ctx->medicao, 0, sizeof(Medicao));
+}
+
+/**
+ * @brief Liga ou desliga O_DIRECT na gravação da saída das próximas descompactações com índice.
+ * @details Os blocos com posição e tamanho alinhados a 4096 bytes são gravados sem passar pelo cache
+ *          de páginas; os demais (em geral, só o último) e os sistemas de arquivos sem O_DIRECT usam a
+ *          gravação comum.
+ * @param ctx Contexto.
+ * @param ativa 1 para usar O_DIRECT; 0 para não usar (o padrão).
+ */
+void ativaSaidaDiretaDescompactacao(ContextoDescompactacao* ctx, int ativa) {
+    ctx->direto = ativa != 0;
+}
+
+/**
+ * @brief Medições acumuladas desde ativaEstatisticasDescompactacao.
+ * @param ctx Contexto.
+ * @param estatisticas Recebe as medições.
+ */
+void estatisticasDescompactacao(const ContextoDescompactacao* ctx, EstatisticasHuffman* estatisticas) {
+    copiaEstatisticas(&ctx->medicao, estatisticas);
+}
+
+/**
+ * @brief Libera o contexto, suas threads e áreas de trabalho.
+ * @param ctx Contexto (pode ser NULL).
+ */
+void liberaContextoDescompactacao(ContextoDescompactacao* ctx) {
+    if (ctx == NULL) {
+        return;
+    }
+    if (ctx->pool) {
+        liberaPoolThreads(ctx->pool);
+    }
+    liberaFilaTransferencias(ctx->fila);
+    if (ctx->tarefas) {
+        for (int i = 0; i < ctx->janela; i++) {
+            free(ctx->tarefas[i].corpo);
+            free(ctx->tarefas[i].saida);
+            liberaDecodificador(ctx->tarefas[i].decodificador);
+        }
+        free(ctx->tarefas);
+    }
+    liberaDecodificador(ctx->decodificador);
+    free(ctx->corpo);
+    free(ctx->saidaFluxo);
+    free(ctx);
+}
+
+/**
+ * @brief Treina um dicionário com as frequências somadas de um conjunto de arquivos de amostra.
+ * @param amostras Caminhos dos arquivos.
+ * @param numAmostras Quantidade de arquivos (ao menos 1).
+ * @param id Identificador gravado nos blocos compactados com o dicionário.
+ * @param comprimentoMax Limite dos códigos (0 = HUFFMAN_COMPRIMENTO_MAX).
+ * @param dicionario Recebe o dicionário (liberar com liberaDicionarioHuffman).
+ * @return HUFFMAN_OK ou código de erro.
+ */
+int treinaDicionario(const char* const amostras[], int numAmostras, unsigned int id, int comprimentoMax,
+                     DicionarioHuffman** dicionario) {
+    if (comprimentoMax == 0) {
+        comprimentoMax = HUFFMAN_COMPRIMENTO_MAX;
+    }
+    if (numAmostras < 1 || comprimentoMax < HUFFMAN_COMPRIMENTO_MIN || comprimentoMax > HUFFMAN_COMPRIMENTO_MAX) {
+        return HUFFMAN_ERRO_PARAMETRO;
+    }
+
+    unsigned long long int frequencias[256] = {0};
+    for (int i = 0; i < numAmostras; i++) {
+        ArquivoEntrada* arquivo = abreArquivoEntrada(amostras[i]);
+        if (arquivo == NULL) {
+            return HUFFMAN_ERRO_ENTRADA;
+        }
+        int resultado = calculaFrequencias(arquivo, frequencias);
+        fechaArquivoEntrada(arquivo);
+        if (resultado != HUFFMAN_OK) {
+            return resultado;
+        }
+    }
+
+    *dicionario = criaDicionario(frequencias, id, comprimentoMax);
+    return *dicionario ? HUFFMAN_OK : HUFFMAN_ERRO_MEMORIA;
+}
+
+/**
+ * @brief Grava um dicionário em arquivo.
+ * @param dicionario Dicionário.
+ * @param nome Caminho do arquivo (criado ou sobrescrito).
+ * @return HUFFMAN_OK ou HUFFMAN_ERRO_SAIDA.
+ */
+int gravaDicionarioArquivo(const DicionarioHuffman* dicionario, const char* nome) {
+    FILE* saida = fopen(nome, "wb");
+    if (!saida) {
+        return HUFFMAN_ERRO_SAIDA;
+    }
+    int resultado = gravaDicionario(dicionario, saida);
+    if (fclose(saida) != 0 || resultado < 0) {
+        return HUFFMAN_ERRO_SAIDA;
+    }
+    return HUFFMAN_OK;
+}
+
+/**
+ * @brief Carrega um dicionário gravado por gravaDicionarioArquivo, já com as tabelas montadas.
+ * @param nome Caminho do arquivo.
+ * @param dicionario Recebe o dicionário (liberar com liberaDicionarioHuffman).
+ * @return HUFFMAN_OK, HUFFMAN_ERRO_ENTRADA ou HUFFMAN_ERRO_FORMATO.
+ */
+int carregaDicionarioArquivo(const char* nome, DicionarioHuffman** dicionario) {
+    FILE* entrada = fopen(nome, "rb");
+    if (!entrada) {
+        return HUFFMAN_ERRO_ENTRADA;
+    }
+    *dicionario = leDicionario(entrada);
+    int erroLeitura = ferror(entrada);
+    fclose(entrada);
+    if (*dicionario == NULL) {
+        return erroLeitura ? HUFFMAN_ERRO_ENTRADA : HUFFMAN_ERRO_FORMATO;
+    }
+    return HUFFMAN_OK;
+}
+
+/**
+ * @brief Identificador de um dicionário.
+ */
+unsigned int idDicionarioHuffman(const DicionarioHuffman* dicionario) {
+    return idDicionario(dicionario);
+}
+
+/**
+ * @brief Libera um dicionário.
+ * @param dicionario Dicionário (pode ser NULL).
+ */
+void liberaDicionarioHuffman(DicionarioHuffman* dicionario) {
+    liberaDicionario(dicionario);
+}
+
+/**
+ * @brief Arquivos de um lote, já com os diretórios expandidos.
+ */
+typedef struct {
+    char** nomes;
+    size_t quantidade;
+    size_t capacidade;
+} ListaArquivos;
+
+/**
+ * @brief Lote em processamento: os trabalhadores retiram o próximo arquivo da lista sob a trava.
+ */
+typedef struct {
+    ListaArquivos arquivos;
+    size_t proximo;
+    int compactar;                  ///< 1 = compactaLote; 0 = descompactaLote ou verificaLote
+    int verificar;                  ///< 1 = verificaLote (sem gravar a saída)
+    InformaLoteHuffman informa;
+    void* arg;
+    ResultadoLote resultado;
+    pthread_mutex_t trava;
+} Lote;
+
+/**
+ * @brief Trabalhador de um lote, com o seu contexto (buffers e tabelas reaproveitados entre arquivos).
+ */
+typedef struct {
+    Tarefa tarefa;
+    Lote* lote;
+    ContextoCompactacao* compactacao;
+    ContextoDescompactacao* descompactacao;
+} TrabalhadorLote;
+
+/**
+ * @brief Indica se @p nome termina com ".comp".
+ */
+static int terminaComComp(const char* nome) {
+    size_t n = strlen(nome);
+    return n >= 5 && strcmp(nome + n - 5, ".comp") == 0;
+}
+
+/**
+ * @brief Acrescenta uma cópia de @p nome à lista.
+ * @return 0 em sucesso; -1 em falta de memória.
+ */
+static int acrescentaArquivo(ListaArquivos* l, const char* nome) {
+    if (l->quantidade == l->capacidade) {
+        size_t capacidade = l->capacidade ? 2 * l->capacidade : 64;
+        char** nomes = (char**) realloc(l->nomes, capacidade * sizeof(char*));
+        if (nomes == NULL) {
+            return -1;
+        }
+        l->nomes = nomes;
+        l->capacidade = capacidade;
+    }
+    char* copia = (char*) malloc(strlen(nome) + 1);
+    if (copia == NULL) {
+        return -1;
+    }
+    strcpy(copia, nome);
+    l->nomes[l->quantidade++] = copia;
+    return 0;
+}
+
+/**
+ * @brief Acrescenta um caminho à lista, percorrendo diretórios recursivamente.
+ * @details Um caminho dado explicitamente entra como está (os erros aparecem ao processá-lo); dentro
+ *          de diretórios, só os arquivos regulares que terminam em ".comp" (na descompactação) ou que
+ *          não terminam (na compactação), sem seguir links simbólicos.
+ * @param lote Lote (a lista e a função de aviso).
+ * @param caminho Arquivo ou diretório.
+ * @param explicito 1 se o caminho foi dado pelo chamador.
+ * @return 0 em sucesso; -1 em falta de memória (um diretório ilegível é informado como falha e pulado).
+ */
+static int percorreCaminho(Lote* lote, const char* caminho, int explicito) {
+    struct stat st;
+    if ((explicito ? stat(caminho, &st) : lstat(caminho, &st)) != 0) {
+        return explicito ? acrescentaArquivo(&lote->arquivos, caminho) : 0;
+    }
+    if (!S_ISDIR(st.st_mode)) {
+        if (explicito || (S_ISREG(st.st_mode) && terminaComComp(caminho) != lote->compactar)) {
+            return acrescentaArquivo(&lote->arquivos, caminho);
+        }
+        return 0;
+    }
+
+    DIR* diretorio = opendir(caminho);
+    if (diretorio == NULL) {
+        ResultadoHuffman vazio = {0, 0};
+        lote->resultado.falhas++;
+        if (lote->informa) {
+            lote->informa(lote->arg, caminho, HUFFMAN_ERRO_ENTRADA, &vazio);
+        }
+        return 0;
+    }
+    size_t tamanho = strlen(caminho);
+    int resultado = 0;
+    struct dirent* item;
+    while (resultado == 0 && (item = readdir(diretorio)) != NULL) {
+        if (strcmp(item->d_name, ".") == 0 || strcmp(item->d_name, "..") == 0) {
+            continue;
+        }
+        char* filho = (char*) malloc(tamanho + strlen(item->d_name) + 2);
+        if (filho == NULL) {
+            resultado = -1;
+            break;
+        }
+        sprintf(filho, "%s%s%s", caminho, tamanho > 0 && caminho[tamanho - 1] == '/' ? "" : "/", item->d_name);
+        resultado = percorreCaminho(lote, filho, 0);
+        free(filho);
+    }
+    closedir(diretorio);
+    return resultado;
+}
+
+/**
+ * @brief Compacta, descompacta ou verifica um arquivo do lote com o contexto do trabalhador.
+ * @return Código HUFFMAN_* do arquivo.
+ */
+static int processaArquivoLote(TrabalhadorLote* w, const char* nome, ResultadoHuffman* r) {
+    size_t n = strlen(nome);
+    if (w->lote->verificar) {
+        return verificaArquivo(w->descompactacao, nome, r);
+    }
+    if (!w->lote->compactar && !terminaComComp(nome)) {
+        return HUFFMAN_ERRO_PARAMETRO;
+    }
+    char* saida = (char*) malloc(n + 6);
+    if (saida == NULL) {
+        return HUFFMAN_ERRO_MEMORIA;
+    }
+    int codigo;
+    if (w->lote->compactar) {
+        sprintf(saida, "%s.comp", nome);
+        codigo = compactaArquivo(w->compactacao, nome, saida, r);
+    } else {
+        memcpy(saida, nome, n - 5);
+        saida[n - 5] = '\0';
+        codigo = descompactaArquivo(w->descompactacao, nome, saida, r);
+    }
+    free(saida);
+    return codigo;
+}
+
+/**
+ * @brief Laço de um trabalhador: processa arquivos até a lista acabar.
+ */
+static void executaTrabalhadorLote(void* arg) {
+    TrabalhadorLote* w = (TrabalhadorLote*) arg;
+    Lote* lote = w->lote;
+    pthread_mutex_lock(&lote->trava);
+    while (lote->proximo < lote->arquivos.quantidade) {
+        const char* nome = lote->arquivos.nomes[lote->proximo++];
+        pthread_mutex_unlock(&lote->trava);
+
+        ResultadoHuffman r = {0, 0};
+        int codigo = processaArquivoLote(w, nome, &r);
+        int erro = errno;
+
+        pthread_mutex_lock(&lote->trava);
+        if (codigo == HUFFMAN_OK || codigo == HUFFMAN_AVISO_CODIGO_INCOMPLETO || codigo == HUFFMAN_AVISO_SEM_CRC) {
+            lote->resultado.arquivos++;
+            lote->resultado.tamanhoOriginal += r.tamanhoOriginal;
+            lote->resultado.tamanhoCompactado += r.tamanhoCompactado;
+        } else {
+            lote->resultado.falhas++;
+        }
+        if (lote->informa) {
+            errno = erro;
+            lote->informa(lote->arg, nome, codigo, &r);
+        }
+    }
+    pthread_mutex_unlock(&lote->trava);
+}
+
+/**
+ * @brief Soma as medições de @p origem às de @p destino.
+ */
+static void somaEstatisticas(EstatisticasHuffman* destino, const EstatisticasHuffman* origem) {
+    for (int f = 0; f < HUFFMAN_NUM_FASES; f++) {
+        destino->segundos[f] += origem->segundos[f];
+        destino->segundosCpu[f] += origem->segundosCpu[f];
+    }
+    destino->blocos += origem->blocos;
+    for (int i = 0; i < 256; i++) {
+        destino->frequencias[i] += origem->frequencias[i];
+    }
+    for (int i = 0; i <= HUFFMAN_BITS_CODIGO_MAX; i++) {
+        destino->bytesPorComprimento[i] += origem->bytesPorComprimento[i];
+    }
+}
+
+/**
+ * @brief Processa um lote com @p numThreads trabalhadores, cada um com um contexto sem threads próprias.
+ * @return HUFFMAN_OK ou HUFFMAN_ERRO_MEMORIA.
+ */
+static int executaLote(Lote* lote, const char* const caminhos[], int numCaminhos, const OpcoesHuffman* opcoes,
+                       const DicionarioHuffman* dicionario, int numThreads, EstatisticasHuffman* estatisticas) {
+    if (numThreads <= 0) {
+        numThreads = numeroProcessadores();
+    }
+    if (opcoes && !opcoesValidas(opcoes)) {
+        return HUFFMAN_ERRO_PARAMETRO;
+    }
+    int codigo = HUFFMAN_OK;
+    for (int i = 0; i < numCaminhos && codigo == HUFFMAN_OK; i++) {
+        if (percorreCaminho(lote, caminhos[i], 1) < 0) {
+            codigo = HUFFMAN_ERRO_MEMORIA;
+        }
+    }
+    // Nunca mais trabalhadores que arquivos: cada um guarda as áreas de trabalho de um arquivo inteiro
+    if ((size_t) numThreads > lote->arquivos.quantidade) {
+        numThreads = lote->arquivos.quantidade > 0 ? (int) lote->arquivos.quantidade : 1;
+    }
+
+    TrabalhadorLote* trabalhadores = (TrabalhadorLote*) calloc(numThreads, sizeof(TrabalhadorLote));
+    PoolThreads* pool = criaPoolThreads(numThreads);
+    if (trabalhadores == NULL || pool == NULL) {
+        codigo = HUFFMAN_ERRO_MEMORIA;
+    }
+    for (int i = 0; codigo == HUFFMAN_OK && i < numThreads; i++) {
+        TrabalhadorLote* w = &trabalhadores[i];
+        w->lote = lote;
+        w->tarefa.funcao = executaTrabalhadorLote;
+        w->tarefa.arg = w;
+        if (lote->compactar) {
+            w->compactacao = criaContextoCompactacaoPool(0);
+            if (w->compactacao == NULL) {
+                codigo = HUFFMAN_ERRO_MEMORIA;
+            } else {
+                if (opcoes) {
+                    defineOpcoesCompactacao(w->compactacao, opcoes);
+                }
+                defineDicionarioCompactacao(w->compactacao, dicionario);
+                ativaEstatisticasCompactacao(w->compactacao, estatisticas != NULL);
+            }
+        } else {
+            w->descompactacao = criaContextoDescompactacaoPool(0);
+            if (w->descompactacao == NULL) {
+                codigo = HUFFMAN_ERRO_MEMORIA;
+            } else {
+                defineDicionarioDescompactacao(w->descompactacao, dicionario);
+                ativaEstatisticasDescompactacao(w->descompactacao, estatisticas != NULL);
+            }
+        }
+    }
+
+    if (codigo == HUFFMAN_OK) {
+        for (int i = 0; i < numThreads; i++) {
+            submeteTarefa(pool, &trabalhadores[i].tarefa);
+        }
+        for (int i = 0; i < numThreads; i++) {
+            aguardaTarefa(pool, &trabalhadores[i].tarefa);
+        }
+    }
+    if (estatisticas) {
+        memset(estatisticas, 0, sizeof(EstatisticasHuffman));
+    }
+    liberaPoolThreads(pool);
+    for (int i = 0; trabalhadores && i < numThreads; i++) {
+        EstatisticasHuffman e;
+        if (trabalhadores[i].compactacao) {
+            estatisticasCompactacao(trabalhadores[i].compactacao, &e);
+            liberaContextoCompactacao(trabalhadores[i].compactacao);
+        } else if (trabalhadores[i].descompactacao) {
+            estatisticasDescompactacao(trabalhadores[i].descompactacao, &e);
+            liberaContextoDescompactacao(trabalhadores[i].descompactacao);
+        } else {
+            continue;
+        }
+        if (estatisticas && codigo == HUFFMAN_OK) {
+            somaEstatisticas(estatisticas, &e);
+        }
+    }
+    free(trabalhadores);
+    for (size_t i = 0; i < lote->arquivos.quantidade; i++) {
+        free(lote->arquivos.nomes[i]);
+    }
+    free(lote->arquivos.nomes);
+    pthread_mutex_destroy(&lote->trava);
+    return codigo;
+}
+
+/**
+ * @brief Compacta muitos arquivos em um único processo, vários ao mesmo tempo.
+ * @details Cada caminho pode ser um arquivo ou um diretório, percorrido recursivamente (sem seguir links
+ *          simbólicos e pulando os arquivos .comp). Cada arquivo gera <nome>.comp, idêntico ao de
+ *          compactaArquivo com as mesmas opções. Os arquivos são distribuídos entre @p numThreads
+ *          trabalhadores; cada um compacta os seus blocos na própria thread, com um contexto cujas
+ *          áreas de trabalho são reaproveitadas de um arquivo para o outro.
+ * @param caminhos Arquivos e diretórios.
+ * @param numCaminhos Quantidade de caminhos.
+ * @param opcoes Opções de compactação (NULL = padrão).
+ * @param dicionario Dicionário para os blocos (pode ser NULL).
+ * @param numThreads Arquivos processados ao mesmo tempo (0 = número de processadores).
+ * @param informa Chamada ao fim de cada arquivo (pode ser NULL).
+ * @param arg Argumento de @p informa.
+ * @param resultado Recebe os totais (pode ser NULL).
+ * @param estatisticas Recebe as medições somadas de todos os arquivos (NULL = sem medição).
+ * @return HUFFMAN_OK se o lote foi processado (as falhas de cada arquivo são contadas em @p resultado);
+ *         HUFFMAN_ERRO_PARAMETRO ou HUFFMAN_ERRO_MEMORIA caso contrário.
+ */
+int compactaLote(const char* const caminhos[], int numCaminhos, const OpcoesHuffman* opcoes,
+                 const DicionarioHuffman* dicionario, int numThreads, InformaLoteHuffman informa, void* arg,
+                 ResultadoLote* resultado, EstatisticasHuffman* estatisticas) {
+    Lote lote = {{NULL, 0, 0}, 0, 1, 0, informa, arg, {0, 0, 0, 0}, PTHREAD_MUTEX_INITIALIZER};
+    int codigo = executaLote(&lote, caminhos, numCaminhos, opcoes, dicionario, numThreads, estatisticas);
+    if (resultado) {
+        *resultado = lote.resultado;
+    }
+    return codigo;
+}
+
+/**
+ * @brief Descompacta muitos arquivos .comp em um único processo, vários ao mesmo tempo.
+ * @details Os diretórios são percorridos recursivamente, considerando só os arquivos .comp; cada
+ *          <nome>.comp gera <nome>. Um caminho explícito sem a extensão .comp falha com
+ *          HUFFMAN_ERRO_PARAMETRO. Os trabalhadores funcionam como em compactaLote.
+ * @param caminhos Arquivos e diretórios.
+ * @param numCaminhos Quantidade de caminhos.
+ * @param dicionario Dicionário dos blocos BLOCO_DICIONARIO (pode ser NULL).
+ * @param numThreads Arquivos processados ao mesmo tempo (0 = número de processadores).
+ * @param informa Chamada ao fim de cada arquivo (pode ser NULL).
+ * @param arg Argumento de @p informa.
+ * @param resultado Recebe os totais (pode ser NULL).
+ * @param estatisticas Recebe as medições somadas de todos os arquivos (NULL = sem medição).
+ * @return HUFFMAN_OK se o lote foi processado (as falhas de cada arquivo são contadas em @p resultado);
+ *         HUFFMAN_ERRO_MEMORIA caso contrário.
+ */
+int descompactaLote(const char* const caminhos[], int numCaminhos, const DicionarioHuffman* dicionario,
+                    int numThreads, InformaLoteHuffman informa, void* arg, ResultadoLote* resultado,
+                    EstatisticasHuffman* estatisticas) {
+    Lote lote = {{NULL, 0, 0}, 0, 0, 0, informa, arg, {0, 0, 0, 0}, PTHREAD_MUTEX_INITIALIZER};
+    int codigo = executaLote(&lote, caminhos, numCaminhos, NULL, dicionario, numThreads, estatisticas);
+    if (resultado) {
+        *resultado = lote.resultado;
+    }
+    return codigo;
+}
+
+/**
+ * @brief Verifica muitos arquivos .comp em um único processo, vários ao mesmo tempo (verificaArquivo).
+ * @details Os diretórios são percorridos como em descompactaLote, mas um caminho explícito não precisa
+ *          da extensão .comp; nada é gravado. Os arquivos que terminam com HUFFMAN_AVISO_SEM_CRC contam
+ *          como processados.
+ * @param caminhos Arquivos e diretórios.
+ * @param numCaminhos Quantidade de caminhos.
+ * @param dicionario Dicionário dos blocos BLOCO_DICIONARIO (pode ser NULL).
+ * @param numThreads Arquivos processados ao mesmo tempo (0 = número de processadores).
+ * @param informa Chamada ao fim de cada arquivo (pode ser NULL).
+ * @param arg Argumento de @p informa.
+ * @param resultado Recebe os totais (pode ser NULL).
+ * @param estatisticas Recebe as medições somadas de todos os arquivos (NULL = sem medição).
+ * @return HUFFMAN_OK se o lote foi processado (as falhas de cada arquivo são contadas em @p resultado);
+ *         HUFFMAN_ERRO_MEMORIA caso contrário.
+ */
+int verificaLote(const char* const caminhos[], int numCaminhos, const DicionarioHuffman* dicionario,
+                 int numThreads, InformaLoteHuffman informa, void* arg, ResultadoLote* resultado,
+                 EstatisticasHuffman* estatisticas) {
+    Lote lote = {{NULL, 0, 0}, 0, 0, 1, informa, arg, {0, 0, 0, 0}, PTHREAD_MUTEX_INITIALIZER};
+    int codigo = executaLote(&lote, caminhos, numCaminhos, NULL, dicionario, numThreads, estatisticas);
+    if (resultado) {
+        *resultado = lote.resultado;
+    }
+    return codigo;
+}
@@ -0,0 +1,512 @@
+#ifndef LIBHUFFMAN_H
+#define LIBHUFFMAN_H
+
+#include <stddef.h>
+#include <stdio.h>
+
+/**
+ * @file libhuffman.h
+ * @brief Biblioteca de compactação por Huffman: buffers em memória, arquivos, fluxos incrementais,
+ *        extração de trechos e dicionários pré-treinados para mensagens pequenas.
+ * @details As funções retornam um código HUFFMAN_* em vez de encerrar o programa. Os contextos
+ *          guardam o pool de threads, as áreas de trabalho dos blocos e as tabelas de decodificação,
+ *          reaproveitados entre chamadas; um contexto não deve ser usado por duas threads ao mesmo tempo.
+ *          A saída em memória é idêntica ao arquivo gerado com as mesmas opções (container.h).
+ */
+
+#define HUFFMAN_OK 0
+#define HUFFMAN_AVISO_CODIGO_INCOMPLETO 1   ///< formato antigo: os dados terminaram no meio de um código
+#define HUFFMAN_FIM_FLUXO 2                 ///< compactaFluxo/descompactaFluxo: toda a saída foi entregue
+#define HUFFMAN_ERRO_PARAMETRO (-1)
+#define HUFFMAN_ERRO_MEMORIA (-2)
+#define HUFFMAN_ERRO_ENTRADA (-3)           ///< falha ao abrir ou ler a entrada (errno indica a causa)
+#define HUFFMAN_ERRO_SAIDA (-4)             ///< falha ao criar ou gravar a saída (errno indica a causa)
+#define HUFFMAN_ERRO_FORMATO (-5)
+#define HUFFMAN_ERRO_CORROMPIDO (-6)
+#define HUFFMAN_ERRO_DESTINO_PEQUENO (-7)
+#define HUFFMAN_ERRO_CODIGO_LONGO (-8)
+#define HUFFMAN_ERRO_SEM_INDICE (-9)
+#define HUFFMAN_ERRO_DICIONARIO (-10)       ///< blocos compactados com um dicionário ausente ou diferente
+#define HUFFMAN_ERRO_CRC (-11)              ///< bloco decodificado com CRC32C diferente do gravado
+#define HUFFMAN_AVISO_SEM_CRC 3             ///< verificaArquivo: há blocos sem CRC32C, só decodificados
+
+#define HUFFMAN_TAMANHO_BLOCO_PADRAO (4u << 20)
+#define HUFFMAN_TAMANHO_BLOCO_MAX (256u << 20)
+#define HUFFMAN_INTERVALO_PONTOS_PADRAO (64u << 10)
+#define HUFFMAN_COMPRIMENTO_MIN 8           ///< limites de OpcoesHuffman.comprimentoMax
+#define HUFFMAN_COMPRIMENTO_MAX 15
+#define HUFFMAN_FLUXOS_INTERCALADOS 4       ///< cada bloco em quatro fluxos, decodificados juntos
+
+// Fases medidas com as estatísticas ativas (EstatisticasHuffman)
+#define HUFFMAN_FASE_LEITURA 0              ///< entrada, cabeçalhos e corpos dos blocos
+#define HUFFMAN_FASE_FREQUENCIAS 1
+#define HUFFMAN_FASE_ARVORE 2               ///< construção e serialização; na leitura, desserialização e tabelas
+#define HUFFMAN_FASE_DICIONARIO 3
+#define HUFFMAN_FASE_CODIFICACAO 4
+#define HUFFMAN_FASE_DECODIFICACAO 5
+#define HUFFMAN_FASE_ESCRITA 6
+#define HUFFMAN_NUM_FASES 7
+#define HUFFMAN_BITS_CODIGO_MAX 64          ///< maior código de uma árvore sem limite de comprimento
+
+/**
+ * @brief Opções de compactação.
+ */
+typedef struct {
+    unsigned int tamanhoBloco;      ///< bytes da entrada por bloco (1 a HUFFMAN_TAMANHO_BLOCO_MAX)
+    unsigned int intervaloPontos;   ///< bytes entre pontos de acesso (0 = nenhum; até HUFFMAN_TAMANHO_BLOCO_MAX)
+    int comprimentoMax;             ///< 0 = árvore por bloco; ou códigos canônicos de até tantos bits
+    int legado;                     ///< 1 = formato antigo, de um único fluxo (apenas para arquivos)
+    int fluxos;                     ///< 1, ou HUFFMAN_FLUXOS_INTERCALADOS para blocos em quatro fluxos
+    int contexto;                   ///< 1 = modelo de ordem 1 nos blocos em que compensar (não com legado)
+    int crc;                        ///< 1 = CRC32C dos bytes originais de cada bloco (não com legado)
+    int direto;                     ///< 1 = arquivos com O_DIRECT, sem o cache de páginas (ignorado no legado)
+} OpcoesHuffman;
+
+/**
+ * @brief Tamanhos processados por uma chamada.
+ */
+typedef struct {
+    unsigned long long int tamanhoOriginal;
+    unsigned long long int tamanhoCompactado;
+} ResultadoHuffman;
+
+/**
+ * @brief Buffers de uma chamada incremental (compactaFluxo, descompactaFluxo), no estilo do zlib.
+ * @details O chamador aponta a entrada e a saída disponíveis; a chamada avança os ponteiros e diminui
+ *          os tamanhos conforme consome e produz. Os totais acumulam desde o início do fluxo.
+ */
+typedef struct {
+    const unsigned char* entrada;
+    size_t disponivelEntrada;
+    unsigned char* saida;
+    size_t disponivelSaida;
+    unsigned long long int totalEntrada;
+    unsigned long long int totalSaida;
+} FluxoHuffman;
+
+/**
+ * @brief Medições acumuladas por um contexto desde que as estatísticas foram ativadas.
+ * @details Os tempos das fases de cada bloco são somados entre blocos e threads: com várias threads, a
+ *          soma pode passar do tempo total da chamada. O histograma e a distribuição dos comprimentos
+ *          só são preenchidos na compactação.
+ */
+typedef struct {
+    double segundos[HUFFMAN_NUM_FASES];     ///< tempo de relógio de cada fase HUFFMAN_FASE_*
+    double segundosCpu[HUFFMAN_NUM_FASES];  ///< tempo de CPU das threads em cada fase
+    unsigned long long int blocos;
+    unsigned long long int frequencias[256];
+    unsigned long long int bytesPorComprimento[HUFFMAN_BITS_CODIGO_MAX + 1];   ///< [0] = guardados sem código
+} EstatisticasHuffman;
+
+/**
+ * @brief Totais de um lote de arquivos (compactaLote, descompactaLote).
+ */
+typedef struct {
+    unsigned long long int arquivos;            ///< arquivos processados com sucesso
+    unsigned long long int falhas;              ///< arquivos e diretórios que falharam
+    unsigned long long int tamanhoOriginal;     ///< somas dos tamanhos dos arquivos processados
+    unsigned long long int tamanhoCompactado;
+} ResultadoLote;
+
+/**
+ * @brief Aviso do fim de cada arquivo de um lote; as chamadas nunca ocorrem ao mesmo tempo.
+ * @param arg Argumento passado ao lote.
+ * @param nome Caminho do arquivo (ou do diretório que não pôde ser lido).
+ * @param codigo HUFFMAN_OK, um aviso HUFFMAN_AVISO_* ou código de erro (com HUFFMAN_ERRO_ENTRADA e
+ *        HUFFMAN_ERRO_SAIDA, errno indica a causa).
+ * @param resultado Tamanhos do arquivo.
+ */
+typedef void (*InformaLoteHuffman)(void* arg, const char* nome, int codigo, const ResultadoHuffman* resultado);
+
+typedef struct contextoCompactacao ContextoCompactacao;
+typedef struct contextoDescompactacao ContextoDescompactacao;
+typedef struct dicionario DicionarioHuffman;
+
+/**
+ * @brief Preenche @p opcoes com os valores padrão (blocos de 4 MB, pontos a cada 64 KB, árvore por bloco).
+ */
+void opcoesPadraoHuffman(OpcoesHuffman* opcoes);
+
+/**
+ * @brief Texto descritivo de um código de retorno.
+ * @param codigo Código HUFFMAN_*.
+ * @return Texto estático.
+ */
+const char* mensagemErroHuffman(int codigo);
+
+/**
+ * @brief Nome de uma fase das estatísticas.
+ * @param fase HUFFMAN_FASE_*.
+ * @return Texto estático ("?" fora dos limites).
+ */
+const char* nomeFaseHuffman(int fase);
+
+/**
+ * @brief Entropia de ordem 0 do histograma das estatísticas, o mínimo em bits por byte de qualquer código
+ *        de prefixo com um único código para os dados inteiros.
+ * @return Bits por byte (0 sem dados).
+ */
+double entropiaHuffman(const EstatisticasHuffman* estatisticas);
+
+/**
+ * @brief Cria um contexto de compactação com as opções padrão.
+ * @param numThreads Threads para compactar blocos em paralelo (0 = número de processadores).
+ * @return Contexto ou NULL em falta de memória.
+ */
+ContextoCompactacao* criaContextoCompactacao(int numThreads);
+
+/**
+ * @brief Troca as opções usadas nas próximas compactações.
+ * @param ctx Contexto.
+ * @param opcoes Novas opções.
+ * @return HUFFMAN_OK ou HUFFMAN_ERRO_PARAMETRO se alguma opção estiver fora dos limites.
+ */
+int defineOpcoesCompactacao(ContextoCompactacao* ctx, const OpcoesHuffman* opcoes);
+
+/**
+ * @brief Passa a compactar com os códigos de um dicionário, gravando nos blocos só o seu id.
+ * @details O dicionário não é copiado e deve existir enquanto o contexto o usar. O formato antigo o ignora.
+ * @param ctx Contexto.
+ * @param dicionario Dicionário, ou NULL para voltar ao código próprio de cada bloco.
+ * @return HUFFMAN_OK.
+ */
+int defineDicionarioCompactacao(ContextoCompactacao* ctx, const DicionarioHuffman* dicionario);
+
+/**
+ * @brief Maior tamanho possível da saída de compactaMemoria para @p tamanho bytes de entrada.
+ * @param ctx Contexto (as opções atuais determinam o número de blocos e pontos).
+ * @param tamanho Bytes da entrada.
+ */
+size_t limiteCompactacao(const ContextoCompactacao* ctx, size_t tamanho);
+
+/**
+ * @brief Compacta um buffer para o formato em blocos, em memória.
+ * @details Uma entrada que cabe em um único bloco (ou vazia) sai em um quadro único, sem cabeçalho do
+ *          arquivo nem índice (container.h).
+ * @param ctx Contexto.
+ * @param origem Bytes a compactar.
+ * @param tamanho Quantidade de bytes.
+ * @param destino Buffer de saída (limiteCompactacao bytes sempre bastam).
+ * @param capacidade Bytes disponíveis em @p destino.
+ * @param tamanhoSaida Recebe a quantidade de bytes gravados.
+ * @return HUFFMAN_OK ou código de erro (HUFFMAN_ERRO_PARAMETRO com a opção legado).
+ */
+int compactaMemoria(ContextoCompactacao* ctx, const void* origem, size_t tamanho,
+                    void* destino, size_t capacidade, size_t* tamanhoSaida);
+
+/**
+ * @brief Compacta um arquivo.
+ * @param ctx Contexto.
+ * @param nomeEntrada Caminho do arquivo original.
+ * @param nomeSaida Caminho do arquivo compactado (criado ou sobrescrito).
+ * @param resultado Recebe os tamanhos (pode ser NULL).
+ * @return HUFFMAN_OK ou código de erro.
+ */
+int compactaArquivo(ContextoCompactacao* ctx, const char* nomeEntrada, const char* nomeSaida,
+                    ResultadoHuffman* resultado);
+
+/**
+ * @brief Começa uma compactação incremental; um fluxo anterior ainda em andamento é abandonado.
+ * @details A saída é a mesma de compactaMemoria com as opções atuais: o cabeçalho do formato só é
+ *          gerado quando há um segundo bloco, e uma entrada de até um bloco sai em um quadro único.
+ * @param ctx Contexto.
+ * @return HUFFMAN_OK ou código de erro (HUFFMAN_ERRO_PARAMETRO com a opção legado).
+ */
+int iniciaCompactacaoFluxo(ContextoCompactacao* ctx);
+
+/**
+ * @brief Consome entrada e produz saída do fluxo iniciado com iniciaCompactacaoFluxo.
+ * @details Cada bloco completo é compactado com seu próprio código assim que chega, em paralelo com os
+ *          seguintes; a entrada nunca é lida duas vezes. A chamada retorna quando a entrada acaba ou
+ *          a saída enche; os blocos compactados que não couberem ficam guardados no contexto.
+ * @param ctx Contexto.
+ * @param f Buffers de entrada e saída; avançam sobre o que foi consumido e produzido.
+ * @param finalizar 1 quando @p f traz o fim da entrada: o último bloco, o terminador e o índice (ou o
+ *        quadro único) são gerados, e a função deve ser chamada de novo enquanto retornar HUFFMAN_OK.
+ * @return HUFFMAN_OK, HUFFMAN_FIM_FLUXO quando toda a saída foi entregue, ou código de erro (o fluxo
+ *         é abandonado).
+ */
+int compactaFluxo(ContextoCompactacao* ctx, FluxoHuffman* f, int finalizar);
+
+/**
+ * @brief Compacta tudo o que for lido de @p entrada até o fim, gravando em @p saida à medida que os
+ *        blocos ficam prontos (entradas sem tamanho conhecido, como pipes).
+ * @param ctx Contexto.
+ * @param entrada Arquivo aberto para leitura (binário).
+ * @param saida Arquivo aberto para escrita (binário).
+ * @param resultado Recebe os tamanhos (pode ser NULL).
+ * @return HUFFMAN_OK ou código de erro.
+ */
+int compactaFluxoArquivo(ContextoCompactacao* ctx, FILE* entrada, FILE* saida, ResultadoHuffman* resultado);
+
+/**
+ * @brief Liga ou desliga a medição das próximas compactações; as medições anteriores são zeradas.
+ * @details Desligada (o padrão), nenhum relógio é lido.
+ * @param ctx Contexto.
+ * @param ativa 1 para medir; 0 para não medir.
+ */
+void ativaEstatisticasCompactacao(ContextoCompactacao* ctx, int ativa);
+
+/**
+ * @brief Medições acumuladas desde ativaEstatisticasCompactacao.
+ * @param ctx Contexto.
+ * @param estatisticas Recebe as medições.
+ */
+void estatisticasCompactacao(const ContextoCompactacao* ctx, EstatisticasHuffman* estatisticas);
+
+/**
+ * @brief Libera o contexto, suas threads e áreas de trabalho.
+ * @param ctx Contexto (pode ser NULL).
+ */
+void liberaContextoCompactacao(ContextoCompactacao* ctx);
+
+/**
+ * @brief Cria um contexto de descompactação.
+ * @param numThreads Threads para descompactar blocos em paralelo (0 = número de processadores).
+ * @return Contexto ou NULL em falta de memória.
+ */
+ContextoDescompactacao* criaContextoDescompactacao(int numThreads);
+
+/**
+ * @brief Informa o dicionário dos blocos compactados com um (BLOCO_DICIONARIO); as tabelas dele são
+ *        usadas diretamente, sem montar nada por bloco.
+ * @details O dicionário não é copiado e deve existir enquanto o contexto o usar.
+ * @param ctx Contexto.
+ * @param dicionario Dicionário (NULL remove o atual).
+ * @return HUFFMAN_OK.
+ */
+int defineDicionarioDescompactacao(ContextoDescompactacao* ctx, const DicionarioHuffman* dicionario);
+
+/**
+ * @brief Tamanho original dos dados em um buffer no formato em blocos (somando os cabeçalhos dos blocos)
+ *        ou em um quadro único.
+ * @param origem Bytes compactados.
+ * @param tamanho Quantidade de bytes.
+ * @param tamanhoOriginal Recebe o tamanho descompactado.
+ * @return HUFFMAN_OK, HUFFMAN_ERRO_FORMATO ou HUFFMAN_ERRO_CORROMPIDO.
+ */
+int tamanhoDescompactado(const void* origem, size_t tamanho, unsigned long long int* tamanhoOriginal);
+
+/**
+ * @brief Descompacta um buffer no formato em blocos ou em um quadro único, em memória.
+ * @param ctx Contexto.
+ * @param origem Bytes compactados.
+ * @param tamanho Quantidade de bytes.
+ * @param destino Buffer de saída (tamanhoDescompactado bytes).
+ * @param capacidade Bytes disponíveis em @p destino.
+ * @param tamanhoSaida Recebe a quantidade de bytes gravados.
+ * @return HUFFMAN_OK ou código de erro (o formato antigo só é aceito por descompactaArquivo).
+ */
+int descompactaMemoria(ContextoDescompactacao* ctx, const void* origem, size_t tamanho,
+                       void* destino, size_t capacidade, size_t* tamanhoSaida);
+
+/**
+ * @brief Descompacta um arquivo em qualquer dos formatos .comp.
+ * @details Com índice, os blocos são descompactados em paralelo e gravados nas posições finais;
+ *          sem índice, em sequência. Os blocos gravados com CRC32C são conferidos.
+ * @param ctx Contexto.
+ * @param nomeEntrada Caminho do arquivo compactado.
+ * @param nomeSaida Caminho do arquivo descompactado (criado ou sobrescrito).
+ * @param resultado Recebe os tamanhos (pode ser NULL).
+ * @return HUFFMAN_OK, HUFFMAN_AVISO_CODIGO_INCOMPLETO ou código de erro.
+ */
+int descompactaArquivo(ContextoDescompactacao* ctx, const char* nomeEntrada, const char* nomeSaida,
+                       ResultadoHuffman* resultado);
+
+/**
+ * @brief Verifica a integridade de um arquivo .comp: decodifica todos os blocos, em paralelo se houver
+ *        índice, e confere os CRC32C, sem gravar a saída.
+ * @details Um bloco sem CRC32C só é conferido pela decodificação (códigos válidos e tamanho exato). O
+ *          formato antigo é decodificado inteiro e descartado; o seu tamanho original é o dos bytes decodificados.
+ * @param ctx Contexto.
+ * @param nomeEntrada Caminho do arquivo compactado.
+ * @param resultado Recebe os tamanhos (pode ser NULL).
+ * @return HUFFMAN_OK se todos os blocos conferiram; HUFFMAN_AVISO_SEM_CRC se todos foram decodificados
+ *         mas algum não tinha CRC32C; HUFFMAN_AVISO_CODIGO_INCOMPLETO ou código de erro
+ *         (HUFFMAN_ERRO_CRC se um CRC32C não conferiu).
+ */
+int verificaArquivo(ContextoDescompactacao* ctx, const char* nomeEntrada, ResultadoHuffman* resultado);
+
+/**
+ * @brief Começa uma descompactação incremental do formato em blocos.
+ * @param ctx Contexto.
+ * @return HUFFMAN_OK.
+ */
+int iniciaDescompactacaoFluxo(ContextoDescompactacao* ctx);
+
+/**
+ * @brief Consome entrada e produz saída do fluxo iniciado com iniciaDescompactacaoFluxo.
+ * @details Cabeçalhos, descrições de código e dados podem chegar divididos em qualquer ponto, inclusive
+ *          no meio de um código: o estado da decodificação é guardado no contexto. O índice após o
+ *          terminador não é necessário e não é consumido. O CRC32C de um bloco é conferido ao fim dele,
+ *          depois que seus bytes já saíram: o erro HUFFMAN_ERRO_CRC invalida a saída do bloco.
+ * @param ctx Contexto.
+ * @param f Buffers de entrada e saída; avançam sobre o que foi consumido e produzido.
+ * @return HUFFMAN_OK quando precisa de mais entrada ou espaço na saída, HUFFMAN_FIM_FLUXO após o
+ *         terminador ou o fim do quadro único, ou código de erro (HUFFMAN_ERRO_FORMATO para o formato antigo, que não tem fim
+ *         marcado; o fluxo é abandonado).
+ */
+int descompactaFluxo(ContextoDescompactacao* ctx, FluxoHuffman* f);
+
+/**
+ * @brief Descompacta o formato em blocos lido de @p entrada, gravando em @p saida à medida que os
+ *        blocos são decodificados (entradas sem posicionamento, como pipes).
+ * @details Após o terminador, o resto da entrada (o índice) é lido e descartado.
+ * @param ctx Contexto.
+ * @param entrada Arquivo aberto para leitura (binário).
+ * @param saida Arquivo aberto para escrita (binário).
+ * @param resultado Recebe os tamanhos (pode ser NULL).
+ * @return HUFFMAN_OK ou código de erro (HUFFMAN_ERRO_CORROMPIDO se a entrada acabar antes do terminador).
+ */
+int descompactaFluxoArquivo(ContextoDescompactacao* ctx, FILE* entrada, FILE* saida, ResultadoHuffman* resultado);
+
+/**
+ * @brief Descompacta apenas os bytes [inicio, inicio + tamanho) do original (limitados ao fim dos dados).
+ * @details Só os blocos decodificados inteiros têm o CRC32C conferido; um trecho de bloco com pontos de
+ *          acesso não cobre todos os bytes do CRC.
+ * @param ctx Contexto.
+ * @param nomeEntrada Caminho do arquivo no formato em blocos, com índice.
+ * @param inicio Posição do primeiro byte nos dados originais.
+ * @param tamanho Quantidade de bytes.
+ * @param saida Arquivo de saída aberto (binário).
+ * @param extraidos Recebe a quantidade de bytes gravados (pode ser NULL).
+ * @return HUFFMAN_OK ou código de erro (HUFFMAN_ERRO_SEM_INDICE se o arquivo não tiver índice, como
+ *         um quadro único).
+ */
+int extraiTrechoArquivo(ContextoDescompactacao* ctx, const char* nomeEntrada, unsigned long long int inicio,
+                        unsigned long long int tamanho, FILE* saida, unsigned long long int* extraidos);
+
+/**
+ * @brief Liga ou desliga a medição das próximas descompactações; as medições anteriores são zeradas.
+ * @details A extração de trechos não é medida.
+ * @param ctx Contexto.
+ * @param ativa 1 para medir; 0 para não medir.
+ */
+void ativaEstatisticasDescompactacao(ContextoDescompactacao* ctx, int ativa);
+
+/**
+ * @brief Liga ou desliga O_DIRECT na gravação da saída das próximas descompactações com índice.
+ * @details Os blocos com posição e tamanho alinhados a 4096 bytes são gravados sem passar pelo cache
+ *          de páginas; os demais (em geral, só o último) e os sistemas de arquivos sem O_DIRECT usam a
+ *          gravação comum.
+ * @param ctx Contexto.
+ * @param ativa 1 para usar O_DIRECT; 0 para não usar (o padrão).
+ */
+void ativaSaidaDiretaDescompactacao(ContextoDescompactacao* ctx, int ativa);
+
+/**
+ * @brief Medições acumuladas desde ativaEstatisticasDescompactacao.
+ * @param ctx Contexto.
+ * @param estatisticas Recebe as medições.
+ */
+void estatisticasDescompactacao(const ContextoDescompactacao* ctx, EstatisticasHuffman* estatisticas);
+
+/**
+ * @brief Libera o contexto, suas threads e áreas de trabalho.
+ * @param ctx Contexto (pode ser NULL).
+ */
+void liberaContextoDescompactacao(ContextoDescompactacao* ctx);
+
+/**
+ * @brief Compacta muitos arquivos em um único processo, vários ao mesmo tempo.
+ * @details Cada caminho pode ser um arquivo ou um diretório, percorrido recursivamente (sem seguir links
+ *          simbólicos e pulando os arquivos .comp). Cada arquivo gera <nome>.comp, idêntico ao de
+ *          compactaArquivo com as mesmas opções. Os arquivos são distribuídos entre @p numThreads
+ *          trabalhadores; cada um compacta os seus blocos na própria thread, com um contexto cujas
+ *          áreas de trabalho são reaproveitadas de um arquivo para o outro.
+ * @param caminhos Arquivos e diretórios.
+ * @param numCaminhos Quantidade de caminhos.
+ * @param opcoes Opções de compactação (NULL = padrão).
+ * @param dicionario Dicionário para os blocos (pode ser NULL).
+ * @param numThreads Arquivos processados ao mesmo tempo (0 = número de processadores).
+ * @param informa Chamada ao fim de cada arquivo (pode ser NULL).
+ * @param arg Argumento de @p informa.
+ * @param resultado Recebe os totais (pode ser NULL).
+ * @param estatisticas Recebe as medições somadas de todos os arquivos (NULL = sem medição).
+ * @return HUFFMAN_OK se o lote foi processado (as falhas de cada arquivo são contadas em @p resultado);
+ *         HUFFMAN_ERRO_PARAMETRO ou HUFFMAN_ERRO_MEMORIA caso contrário.
+ */
+int compactaLote(const char* const caminhos[], int numCaminhos, const OpcoesHuffman* opcoes,
+                 const DicionarioHuffman* dicionario, int numThreads, InformaLoteHuffman informa, void* arg,
+                 ResultadoLote* resultado, EstatisticasHuffman* estatisticas);
+
+/**
+ * @brief Descompacta muitos arquivos .comp em um único processo, vários ao mesmo tempo.
+ * @details Os diretórios são percorridos recursivamente, considerando só os arquivos .comp; cada
+ *          <nome>.comp gera <nome>. Um caminho explícito sem a extensão .comp falha com
+ *          HUFFMAN_ERRO_PARAMETRO. Os trabalhadores funcionam como em compactaLote.
+ * @param caminhos Arquivos e diretórios.
+ * @param numCaminhos Quantidade de caminhos.
+ * @param dicionario Dicionário dos blocos BLOCO_DICIONARIO (pode ser NULL).
+ * @param numThreads Arquivos processados ao mesmo tempo (0 = número de processadores).
+ * @param informa Chamada ao fim de cada arquivo (pode ser NULL).
+ * @param arg Argumento de @p informa.
+ * @param resultado Recebe os totais (pode ser NULL).
+ * @param estatisticas Recebe as medições somadas de todos os arquivos (NULL = sem medição).
+ * @return HUFFMAN_OK se o lote foi processado (as falhas de cada arquivo são contadas em @p resultado);
+ *         HUFFMAN_ERRO_MEMORIA caso contrário.
+ */
+int descompactaLote(const char* const caminhos[], int numCaminhos, const DicionarioHuffman* dicionario,
+                    int numThreads, InformaLoteHuffman informa, void* arg, ResultadoLote* resultado,
+                    EstatisticasHuffman* estatisticas);
+
+/**
+ * @brief Verifica muitos arquivos .comp em um único processo, vários ao mesmo tempo (verificaArquivo).
+ * @details Os diretórios são percorridos como em descompactaLote, mas um caminho explícito não precisa
+ *          da extensão .comp; nada é gravado. Os arquivos que terminam com HUFFMAN_AVISO_SEM_CRC contam
+ *          como processados.
+ * @param caminhos Arquivos e diretórios.
+ * @param numCaminhos Quantidade de caminhos.
+ * @param dicionario Dicionário dos blocos BLOCO_DICIONARIO (pode ser NULL).
+ * @param numThreads Arquivos processados ao mesmo tempo (0 = número de processadores).
+ * @param informa Chamada ao fim de cada arquivo (pode ser NULL).
+ * @param arg Argumento de @p informa.
+ * @param resultado Recebe os totais (pode ser NULL).
+ * @param estatisticas Recebe as medições somadas de todos os arquivos (NULL = sem medição).
+ * @return HUFFMAN_OK se o lote foi processado (as falhas de cada arquivo são contadas em @p resultado);
+ *         HUFFMAN_ERRO_MEMORIA caso contrário.
+ */
+int verificaLote(const char* const caminhos[], int numCaminhos, const DicionarioHuffman* dicionario,
+                 int numThreads, InformaLoteHuffman informa, void* arg, ResultadoLote* resultado,
+                 EstatisticasHuffman* estatisticas);
+
+/**
+ * @brief Treina um dicionário com as frequências somadas de um conjunto de arquivos de amostra.
+ * @param amostras Caminhos dos arquivos.
+ * @param numAmostras Quantidade de arquivos (ao menos 1).
+ * @param id Identificador gravado nos blocos compactados com o dicionário.
+ * @param comprimentoMax Limite dos códigos (0 = HUFFMAN_COMPRIMENTO_MAX).
+ * @param dicionario Recebe o dicionário (liberar com liberaDicionarioHuffman).
+ * @return HUFFMAN_OK ou código de erro.
+ */
+int treinaDicionario(const char* const amostras[], int numAmostras, unsigned int id, int comprimentoMax,
+                     DicionarioHuffman** dicionario);
+
+/**
+ * @brief Grava um dicionário em arquivo.
+ * @param dicionario Dicionário.
+ * @param nome Caminho do arquivo (criado ou sobrescrito).
+ * @return HUFFMAN_OK ou HUFFMAN_ERRO_SAIDA.
+ */
+int gravaDicionarioArquivo(const DicionarioHuffman* dicionario, const char* nome);
+
+/**
+ * @brief Carrega um dicionário gravado por gravaDicionarioArquivo, já com as tabelas montadas.
+ * @param nome Caminho do arquivo.
+ * @param dicionario Recebe o dicionário (liberar com liberaDicionarioHuffman).
+ * @return HUFFMAN_OK, HUFFMAN_ERRO_ENTRADA ou HUFFMAN_ERRO_FORMATO.
+ */
+int carregaDicionarioArquivo(const char* nome, DicionarioHuffman** dicionario);
+
+/**
+ * @brief Identificador de um dicionário.
+ */
+unsigned int idDicionarioHuffman(const DicionarioHuffman* dicionario);
+
+/**
+ * @brief Libera um dicionário.
+ * @param dicionario Dicionário (pode ser NULL).
+ */
+void liberaDicionarioHuffman(DicionarioHuffman* dicionario);
+
+#endif
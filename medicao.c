@@ -0,0 +1,63 @@
+#include "medicao.h"
+#include <time.h>
+
+static double leRelogio(clockid_t relogio) {
+    struct timespec t;
+    clock_gettime(relogio, &t);
+    return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+/**
+ * @brief Marca o início da primeira fase.
+ * @param tempos Destino dos tempos (NULL = sem medição).
+ * @param m Marca a iniciar.
+ */
+void iniciaMedicao(const TemposFases* tempos, MarcaTempo* m) {
+    if (tempos == NULL) {
+        return;
+    }
+    m->relogio = leRelogio(CLOCK_MONOTONIC);
+    m->cpu = leRelogio(CLOCK_THREAD_CPUTIME_ID);
+}
+
+/**
+ * @brief Soma à @p fase o tempo desde a marca e a move para agora, início da fase seguinte.
+ * @param tempos Destino dos tempos (NULL = sem medição).
+ * @param fase FASE_*.
+ * @param m Marca iniciada por iniciaMedicao.
+ */
+void encerraFase(TemposFases* tempos, int fase, MarcaTempo* m) {
+    if (tempos == NULL) {
+        return;
+    }
+    double relogio = leRelogio(CLOCK_MONOTONIC);
+    double cpu = leRelogio(CLOCK_THREAD_CPUTIME_ID);
+    tempos->segundos[fase] += relogio - m->relogio;
+    tempos->segundosCpu[fase] += cpu - m->cpu;
+    m->relogio = relogio;
+    m->cpu = cpu;
+}
+
+/**
+ * @brief Soma os tempos de @p origem aos de @p destino.
+ */
+void somaTempos(TemposFases* destino, const TemposFases* origem) {
+    for (int f = 0; f < NUM_FASES; f++) {
+        destino->segundos[f] += origem->segundos[f];
+        destino->segundosCpu[f] += origem->segundosCpu[f];
+    }
+}
+
+/**
+ * @brief Soma tempos, contagens e distribuição de @p origem às de @p destino.
+ */
+void somaMedicao(Medicao* destino, const Medicao* origem) {
+    somaTempos(&destino->tempos, &origem->tempos);
+    destino->blocos += origem->blocos;
+    for (int i = 0; i < 256; i++) {
+        destino->frequencias[i] += origem->frequencias[i];
+    }
+    for (int i = 0; i <= TAMANHO_MAX_CODIGO; i++) {
+        destino->bytesPorComprimento[i] += origem->bytesPorComprimento[i];
+    }
+}
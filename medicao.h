@@ -0,0 +1,70 @@
+#ifndef MEDICAO_H
+#define MEDICAO_H
+
+#include "codificador.h"
+
+/**
+ * @file medicao.h
+ * @brief Tempo por fase da compactação e da descompactação, medido só quando pedido (--stats).
+ * @details Cada thread acumula os seus tempos em uma TemposFases própria; quem aguarda a tarefa soma o
+ *          resultado com somaMedicao. Com tempos NULL, as funções não fazem nada.
+ */
+
+#define FASE_LEITURA 0          ///< leitura da entrada, dos cabeçalhos e dos corpos dos blocos
+#define FASE_FREQUENCIAS 1      ///< histograma dos bytes
+#define FASE_ARVORE 2           ///< construção e serialização do código; na leitura, desserialização e tabelas
+#define FASE_DICIONARIO 3       ///< códigos de cada byte (gerarDicionario)
+#define FASE_CODIFICACAO 4
+#define FASE_DECODIFICACAO 5
+#define FASE_ESCRITA 6
+#define NUM_FASES 7
+
+typedef struct {
+    double segundos[NUM_FASES];      ///< tempo de relógio
+    double segundosCpu[NUM_FASES];   ///< tempo de CPU da thread
+} TemposFases;
+
+/**
+ * @brief Instante em que começou a fase em andamento.
+ */
+typedef struct {
+    double relogio;
+    double cpu;
+} MarcaTempo;
+
+/**
+ * @brief Tempos e distribuição dos códigos acumulados em um bloco ou em um contexto.
+ */
+typedef struct {
+    TemposFases tempos;
+    unsigned long long int blocos;
+    unsigned long long int frequencias[256];    ///< histograma dos bytes compactados
+    unsigned long long int bytesPorComprimento[TAMANHO_MAX_CODIGO + 1];    ///< [0] = bytes guardados sem código
+} Medicao;
+
+/**
+ * @brief Marca o início da primeira fase.
+ * @param tempos Destino dos tempos (NULL = sem medição).
+ * @param m Marca a iniciar.
+ */
+void iniciaMedicao(const TemposFases* tempos, MarcaTempo* m);
+
+/**
+ * @brief Soma à @p fase o tempo desde a marca e a move para agora, início da fase seguinte.
+ * @param tempos Destino dos tempos (NULL = sem medição).
+ * @param fase FASE_*.
+ * @param m Marca iniciada por iniciaMedicao.
+ */
+void encerraFase(TemposFases* tempos, int fase, MarcaTempo* m);
+
+/**
+ * @brief Soma os tempos de @p origem aos de @p destino.
+ */
+void somaTempos(TemposFases* destino, const TemposFases* origem);
+
+/**
+ * @brief Soma tempos, contagens e distribuição de @p origem às de @p destino.
+ */
+void somaMedicao(Medicao* destino, const Medicao* origem);
+
+#endif
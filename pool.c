@@ -0,0 +1,160 @@
+#include "pool.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+struct poolThreads {
+    pthread_t* threads;
+    int numThreads;
+    Tarefa* inicio;             ///< fila de tarefas ainda não iniciadas
+    Tarefa* fim;
+    int encerrar;
+    pthread_mutex_t trava;
+    pthread_cond_t temTarefa;
+    pthread_cond_t terminou;
+};
+
+/**
+ * @brief Laço de cada thread: retira a próxima tarefa da fila, executa e sinaliza a conclusão.
+ */
+static void* trabalhador(void* arg) {
+    PoolThreads* p = (PoolThreads*) arg;
+    for (;;) {
+        pthread_mutex_lock(&p->trava);
+        while (p->inicio == NULL && !p->encerrar) {
+            pthread_cond_wait(&p->temTarefa, &p->trava);
+        }
+        Tarefa* t = p->inicio;
+        if (t == NULL) {
+            pthread_mutex_unlock(&p->trava);
+            return NULL;
+        }
+        p->inicio = t->prox;
+        if (p->inicio == NULL) {
+            p->fim = NULL;
+        }
+        pthread_mutex_unlock(&p->trava);
+
+        t->funcao(t->arg);
+
+        pthread_mutex_lock(&p->trava);
+        t->concluida = 1;
+        pthread_cond_broadcast(&p->terminou);
+        pthread_mutex_unlock(&p->trava);
+    }
+}
+
+/**
+ * @brief Cria um pool com @p numThreads threads de trabalho.
+ * @param numThreads Quantidade de threads; 0 = nenhuma, cada tarefa é executada por submeteTarefa.
+ * @return Pool criado ou NULL em erro.
+ */
+PoolThreads* criaPoolThreads(int numThreads) {
+    if (numThreads < 0) {
+        numThreads = 0;
+    }
+    PoolThreads* p = (PoolThreads*) calloc(1, sizeof(PoolThreads));
+    if (p == NULL) {
+        return NULL;
+    }
+    // Sem threads não há vetor: malloc(0) pode retornar NULL e seria tomado por falta de memória
+    if (numThreads > 0 && (p->threads = (pthread_t*) malloc(numThreads * sizeof(pthread_t))) == NULL) {
+        free(p);
+        return NULL;
+    }
+    pthread_mutex_init(&p->trava, NULL);
+    pthread_cond_init(&p->temTarefa, NULL);
+    pthread_cond_init(&p->terminou, NULL);
+    for (int i = 0; i < numThreads; i++) {
+        if (pthread_create(&p->threads[i], NULL, trabalhador, p) != 0) {
+            break;
+        }
+        p->numThreads++;
+    }
+    if (p->numThreads == 0 && numThreads > 0) {
+        liberaPoolThreads(p);
+        return NULL;
+    }
+    return p;
+}
+
+/**
+ * @brief Enfileira uma tarefa; as tarefas começam na ordem em que foram submetidas (sem threads, é
+ *        executada antes de retornar).
+ * @param p Pool.
+ * @param t Tarefa com funcao e arg preenchidos.
+ */
+void submeteTarefa(PoolThreads* p, Tarefa* t) {
+    t->prox = NULL;
+    if (p->numThreads == 0) {
+        t->funcao(t->arg);
+        t->concluida = 1;
+        return;
+    }
+    t->concluida = 0;
+    pthread_mutex_lock(&p->trava);
+    if (p->fim) {
+        p->fim->prox = t;
+    } else {
+        p->inicio = t;
+    }
+    p->fim = t;
+    pthread_cond_signal(&p->temTarefa);
+    pthread_mutex_unlock(&p->trava);
+}
+
+/**
+ * @brief Bloqueia até que a tarefa termine.
+ * @param p Pool.
+ * @param t Tarefa submetida anteriormente.
+ */
+void aguardaTarefa(PoolThreads* p, Tarefa* t) {
+    pthread_mutex_lock(&p->trava);
+    while (!t->concluida) {
+        pthread_cond_wait(&p->terminou, &p->trava);
+    }
+    pthread_mutex_unlock(&p->trava);
+}
+
+/**
+ * @brief Indica, sem bloquear, se a tarefa já terminou.
+ * @param p Pool.
+ * @param t Tarefa submetida anteriormente.
+ * @return 1 se terminou (aguardaTarefa retorna imediatamente); 0 caso contrário.
+ */
+int tarefaConcluida(PoolThreads* p, Tarefa* t) {
+    pthread_mutex_lock(&p->trava);
+    int concluida = t->concluida;
+    pthread_mutex_unlock(&p->trava);
+    return concluida;
+}
+
+/**
+ * @brief Aguarda as tarefas pendentes, encerra as threads e libera o pool.
+ * @param p Pool (pode ser NULL).
+ */
+void liberaPoolThreads(PoolThreads* p) {
+    if (p == NULL) {
+        return;
+    }
+    pthread_mutex_lock(&p->trava);
+    p->encerrar = 1;
+    pthread_cond_broadcast(&p->temTarefa);
+    pthread_mutex_unlock(&p->trava);
+    for (int i = 0; i < p->numThreads; i++) {
+        pthread_join(p->threads[i], NULL);
+    }
+    pthread_mutex_destroy(&p->trava);
+    pthread_cond_destroy(&p->temTarefa);
+    pthread_cond_destroy(&p->terminou);
+    free(p->threads);
+    free(p);
+}
+
+/**
+ * @brief Quantidade de processadores disponíveis (pelo menos 1).
+ */
+int numeroProcessadores(void) {
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (int) n : 1;
+}
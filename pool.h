@@ -0,0 +1,58 @@
+#ifndef POOL_H
+#define POOL_H
+
+typedef struct poolThreads PoolThreads;
+
+/**
+ * @brief Tarefa executada por uma thread do pool.
+ * @details A estrutura pertence a quem submete e deve permanecer válida até aguardaTarefa retornar.
+ */
+typedef struct tarefa {
+    void (*funcao)(void* arg);
+    void* arg;
+    int concluida;          ///< uso interno do pool
+    struct tarefa* prox;    ///< uso interno do pool
+} Tarefa;
+
+/**
+ * @brief Cria um pool com @p numThreads threads de trabalho.
+ * @param numThreads Quantidade de threads; 0 = nenhuma, cada tarefa é executada por submeteTarefa.
+ * @return Pool criado ou NULL em erro.
+ */
+PoolThreads* criaPoolThreads(int numThreads);
+
+/**
+ * @brief Enfileira uma tarefa; as tarefas começam na ordem em que foram submetidas (sem threads, é
+ *        executada antes de retornar).
+ * @param p Pool.
+ * @param t Tarefa com funcao e arg preenchidos.
+ */
+void submeteTarefa(PoolThreads* p, Tarefa* t);
+
+/**
+ * @brief Bloqueia até que a tarefa termine.
+ * @param p Pool.
+ * @param t Tarefa submetida anteriormente.
+ */
+void aguardaTarefa(PoolThreads* p, Tarefa* t);
+
+/**
+ * @brief Indica, sem bloquear, se a tarefa já terminou.
+ * @param p Pool.
+ * @param t Tarefa submetida anteriormente.
+ * @return 1 se terminou (aguardaTarefa retorna imediatamente); 0 caso contrário.
+ */
+int tarefaConcluida(PoolThreads* p, Tarefa* t);
+
+/**
+ * @brief Aguarda as tarefas pendentes, encerra as threads e libera o pool.
+ * @param p Pool (pode ser NULL).
+ */
+void liberaPoolThreads(PoolThreads* p);
+
+/**
+ * @brief Quantidade de processadores disponíveis (pelo menos 1).
+ */
+int numeroProcessadores(void);
+
+#endif
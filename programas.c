@@ -0,0 +1,118 @@
+#include "programas.h"
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <time.h>
+
+/**
+ * @brief Relógio monotônico, em segundos.
+ */
+double agora(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+/**
+ * @brief Tempo de CPU do processo (todas as threads, usuário + sistema) e pico de memória residente.
+ */
+void usoProcesso(double* segundosCpu, long* picoMemoriaKB) {
+    struct rusage uso;
+    *segundosCpu = 0;
+    *picoMemoriaKB = -1;
+    if (getrusage(RUSAGE_SELF, &uso) == 0) {
+        *segundosCpu = uso.ru_utime.tv_sec + uso.ru_utime.tv_usec * 1e-6 + uso.ru_stime.tv_sec + uso.ru_stime.tv_usec * 1e-6;
+#ifdef __APPLE__
+        *picoMemoriaKB = uso.ru_maxrss / 1024;  // bytes no macOS
+#else
+        *picoMemoriaKB = uso.ru_maxrss;
+#endif
+    }
+}
+
+/**
+ * @brief Acrescenta uma cópia de @p nome à lista; encerra o programa em falta de memória.
+ */
+void acrescentaCaminho(ListaCaminhos* l, const char* nome) {
+    if (l->quantidade == l->capacidade) {
+        int capacidade = l->capacidade ? 2 * l->capacidade : 16;
+        char** nomes = (char**) realloc(l->nomes, capacidade * sizeof(char*));
+        if (nomes == NULL) {
+            fprintf(stderr, "Erro: %s\n", mensagemErroHuffman(HUFFMAN_ERRO_MEMORIA));
+            exit(1);
+        }
+        l->nomes = nomes;
+        l->capacidade = capacidade;
+    }
+    char* copia = strdup(nome);
+    if (copia == NULL) {
+        fprintf(stderr, "Erro: %s\n", mensagemErroHuffman(HUFFMAN_ERRO_MEMORIA));
+        exit(1);
+    }
+    l->nomes[l->quantidade++] = copia;
+}
+
+/**
+ * @brief Libera os nomes e a própria lista.
+ */
+void liberaCaminhos(ListaCaminhos* l) {
+    for (int i = 0; i < l->quantidade; i++) {
+        free(l->nomes[i]);
+    }
+    free(l->nomes);
+}
+
+/**
+ * @brief Acrescenta os caminhos de uma lista, um por linha ("-" = entrada padrão); linhas vazias são puladas.
+ * @return 0 em sucesso; -1 se a lista não puder ser lida.
+ */
+int leListaCaminhos(ListaCaminhos* l, const char* nomeLista) {
+    FILE* lista = strcmp(nomeLista, "-") == 0 ? stdin : fopen(nomeLista, "r");
+    if (lista == NULL) {
+        return -1;
+    }
+    char* linha = NULL;
+    size_t capacidade = 0;
+    ssize_t n;
+    while ((n = getline(&linha, &capacidade, lista)) >= 0) {
+        while (n > 0 && (linha[n - 1] == '\n' || linha[n - 1] == '\r')) {
+            linha[--n] = '\0';
+        }
+        if (n > 0) {
+            acrescentaCaminho(l, linha);
+        }
+    }
+    free(linha);
+    int erro = ferror(lista);
+    if (lista != stdin) {
+        fclose(lista);
+    }
+    return erro ? -1 : 0;
+}
+
+/**
+ * @brief Informa os arquivos de um lote que falharam ou terminaram com aviso (InformaLoteHuffman).
+ * @param arg FILE* das mensagens.
+ */
+void informaArquivo(void* arg, const char* nome, int codigo, const ResultadoHuffman* resultado) {
+    FILE* mensagens = (FILE*) arg;
+    (void) resultado;
+    if (codigo == HUFFMAN_AVISO_CODIGO_INCOMPLETO || codigo == HUFFMAN_AVISO_SEM_CRC) {
+        fprintf(mensagens, "Aviso: %s: %s\n", nome, mensagemErroHuffman(codigo));
+    } else if (codigo == HUFFMAN_ERRO_ENTRADA || codigo == HUFFMAN_ERRO_SAIDA) {
+        fprintf(mensagens, "Erro: %s: %s: %s\n", nome, mensagemErroHuffman(codigo), strerror(errno));
+    } else if (codigo != HUFFMAN_OK) {
+        fprintf(mensagens, "Erro: %s: %s\n", nome, mensagemErroHuffman(codigo));
+    }
+}
+
+/**
+ * @brief Indica se @p nome é um diretório.
+ */
+int ehDiretorio(const char* nome) {
+    struct stat st;
+    return stat(nome, &st) == 0 && S_ISDIR(st.st_mode);
+}
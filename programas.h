@@ -0,0 +1,61 @@
+#ifndef PROGRAMAS_H
+#define PROGRAMAS_H
+
+#include "libhuffman.h"
+
+/**
+ * @file programas.h
+ * @brief Funções comuns aos programas compacta e descompacta: relógio e uso do processo para --stats,
+ *        lista de caminhos de um lote (-L) e mensagens de cada arquivo do lote.
+ */
+
+#define ESTATISTICAS_TEXTO 1
+#define ESTATISTICAS_JSON 2
+
+/**
+ * @brief Caminhos a processar: os da linha de comando e os das listas de -L.
+ */
+typedef struct {
+    char** nomes;
+    int quantidade;
+    int capacidade;
+} ListaCaminhos;
+
+/**
+ * @brief Relógio monotônico, em segundos.
+ */
+double agora(void);
+
+/**
+ * @brief Tempo de CPU do processo (todas as threads, usuário + sistema) e pico de memória residente.
+ */
+void usoProcesso(double* segundosCpu, long* picoMemoriaKB);
+
+/**
+ * @brief Acrescenta uma cópia de @p nome à lista; encerra o programa em falta de memória.
+ */
+void acrescentaCaminho(ListaCaminhos* l, const char* nome);
+
+/**
+ * @brief Libera os nomes e a própria lista.
+ */
+void liberaCaminhos(ListaCaminhos* l);
+
+/**
+ * @brief Acrescenta os caminhos de uma lista, um por linha ("-" = entrada padrão); linhas vazias são puladas.
+ * @return 0 em sucesso; -1 se a lista não puder ser lida.
+ */
+int leListaCaminhos(ListaCaminhos* l, const char* nomeLista);
+
+/**
+ * @brief Informa os arquivos de um lote que falharam ou terminaram com aviso (InformaLoteHuffman).
+ * @param arg FILE* das mensagens.
+ */
+void informaArquivo(void* arg, const char* nome, int codigo, const ResultadoHuffman* resultado);
+
+/**
+ * @brief Indica se @p nome é um diretório.
+ */
+int ehDiretorio(const char* nome);
+
+#endif
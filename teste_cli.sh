@@ -0,0 +1,273 @@
+#!/bin/sh
+# Testes de compacta e descompacta, um grupo por execução:
+#   sh teste_cli.sh <grupo> <diretório dos programas> <diretório de trabalho>
+# Grupos: extracao, crc, fifo, legado, lote, direto e estatisticas.
+# Retorna 0 se todas as verificações passarem.
+
+grupo=$1
+programas=$2
+trabalho=$3
+if [ -z "$grupo" ] || [ ! -x "$programas/compacta" ] || [ -z "$trabalho" ]; then
+    echo "Uso: sh teste_cli.sh <grupo> <diretório dos programas> <diretório de trabalho>"
+    echo "Grupos: extracao, crc, fifo, legado, lote, direto e estatisticas"
+    exit 1
+fi
+rm -rf "$trabalho"
+mkdir -p "$trabalho" || exit 1
+cd "$trabalho" || exit 1
+falhas=0
+
+falha() {
+    echo "FALHA: $*"
+    falhas=$((falhas + 1))
+}
+
+# Texto de log de uns 2,5 MB, sempre o mesmo
+geraTexto() {
+    awk 'BEGIN {
+        estado = 12345
+        for (i = 0; i < 40000; i++) {
+            estado = (estado * 1103515245 + 12345) % 2147483648
+            printf "2026-10-16 %05d %s req=%d path=/api/v1/itens/%d\n", i, (estado % 7 == 0 ? "WARN" : "INFO"),
+                   estado % 100000, estado % 997
+        }
+    }' > "$1"
+}
+
+# Byte da posição $2 (a partir de 0) do arquivo $1, em decimal
+leByte() {
+    od -An -tu1 -j "$2" -N 1 "$1" | tr -d ' '
+}
+
+# Inteiro little-endian de $3 bytes na posição $2 do arquivo $1
+leInteiro() {
+    valor=0
+    k=$(($3 - 1))
+    while [ $k -ge 0 ]; do
+        valor=$((valor * 256 + $(leByte "$1" $(($2 + k)))))
+        k=$((k - 1))
+    done
+    echo $valor
+}
+
+# Inverte os bits do byte na posição $2 do arquivo $1
+inverteByte() {
+    novo=$(($(leByte "$1" "$2") ^ 255))
+    printf "\\$(printf %o $novo)" | dd of="$1" bs=1 seek="$2" conv=notrunc 2>/dev/null
+}
+
+# Confere que o arquivo $1 tem só um objeto JSON de --stats=json da operação $2, com $3 bytes lidos e
+# $4 gravados
+confereJson() {
+    [ "$(head -c 1 "$1")" = "{" ] && [ "$(tail -c 2 "$1")" = "}" ] || falha "$1: não é só um objeto JSON"
+    [ "$(tr -cd '{' < "$1" | wc -c)" -eq "$(tr -cd '}' < "$1" | wc -c)" ] || falha "$1: chaves desbalanceadas"
+    grep -q "\"operacao\": \"$2\", \"bytes_lidos\": $3, \"bytes_gravados\": $4," "$1" ||
+        falha "$1: operação ou bytes diferentes de $2, $3 e $4"
+    for fase in leitura frequencias arvore dicionario codificacao decodificacao escrita; do
+        grep -q "\"$fase\": {\"segundos\": " "$1" || falha "$1: sem a fase $fase"
+    done
+}
+
+case $grupo in
+extracao)
+    geraTexto original
+    tamanho=$(wc -c < original)
+    for opcoes in "-b 1 -p 4" "-b 1 -p 0" "-b 1 -f 4" "-b 1 -c --crc"; do
+        rm -f original.comp
+        # shellcheck disable=SC2086
+        "$programas/compacta" $opcoes original > /dev/null || { falha "compacta $opcoes"; continue; }
+        for trecho in "0 1" "0 100" "12345 70000" "1048570 20" "1048576 1048576" "$((tamanho - 10)) 100" \
+                      "$tamanho 10" "0 $tamanho"; do
+            set -- $trecho
+            "$programas/descompacta" -x "$1" "$2" original.comp > extraido || { falha "-x $trecho ($opcoes)"; continue; }
+            tail -c +$(($1 + 1)) original | head -c "$2" > esperado
+            cmp -s extraido esperado || falha "-x $trecho ($opcoes): trecho diferente do original"
+        done
+    done
+    ;;
+crc)
+    geraTexto original
+    "$programas/compacta" -b 1 --crc original > /dev/null || falha "compacta --crc"
+    "$programas/descompacta" -t original.comp > /dev/null || falha "-t recusou um arquivo íntegro"
+    # Primeiro bloco: cabeçalho do arquivo (9 bytes), cabeçalho do bloco (15), descrição, dados e CRC32C
+    bitsArvore=$(leInteiro original.comp 14 2)
+    bitsDados=$(leInteiro original.comp 16 8)
+    posicaoCrc=$((9 + 15 + (bitsArvore + 7) / 8 + (bitsDados + 7) / 8))
+    for k in 0 3; do
+        cp original.comp alterado.comp
+        inverteByte alterado.comp $((posicaoCrc + k))
+        if "$programas/descompacta" -t alterado.comp > saida; then
+            falha "-t aceitou o byte $k do CRC32C alterado"
+        fi
+        grep -q CRC32C saida || falha "-t não informou o CRC32C que não confere"
+        rm -f alterado
+        "$programas/descompacta" alterado.comp > /dev/null && falha "descompacta aceitou o CRC32C alterado"
+    done
+    # Sem o índice (rodapé alterado), o tamanho original além do bloco e o corpo além do fim do arquivo
+    # são recusados antes de alocar
+    for k in 13 23; do
+        cp original.comp alterado.comp
+        inverteByte alterado.comp $(($(wc -c < original.comp) - 1))
+        inverteByte alterado.comp $k
+        "$programas/descompacta" alterado.comp > saida && falha "descompacta aceitou o byte $k do cabeçalho alterado"
+        grep -q corrompidos saida || falha "o byte $k do cabeçalho alterado não foi tratado como corrompido"
+    done
+    ;;
+fifo)
+    # O formato antigo lê a entrada duas vezes: um FIFO deve ser recusado, sem gerar um .comp truncado
+    geraTexto original
+    mkfifo entrada || { echo "mkfifo indisponível"; exit 1; }
+    cat original > entrada &
+    escritor=$!
+    "$programas/compacta" --legado entrada > saida && falha "--legado aceitou um FIFO"
+    grep -q Erro saida || falha "--legado não informou o erro do FIFO"
+    [ -e entrada.comp ] && falha "--legado deixou entrada.comp ao recusar o FIFO"
+    kill $escritor 2> /dev/null
+    wait $escritor 2> /dev/null
+    # O formato em blocos lê a entrada uma vez e aceita o FIFO
+    cat original > entrada &
+    escritor=$!
+    "$programas/compacta" -b 1 entrada > /dev/null || falha "compacta recusou um FIFO"
+    wait $escritor
+    mv entrada.comp copia.comp
+    "$programas/descompacta" copia.comp > /dev/null && cmp -s copia original || falha "ida e volta pelo FIFO diferente"
+    ;;
+legado)
+    # --legado grava os mesmos bytes que o compactador original; as somas vêm dele, para estas entradas
+    geraTexto original
+    awk 'BEGIN { for (i = 0; i < 64; i++) printf "aabbccddeeffgghhiijjkkllmmnnoopp" }' > empates
+    for caso in "original 1789880230 1304297" "empates 2675067297 1049"; do
+        set -- $caso
+        "$programas/compacta" --legado "$1" > /dev/null || { falha "compacta --legado $1"; continue; }
+        [ "$(cksum < "$1.comp")" = "$2 $3" ] || falha "--legado $1: saída diferente da do compactador original"
+    done
+    # Ida e volta no formato antigo, também com arquivo vazio e de um só byte
+    : > vazio
+    printf 'a' > um
+    "$programas/compacta" --legado vazio > /dev/null || falha "compacta --legado vazio"
+    "$programas/compacta" --legado um > /dev/null || falha "compacta --legado um"
+    for nome in original empates vazio um; do
+        mv "$nome" "$nome.antes"
+        "$programas/descompacta" "$nome.comp" > /dev/null || falha "descompacta recusou $nome.comp do formato antigo"
+        cmp -s "$nome" "$nome.antes" || falha "ida e volta de $nome no formato antigo diferente"
+        "$programas/descompacta" -t "$nome.comp" > /dev/null || falha "-t recusou $nome.comp do formato antigo"
+    done
+    # Um .comp gravado pelo compactador original é lido, e --legado o reproduz byte a byte
+    printf 'o rato roeu a roupa do rei de roma; a rainha, com raiva, resolveu remendar.\n' > esperado
+    printf '\321\000\000\000\002\044\001\012\272\135\213\145\241\163\270\133\313\225\204\133\155\044\271' > antigo.comp
+    printf '\143\235\335\113\042\335\054\262\200\144\250\262\077\331\110\366\275\070\311\371\071\344\170' >> antigo.comp
+    printf '\272\312\113\236\225\275\232\236\011\162\233\331\075\146\242\177\144\374\177\134\263\104\000' >> antigo.comp
+    "$programas/descompacta" antigo.comp > /dev/null || falha "descompacta recusou o .comp do compactador original"
+    cmp -s antigo esperado || falha "o .comp do compactador original não voltou ao texto"
+    mv antigo.comp original.comp.antigo
+    mv esperado antigo
+    "$programas/compacta" --legado antigo > /dev/null || falha "compacta --legado antigo"
+    cmp -s antigo.comp original.comp.antigo || falha "--legado não reproduziu o .comp do compactador original"
+    ;;
+lote)
+    # Diretórios percorridos recursivamente, cada arquivo com o seu .comp, numa única execução
+    mkdir -p arvore/sub
+    geraTexto arvore/a
+    head -c 100000 arvore/a > arvore/sub/b
+    printf 'x' > arvore/sub/c
+    : > arvore/vazio
+    "$programas/compacta" -b 1 -j 2 arvore > saida || falha "compacta recusou o diretório"
+    grep -q "Arquivos compactados: 4 (0 com erro)" saida || falha "compacta não informou os 4 arquivos do lote"
+    for nome in a sub/b sub/c vazio; do
+        [ -f "arvore/$nome.comp" ] || falha "lote sem arvore/$nome.comp"
+        cp "arvore/$nome" "arvore/$nome.original"
+        rm "arvore/$nome"
+    done
+    # Nos diretórios, a verificação e a descompactação consideram só os .comp
+    "$programas/descompacta" -t -j 2 arvore > saida || falha "-t recusou o lote"
+    grep -q "Arquivos verificados: 4 (0 com erro)" saida || falha "-t não informou os 4 arquivos do lote"
+    "$programas/descompacta" -j 2 arvore > /dev/null || falha "descompacta recusou o diretório"
+    for nome in a sub/b sub/c vazio; do
+        cmp -s "arvore/$nome" "arvore/$nome.original" || falha "lote: arvore/$nome diferente do original"
+    done
+    # Lista de -L pela entrada padrão, com linha vazia, somada aos caminhos da linha de comando
+    rm arvore/a arvore/sub/b
+    printf 'arvore/a.comp\n\n' | "$programas/descompacta" -L - arvore/sub/b.comp > /dev/null ||
+        falha "descompacta -L recusou a lista"
+    cmp -s arvore/a arvore/a.original && cmp -s arvore/sub/b arvore/sub/b.original || falha "-L: saída diferente"
+    # Um arquivo com falha não interrompe os demais, mas muda o código de saída
+    rm arvore/sub/c
+    if "$programas/descompacta" arvore/sub/c.comp arvore/a > saida; then
+        falha "descompacta aceitou um caminho sem .comp no lote"
+    fi
+    grep -q "arvore/a: O arquivo deve ter extensão .comp" saida || falha "o caminho sem .comp não foi informado"
+    cmp -s arvore/sub/c arvore/sub/c.original || falha "o erro de um arquivo interrompeu o lote"
+    if "$programas/compacta" arvore/a inexistente > saida; then
+        falha "compacta aceitou um arquivo inexistente no lote"
+    fi
+    grep -q "(1 com erro)" saida || falha "compacta não contou o arquivo inexistente"
+    ;;
+direto)
+    # Com --direto (O_DIRECT quando o sistema de arquivos aceita) e sem, com e sem threads, a saída é a mesma
+    geraTexto original
+    "$programas/compacta" -b 1 original > /dev/null || falha "compacta"
+    mv original.comp referencia.comp
+    # Opções de compacta, com a mesma saída da referência ou não, e de descompacta
+    for caso in "--direto:igual:--direto" "--direto -j 1:igual:--direto -j 1" "--direto -f 4 --crc:outra:--direto" \
+                "-j 1:igual:-j 1" "-b 1:igual:--direto"; do
+        opcoes=${caso%%:*}
+        resto=${caso#*:}
+        # shellcheck disable=SC2086
+        "$programas/compacta" -b 1 $opcoes original > /dev/null || { falha "compacta $opcoes"; continue; }
+        if [ "${resto%%:*}" = igual ]; then
+            cmp -s original.comp referencia.comp || falha "compacta $opcoes: saída diferente da sem --direto"
+        fi
+        mv original original.antes
+        # shellcheck disable=SC2086
+        "$programas/descompacta" ${resto#*:} original.comp > /dev/null || falha "descompacta ${resto#*:}"
+        cmp -s original original.antes || falha "ida e volta com $opcoes e ${resto#*:} diferente"
+        mv original.antes original
+    done
+    ;;
+estatisticas)
+    geraTexto original
+    tamanho=$(wc -c < original)
+    "$programas/compacta" --stats original > saida || falha "compacta --stats"
+    grep -q "Estatísticas da compactação" saida && grep -q "Bytes lidos: $tamanho" saida &&
+        grep -q "Entropia (ordem 0)" saida || falha "compacta --stats: relatório incompleto"
+    compactado=$(wc -c < original.comp)
+    "$programas/compacta" --stats=json original > compacta.json || falha "compacta --stats=json"
+    confereJson compacta.json compactacao "$tamanho" "$compactado"
+    grep -q '"bytes_por_comprimento": {' compacta.json || falha "compacta.json: sem os comprimentos"
+
+    "$programas/descompacta" --stats original.comp > saida || falha "descompacta --stats"
+    grep -q "Estatísticas da descompactação" saida && grep -q "Bytes gravados: $tamanho" saida ||
+        falha "descompacta --stats: relatório incompleto"
+    "$programas/descompacta" --stats=json original.comp > descompacta.json || falha "descompacta --stats=json"
+    confereJson descompacta.json descompactacao "$compactado" "$tamanho"
+    # Com -t, a saída padrão recebe só o JSON e as mensagens vão para a saída de erro
+    "$programas/descompacta" -t --stats=json original.comp > verifica.json 2> saida || falha "-t --stats=json"
+    confereJson verifica.json descompactacao "$compactado" "$tamanho"
+    grep -q "Arquivo íntegro" saida || falha "-t --stats=json: sem a mensagem de arquivo íntegro"
+
+    # Como filtro, os dados vão pela saída padrão e o relatório pela de erro
+    "$programas/compacta" --stats=json - < original > filtro.comp 2> filtro.json || falha "compacta - --stats=json"
+    confereJson filtro.json compactacao "$tamanho" "$(wc -c < filtro.comp)"
+    "$programas/descompacta" --stats=json - < filtro.comp > volta 2> filtro.json || falha "descompacta - --stats=json"
+    cmp -s volta original || falha "ida e volta pelo filtro com --stats=json diferente"
+    confereJson filtro.json descompactacao "$(wc -c < filtro.comp)" "$tamanho"
+
+    # Em lote, com a contagem de arquivos
+    mkdir lote
+    cp original lote/a
+    cp original lote/b
+    "$programas/compacta" --stats=json lote > lote.json || falha "compacta --stats=json em lote"
+    confereJson lote.json compactacao $((2 * tamanho)) $((2 * compactado))
+    grep -q '"arquivos": 2, "falhas": 0' lote.json || falha "lote.json: contagem de arquivos"
+    ;;
+*)
+    echo "Grupo desconhecido: $grupo"
+    exit 1
+    ;;
+esac
+
+if [ $falhas -gt 0 ]; then
+    echo "$falhas verificações falharam"
+    exit 1
+fi
+echo OK
@@ -0,0 +1,709 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "container.h"
+#include "dicionario.h"
+#include "huffman.h"
+#include "libhuffman.h"
+#include "transferencia.h"
+
+/**
+ * @brief Testes da biblioteca, um grupo por execução: ./teste_huffman <grupo>.
+ * @details Grupos: blocos (ida e volta de cada tipo de bloco), fluxo (API incremental igual à em
+ *          memória), truncados (cabeçalhos e blocos incompletos ou inválidos), mensagens (quadro único
+ *          de saídas de um bloco, com e sem dicionário), arvores (árvores e comprimentos serializados
+ *          inválidos) e transferencias (E/S assíncrona, com io_uring ou pread/pwrite, com e sem
+ *          O_DIRECT). Retorna 0 se todas as verificações passarem.
+ */
+
+#define TAMANHO_AMOSTRA (300u << 10)
+#define TAMANHO_BLOCO_TESTE (64u << 10)
+// Blocos pequenos, em que a descrição da árvore pesa e o dicionário compensa
+#define TAMANHO_BLOCO_DICIONARIO (8u << 10)
+#define TAMANHO_MENSAGEM 4096u
+
+static int falhas = 0;
+
+#define VERIFICA(condicao, ...)                                     \
+    do {                                                            \
+        if (!(condicao)) {                                          \
+            fprintf(stderr, "%s:%d: ", __FILE__, __LINE__);         \
+            fprintf(stderr, __VA_ARGS__);                           \
+            fprintf(stderr, "\n");                                  \
+            falhas++;                                               \
+        }                                                           \
+    } while (0)
+
+/**
+ * @brief Amostras sintéticas, sempre as mesmas para o mesmo tamanho.
+ */
+static void geraAmostra(const char* tipo, unsigned char* dados, size_t n) {
+    unsigned int estado = 12345;
+    const char* texto = "Lorem ipsum dolor sit amet, consectetur adipiscing elit. 2026-10-16 INFO ok\n";
+    size_t tamTexto = strlen(texto);
+    unsigned char anterior = 0;
+    for (size_t i = 0; i < n; i++) {
+        estado = estado * 1103515245u + 12345u;
+        if (strcmp(tipo, "texto") == 0) {
+            dados[i] = (unsigned char) texto[(i + (estado >> 28)) % tamTexto];
+        } else if (strcmp(tipo, "aleatorio") == 0) {
+            dados[i] = (unsigned char) (estado >> 16);
+        } else if (strcmp(tipo, "unico") == 0) {
+            dados[i] = 'a';
+        } else if (strcmp(tipo, "corridas") == 0) {
+            // Trechos de texto separados por corridas longas de zeros
+            dados[i] = i % 8192 < 1024 ? (unsigned char) texto[(i + (estado >> 28)) % tamTexto] : 0;
+        } else if (strcmp(tipo, "binario") == 0) {
+            // Poucos valores acima de 0x80, nenhum presente no texto
+            dados[i] = (unsigned char) (0x80 | ((estado >> 28) & (estado >> 24) & 15));
+        } else {
+            // "markov": cada byte quase determinado pelo anterior, com todos os 256 valores presentes
+            anterior = (unsigned char) (anterior * 7 + 1 + ((estado >> 24) & 1));
+            dados[i] = anterior;
+        }
+    }
+}
+
+/**
+ * @brief Tipo (sem os bits de fluxos e CRC) e byte de tipo completo do primeiro bloco de uma saída.
+ */
+static int tipoPrimeiroBloco(const unsigned char* saida, size_t tamanho, int* byteTipo) {
+    size_t posicao = ehQuadroUnico(saida, tamanho) ? TAMANHO_MAGICO_QUADRO : TAMANHO_CABECALHO_CONTAINER;
+    if (tamanho <= posicao) {
+        return -1;
+    }
+    *byteTipo = saida[posicao];
+    return *byteTipo & ~(BLOCO_QUATRO_FLUXOS | BLOCO_COM_CRC);
+}
+
+/**
+ * @brief Compacta em memória, confere o tipo do primeiro bloco e descompacta.
+ * @return Saída compactada (liberar com free) ou NULL em falha.
+ */
+static unsigned char* compactaConfere(ContextoCompactacao* cc, ContextoDescompactacao* cd,
+                                      const unsigned char* dados, size_t n, int tipoEsperado,
+                                      int bitsEsperados, size_t* tamanhoSaida, const char* nome) {
+    size_t capacidade = limiteCompactacao(cc, n);
+    unsigned char* saida = (unsigned char*) malloc(capacidade);
+    unsigned char* volta = (unsigned char*) malloc(n ? n : 1);
+    if (saida == NULL || volta == NULL) {
+        free(saida);
+        free(volta);
+        VERIFICA(0, "%s: falta de memória", nome);
+        return NULL;
+    }
+    int codigo = compactaMemoria(cc, dados, n, saida, capacidade, tamanhoSaida);
+    VERIFICA(codigo == HUFFMAN_OK, "%s: compactaMemoria retornou %d", nome, codigo);
+    if (codigo == HUFFMAN_OK && tipoEsperado >= 0) {
+        int byteTipo = 0;
+        int tipo = tipoPrimeiroBloco(saida, *tamanhoSaida, &byteTipo);
+        VERIFICA(tipo == tipoEsperado, "%s: primeiro bloco do tipo %d, esperado %d", nome, tipo, tipoEsperado);
+        VERIFICA((byteTipo & (BLOCO_QUATRO_FLUXOS | BLOCO_COM_CRC)) == bitsEsperados,
+                 "%s: bits do tipo 0x%02x, esperados 0x%02x", nome, byteTipo & 0xC0, bitsEsperados);
+    }
+    size_t produzidos = 0;
+    unsigned long long int tamanhoOriginal = 0;
+    if (codigo == HUFFMAN_OK) {
+        codigo = tamanhoDescompactado(saida, *tamanhoSaida, &tamanhoOriginal);
+        VERIFICA(codigo == HUFFMAN_OK && tamanhoOriginal == n, "%s: tamanhoDescompactado %d (%llu)", nome,
+                 codigo, tamanhoOriginal);
+        codigo = descompactaMemoria(cd, saida, *tamanhoSaida, volta, n, &produzidos);
+        VERIFICA(codigo == HUFFMAN_OK, "%s: descompactaMemoria retornou %d", nome, codigo);
+        VERIFICA(produzidos == n && memcmp(volta, dados, n) == 0, "%s: ida e volta diferente", nome);
+    }
+    free(volta);
+    if (codigo != HUFFMAN_OK) {
+        free(saida);
+        return NULL;
+    }
+    return saida;
+}
+
+/**
+ * @brief Ida e volta em memória de cada tipo de bloco, em vários blocos por entrada.
+ */
+static void testaBlocos(void) {
+    ContextoCompactacao* cc = criaContextoCompactacao(2);
+    ContextoDescompactacao* cd = criaContextoDescompactacao(2);
+    unsigned char* dados = (unsigned char*) malloc(TAMANHO_AMOSTRA);
+    if (cc == NULL || cd == NULL || dados == NULL) {
+        VERIFICA(0, "falta de memória");
+        return;
+    }
+
+    struct {
+        const char* nome;
+        const char* amostra;
+        unsigned int tamanhoBloco;
+        int comprimentoMax;
+        int fluxos;
+        int contexto;
+        int crc;
+        int dicionario;
+        int tipo;
+        int bits;
+    } casos[] = {
+        {"huffman", "texto", TAMANHO_BLOCO_TESTE, 0, 1, 0, 0, 0, BLOCO_HUFFMAN, 0},
+        {"canonico", "texto", TAMANHO_BLOCO_TESTE, 12, 1, 0, 0, 0, BLOCO_CANONICO, 0},
+        {"dicionario", "texto", TAMANHO_BLOCO_DICIONARIO, 0, 1, 0, 0, 1, BLOCO_DICIONARIO, 0},
+        {"dicionario pior que a arvore", "binario", TAMANHO_BLOCO_DICIONARIO, 0, 1, 0, 0, 1, BLOCO_HUFFMAN, 0},
+        {"armazenado", "aleatorio", TAMANHO_BLOCO_TESTE, 0, 1, 0, 0, 0, BLOCO_ARMAZENADO, 0},
+        {"repetido", "unico", TAMANHO_BLOCO_TESTE, 0, 1, 0, 0, 0, BLOCO_REPETIDO, 0},
+        {"corridas", "corridas", TAMANHO_BLOCO_TESTE, 0, 1, 0, 0, 0, BLOCO_CORRIDAS, 0},
+        {"contexto", "markov", TAMANHO_BLOCO_TESTE, 0, 1, 1, 0, 0, BLOCO_CONTEXTO, 0},
+        {"quatro fluxos", "texto", TAMANHO_BLOCO_TESTE, 0, HUFFMAN_FLUXOS_INTERCALADOS, 0, 0, 0, BLOCO_HUFFMAN,
+         BLOCO_QUATRO_FLUXOS},
+        {"quatro fluxos canonico", "texto", TAMANHO_BLOCO_TESTE, 12, HUFFMAN_FLUXOS_INTERCALADOS, 0, 0, 0,
+         BLOCO_CANONICO, BLOCO_QUATRO_FLUXOS},
+        {"quatro fluxos dicionario", "texto", TAMANHO_BLOCO_DICIONARIO, 0, HUFFMAN_FLUXOS_INTERCALADOS, 0, 0, 1,
+         BLOCO_DICIONARIO, BLOCO_QUATRO_FLUXOS},
+        {"crc", "texto", TAMANHO_BLOCO_TESTE, 0, 1, 0, 1, 0, BLOCO_HUFFMAN, BLOCO_COM_CRC},
+        {"crc corridas", "corridas", TAMANHO_BLOCO_TESTE, 0, 1, 0, 1, 0, BLOCO_CORRIDAS, BLOCO_COM_CRC},
+    };
+
+    // Dicionário treinado sobre o próprio texto
+    unsigned long long int frequencias[256] = {0};
+    geraAmostra("texto", dados, TAMANHO_AMOSTRA);
+    for (size_t i = 0; i < TAMANHO_AMOSTRA; i++) {
+        frequencias[dados[i]]++;
+    }
+    Dicionario* dicionario = criaDicionario(frequencias, 7, HUFFMAN_COMPRIMENTO_MAX);
+    VERIFICA(dicionario != NULL, "criaDicionario falhou");
+    defineDicionarioDescompactacao(cd, dicionario);
+
+    for (size_t k = 0; k < sizeof(casos) / sizeof(casos[0]); k++) {
+        OpcoesHuffman opcoes;
+        opcoesPadraoHuffman(&opcoes);
+        opcoes.tamanhoBloco = casos[k].tamanhoBloco;
+        opcoes.intervaloPontos = 4096;
+        opcoes.comprimentoMax = casos[k].comprimentoMax;
+        opcoes.fluxos = casos[k].fluxos;
+        opcoes.contexto = casos[k].contexto;
+        opcoes.crc = casos[k].crc;
+        VERIFICA(defineOpcoesCompactacao(cc, &opcoes) == HUFFMAN_OK, "%s: opções recusadas", casos[k].nome);
+        defineDicionarioCompactacao(cc, casos[k].dicionario ? dicionario : NULL);
+        geraAmostra(casos[k].amostra, dados, TAMANHO_AMOSTRA);
+        size_t tamanhoSaida, semPontos;
+        free(compactaConfere(cc, cd, dados, TAMANHO_AMOSTRA, casos[k].tipo, casos[k].bits, &tamanhoSaida,
+                             casos[k].nome));
+
+        // Só os blocos de um único fluxo de código guardam pontos de acesso no índice
+        opcoes.intervaloPontos = 0;
+        defineOpcoesCompactacao(cc, &opcoes);
+        free(compactaConfere(cc, cd, dados, TAMANHO_AMOSTRA, casos[k].tipo, casos[k].bits, &semPontos,
+                             casos[k].nome));
+        int usaPontos = casos[k].tipo <= BLOCO_DICIONARIO && casos[k].fluxos == 1;
+        VERIFICA((tamanhoSaida > semPontos) == usaPontos && (tamanhoSaida == semPontos) == !usaPontos,
+                 "%s: %zu bytes com pontos de acesso, %zu sem", casos[k].nome, tamanhoSaida, semPontos);
+    }
+
+    // Entradas vazias e de um byte
+    OpcoesHuffman opcoes;
+    opcoesPadraoHuffman(&opcoes);
+    defineOpcoesCompactacao(cc, &opcoes);
+    defineDicionarioCompactacao(cc, NULL);
+    size_t tamanhoSaida;
+    free(compactaConfere(cc, cd, dados, 0, -1, 0, &tamanhoSaida, "vazio"));
+    free(compactaConfere(cc, cd, dados, 1, -1, 0, &tamanhoSaida, "um byte"));
+
+    liberaDicionario(dicionario);
+    liberaContextoCompactacao(cc);
+    liberaContextoDescompactacao(cd);
+    free(dados);
+}
+
+/**
+ * @brief Compacta pela API incremental, em pedaços pequenos de entrada e de saída.
+ * @return Bytes produzidos ou 0 em erro.
+ */
+static size_t compactaEmPedacos(ContextoCompactacao* cc, const unsigned char* dados, size_t n,
+                                unsigned char* saida, size_t capacidade, size_t pedaco) {
+    if (iniciaCompactacaoFluxo(cc) != HUFFMAN_OK) {
+        return 0;
+    }
+    FluxoHuffman f;
+    memset(&f, 0, sizeof(f));
+    size_t consumidos = 0;
+    for (;;) {
+        size_t parte = n - consumidos < pedaco ? n - consumidos : pedaco;
+        f.entrada = dados + consumidos;
+        f.disponivelEntrada = parte;
+        f.saida = saida + f.totalSaida;
+        f.disponivelSaida = capacidade - f.totalSaida < pedaco ? capacidade - f.totalSaida : pedaco;
+        int codigo = compactaFluxo(cc, &f, consumidos + parte == n);
+        consumidos += parte - f.disponivelEntrada;
+        if (codigo == HUFFMAN_FIM_FLUXO) {
+            return (size_t) f.totalSaida;
+        }
+        if (codigo != HUFFMAN_OK || (f.totalSaida == capacidade && f.disponivelEntrada == parte)) {
+            return 0;
+        }
+    }
+}
+
+/**
+ * @brief Descompacta pela API incremental, em pedaços pequenos de entrada e de saída.
+ * @return Bytes produzidos ou (size_t) -1 em erro.
+ */
+static size_t descompactaEmPedacos(ContextoDescompactacao* cd, const unsigned char* origem, size_t tamanho,
+                                   unsigned char* destino, size_t capacidade, size_t pedaco) {
+    if (iniciaDescompactacaoFluxo(cd) != HUFFMAN_OK) {
+        return (size_t) -1;
+    }
+    FluxoHuffman f;
+    memset(&f, 0, sizeof(f));
+    for (;;) {
+        size_t restante = tamanho - f.totalEntrada;
+        f.entrada = origem + f.totalEntrada;
+        f.disponivelEntrada = restante < pedaco ? restante : pedaco;
+        f.saida = destino + f.totalSaida;
+        f.disponivelSaida = capacidade - f.totalSaida < pedaco ? capacidade - f.totalSaida : pedaco;
+        unsigned long long int antes = f.totalEntrada + f.totalSaida;
+        int codigo = descompactaFluxo(cd, &f);
+        if (codigo == HUFFMAN_FIM_FLUXO) {
+            return (size_t) f.totalSaida;
+        }
+        if (codigo != HUFFMAN_OK || f.totalEntrada + f.totalSaida == antes) {
+            return (size_t) -1;
+        }
+    }
+}
+
+/**
+ * @brief A saída da API incremental é idêntica à de compactaMemoria, com os mesmos dados e opções.
+ */
+static void testaFluxo(void) {
+    ContextoCompactacao* cc = criaContextoCompactacao(2);
+    ContextoDescompactacao* cd = criaContextoDescompactacao(1);
+    unsigned char* dados = (unsigned char*) malloc(TAMANHO_AMOSTRA);
+    if (cc == NULL || cd == NULL || dados == NULL) {
+        VERIFICA(0, "falta de memória");
+        return;
+    }
+    const char* amostras[] = {"texto", "aleatorio", "corridas", "markov"};
+    size_t pedacos[] = {1, 777, 65536};
+    for (size_t a = 0; a < sizeof(amostras) / sizeof(amostras[0]); a++) {
+        for (int fluxos = 1; fluxos <= HUFFMAN_FLUXOS_INTERCALADOS; fluxos += HUFFMAN_FLUXOS_INTERCALADOS - 1) {
+            OpcoesHuffman opcoes;
+            opcoesPadraoHuffman(&opcoes);
+            opcoes.tamanhoBloco = TAMANHO_BLOCO_TESTE;
+            opcoes.fluxos = fluxos;
+            opcoes.contexto = 1;
+            opcoes.crc = 1;
+            defineOpcoesCompactacao(cc, &opcoes);
+            geraAmostra(amostras[a], dados, TAMANHO_AMOSTRA);
+            size_t n = TAMANHO_AMOSTRA;
+
+            size_t capacidade = limiteCompactacao(cc, n);
+            unsigned char* memoria = (unsigned char*) malloc(capacidade);
+            unsigned char* fluxo = (unsigned char*) malloc(capacidade);
+            unsigned char* volta = (unsigned char*) malloc(n);
+            size_t tamanhoMemoria = 0;
+            VERIFICA(memoria && fluxo && volta &&
+                     compactaMemoria(cc, dados, n, memoria, capacidade, &tamanhoMemoria) == HUFFMAN_OK,
+                     "%s: compactaMemoria falhou", amostras[a]);
+            for (size_t p = 0; p < sizeof(pedacos) / sizeof(pedacos[0]) && memoria && fluxo && volta; p++) {
+                // Com um byte por chamada, só um trecho da amostra, para não demorar
+                size_t m = pedacos[p] == 1 ? 20000 : n;
+                size_t esperado = tamanhoMemoria;
+                const unsigned char* referencia = memoria;
+                unsigned char* menor = NULL;
+                if (m != n) {
+                    menor = (unsigned char*) malloc(capacidade);
+                    esperado = 0;
+                    VERIFICA(menor && compactaMemoria(cc, dados, m, menor, capacidade, &esperado) == HUFFMAN_OK,
+                             "%s: compactaMemoria falhou", amostras[a]);
+                    referencia = menor;
+                }
+                size_t tamanhoFluxo = compactaEmPedacos(cc, dados, m, fluxo, capacidade, pedacos[p]);
+                VERIFICA(tamanhoFluxo == esperado && memcmp(fluxo, referencia, esperado) == 0,
+                         "%s, %d fluxo(s), pedaços de %zu: saída incremental diferente da em memória",
+                         amostras[a], fluxos, pedacos[p]);
+                size_t produzidos = descompactaEmPedacos(cd, fluxo, tamanhoFluxo, volta, n, pedacos[p]);
+                VERIFICA(produzidos == m && memcmp(volta, dados, m) == 0,
+                         "%s, %d fluxo(s), pedaços de %zu: descompactação incremental diferente", amostras[a],
+                         fluxos, pedacos[p]);
+                free(menor);
+            }
+            free(memoria);
+            free(fluxo);
+            free(volta);
+        }
+    }
+    liberaContextoCompactacao(cc);
+    liberaContextoDescompactacao(cd);
+    free(dados);
+}
+
+/**
+ * @brief Saídas truncadas em qualquer ponto e cabeçalhos inválidos são recusados, sem ler fora do buffer.
+ */
+static void testaTruncados(void) {
+    ContextoCompactacao* cc = criaContextoCompactacao(1);
+    ContextoDescompactacao* cd = criaContextoDescompactacao(1);
+    size_t n = 20000;
+    unsigned char* dados = (unsigned char*) malloc(n);
+    if (cc == NULL || cd == NULL || dados == NULL) {
+        VERIFICA(0, "falta de memória");
+        return;
+    }
+    OpcoesHuffman opcoes;
+    opcoesPadraoHuffman(&opcoes);
+    opcoes.tamanhoBloco = 8192;
+    opcoes.intervaloPontos = 1024;
+    const char* amostras[] = {"texto", "corridas", "markov"};
+    for (size_t a = 0; a < sizeof(amostras) / sizeof(amostras[0]); a++) {
+        opcoes.contexto = a == 2;
+        opcoes.fluxos = a == 0 ? HUFFMAN_FLUXOS_INTERCALADOS : 1;
+        defineOpcoesCompactacao(cc, &opcoes);
+        geraAmostra(amostras[a], dados, n);
+        size_t capacidade = limiteCompactacao(cc, n);
+        unsigned char* saida = (unsigned char*) malloc(capacidade);
+        unsigned char* volta = (unsigned char*) malloc(n);
+        size_t tamanho = 0;
+        if (saida == NULL || volta == NULL || compactaMemoria(cc, dados, n, saida, capacidade, &tamanho) != HUFFMAN_OK) {
+            VERIFICA(0, "%s: compactaMemoria falhou", amostras[a]);
+            free(saida);
+            free(volta);
+            continue;
+        }
+        // Cada prefixo vai para um buffer do seu tamanho exato (o ASan acusa qualquer leitura além)
+        for (size_t k = 0; k < tamanho; k++) {
+            unsigned char* prefixo = (unsigned char*) malloc(k ? k : 1);
+            memcpy(prefixo, saida, k);
+            size_t produzidos = 0;
+            int codigo = descompactaMemoria(cd, prefixo, k, volta, n, &produzidos);
+            // O índice não é necessário: o prefixo que vai até o terminador é válido
+            VERIFICA(codigo < 0 || (codigo == HUFFMAN_OK && produzidos == n && memcmp(volta, dados, n) == 0),
+                     "%s: prefixo de %zu bytes aceito com %d", amostras[a], k, codigo);
+            free(prefixo);
+        }
+        // Número mágico, versão, tipo de bloco e tamanho original inválidos
+        size_t posicoes[] = {0, 4, TAMANHO_CABECALHO_CONTAINER, TAMANHO_CABECALHO_CONTAINER + 1,
+                             TAMANHO_CABECALHO_CONTAINER + 4};
+        unsigned char valores[] = {'X', VERSAO_CONTAINER + 1, 0x3F, 0xFF, 0xFF};
+        for (size_t p = 0; p < sizeof(posicoes) / sizeof(posicoes[0]); p++) {
+            unsigned char original = saida[posicoes[p]];
+            saida[posicoes[p]] = valores[p];
+            size_t produzidos = 0;
+            int codigo = descompactaMemoria(cd, saida, tamanho, volta, n, &produzidos);
+            VERIFICA(codigo < 0, "%s: cabeçalho alterado no byte %zu aceito", amostras[a], posicoes[p]);
+            VERIFICA(descompactaEmPedacos(cd, saida, tamanho, volta, n, 4096) == (size_t) -1,
+                     "%s: cabeçalho alterado no byte %zu aceito pelo fluxo", amostras[a], posicoes[p]);
+            saida[posicoes[p]] = original;
+        }
+        free(saida);
+        free(volta);
+    }
+    // Um destino pequeno demais é recusado
+    defineOpcoesCompactacao(cc, &opcoes);
+    unsigned char pequeno[16];
+    size_t tamanho = 0;
+    VERIFICA(compactaMemoria(cc, dados, n, pequeno, sizeof(pequeno), &tamanho) == HUFFMAN_ERRO_DESTINO_PEQUENO,
+             "destino pequeno aceito");
+    liberaContextoCompactacao(cc);
+    liberaContextoDescompactacao(cd);
+    free(dados);
+}
+
+/**
+ * @brief Saídas de um único bloco vão num quadro único, sem o cabeçalho do container nem o índice,
+ *        iguais pela API incremental; o dicionário só entra quando deixa a mensagem menor.
+ */
+static void testaMensagens(void) {
+    ContextoCompactacao* cc = criaContextoCompactacao(2);
+    ContextoDescompactacao* cd = criaContextoDescompactacao(1);
+    unsigned char* dados = (unsigned char*) malloc(TAMANHO_AMOSTRA);
+    unsigned char* volta = (unsigned char*) malloc(TAMANHO_MENSAGEM + 1);
+    if (cc == NULL || cd == NULL || dados == NULL || volta == NULL) {
+        VERIFICA(0, "falta de memória");
+        return;
+    }
+    unsigned long long int frequencias[256] = {0};
+    geraAmostra("texto", dados, TAMANHO_AMOSTRA);
+    for (size_t i = 0; i < TAMANHO_AMOSTRA; i++) {
+        frequencias[dados[i]]++;
+    }
+    Dicionario* dicionario = criaDicionario(frequencias, 7, HUFFMAN_COMPRIMENTO_MAX);
+    VERIFICA(dicionario != NULL, "criaDicionario falhou");
+    defineDicionarioDescompactacao(cd, dicionario);
+
+    OpcoesHuffman opcoes;
+    opcoesPadraoHuffman(&opcoes);
+    opcoes.tamanhoBloco = TAMANHO_MENSAGEM;
+    defineOpcoesCompactacao(cc, &opcoes);
+    size_t capacidade = limiteCompactacao(cc, TAMANHO_MENSAGEM + 1);
+    unsigned char* saida = (unsigned char*) malloc(capacidade);
+    unsigned char* fluxo = (unsigned char*) malloc(capacidade);
+    if (saida == NULL || fluxo == NULL) {
+        VERIFICA(0, "falta de memória");
+        capacidade = 0;
+    }
+
+    // Uma mensagem de texto fica menor com o dicionário do que com a própria árvore
+    size_t semDicionario = 0, comDicionario = 0;
+    for (int usaDicionario = 0; usaDicionario <= 1 && capacidade; usaDicionario++) {
+        defineDicionarioCompactacao(cc, usaDicionario ? dicionario : NULL);
+        size_t tamanho = 0;
+        free(compactaConfere(cc, cd, dados, TAMANHO_MENSAGEM, usaDicionario ? BLOCO_DICIONARIO : BLOCO_HUFFMAN, 0,
+                             &tamanho, usaDicionario ? "mensagem com dicionário" : "mensagem sem dicionário"));
+        *(usaDicionario ? &comDicionario : &semDicionario) = tamanho;
+    }
+    VERIFICA(comDicionario > 0 && comDicionario < semDicionario && comDicionario < TAMANHO_MENSAGEM,
+             "mensagem: %zu bytes com dicionário, %zu sem", comDicionario, semDicionario);
+
+    // Quadro único até o tamanho do bloco, container a partir de dois blocos
+    size_t tamanhos[] = {0, 1, 100, TAMANHO_MENSAGEM, TAMANHO_MENSAGEM + 1};
+    size_t pedacos[] = {1, 777, TAMANHO_MENSAGEM};
+    for (size_t t = 0; t < sizeof(tamanhos) / sizeof(tamanhos[0]) && capacidade; t++) {
+        size_t n = tamanhos[t];
+        size_t tamanho = 0;
+        if (compactaMemoria(cc, dados, n, saida, capacidade, &tamanho) != HUFFMAN_OK) {
+            VERIFICA(0, "%zu bytes: compactaMemoria falhou", n);
+            continue;
+        }
+        int quadro = ehQuadroUnico(saida, tamanho);
+        VERIFICA(quadro == (n <= TAMANHO_MENSAGEM), "%zu bytes: quadro único %d", n, quadro);
+        VERIFICA(n > 0 || tamanho == TAMANHO_MAGICO_QUADRO + 1, "entrada vazia em %zu bytes", tamanho);
+        for (size_t p = 0; p < sizeof(pedacos) / sizeof(pedacos[0]); p++) {
+            size_t tamanhoFluxo = compactaEmPedacos(cc, dados, n, fluxo, capacidade, pedacos[p]);
+            VERIFICA(tamanhoFluxo == tamanho && memcmp(fluxo, saida, tamanho) == 0,
+                     "%zu bytes, pedaços de %zu: saída incremental diferente da em memória", n, pedacos[p]);
+            size_t produzidos = descompactaEmPedacos(cd, saida, tamanho, volta, n, pedacos[p]);
+            VERIFICA(produzidos == n && memcmp(volta, dados, n) == 0,
+                     "%zu bytes, pedaços de %zu: descompactação incremental diferente", n, pedacos[p]);
+        }
+        if (!quadro) {
+            continue;
+        }
+        // Um quadro termina no último byte do bloco: prefixos e, em memória, bytes a mais são recusados
+        for (size_t k = 0; k <= tamanho; k++) {
+            unsigned char* prefixo = (unsigned char*) malloc(k + 1);
+            memcpy(prefixo, saida, k < tamanho ? k : tamanho);
+            prefixo[k] = 0;
+            size_t lidos = k < tamanho ? k : tamanho + 1;
+            size_t produzidos = 0;
+            unsigned long long int tamanhoOriginal = 0;
+            VERIFICA(descompactaMemoria(cd, prefixo, lidos, volta, n, &produzidos) < 0 &&
+                         tamanhoDescompactado(prefixo, lidos, &tamanhoOriginal) < 0,
+                     "%zu bytes: quadro de %zu bytes aceito com %zu", n, tamanho, lidos);
+            // A API incremental para no fim do quadro, sem consumir o que vem depois
+            VERIFICA(k == tamanho || descompactaEmPedacos(cd, prefixo, lidos, volta, n, 1) == (size_t) -1,
+                     "%zu bytes: quadro de %zu bytes aceito pela API incremental com %zu", n, tamanho, lidos);
+            free(prefixo);
+        }
+    }
+    free(saida);
+    free(fluxo);
+    liberaDicionario(dicionario);
+    liberaContextoCompactacao(cc);
+    liberaContextoDescompactacao(cd);
+    free(dados);
+    free(volta);
+}
+
+/**
+ * @brief Árvores e comprimentos serializados inválidos são recusados; bits alterados em blocos com
+ *        CRC32C nunca produzem dados diferentes dos originais.
+ */
+static void testaArvores(void) {
+    ArvoreHuffman arvore;
+    unsigned char comprimentos[256];
+
+    // Folha única ('a'), nó interno com uma só folha, byte repetido e bits que sobram
+    unsigned char folha[] = {0xB0, 0x80};                   // 1 01100001
+    VERIFICA(leArvoreHuffman(folha, 9, &arvore) == 0, "folha única recusada");
+    VERIFICA(leArvoreHuffman(folha, 10, &arvore) < 0, "bits sobrando aceitos");
+    VERIFICA(leArvoreHuffman(folha, 8, &arvore) < 0, "folha truncada aceita");
+    unsigned char incompleta[] = {0x58, 0x40};              // 0 1 01100001 (falta o filho direito)
+    VERIFICA(leArvoreHuffman(incompleta, 10, &arvore) < 0, "nó interno incompleto aceito");
+    unsigned char repetida[] = {0x58, 0x6C, 0x20};          // 0 1 01100001 1 01100001
+    VERIFICA(leArvoreHuffman(repetida, 19, &arvore) < 0, "byte em duas folhas aceito");
+    unsigned char profunda[64];
+    memset(profunda, 0, sizeof(profunda));                  // só nós internos
+    VERIFICA(leArvoreHuffman(profunda, 8 * sizeof(profunda), &arvore) < 0, "árvore sem folhas aceita");
+
+    // Comprimentos: 256 códigos de 1 bit não formam um código de prefixo
+    unsigned char uns[128];
+    memset(uns, 0x11, sizeof(uns));
+    VERIFICA(leComprimentos(uns, 8 * sizeof(uns), comprimentos) < 0, "comprimentos inválidos aceitos");
+    VERIFICA(leComprimentos(uns, 12, comprimentos) < 0, "comprimentos truncados aceitos");
+
+    // Bits aleatórios nunca derrubam a leitura
+    unsigned int estado = 99;
+    unsigned char lixo[400];
+    for (int k = 0; k < 2000; k++) {
+        for (size_t i = 0; i < sizeof(lixo); i++) {
+            estado = estado * 1103515245u + 12345u;
+            lixo[i] = (unsigned char) (estado >> 16);
+        }
+        leArvoreHuffman(lixo, 8 * sizeof(lixo) - (k % 64), &arvore);
+        leComprimentos(lixo, 4 * (k % 800), comprimentos);
+    }
+
+    // Bits alterados na descrição do código e nos dados de blocos com CRC32C
+    ContextoCompactacao* cc = criaContextoCompactacao(1);
+    ContextoDescompactacao* cd = criaContextoDescompactacao(1);
+    size_t n = 30000;
+    unsigned char* dados = (unsigned char*) malloc(n);
+    unsigned char* volta = (unsigned char*) malloc(n);
+    if (cc == NULL || cd == NULL || dados == NULL || volta == NULL) {
+        VERIFICA(0, "falta de memória");
+        return;
+    }
+    OpcoesHuffman opcoes;
+    opcoesPadraoHuffman(&opcoes);
+    opcoes.crc = 1;
+    const char* amostras[] = {"texto", "texto", "markov"};
+    int limites[] = {0, 12, 0};
+    for (size_t a = 0; a < sizeof(amostras) / sizeof(amostras[0]); a++) {
+        opcoes.comprimentoMax = limites[a];
+        opcoes.contexto = a == 2;
+        defineOpcoesCompactacao(cc, &opcoes);
+        geraAmostra(amostras[a], dados, n);
+        size_t capacidade = limiteCompactacao(cc, n);
+        unsigned char* saida = (unsigned char*) malloc(capacidade);
+        size_t tamanho = 0;
+        if (saida == NULL || compactaMemoria(cc, dados, n, saida, capacidade, &tamanho) != HUFFMAN_OK) {
+            VERIFICA(0, "%s: compactaMemoria falhou", amostras[a]);
+            free(saida);
+            continue;
+        }
+        size_t inicioCorpo = TAMANHO_CABECALHO_CONTAINER + TAMANHO_CABECALHO_BLOCO;
+        for (size_t pos = inicioCorpo; pos < tamanho && pos < inicioCorpo + 600; pos++) {
+            for (int bit = 0; bit < 8; bit += 3) {
+                saida[pos] ^= (unsigned char) (1u << bit);
+                size_t produzidos = 0;
+                int codigo = descompactaMemoria(cd, saida, tamanho, volta, n, &produzidos);
+                VERIFICA(codigo < 0 || (produzidos == n && memcmp(volta, dados, n) == 0),
+                         "%s: bit %d do byte %zu alterado e aceito com dados diferentes", amostras[a], bit, pos);
+                saida[pos] ^= (unsigned char) (1u << bit);
+            }
+        }
+        free(saida);
+    }
+    liberaContextoCompactacao(cc);
+    liberaContextoDescompactacao(cd);
+    free(dados);
+    free(volta);
+}
+
+/**
+ * @brief Gravação adiada e leitura antecipada de um arquivo, na fila síncrona (pread/pwrite na própria
+ *        chamada) e na assíncrona (io_uring se o kernel aceitar, threads caso contrário), com e sem
+ *        O_DIRECT; leituras além do fim e em descritor inválido.
+ */
+static void testaTransferencias(void) {
+    const char* nome = "teste_transferencias.tmp";
+    size_t n = 300000 + 123;    // o último trecho não é múltiplo do alinhamento
+    size_t tamanhoTrecho = 64u << 10;
+    unsigned char* dados = (unsigned char*) malloc(n);
+    unsigned char* alinhado = NULL;
+    size_t capacidadeAlinhado = 0;
+    if (dados == NULL || garanteBufferAlinhado(&alinhado, &capacidadeAlinhado, 2 * ALINHAMENTO_TRANSFERENCIA) < 0) {
+        VERIFICA(0, "falta de memória");
+        free(dados);
+        return;
+    }
+    geraAmostra("aleatorio", dados, n);
+
+    for (int profundidade = 0; profundidade <= 4; profundidade += 4) {
+        for (int direto = 0; direto <= 1; direto++) {
+            FilaTransferencias* fila = criaFilaTransferencias(profundidade);
+            VERIFICA(fila != NULL, "criaFilaTransferencias(%d) falhou", profundidade);
+            if (fila == NULL) {
+                continue;
+            }
+            const char* modo = profundidade == 0 ? "síncrona" : filaUsaIoUring(fila) ? "io_uring" : "threads";
+            int comDireto = 0;
+            int fd = abreArquivoTransferencia(nome, O_WRONLY | O_CREAT | O_TRUNC, direto, &comDireto);
+            GravadorAdiado* g = fd >= 0 ? criaGravadorAdiado(fila, fd, tamanhoTrecho, 3, comDireto) : NULL;
+            VERIFICA(g != NULL, "%s: gravador não criado", modo);
+            int erro = g == NULL;
+            for (size_t i = 0; g != NULL && i < n && !erro; i += 1000) {
+                erro = gravaAdiado(g, dados + i, n - i < 1000 ? n - i : 1000) < 0;
+            }
+            erro = erro || concluiGravadorAdiado(g) < 0;
+            VERIFICA(!erro, "%s (O_DIRECT %d): gravação falhou", modo, comDireto);
+            liberaGravadorAdiado(g);
+            if (fd >= 0) {
+                close(fd);
+            }
+
+            fd = abreArquivoTransferencia(nome, O_RDONLY, direto, &comDireto);
+            LeitorAntecipado* l = fd >= 0 ? criaLeitorAntecipado(fila, fd, n, tamanhoTrecho, 3) : NULL;
+            VERIFICA(l != NULL, "%s: leitor não criado", modo);
+            size_t lidos = 0, k;
+            const unsigned char* trecho;
+            while (l != NULL && (k = proximoTrecho(l, &trecho)) > 0) {
+                VERIFICA(lidos + k <= n && memcmp(trecho, dados + lidos, k) == 0,
+                         "%s (O_DIRECT %d): trecho em %zu diferente", modo, comDireto, lidos);
+                lidos += k;
+                devolveTrecho(l);
+            }
+            VERIFICA(l != NULL && lidos == n && !erroLeitorAntecipado(l), "%s (O_DIRECT %d): %zu de %zu bytes lidos",
+                     modo, comDireto, lidos, n);
+            liberaLeitorAntecipado(l);
+
+            // Uma leitura que passa do fim termina nele
+            Transferencia t;
+            memset(&t, 0, sizeof(t));
+            t.fd = fd;
+            t.buffer = alinhado;
+            t.tamanho = 2 * ALINHAMENTO_TRANSFERENCIA;
+            t.offset = n / ALINHAMENTO_TRANSFERENCIA * ALINHAMENTO_TRANSFERENCIA;
+            submeteTransferencia(fila, &t);
+            VERIFICA(aguardaTransferencia(fila, &t) == 0 && t.transferidos == n - t.offset &&
+                     memcmp(alinhado, dados + t.offset, t.transferidos) == 0,
+                     "%s (O_DIRECT %d): leitura até o fim com %zu bytes", modo, comDireto, t.transferidos);
+            if (fd >= 0) {
+                close(fd);
+            }
+
+            // O erro de E/S chega a quem aguarda
+            t.fd = -1;
+            submeteTransferencia(fila, &t);
+            VERIFICA(aguardaTransferencia(fila, &t) < 0 && t.erro == EBADF, "%s: descritor inválido aceito (%d)",
+                     modo, t.erro);
+            liberaFilaTransferencias(fila);
+        }
+    }
+    unlink(nome);
+    free(alinhado);
+    free(dados);
+}
+
+int main(int argc, char* argv[]) {
+    struct {
+        const char* nome;
+        void (*testa)(void);
+    } grupos[] = {
+        {"blocos", testaBlocos},
+        {"fluxo", testaFluxo},
+        {"truncados", testaTruncados},
+        {"mensagens", testaMensagens},
+        {"arvores", testaArvores},
+        {"transferencias", testaTransferencias},
+    };
+    int numGrupos = (int) (sizeof(grupos) / sizeof(grupos[0]));
+    int executados = 0;
+    for (int g = 0; g < numGrupos; g++) {
+        if (argc < 2 || strcmp(argv[1], grupos[g].nome) == 0) {
+            grupos[g].testa();
+            executados++;
+        }
+    }
+    if (executados == 0) {
+        printf("Uso: ./teste_huffman [blocos | fluxo | truncados | mensagens | arvores | transferencias]\n");
+        return 1;
+    }
+    if (falhas > 0) {
+        printf("%d verificações falharam\n", falhas);
+        return 1;
+    }
+    printf("OK\n");
+    return 0;
+}
@@ -0,0 +1,716 @@
+#define _GNU_SOURCE
+#define _FILE_OFFSET_BITS 64
+#include "transferencia.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#if defined(HUFFMAN_IO_URING) && defined(__linux__)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#if defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter)
+#define USA_IO_URING
+#endif
+#endif
+
+#define MAX_THREADS_TRANSFERENCIA 4
+
+struct filaTransferencias {
+    PoolThreads* pool;              ///< threads de pread/pwrite (0 threads = síncrona); NULL com io_uring
+    int profundidade;
+#ifdef USA_IO_URING
+    int anel;                       ///< descritor do io_uring (-1 = sem io_uring)
+    int emAndamento;                ///< transferências enviadas ao anel e ainda não colhidas
+    int erroAnel;                   ///< errno do io_uring_enter que falhou ao aguardar (0 = anel em uso)
+    void* mapaSq;
+    size_t tamanhoMapaSq;
+    void* mapaCq;                   ///< igual a mapaSq com IORING_FEAT_SINGLE_MMAP
+    size_t tamanhoMapaCq;
+    struct io_uring_sqe* sqes;
+    size_t tamanhoSqes;
+    unsigned* sqCabeca;
+    unsigned* sqCauda;
+    unsigned* sqMascara;
+    unsigned* sqVetor;
+    unsigned* cqCabeca;
+    unsigned* cqCauda;
+    unsigned* cqMascara;
+    struct io_uring_cqe* cqes;
+#endif
+};
+
+/**
+ * @brief Faz a transferência inteira com pread/pwrite (thread do pool ou a própria chamada).
+ */
+static void executaTransferencia(void* arg) {
+    Transferencia* t = (Transferencia*) arg;
+    while (t->transferidos < t->tamanho) {
+        unsigned char* p = t->buffer + t->transferidos;
+        size_t n = t->tamanho - t->transferidos;
+        off_t offset = (off_t) (t->offset + t->transferidos);
+        ssize_t r = t->gravacao ? pwrite(t->fd, p, n, offset) : pread(t->fd, p, n, offset);
+        if (r < 0 && errno == EINTR) {
+            continue;
+        }
+        if (r < 0 || (r == 0 && t->gravacao)) {
+            t->erro = r < 0 ? errno : EIO;
+            return;
+        }
+        if (r == 0) {
+            return;     // fim do arquivo
+        }
+        t->transferidos += (size_t) r;
+    }
+}
+
+#ifdef USA_IO_URING
+/**
+ * @brief Cria o anel e mapeia as filas de envio e de conclusão.
+ * @return 0 em sucesso; -1 se o kernel não oferece io_uring (ou o recusa, como em alguns contêineres).
+ */
+static int criaAnel(FilaTransferencias* f) {
+    struct io_uring_params p;
+    memset(&p, 0, sizeof(p));
+    f->anel = (int) syscall(__NR_io_uring_setup, (unsigned) f->profundidade, &p);
+    if (f->anel < 0) {
+        return -1;
+    }
+    f->tamanhoMapaSq = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    f->tamanhoMapaCq = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+    if (p.features & IORING_FEAT_SINGLE_MMAP) {
+        if (f->tamanhoMapaCq > f->tamanhoMapaSq) {
+            f->tamanhoMapaSq = f->tamanhoMapaCq;
+        }
+        f->tamanhoMapaCq = 0;
+    }
+    f->mapaSq = mmap(NULL, f->tamanhoMapaSq, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, f->anel,
+                     IORING_OFF_SQ_RING);
+    if (f->mapaSq == MAP_FAILED) {
+        f->mapaSq = NULL;
+        return -1;
+    }
+    f->mapaCq = f->mapaSq;
+    if (f->tamanhoMapaCq > 0) {
+        f->mapaCq = mmap(NULL, f->tamanhoMapaCq, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, f->anel,
+                         IORING_OFF_CQ_RING);
+        if (f->mapaCq == MAP_FAILED) {
+            f->mapaCq = NULL;
+            return -1;
+        }
+    }
+    f->tamanhoSqes = p.sq_entries * sizeof(struct io_uring_sqe);
+    f->sqes = (struct io_uring_sqe*) mmap(NULL, f->tamanhoSqes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                                          f->anel, IORING_OFF_SQES);
+    if (f->sqes == MAP_FAILED) {
+        f->sqes = NULL;
+        return -1;
+    }
+
+    unsigned char* sq = (unsigned char*) f->mapaSq;
+    unsigned char* cq = (unsigned char*) f->mapaCq;
+    f->sqCabeca = (unsigned*) (sq + p.sq_off.head);
+    f->sqCauda = (unsigned*) (sq + p.sq_off.tail);
+    f->sqMascara = (unsigned*) (sq + p.sq_off.ring_mask);
+    f->sqVetor = (unsigned*) (sq + p.sq_off.array);
+    f->cqCabeca = (unsigned*) (cq + p.cq_off.head);
+    f->cqCauda = (unsigned*) (cq + p.cq_off.tail);
+    f->cqMascara = (unsigned*) (cq + p.cq_off.ring_mask);
+    f->cqes = (struct io_uring_cqe*) (cq + p.cq_off.cqes);
+    f->profundidade = (int) p.sq_entries;
+    return 0;
+}
+
+/**
+ * @brief Desfaz os mapeamentos e fecha o anel.
+ */
+static void liberaAnel(FilaTransferencias* f) {
+    if (f->sqes) {
+        munmap(f->sqes, f->tamanhoSqes);
+    }
+    if (f->mapaCq && f->mapaCq != f->mapaSq) {
+        munmap(f->mapaCq, f->tamanhoMapaCq);
+    }
+    if (f->mapaSq) {
+        munmap(f->mapaSq, f->tamanhoMapaSq);
+    }
+    if (f->anel >= 0) {
+        close(f->anel);
+    }
+    f->anel = -1;
+}
+
+/**
+ * @brief Chama io_uring_enter, repetindo se interrompido.
+ * @return Retorno da chamada (entradas enviadas) ou -1 em erro.
+ */
+static int entraAnel(FilaTransferencias* f, unsigned enviar, unsigned aguardar) {
+    for (;;) {
+        int r = (int) syscall(__NR_io_uring_enter, f->anel, enviar, aguardar,
+                              aguardar > 0 ? IORING_ENTER_GETEVENTS : 0, NULL, 0);
+        if (r >= 0 || errno != EINTR) {
+            return r;
+        }
+    }
+}
+
+/**
+ * @brief Envia ao anel o restante da transferência (do byte transferidos em diante).
+ * @details Se o kernel recusar o envio, ou o anel já tiver falhado, a transferência é feita com
+ *          pread/pwrite na própria chamada.
+ */
+static void enviaAnel(FilaTransferencias* f, Transferencia* t) {
+    if (f->erroAnel) {
+        executaTransferencia(t);
+        t->concluida = 1;
+        return;
+    }
+    unsigned cauda = *f->sqCauda;
+    unsigned i = cauda & *f->sqMascara;
+    struct io_uring_sqe* e = &f->sqes[i];
+    memset(e, 0, sizeof(*e));
+    t->vetor.iov_base = t->buffer + t->transferidos;
+    t->vetor.iov_len = t->tamanho - t->transferidos;
+    e->opcode = t->gravacao ? IORING_OP_WRITEV : IORING_OP_READV;
+    e->fd = t->fd;
+    e->addr = (unsigned long long int) (uintptr_t) &t->vetor;
+    e->len = 1;
+    e->off = t->offset + t->transferidos;
+    e->user_data = (unsigned long long int) (uintptr_t) t;
+    f->sqVetor[i] = i;
+    __atomic_store_n(f->sqCauda, cauda + 1, __ATOMIC_RELEASE);
+
+    if (entraAnel(f, 1, 0) == 1 || __atomic_load_n(f->sqCabeca, __ATOMIC_ACQUIRE) != cauda) {
+        f->emAndamento++;
+        return;
+    }
+    // Não consumida pelo kernel: desfaz o envio
+    __atomic_store_n(f->sqCauda, cauda, __ATOMIC_RELEASE);
+    executaTransferencia(t);
+    t->concluida = 1;
+}
+
+/**
+ * @brief Processa as conclusões já disponíveis, reenviando as transferências parciais.
+ */
+static void colheAnel(FilaTransferencias* f) {
+    if (f->erroAnel) {
+        return;     // as transferências que restavam já foram dadas como falhas
+    }
+    unsigned cabeca = *f->cqCabeca;
+    while (cabeca != __atomic_load_n(f->cqCauda, __ATOMIC_ACQUIRE)) {
+        const struct io_uring_cqe* c = &f->cqes[cabeca & *f->cqMascara];
+        Transferencia* t = (Transferencia*) (uintptr_t) c->user_data;
+        int r = c->res;
+        __atomic_store_n(f->cqCabeca, ++cabeca, __ATOMIC_RELEASE);
+        f->emAndamento--;
+
+        if (r == -EINTR || r == -EAGAIN) {
+            enviaAnel(f, t);
+            continue;
+        }
+        if (r < 0 || (r == 0 && t->gravacao)) {
+            t->erro = r < 0 ? -r : EIO;
+        } else if (r > 0) {
+            t->transferidos += (size_t) r;
+            if (t->transferidos < t->tamanho) {
+                enviaAnel(f, t);
+                continue;
+            }
+        }
+        t->concluida = 1;
+    }
+}
+
+/**
+ * @brief Bloqueia até o anel ter ao menos uma conclusão e a processa.
+ * @details Se io_uring_enter falhar com outro erro que não EAGAIN ou EBUSY, o anel deixa de ser usado:
+ *          as transferências que aguardavam falham com esse errno e as seguintes são feitas com
+ *          pread/pwrite.
+ * @return 0 em sucesso; -1 se o anel falhou (errno indica a causa).
+ */
+static int aguardaAnel(FilaTransferencias* f) {
+    if (f->erroAnel == 0 && f->emAndamento > 0 && entraAnel(f, 0, 1) < 0 && errno != EAGAIN && errno != EBUSY) {
+        f->erroAnel = errno;
+    }
+    if (f->erroAnel) {
+        errno = f->erroAnel;
+        return -1;
+    }
+    colheAnel(f);
+    return 0;
+}
+#endif
+
+/**
+ * @brief Cria uma fila de transferências.
+ * @param profundidade Transferências em andamento ao mesmo tempo; 0 = síncrona (cada transferência é
+ *        feita por submeteTransferencia, sem threads nem io_uring).
+ * @return Fila criada ou NULL em falta de memória.
+ */
+FilaTransferencias* criaFilaTransferencias(int profundidade) {
+    FilaTransferencias* f = (FilaTransferencias*) calloc(1, sizeof(FilaTransferencias));
+    if (f == NULL) {
+        return NULL;
+    }
+    f->profundidade = profundidade > 0 ? profundidade : 0;
+#ifdef USA_IO_URING
+    f->anel = -1;
+    if (f->profundidade > 0) {
+        if (criaAnel(f) == 0) {
+            return f;
+        }
+        liberaAnel(f);
+    }
+#endif
+    int numThreads = f->profundidade < MAX_THREADS_TRANSFERENCIA ? f->profundidade : MAX_THREADS_TRANSFERENCIA;
+    f->pool = criaPoolThreads(numThreads);
+    if (f->pool == NULL) {
+        free(f);
+        return NULL;
+    }
+    return f;
+}
+
+/**
+ * @brief Inicia uma transferência (se a fila estiver cheia, antes aguarda uma das anteriores).
+ * @param f Fila.
+ * @param t Transferência com fd, buffer, tamanho, offset e gravacao preenchidos.
+ */
+void submeteTransferencia(FilaTransferencias* f, Transferencia* t) {
+    t->transferidos = 0;
+    t->erro = 0;
+    t->concluida = 0;
+#ifdef USA_IO_URING
+    if (f->anel >= 0) {
+        while (f->emAndamento >= f->profundidade) {
+            if (aguardaAnel(f) < 0) {
+                break;
+            }
+        }
+        enviaAnel(f, t);
+        return;
+    }
+#endif
+    t->tarefa.funcao = executaTransferencia;
+    t->tarefa.arg = t;
+    submeteTarefa(f->pool, &t->tarefa);
+}
+
+/**
+ * @brief Bloqueia até que a transferência termine.
+ * @param f Fila.
+ * @param t Transferência submetida anteriormente.
+ * @return 0 em sucesso; -1 em erro de E/S (errno e t->erro indicam a causa).
+ */
+int aguardaTransferencia(FilaTransferencias* f, Transferencia* t) {
+#ifdef USA_IO_URING
+    if (f->anel >= 0) {
+        colheAnel(f);
+        while (!t->concluida) {
+            if (aguardaAnel(f) < 0) {
+                break;
+            }
+        }
+        if (!t->concluida) {
+            t->erro = f->erroAnel;
+            t->concluida = 1;
+        }
+    } else
+#endif
+    {
+        aguardaTarefa(f->pool, &t->tarefa);
+    }
+    if (t->erro != 0) {
+        errno = t->erro;
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Indica, sem bloquear, se a transferência já terminou.
+ * @param f Fila.
+ * @param t Transferência submetida anteriormente.
+ * @return 1 se terminou (aguardaTransferencia retorna imediatamente); 0 caso contrário.
+ */
+int transferenciaConcluida(FilaTransferencias* f, Transferencia* t) {
+#ifdef USA_IO_URING
+    if (f->anel >= 0) {
+        colheAnel(f);
+        return t->concluida;
+    }
+#endif
+    return tarefaConcluida(f->pool, &t->tarefa);
+}
+
+/**
+ * @brief Indica se a fila usa io_uring.
+ * @param f Fila.
+ * @return 1 com io_uring; 0 com threads ou síncrona.
+ */
+int filaUsaIoUring(const FilaTransferencias* f) {
+#ifdef USA_IO_URING
+    return f->anel >= 0;
+#else
+    (void) f;
+    return 0;
+#endif
+}
+
+/**
+ * @brief Aguarda as transferências pendentes e libera a fila.
+ * @param f Fila (pode ser NULL).
+ */
+void liberaFilaTransferencias(FilaTransferencias* f) {
+    if (f == NULL) {
+        return;
+    }
+#ifdef USA_IO_URING
+    if (f->anel >= 0) {
+        while (f->emAndamento > 0) {
+            if (aguardaAnel(f) < 0) {
+                break;
+            }
+        }
+        liberaAnel(f);
+    }
+#endif
+    liberaPoolThreads(f->pool);
+    free(f);
+}
+
+/**
+ * @brief Garante que @p buffer tenha ao menos @p tamanho bytes, alinhados a ALINHAMENTO_TRANSFERENCIA.
+ * @details O conteúdo anterior não é preservado quando o buffer cresce. Liberar com free.
+ * @return 0 em sucesso; -1 em falta de memória.
+ */
+int garanteBufferAlinhado(unsigned char** buffer, size_t* capacidade, size_t tamanho) {
+    if (tamanho <= *capacidade && *buffer != NULL) {
+        return 0;
+    }
+    size_t arredondado = (tamanho + ALINHAMENTO_TRANSFERENCIA - 1) / ALINHAMENTO_TRANSFERENCIA * ALINHAMENTO_TRANSFERENCIA;
+    void* novo;
+    if (posix_memalign(&novo, ALINHAMENTO_TRANSFERENCIA, arredondado > 0 ? arredondado : ALINHAMENTO_TRANSFERENCIA) != 0) {
+        return -1;
+    }
+    free(*buffer);
+    *buffer = (unsigned char*) novo;
+    *capacidade = arredondado;
+    return 0;
+}
+
+/**
+ * @brief Abre um arquivo com open(2), com O_DIRECT quando @p direto for 1 e o sistema de arquivos aceitar.
+ * @param nome Caminho do arquivo.
+ * @param flags Flags de open (sem O_DIRECT).
+ * @param direto 1 para tentar O_DIRECT.
+ * @param comDireto Recebe 1 se o arquivo foi aberto com O_DIRECT (pode ser NULL).
+ * @return Descritor ou -1 em erro (errno indica a causa).
+ */
+int abreArquivoTransferencia(const char* nome, int flags, int direto, int* comDireto) {
+    if (comDireto) {
+        *comDireto = 0;
+    }
+#ifdef O_DIRECT
+    if (direto) {
+        int fd = open(nome, flags | O_DIRECT, 0644);
+        if (fd >= 0) {
+            if (comDireto) {
+                *comDireto = 1;
+            }
+            return fd;
+        }
+        if (errno != EINVAL) {
+            return -1;
+        }
+    }
+#else
+    (void) direto;
+#endif
+    return open(nome, flags, 0644);
+}
+
+struct leitorAntecipado {
+    FilaTransferencias* fila;
+    int fd;
+    unsigned long long int tamanhoArquivo;
+    size_t tamanhoTrecho;
+    int numBuffers;
+    Transferencia* leituras;        ///< o trecho k é lido em leituras[k % numBuffers]
+    unsigned char* buffers;
+    size_t capacidadeBuffers;
+    unsigned long long int numTrechos;
+    unsigned long long int submetidos;
+    unsigned long long int entregues;
+    unsigned long long int devolvidos;
+    int erro;
+};
+
+/**
+ * @brief Submete as leituras dos trechos seguintes enquanto houver buffer livre.
+ */
+static void antecipaLeituras(LeitorAntecipado* l) {
+    while (l->submetidos < l->numTrechos && l->submetidos - l->devolvidos < (unsigned long long int) l->numBuffers) {
+        Transferencia* t = &l->leituras[l->submetidos % l->numBuffers];
+        t->offset = l->submetidos * l->tamanhoTrecho;
+        // Tamanho arredondado para O_DIRECT; a leitura termina antes no fim do arquivo
+        t->tamanho = (l->tamanhoTrecho + ALINHAMENTO_TRANSFERENCIA - 1) / ALINHAMENTO_TRANSFERENCIA *
+                     ALINHAMENTO_TRANSFERENCIA;
+        submeteTransferencia(l->fila, t);
+        l->submetidos++;
+    }
+}
+
+/**
+ * @brief Cria um leitor que lê um arquivo regular em trechos consecutivos de @p tamanhoTrecho bytes,
+ *        mantendo até @p numBuffers trechos lidos ou em leitura à frente de quem os consome.
+ * @param f Fila das leituras.
+ * @param fd Arquivo aberto para leitura (com ou sem O_DIRECT).
+ * @param tamanhoArquivo Tamanho do arquivo.
+ * @param tamanhoTrecho Bytes por trecho (múltiplo de ALINHAMENTO_TRANSFERENCIA com O_DIRECT).
+ * @param numBuffers Trechos entregues e ainda não devolvidos mais os lidos antecipadamente.
+ * @return Leitor ou NULL em falta de memória.
+ */
+LeitorAntecipado* criaLeitorAntecipado(FilaTransferencias* f, int fd, unsigned long long int tamanhoArquivo,
+                                       size_t tamanhoTrecho, int numBuffers) {
+    LeitorAntecipado* l = (LeitorAntecipado*) calloc(1, sizeof(LeitorAntecipado));
+    if (l == NULL) {
+        return NULL;
+    }
+    size_t bytesBuffer = (tamanhoTrecho + ALINHAMENTO_TRANSFERENCIA - 1) / ALINHAMENTO_TRANSFERENCIA *
+                         ALINHAMENTO_TRANSFERENCIA;
+    l->leituras = (Transferencia*) calloc(numBuffers, sizeof(Transferencia));
+    if (l->leituras == NULL || garanteBufferAlinhado(&l->buffers, &l->capacidadeBuffers, bytesBuffer * numBuffers) < 0) {
+        liberaLeitorAntecipado(l);
+        return NULL;
+    }
+    l->fila = f;
+    l->fd = fd;
+    l->tamanhoArquivo = tamanhoArquivo;
+    l->tamanhoTrecho = tamanhoTrecho;
+    l->numBuffers = numBuffers;
+    l->numTrechos = tamanhoArquivo / tamanhoTrecho + (tamanhoArquivo % tamanhoTrecho != 0);
+    for (int i = 0; i < numBuffers; i++) {
+        l->leituras[i].fd = fd;
+        l->leituras[i].buffer = l->buffers + bytesBuffer * i;
+        l->leituras[i].gravacao = 0;
+    }
+    antecipaLeituras(l);
+    return l;
+}
+
+/**
+ * @brief Entrega o próximo trecho, aguardando sua leitura.
+ * @details O trecho continua válido até ser devolvido com devolveTrecho; no máximo numBuffers trechos
+ *          podem estar entregues ao mesmo tempo.
+ * @param l Leitor.
+ * @param trecho Recebe o endereço dos bytes.
+ * @return Quantidade de bytes; 0 no fim do arquivo ou em erro (ver erroLeitorAntecipado).
+ */
+size_t proximoTrecho(LeitorAntecipado* l, const unsigned char** trecho) {
+    if (l->erro || l->entregues == l->numTrechos) {
+        return 0;
+    }
+    antecipaLeituras(l);
+    Transferencia* t = &l->leituras[l->entregues % l->numBuffers];
+    unsigned long long int restante = l->tamanhoArquivo - t->offset;
+    size_t esperado = restante < l->tamanhoTrecho ? (size_t) restante : l->tamanhoTrecho;
+    l->entregues++;
+    if (aguardaTransferencia(l->fila, t) < 0 || t->transferidos < esperado) {
+        l->erro = 1;
+        return 0;
+    }
+    *trecho = t->buffer;
+    return esperado;
+}
+
+/**
+ * @brief Devolve o trecho entregue há mais tempo; o buffer passa a ler um trecho à frente.
+ * @param l Leitor.
+ */
+void devolveTrecho(LeitorAntecipado* l) {
+    if (l->devolvidos < l->entregues) {
+        l->devolvidos++;
+        antecipaLeituras(l);
+    }
+}
+
+/**
+ * @brief Indica se alguma leitura falhou ou terminou antes do tamanho informado do arquivo.
+ * @param l Leitor.
+ * @return Diferente de zero em caso de erro.
+ */
+int erroLeitorAntecipado(const LeitorAntecipado* l) {
+    return l->erro;
+}
+
+/**
+ * @brief Aguarda as leituras pendentes e libera o leitor e seus buffers.
+ * @param l Leitor (pode ser NULL).
+ */
+void liberaLeitorAntecipado(LeitorAntecipado* l) {
+    if (l == NULL) {
+        return;
+    }
+    for (unsigned long long int k = l->entregues; k < l->submetidos; k++) {
+        aguardaTransferencia(l->fila, &l->leituras[k % l->numBuffers]);
+    }
+    free(l->leituras);
+    free(l->buffers);
+    free(l);
+}
+
+struct gravadorAdiado {
+    FilaTransferencias* fila;
+    int fd;
+    int direto;
+    size_t tamanhoBuffer;
+    int numBuffers;
+    Transferencia* gravacoes;       ///< o k-ésimo buffer do arquivo é gravado de gravacoes[k % numBuffers]
+    unsigned char* buffers;
+    size_t capacidadeBuffers;
+    unsigned long long int enviados;    ///< buffers submetidos; o em preenchimento é o de índice enviados
+    unsigned long long int aguardados;
+    size_t usados;                  ///< bytes no buffer em preenchimento
+    int erro;                       ///< errno da primeira gravação que falhou
+};
+
+/**
+ * @brief Aguarda a gravação mais antiga ainda pendente, guardando a primeira falha.
+ */
+static void aguardaGravacao(GravadorAdiado* g) {
+    if (aguardaTransferencia(g->fila, &g->gravacoes[g->aguardados % g->numBuffers]) < 0 && g->erro == 0) {
+        g->erro = errno;
+    }
+    g->aguardados++;
+}
+
+/**
+ * @brief Submete o buffer em preenchimento com @p tamanho bytes.
+ */
+static void enviaBufferGravacao(GravadorAdiado* g, size_t tamanho) {
+    Transferencia* t = &g->gravacoes[g->enviados % g->numBuffers];
+    t->offset = g->enviados * g->tamanhoBuffer;
+    t->tamanho = tamanho;
+    submeteTransferencia(g->fila, t);
+    g->enviados++;
+    g->usados = 0;
+}
+
+/**
+ * @brief Cria um gravador que acumula bytes em buffers de @p tamanhoBuffer bytes e grava cada buffer
+ *        cheio em segundo plano, do início do arquivo em diante.
+ * @param f Fila das gravações.
+ * @param fd Arquivo aberto para escrita, vazio (com ou sem O_DIRECT).
+ * @param tamanhoBuffer Bytes por gravação (múltiplo de ALINHAMENTO_TRANSFERENCIA).
+ * @param numBuffers Buffers em gravação mais o em preenchimento (pelo menos 2).
+ * @param direto 1 se @p fd foi aberto com O_DIRECT: o último trecho, de tamanho qualquer, é gravado
+ *        depois de desligar O_DIRECT.
+ * @return Gravador ou NULL em falta de memória.
+ */
+GravadorAdiado* criaGravadorAdiado(FilaTransferencias* f, int fd, size_t tamanhoBuffer, int numBuffers, int direto) {
+    GravadorAdiado* g = (GravadorAdiado*) calloc(1, sizeof(GravadorAdiado));
+    if (g == NULL) {
+        return NULL;
+    }
+    g->gravacoes = (Transferencia*) calloc(numBuffers, sizeof(Transferencia));
+    if (g->gravacoes == NULL ||
+        garanteBufferAlinhado(&g->buffers, &g->capacidadeBuffers, tamanhoBuffer * numBuffers) < 0) {
+        liberaGravadorAdiado(g);
+        return NULL;
+    }
+    g->fila = f;
+    g->fd = fd;
+    g->direto = direto;
+    g->tamanhoBuffer = tamanhoBuffer;
+    g->numBuffers = numBuffers;
+    for (int i = 0; i < numBuffers; i++) {
+        g->gravacoes[i].fd = fd;
+        g->gravacoes[i].buffer = g->buffers + tamanhoBuffer * i;
+        g->gravacoes[i].gravacao = 1;
+    }
+    return g;
+}
+
+/**
+ * @brief Acrescenta @p n bytes ao arquivo (copiados; @p bytes pode ser reutilizado ao retornar).
+ * @param g Gravador.
+ * @param bytes Bytes a gravar.
+ * @param n Quantidade de bytes.
+ * @return 0 em sucesso; -1 se uma gravação anterior falhou (errno indica a causa).
+ */
+int gravaAdiado(GravadorAdiado* g, const void* bytes, size_t n) {
+    const unsigned char* p = (const unsigned char*) bytes;
+    while (n > 0 && g->erro == 0) {
+        if (g->usados == 0 && g->enviados - g->aguardados == (unsigned long long int) g->numBuffers) {
+            aguardaGravacao(g);     // o buffer a preencher ainda está em gravação
+            continue;
+        }
+        size_t parte = g->tamanhoBuffer - g->usados < n ? g->tamanhoBuffer - g->usados : n;
+        memcpy(g->gravacoes[g->enviados % g->numBuffers].buffer + g->usados, p, parte);
+        g->usados += parte;
+        p += parte;
+        n -= parte;
+        if (g->usados == g->tamanhoBuffer) {
+            enviaBufferGravacao(g, g->tamanhoBuffer);
+        }
+    }
+    if (g->erro != 0) {
+        errno = g->erro;
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Grava o buffer incompleto e aguarda todas as gravações.
+ * @param g Gravador.
+ * @return 0 em sucesso; -1 se alguma gravação falhou (errno indica a causa).
+ */
+int concluiGravadorAdiado(GravadorAdiado* g) {
+    if (g->usados > 0 && g->erro == 0) {
+#ifdef O_DIRECT
+        if (g->direto) {
+            // O último trecho não tem tamanho alinhado: grava sem O_DIRECT, depois dos anteriores
+            while (g->aguardados < g->enviados) {
+                aguardaGravacao(g);
+            }
+            int flags = fcntl(g->fd, F_GETFL);
+            if (flags < 0 || fcntl(g->fd, F_SETFL, flags & ~O_DIRECT) < 0) {
+                g->erro = errno;
+            }
+        }
+#endif
+        if (g->erro == 0) {
+            enviaBufferGravacao(g, g->usados);
+        }
+    }
+    while (g->aguardados < g->enviados) {
+        aguardaGravacao(g);
+    }
+    if (g->erro != 0) {
+        errno = g->erro;
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Aguarda as gravações pendentes (sem gravar o buffer incompleto) e libera o gravador.
+ * @param g Gravador (pode ser NULL).
+ */
+void liberaGravadorAdiado(GravadorAdiado* g) {
+    if (g == NULL) {
+        return;
+    }
+    while (g->gravacoes && g->aguardados < g->enviados) {
+        aguardaGravacao(g);
+    }
+    free(g->gravacoes);
+    free(g->buffers);
+    free(g);
+}
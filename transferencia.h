@@ -0,0 +1,182 @@
+#ifndef TRANSFERENCIA_H
+#define TRANSFERENCIA_H
+
+#include <stddef.h>
+#include <sys/uio.h>
+#include "pool.h"
+
+/**
+ * @file transferencia.h
+ * @brief Leituras e gravações de arquivo assíncronas, para sobrepor E/S e processamento.
+ * @details No Linux com io_uring (compilado com HUFFMAN_IO_URING e aceito pelo kernel), as transferências
+ *          vão direto para o anel do kernel; nos outros casos, threads próprias fazem pread/pwrite.
+ *          Uma fila é usada por uma única thread (a que submete e aguarda).
+ *          Com O_DIRECT, os buffers, as posições e os tamanhos devem ser múltiplos de
+ *          ALINHAMENTO_TRANSFERENCIA (garanteBufferAlinhado garante os buffers).
+ */
+
+#define ALINHAMENTO_TRANSFERENCIA 4096
+
+typedef struct filaTransferencias FilaTransferencias;
+
+/**
+ * @brief Leitura ou gravação de um trecho de arquivo.
+ * @details A estrutura pertence a quem submete e deve permanecer válida até a transferência ser
+ *          aguardada. Uma leitura termina antes de @p tamanho bytes apenas no fim do arquivo.
+ */
+typedef struct transferencia {
+    int fd;
+    unsigned char* buffer;
+    size_t tamanho;
+    unsigned long long int offset;
+    int gravacao;                   ///< 1 = pwrite; 0 = pread
+    size_t transferidos;            ///< bytes já transferidos
+    int erro;                       ///< errno da falha (0 = sucesso)
+    Tarefa tarefa;                  ///< uso interno (threads com pread/pwrite)
+    struct iovec vetor;             ///< uso interno (io_uring)
+    int concluida;                  ///< uso interno (io_uring)
+} Transferencia;
+
+/**
+ * @brief Cria uma fila de transferências.
+ * @param profundidade Transferências em andamento ao mesmo tempo; 0 = síncrona (cada transferência é
+ *        feita por submeteTransferencia, sem threads nem io_uring).
+ * @return Fila criada ou NULL em falta de memória.
+ */
+FilaTransferencias* criaFilaTransferencias(int profundidade);
+
+/**
+ * @brief Inicia uma transferência (se a fila estiver cheia, antes aguarda uma das anteriores).
+ * @param f Fila.
+ * @param t Transferência com fd, buffer, tamanho, offset e gravacao preenchidos.
+ */
+void submeteTransferencia(FilaTransferencias* f, Transferencia* t);
+
+/**
+ * @brief Bloqueia até que a transferência termine.
+ * @param f Fila.
+ * @param t Transferência submetida anteriormente.
+ * @return 0 em sucesso; -1 em erro de E/S (errno e t->erro indicam a causa).
+ */
+int aguardaTransferencia(FilaTransferencias* f, Transferencia* t);
+
+/**
+ * @brief Indica, sem bloquear, se a transferência já terminou.
+ * @param f Fila.
+ * @param t Transferência submetida anteriormente.
+ * @return 1 se terminou (aguardaTransferencia retorna imediatamente); 0 caso contrário.
+ */
+int transferenciaConcluida(FilaTransferencias* f, Transferencia* t);
+
+/**
+ * @brief Indica se a fila usa io_uring.
+ * @param f Fila.
+ * @return 1 com io_uring; 0 com threads ou síncrona.
+ */
+int filaUsaIoUring(const FilaTransferencias* f);
+
+/**
+ * @brief Aguarda as transferências pendentes e libera a fila.
+ * @param f Fila (pode ser NULL).
+ */
+void liberaFilaTransferencias(FilaTransferencias* f);
+
+/**
+ * @brief Garante que @p buffer tenha ao menos @p tamanho bytes, alinhados a ALINHAMENTO_TRANSFERENCIA.
+ * @details O conteúdo anterior não é preservado quando o buffer cresce. Liberar com free.
+ * @return 0 em sucesso; -1 em falta de memória.
+ */
+int garanteBufferAlinhado(unsigned char** buffer, size_t* capacidade, size_t tamanho);
+
+/**
+ * @brief Abre um arquivo com open(2), com O_DIRECT quando @p direto for 1 e o sistema de arquivos aceitar.
+ * @param nome Caminho do arquivo.
+ * @param flags Flags de open (sem O_DIRECT).
+ * @param direto 1 para tentar O_DIRECT.
+ * @param comDireto Recebe 1 se o arquivo foi aberto com O_DIRECT (pode ser NULL).
+ * @return Descritor ou -1 em erro (errno indica a causa).
+ */
+int abreArquivoTransferencia(const char* nome, int flags, int direto, int* comDireto);
+
+typedef struct leitorAntecipado LeitorAntecipado;
+
+/**
+ * @brief Cria um leitor que lê um arquivo regular em trechos consecutivos de @p tamanhoTrecho bytes,
+ *        mantendo até @p numBuffers trechos lidos ou em leitura à frente de quem os consome.
+ * @param f Fila das leituras.
+ * @param fd Arquivo aberto para leitura (com ou sem O_DIRECT).
+ * @param tamanhoArquivo Tamanho do arquivo.
+ * @param tamanhoTrecho Bytes por trecho (múltiplo de ALINHAMENTO_TRANSFERENCIA com O_DIRECT).
+ * @param numBuffers Trechos entregues e ainda não devolvidos mais os lidos antecipadamente.
+ * @return Leitor ou NULL em falta de memória.
+ */
+LeitorAntecipado* criaLeitorAntecipado(FilaTransferencias* f, int fd, unsigned long long int tamanhoArquivo,
+                                       size_t tamanhoTrecho, int numBuffers);
+
+/**
+ * @brief Entrega o próximo trecho, aguardando sua leitura.
+ * @details O trecho continua válido até ser devolvido com devolveTrecho; no máximo numBuffers trechos
+ *          podem estar entregues ao mesmo tempo.
+ * @param l Leitor.
+ * @param trecho Recebe o endereço dos bytes.
+ * @return Quantidade de bytes; 0 no fim do arquivo ou em erro (ver erroLeitorAntecipado).
+ */
+size_t proximoTrecho(LeitorAntecipado* l, const unsigned char** trecho);
+
+/**
+ * @brief Devolve o trecho entregue há mais tempo; o buffer passa a ler um trecho à frente.
+ * @param l Leitor.
+ */
+void devolveTrecho(LeitorAntecipado* l);
+
+/**
+ * @brief Indica se alguma leitura falhou ou terminou antes do tamanho informado do arquivo.
+ * @param l Leitor.
+ * @return Diferente de zero em caso de erro.
+ */
+int erroLeitorAntecipado(const LeitorAntecipado* l);
+
+/**
+ * @brief Aguarda as leituras pendentes e libera o leitor e seus buffers.
+ * @param l Leitor (pode ser NULL).
+ */
+void liberaLeitorAntecipado(LeitorAntecipado* l);
+
+typedef struct gravadorAdiado GravadorAdiado;
+
+/**
+ * @brief Cria um gravador que acumula bytes em buffers de @p tamanhoBuffer bytes e grava cada buffer
+ *        cheio em segundo plano, do início do arquivo em diante.
+ * @param f Fila das gravações.
+ * @param fd Arquivo aberto para escrita, vazio (com ou sem O_DIRECT).
+ * @param tamanhoBuffer Bytes por gravação (múltiplo de ALINHAMENTO_TRANSFERENCIA).
+ * @param numBuffers Buffers em gravação mais o em preenchimento (pelo menos 2).
+ * @param direto 1 se @p fd foi aberto com O_DIRECT: o último trecho, de tamanho qualquer, é gravado
+ *        depois de desligar O_DIRECT.
+ * @return Gravador ou NULL em falta de memória.
+ */
+GravadorAdiado* criaGravadorAdiado(FilaTransferencias* f, int fd, size_t tamanhoBuffer, int numBuffers, int direto);
+
+/**
+ * @brief Acrescenta @p n bytes ao arquivo (copiados; @p bytes pode ser reutilizado ao retornar).
+ * @param g Gravador.
+ * @param bytes Bytes a gravar.
+ * @param n Quantidade de bytes.
+ * @return 0 em sucesso; -1 se uma gravação anterior falhou (errno indica a causa).
+ */
+int gravaAdiado(GravadorAdiado* g, const void* bytes, size_t n);
+
+/**
+ * @brief Grava o buffer incompleto e aguarda todas as gravações.
+ * @param g Gravador.
+ * @return 0 em sucesso; -1 se alguma gravação falhou (errno indica a causa).
+ */
+int concluiGravadorAdiado(GravadorAdiado* g);
+
+/**
+ * @brief Aguarda as gravações pendentes (sem gravar o buffer incompleto) e libera o gravador.
+ * @param g Gravador (pode ser NULL).
+ */
+void liberaGravadorAdiado(GravadorAdiado* g);
+
+#endif
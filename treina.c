@@ -0,0 +1,53 @@
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "libhuffman.h"
+
+/**
+ * @brief Programa de treino de dicionários (libhuffman.h) para compactar mensagens pequenas.
+ * @details Soma as frequências dos arquivos de amostra e grava os códigos resultantes, com o id
+ *          informado, no arquivo de dicionário. O mesmo arquivo é passado com -D a compacta e a
+ *          descompacta; os blocos compactados trazem só o id em vez da árvore.
+ * @param argc Quantidade de argumentos.
+ * @param argv [-l bits] <id> <dicionario> <amostra>...
+ * @return 0 em sucesso; 1 em erro de uso ou de E/S.
+ */
+
+int main(int argc, char* argv[]) {
+    int comprimentoMax = HUFFMAN_COMPRIMENTO_MAX;
+    int i = 1;
+    if (i + 1 < argc && strcmp(argv[i], "-l") == 0) {
+        comprimentoMax = atoi(argv[i + 1]);
+        i += 2;
+    }
+
+    char* fim = NULL;
+    unsigned long int id = i < argc ? strtoul(argv[i], &fim, 10) : 0;
+    if (argc - i < 3 || fim == argv[i] || *fim != '\0' || id > 0xFFFFFFFFul ||
+        comprimentoMax < HUFFMAN_COMPRIMENTO_MIN || comprimentoMax > HUFFMAN_COMPRIMENTO_MAX) {
+        printf("Uso: ./treina [-l <bits por código, %d-%d>] <id> <dicionario> <amostra>...\n",
+               HUFFMAN_COMPRIMENTO_MIN, HUFFMAN_COMPRIMENTO_MAX);
+        return 1;
+    }
+    const char* nomeDicionario = argv[i + 1];
+
+    DicionarioHuffman* dicionario;
+    int codigo = treinaDicionario((const char* const*) argv + i + 2, argc - i - 2, (unsigned int) id,
+                                  comprimentoMax, &dicionario);
+    if (codigo == HUFFMAN_OK) {
+        codigo = gravaDicionarioArquivo(dicionario, nomeDicionario);
+        liberaDicionarioHuffman(dicionario);
+    }
+    if (codigo == HUFFMAN_ERRO_ENTRADA || codigo == HUFFMAN_ERRO_SAIDA) {
+        printf("Erro: %s: %s\n", mensagemErroHuffman(codigo), strerror(errno));
+        exit(1);
+    }
+    if (codigo != HUFFMAN_OK) {
+        printf("Erro: %s\n", mensagemErroHuffman(codigo));
+        exit(1);
+    }
+
+    printf("Dicionário %lu gravado em %s (%d amostras)\n", id, nomeDicionario, argc - i - 2);
+    return 0;
+}